@@ -0,0 +1,61 @@
+(function() {
+"use strict";
+
+load("jstests/libs/optimizer_utils.js");  // For checkCascadesOptimizerEnabled.
+if (!checkCascadesOptimizerEnabled(db)) {
+    jsTestLog("Skipping test because the optimizer is not enabled");
+    return;
+}
+
+const coll = db.cqf_analyze;
+coll.drop();
+const statsColl = db.getCollection("system.statistics." + coll.getName());
+statsColl.drop();
+
+// A skewed distribution: most documents share the same value of 'a'.
+const bulk = coll.initializeUnorderedBulkOp();
+const nDocs = 1000;
+const nSkewed = 900;
+for (let i = 0; i < nDocs; i++) {
+    bulk.insert({a: i < nSkewed ? 1 : i, b: [i, i + 1]});
+}
+assert.commandWorked(bulk.execute());
+
+assert.commandFailedWithCode(db.runCommand({analyze: "cqf_analyze_missing", key: "a"}),
+                             ErrorCodes.NamespaceNotFound);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), key: "a..b"}),
+                             ErrorCodes.InvalidOptions);
+
+assert.commandWorked(db.runCommand({analyze: coll.getName(), key: "a"}));
+assert.commandWorked(db.runCommand(
+    {analyze: coll.getName(), key: "b", numberBuckets: 10, writeConcern: {w: "majority"}}));
+
+let stats = statsColl.findOne({_id: "a"});
+assert.eq(nDocs, stats.statistics.documents, tojson(stats));
+assert.eq(0, stats.statistics.arrayCount, tojson(stats));
+
+stats = statsColl.findOne({_id: "b"});
+assert.eq(nDocs, stats.statistics.arrayCount, tojson(stats));
+assert.gte(10, stats.statistics.arrayUniqueHistogram.buckets.length, tojson(stats));
+
+const getParam = db.adminCommand(
+    {getParameter: 1, internalQueryEnableHistogramCardinalityEstimator: 1});
+assert.commandWorked(getParam);
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryEnableHistogramCardinalityEstimator: true}));
+
+try {
+    const res = coll.explain().aggregate([{$match: {'a': 1}}]);
+    const props = res.queryPlanner.winningPlan.optimizerPlan.properties;
+
+    // The histogram records the frequency of the skewed value.
+    assert.lt(nSkewed * 0.9, props.adjustedCE, tojson(res));
+    assert.gt(nSkewed * 1.1, props.adjustedCE, tojson(res));
+} finally {
+    assert.commandWorked(db.adminCommand({
+        setParameter: 1,
+        internalQueryEnableHistogramCardinalityEstimator:
+            getParam.internalQueryEnableHistogramCardinalityEstimator
+    }));
+}
+}());
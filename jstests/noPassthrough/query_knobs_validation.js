@@ -50,6 +50,7 @@ const expectedParamDefaults = {
     internalQueryIgnoreUnknownJSONSchemaKeywords: false,
     internalQueryProhibitBlockingMergeOnMongoS: false,
     internalQuerySlotBasedExecutionMaxStaticIndexScanIntervals: 1000,
+    internalQuerySlotBasedExecutionGroupBlockSize: 0,
 };
 
 function assertDefaultParameterValues() {
@@ -206,6 +207,11 @@ assertSetParameterSucceeds("internalQuerySlotBasedExecutionMaxStaticIndexScanInt
 assertSetParameterFails("internalQuerySlotBasedExecutionMaxStaticIndexScanIntervals", 0);
 assertSetParameterFails("internalQuerySlotBasedExecutionMaxStaticIndexScanIntervals", -1);
 
+assertSetParameterSucceeds("internalQuerySlotBasedExecutionGroupBlockSize", 1024);
+assertSetParameterSucceeds("internalQuerySlotBasedExecutionGroupBlockSize", 0);
+assertSetParameterFails("internalQuerySlotBasedExecutionGroupBlockSize", -1);
+assertSetParameterFails("internalQuerySlotBasedExecutionGroupBlockSize", 65537);
+
 assertSetParameterSucceeds("internalQueryForceClassicEngine", true);
 assertSetParameterSucceeds("internalQueryForceClassicEngine", false);
 
@@ -0,0 +1,92 @@
+/**
+ * Tests that a $group which the SBE stage builder runs a block at a time, as enabled by
+ * 'internalQuerySlotBasedExecutionGroupBlockSize', returns the same results as when it runs one row
+ * at a time.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStages.
+load("jstests/libs/sbe_util.js");      // For checkSBEEnabled.
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+const db = conn.getDB(jsTestName());
+
+if (!checkSBEEnabled(db, ["featureFlagSBEGroupPushdown"])) {
+    jsTestLog("Skipping test because SBE $group pushdown is disabled");
+    MongoRunner.stopMongod(conn);
+    return;
+}
+
+const coll = db.coll;
+const docs = [];
+for (let i = 0; i < 1000; ++i) {
+    docs.push({
+        _id: i,
+        a: (i % 7) - 3,
+        b: i % 5 === 0 ? null : i * 0.5,
+        c: i % 3 === 0 ? "s" + i : NumberLong(i),
+    });
+}
+docs.push({_id: 1000});
+docs.push({_id: 1001, a: [1, 2], b: {x: 1}, c: NaN});
+assert.commandWorked(coll.insert(docs));
+
+function setBlockSize(blockSize) {
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalQuerySlotBasedExecutionGroupBlockSize: blockSize}));
+}
+
+function usesBlocks(pipeline, options = {}) {
+    const explain = coll.explain("executionStats").aggregate(pipeline, options);
+    assert(explain.hasOwnProperty("executionStats"), explain);
+    return getPlanStages(explain.executionStats.executionStages, "blockpack").length > 0;
+}
+
+const pipelines = [
+    [{
+        $group: {
+            _id: null,
+            minA: {$min: "$a"},
+            maxA: {$max: "$a"},
+            minB: {$min: "$b"},
+            maxB: {$max: "$b"},
+            minC: {$min: "$c"},
+            maxC: {$max: "$c"},
+        }
+    }],
+    [{$match: {a: {$gt: 0}}}, {$group: {_id: "all", min: {$min: "$b"}, max: {$max: "$b"}}}],
+    [{
+        $group:
+            {_id: null, min: {$min: {$ifNull: ["$a", "none"]}}, missing: {$max: "$noSuchField"}}
+    }],
+    [{$match: {_id: {$lt: 0}}}, {$group: {_id: null, min: {$min: "$a"}}}],
+];
+
+try {
+    for (const pipeline of pipelines) {
+        setBlockSize(0);
+        assert(!usesBlocks(pipeline), pipeline);
+        const expected = coll.aggregate(pipeline).toArray();
+
+        for (const blockSize of [1, 7, 128]) {
+            setBlockSize(blockSize);
+            assert(usesBlocks(pipeline), {pipeline, blockSize});
+            assert.eq(expected, coll.aggregate(pipeline).toArray(), {pipeline, blockSize});
+        }
+    }
+
+    // A $group with a non-constant _id, with an accumulator other than $min and $max, or with a
+    // collation still runs one row at a time.
+    setBlockSize(128);
+    assert(!usesBlocks([{$group: {_id: "$a", min: {$min: "$b"}}}]));
+    assert(!usesBlocks([{$group: {_id: null, min: {$min: "$b"}, sum: {$sum: "$b"}}}]));
+    assert(!usesBlocks([{$group: {_id: null, min: {$min: "$c"}}}],
+                       {collation: {locale: "en_US", strength: 2}}));
+} finally {
+    setBlockSize(0);
+}
+
+MongoRunner.stopMongod(conn);
+})();
@@ -30,6 +30,7 @@ const paramList = [
     {name: "internalQueryPlannerGenerateCoveredWholeIndexScans", value: true},
     {name: "internalQueryMaxBlockingSortMemoryUsageBytes", value: 1024},
     {name: "internalQuerySlotBasedExecutionMaxStaticIndexScanIntervals", value: 20},
+    {name: "internalQuerySlotBasedExecutionGroupBlockSize", value: 128},
     {name: "internalQueryDefaultDOP", value: 2},
 ];
 
@@ -0,0 +1,71 @@
+/**
+ * Tests that a node using file copy based initial sync ends up with the data of its sync source,
+ * and keeps it across a restart. Where the sync source cannot open a backup cursor, checks that the
+ * node falls back to logical initial sync instead.
+ *
+ * @tags: [requires_persistence, requires_wiredtiger]
+ */
+(function() {
+"use strict";
+
+const rst = new ReplSetTest({nodes: 1});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const testDB = primary.getDB("test");
+assert.commandWorked(testDB.coll.insert([{_id: 1}, {_id: 2}, {_id: 3}]));
+assert.commandWorked(testDB.coll.createIndex({a: 1}));
+
+// File copy based initial sync copies the files listed by a backup cursor on the sync source.
+let backupCursorsAvailable = true;
+try {
+    primary.getDB("admin").aggregate([{$backupCursor: {}}]).close();
+} catch (e) {
+    jsTestLog("The sync source cannot open a backup cursor: " + tojson(e));
+    backupCursorsAvailable = false;
+}
+
+jsTestLog("Adding a node that uses file copy based initial sync");
+const initialSyncNode = rst.add({
+    rsConfig: {priority: 0, votes: 0},
+    setParameter: {initialSyncMethod: "fileCopyBased", numInitialSyncAttempts: 1},
+});
+rst.reInitiate();
+rst.awaitSecondaryNodes();
+rst.awaitReplication();
+
+function checkSyncedData(node) {
+    node.setSecondaryOk();
+    const syncedColl = node.getDB("test").coll;
+    assert.eq(3, syncedColl.find().itcount());
+    assert.eq(2, syncedColl.getIndexes().length);
+}
+
+if (!backupCursorsAvailable) {
+    checkLog.containsJson(initialSyncNode, 5780600);
+    assert(!checkLog.checkContainsOnceJson(initialSyncNode, 6717025, {}));
+    checkSyncedData(initialSyncNode);
+    jsTestLog("Skipping the file copy checks, as backup cursors are not available");
+    rst.stopSet();
+    return;
+}
+
+// The files were copied and swapped in, without falling back to logical initial sync.
+checkLog.containsJson(initialSyncNode, 6717025);
+assert(!checkLog.checkContainsOnceJson(initialSyncNode, 5780600, {}));
+checkSyncedData(initialSyncNode);
+assert(!pathExists(rst.getDbPath(initialSyncNode) + "/.initialsync"),
+       "the staging directory was left behind");
+
+// The node starts up on the swapped in files and keeps replicating.
+jsTestLog("Restarting the node that used file copy based initial sync");
+const restartedNode = rst.restart(initialSyncNode);
+rst.awaitSecondaryNodes();
+assert.commandWorked(testDB.coll.insert({_id: 4}));
+rst.awaitReplication();
+restartedNode.setSecondaryOk();
+assert.eq(4, restartedNode.getDB("test").coll.find().itcount());
+
+rst.stopSet();
+})();
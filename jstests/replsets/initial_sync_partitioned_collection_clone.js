@@ -0,0 +1,48 @@
+/**
+ * Tests that initial sync clones a collection correctly when it is split into _id ranges, each
+ * fetched over its own connection, including _id values of several types.
+ */
+(function() {
+"use strict";
+
+const replTest = new ReplSetTest({nodes: 1});
+replTest.startSet();
+replTest.initiate();
+
+const dbName = jsTest.name();
+const collName = "test";
+
+const primary = replTest.getPrimary();
+const primaryColl = primary.getDB(dbName)[collName];
+
+jsTestLog("Inserting documents with numeric, string and ObjectId _id values.");
+const bulk = primaryColl.initializeUnorderedBulkOp();
+for (let i = 0; i < 1000; ++i) {
+    bulk.insert({_id: i, x: i});
+    bulk.insert({_id: "str" + i, x: i});
+    bulk.insert({_id: ObjectId(), x: i});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(primaryColl.createIndex({x: 1}));
+
+jsTestLog("Adding a secondary node that clones collections in partitions.");
+const secondary = replTest.add({
+    setParameter: {
+        collectionClonerNumPartitions: 4,
+        collectionClonerPartitionMinBytes: 0,
+        collectionClonerBatchSize: 50,
+    }
+});
+replTest.reInitiate();
+replTest.awaitSecondaryNodes();
+replTest.awaitReplication();
+
+checkLog.containsJson(secondary, 6714002, {namespace: primaryColl.getFullName()});
+
+const secondaryColl = secondary.getDB(dbName)[collName];
+assert.eq(primaryColl.find().itcount(), secondaryColl.find().itcount());
+assert.sameMembers(primaryColl.find().toArray(), secondaryColl.find().toArray());
+assert.eq(2, secondaryColl.getIndexes().length);
+
+replTest.stopSet();
+})();
@@ -0,0 +1,64 @@
+/**
+ * Tests that a secondary with replPipelinedOplogWrites enabled, which writes the next batch to the
+ * oplog while the current batch is being applied, ends up with the same oplog and data as the
+ * primary.
+ */
+
+(function() {
+"use strict";
+
+// Gets the value of metrics.repl.apply.pipelinedBatches.
+function getPipelinedBatches(node) {
+    return assert.commandWorked(node.adminCommand({serverStatus: 1}))
+        .metrics.repl.apply.pipelinedBatches;
+}
+
+// Do a bulk insert of documents as: {{key: 0}, {key: 1}, {key: 2}, ... , {key: num-1}}
+function performBulkInsert(coll, key, num) {
+    let bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < num; i++) {
+        let doc = {};
+        doc[key] = i;
+        bulk.insert(doc);
+    }
+    assert.commandWorked(bulk.execute());
+}
+
+let name = "pipelined_oplog_writes";
+let rst = new ReplSetTest({
+    name: name,
+    nodes: [{}, {rsConfig: {priority: 0}}],
+    // Use small batches so that a burst of writes spans many of them.
+    nodeOptions: {setParameter: {replPipelinedOplogWrites: true, replBatchLimitOperations: 100}}
+});
+rst.startSet();
+rst.initiate();
+
+let primary = rst.getPrimary();
+let secondary = rst.getSecondary();
+let coll = primary.getDB(name)["foo"];
+
+assert.commandWorked(coll.insert({init: 0}));
+rst.awaitReplication();
+
+// Keep the secondary busy with bursts of writes until it has applied a batch that was written to
+// the oplog ahead of time.
+let burst = 0;
+assert.soon(() => {
+    performBulkInsert(coll, "burst" + burst++, 5000);
+    assert.commandWorked(coll.updateMany({}, {$inc: {n: 1}}));
+    return getPipelinedBatches(secondary) > 0;
+});
+rst.awaitReplication();
+
+assert.eq(coll.find().itcount(), secondary.getDB(name)["foo"].find().itcount());
+
+// Restart the secondary to make sure startup recovery handles the oplog it left behind.
+rst.restart(secondary);
+rst.awaitSecondaryNodes();
+performBulkInsert(coll, "afterRestart", 1000);
+rst.awaitReplication();
+
+rst.checkOplogs();
+rst.stopSet();
+})();
@@ -31,6 +31,11 @@ function _testSecondaryMetricsHelper(secondary, opCount, baseOpsApplied, baseOps
     assert.gte(
         ss.metrics.repl.network.ops, opCount + baseOpsApplied, "wrong number of ops retrieved");
     assert(ss.metrics.repl.network.bytes > 0, "zero or missing network bytes");
+    const fetcherMicros = ss.metrics.repl.network.oplogFetcherMicros;
+    assert.gt(fetcherMicros.network, 0, "no oplog fetcher network time");
+    assert.gte(fetcherMicros.decompression, 0, "oplog fetcher decompression time missing");
+    assert.gte(fetcherMicros.parsing, 0, "oplog fetcher parsing time missing");
+    assert.gte(fetcherMicros.enqueue, 0, "oplog fetcher enqueue time missing");
 
     assert.gt(
         ss.metrics.repl.network.replSetUpdatePosition.num, 0, "no update position commands sent");
@@ -202,6 +202,7 @@ let testCases = {
         checkReadConcern: true,
         checkWriteConcern: true,
     },
+    analyze: {skip: "requires the Common Query Framework feature flag"},
     appendOplogNote: {
         command: {appendOplogNote: 1, data: {foo: 1}},
         checkReadConcern: false,
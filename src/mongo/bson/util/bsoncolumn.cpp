@@ -104,6 +104,33 @@ private:
     ElementFunc _elemFunc;
 };
 
+/**
+ * Returns the value of a literal for BSONColumn::decodeTo(), or boost::none if decodeTo() does not
+ * support elements of this type for 'T'.
+ */
+template <typename T>
+boost::optional<T> decodeLiteralTo(const BSONElement& elem) {
+    if constexpr (std::is_same_v<T, double>) {
+        if (elem.type() == NumberDouble) {
+            return elem._numberDouble();
+        }
+    } else {
+        switch (elem.type()) {
+            case NumberInt:
+                return elem._numberInt();
+            case NumberLong:
+                return elem._numberLong();
+            case Date:
+                return elem.date().toMillisSinceEpoch();
+            case bsonTimestamp:
+                return static_cast<int64_t>(elem.timestampValue());
+            default:
+                break;
+        }
+    }
+    return boost::none;
+}
+
 std::size_t hashName(StringData sd) {
     // Keep in sync with DocumentStorageHasher
     unsigned out;
@@ -842,6 +869,112 @@ size_t BSONColumn::size() {
     return _decompressed.size();
 }
 
+template <typename T>
+bool BSONColumn::decodeTo(std::vector<boost::optional<T>>& values) const {
+    // This follows the same decoding steps as Iterator::DecodingState, restricted to the types with
+    // 64-bit deltas that map directly onto 'T'.
+    BSONType lastType = EOO;
+    bool deltaOfDelta = false;
+    int64_t lastEncodedValue = 0;
+    int64_t lastEncodedValueForDeltaOfDelta = 0;
+    T lastValue{};
+    boost::optional<uint64_t> lastSimple8bValue;
+    std::vector<uint64_t> deltas;
+
+    const char* control = _binary;
+    const char* end = _binary + _size;
+    while (true) {
+        uassert(6707002, "Invalid BSON Column encoding", control < end);
+        if (*control == EOO) {
+            return true;
+        }
+        if (*control == kInterleavedStartControlByte) {
+            return false;
+        }
+
+        if (isLiteralControlByte(*control)) {
+            BSONElement literal(control, 1, -1);
+            auto value = decodeLiteralTo<T>(literal);
+            if (!value) {
+                return false;
+            }
+
+            lastType = literal.type();
+            deltaOfDelta = usesDeltaOfDelta(lastType);
+            lastEncodedValue = lastType == NumberDouble ? 0 : static_cast<int64_t>(*value);
+            if (deltaOfDelta) {
+                lastEncodedValueForDeltaOfDelta = lastEncodedValue;
+                lastEncodedValue = 0;
+            }
+            lastValue = *value;
+            lastSimple8bValue = 0;
+
+            values.push_back(lastValue);
+            control += literal.size();
+            continue;
+        }
+
+        const uint8_t scaleIndex =
+            kControlToScaleIndex[(static_cast<uint8_t>(*control) & 0xF0) >> 4];
+        uassert(6707003, "Invalid control byte in BSON Column", scaleIndex != kInvalidScaleIndex);
+        if constexpr (std::is_same_v<T, double>) {
+            auto encoded = Simple8bTypeUtil::encodeDouble(lastValue, scaleIndex);
+            uassert(6707005, "Invalid double encoding in BSON Column", encoded);
+            lastEncodedValue = *encoded;
+        }
+
+        const int size = sizeof(uint64_t) * numSimple8bBlocksForControlByte(*control);
+        uassert(6707006, "Invalid BSON Column encoding", control + size + 1 < end);
+
+        deltas.clear();
+        Simple8b<uint64_t>(control + 1, size, lastSimple8bValue).decode(deltas);
+        if (!deltas.empty()) {
+            lastSimple8bValue = deltas.back() == Simple8b<uint64_t>::skipValue()
+                ? boost::none
+                : boost::make_optional(deltas.back());
+        }
+
+        values.reserve(values.size() + deltas.size());
+        for (uint64_t delta : deltas) {
+            if (delta == Simple8b<uint64_t>::skipValue()) {
+                values.push_back(boost::none);
+                continue;
+            }
+
+            // Only skips may come before the first literal.
+            uassert(6707004, "Invalid BSON Column encoding", lastType != EOO);
+
+            // A zero delta repeats the previous value as is, like the iterator does.
+            if (!deltaOfDelta && delta == 0) {
+                values.push_back(lastValue);
+                continue;
+            }
+
+            lastEncodedValue = expandDelta(lastEncodedValue, Simple8bTypeUtil::decodeInt64(delta));
+            if (deltaOfDelta) {
+                lastEncodedValueForDeltaOfDelta =
+                    expandDelta(lastEncodedValueForDeltaOfDelta, lastEncodedValue);
+            }
+
+            if constexpr (std::is_same_v<T, double>) {
+                lastValue = Simple8bTypeUtil::decodeDouble(lastEncodedValue, scaleIndex);
+            } else if (deltaOfDelta) {
+                lastValue = lastEncodedValueForDeltaOfDelta;
+            } else if (lastType == NumberInt) {
+                lastValue = static_cast<int32_t>(lastEncodedValue);
+            } else {
+                lastValue = lastEncodedValue;
+            }
+            values.push_back(lastValue);
+        }
+
+        control += size + 1;
+    }
+}
+
+template bool BSONColumn::decodeTo<int64_t>(std::vector<boost::optional<int64_t>>&) const;
+template bool BSONColumn::decodeTo<double>(std::vector<boost::optional<double>>&) const;
+
 void BSONColumn::DecodingStartPosition::setIfLarger(size_t index, const char* control) {
     if (_index < index) {
         _control = control;
@@ -254,6 +254,23 @@ public:
      */
     size_t size();
 
+    /**
+     * Bulk decoding. Appends all elements to 'values', with boost::none for skipped elements. This
+     * is considerably faster than iterating, as no BSONElement is materialized and Simple-8b blocks
+     * are unpacked a whole block at a time.
+     *
+     * Supported when every element is a NumberInt, NumberLong, Date or Timestamp and 'T' is
+     * int64_t, or when every element is a NumberDouble and 'T' is double. Dates are decoded as
+     * milliseconds since the epoch and Timestamps as their 64-bit representation.
+     *
+     * Returns false if the BSONColumn contains elements of any other type or interleaved objects.
+     * 'values' is then left in an unspecified state and the caller should iterate instead.
+     *
+     * Throws if invalid encoding is encountered.
+     */
+    template <typename T>
+    bool decodeTo(std::vector<boost::optional<T>>& values) const;
+
     /**
      * Field name that this BSONColumn represents.
      *
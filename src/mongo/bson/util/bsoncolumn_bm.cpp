@@ -190,6 +190,25 @@ void benchmarkDecompression(benchmark::State& state,
                     100.0 * (1 - ((double)compressedElement.valuesize() / uncompressedSize))));
 }
 
+template <typename T>
+void benchmarkBulkDecompression(benchmark::State& state,
+                                const BSONElement& compressedElement,
+                                int valueSize) {
+    uint64_t totalElements = 0;
+    uint64_t totalBytes = 0;
+    std::vector<boost::optional<T>> values;
+    for (auto _ : state) {
+        BSONColumn col(compressedElement);
+        values.clear();
+        invariant(col.decodeTo(values));
+        benchmark::DoNotOptimize(values.data());
+        totalElements += values.size();
+        totalBytes += values.size() * valueSize;
+    }
+    state.SetItemsProcessed(totalElements);
+    state.SetBytesProcessed(totalBytes);
+}
+
 void benchmarkCompression(benchmark::State& state,
                           const BSONElement& compressedElement,
                           int skipSize) {
@@ -255,6 +274,24 @@ void BM_decompressFTDC(benchmark::State& state) {
     benchmarkDecompression(state, compressed.firstElement(), 0);
 }
 
+void BM_bulkDecompressIntegers(benchmark::State& state, int skipPercentage) {
+    BSONObj compressed = buildCompressed(generateIntegers(10000, skipPercentage));
+    benchmarkBulkDecompression<int64_t>(state, compressed.firstElement(), sizeof(int32_t));
+}
+
+void BM_bulkDecompressDoubles(benchmark::State& state, int decimals, int skipPercentage) {
+    BSONObj compressed = buildCompressed(generateDoubles(10000, skipPercentage, decimals));
+    benchmarkBulkDecompression<double>(state, compressed.firstElement(), sizeof(double));
+}
+
+void BM_bulkDecompressTimestamps(benchmark::State& state,
+                                 double mean,
+                                 double stddev,
+                                 int skipPercentage) {
+    BSONObj compressed = buildCompressed(generateTimestamps(10000, skipPercentage, mean, stddev));
+    benchmarkBulkDecompression<int64_t>(state, compressed.firstElement(), sizeof(Timestamp));
+}
+
 void BM_compressIntegers(benchmark::State& state, int skipPercentage) {
     BSONObj compressed = buildCompressed(generateIntegers(10000, skipPercentage));
     benchmarkCompression(state, compressed.firstElement(), sizeof(int32_t));
@@ -311,6 +348,18 @@ BENCHMARK_CAPTURE(BM_decompressTimestamps, Mean = 5 / Stddev = 2 / Skip = 10 %,
 BENCHMARK_CAPTURE(BM_decompressTimestamps, Mean = 1 / Stddev = 0 / Skip = 90 %, 0, 1, 90);
 BENCHMARK_CAPTURE(BM_decompressTimestamps, Mean = 5 / Stddev = 2 / Skip = 90 %, 0, 1, 90);
 
+BENCHMARK_CAPTURE(BM_bulkDecompressIntegers, Skip = 0 %, 0);
+BENCHMARK_CAPTURE(BM_bulkDecompressIntegers, Skip = 10 %, 10);
+BENCHMARK_CAPTURE(BM_bulkDecompressIntegers, Skip = 90 %, 90);
+
+BENCHMARK_CAPTURE(BM_bulkDecompressDoubles, Decimals = 0 / Skip = 0 %, 0, 0);
+BENCHMARK_CAPTURE(BM_bulkDecompressDoubles, Decimals = 2 / Skip = 0 %, 2, 0);
+BENCHMARK_CAPTURE(BM_bulkDecompressDoubles, Decimals = 2 / Skip = 10 %, 2, 10);
+BENCHMARK_CAPTURE(BM_bulkDecompressDoubles, Decimals = 2 / Skip = 90 %, 2, 90);
+
+BENCHMARK_CAPTURE(BM_bulkDecompressTimestamps, Mean = 1 / Stddev = 0 / Skip = 0 %, 0, 1, 0);
+BENCHMARK_CAPTURE(BM_bulkDecompressTimestamps, Mean = 1 / Stddev = 0 / Skip = 10 %, 0, 1, 10);
+
 BENCHMARK_CAPTURE(BM_decompressObjectIds, Skip = 0 %, 0);
 BENCHMARK_CAPTURE(BM_decompressObjectIds, Skip = 10 %, 10);
 BENCHMARK_CAPTURE(BM_decompressObjectIds, Skip = 90 %, 90);
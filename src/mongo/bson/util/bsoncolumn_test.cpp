@@ -393,6 +393,44 @@ public:
         ASSERT_EQ(memcmp(columnBinary.data, buf, columnBinary.length), 0);
     }
 
+    template <typename T>
+    static void verifyDecodeTo(const BSONColumn& col, const std::vector<BSONElement>& expected) {
+        auto isSupported = [](const BSONElement& elem) {
+            if constexpr (std::is_same_v<T, double>) {
+                return elem.eoo() || elem.type() == NumberDouble;
+            } else {
+                return elem.eoo() || elem.type() == NumberInt || elem.type() == NumberLong ||
+                    elem.type() == Date || elem.type() == bsonTimestamp;
+            }
+        };
+
+        std::vector<boost::optional<T>> values;
+        if (!col.decodeTo(values)) {
+            ASSERT_FALSE(std::all_of(expected.begin(), expected.end(), isSupported));
+            return;
+        }
+
+        ASSERT_EQ(values.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            const auto& elem = expected[i];
+            ASSERT_EQ(elem.eoo(), !values[i]);
+            if (elem.eoo()) {
+                continue;
+            }
+
+            if constexpr (std::is_same_v<T, double>) {
+                // Compare the binary representation so that NaN and negative zero are verified.
+                ASSERT(elem.binaryEqualValues(BSON("" << *values[i]).firstElement()));
+            } else if (elem.type() == Date) {
+                ASSERT_EQ(*values[i], elem.date().toMillisSinceEpoch());
+            } else if (elem.type() == bsonTimestamp) {
+                ASSERT_EQ(*values[i], static_cast<int64_t>(elem.timestampValue()));
+            } else {
+                ASSERT_EQ(*values[i], elem.numberLong());
+            }
+        }
+    }
+
     static void verifyDecompression(BSONBinData columnBinary,
                                     const std::vector<BSONElement>& expected) {
         BSONObjBuilder obj;
@@ -470,6 +508,13 @@ public:
 
             ASSERT(it1 == it2);
         }
+
+        // Verify that bulk decoding, where the types allow it, gives the same values
+        {
+            BSONColumn col(columnElement);
+            verifyDecodeTo<int64_t>(col, expected);
+            verifyDecodeTo<double>(col, expected);
+        }
     }
 
     const boost::optional<uint64_t> kDeltaForBinaryEqualValues = Simple8bTypeUtil::encodeInt64(0);
@@ -35,6 +35,13 @@
 #include <algorithm>
 #include <array>
 
+// The AVX2 kernel is compiled for AVX2 on its own, whatever the target of the rest of the build,
+// and is only called after checking that the CPU supports it.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MONGO_SIMPLE8B_HAS_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
 namespace mongo {
 
 namespace {
@@ -263,6 +270,89 @@ uint8_t _countBitsWithoutLeadingZeros(uint128_t value) {
     }
 }
 
+#ifdef MONGO_SIMPLE8B_HAS_AVX2_KERNEL
+bool cpuSupportsAVX2() {
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }();
+    return supported;
+}
+
+/**
+ * Unpacks the slots of a Simple8b block four at a time with AVX2, as described for unpackSlots().
+ * Each 64-bit lane shifts its own slot down with a variable shift, and the skip comparison result,
+ * which is all ones for a skip, is OR'ed into the decoded value so that skips come out with all
+ * bits set without any branching. Returns the number of slots unpacked, a multiple of four, and
+ * leaves the remaining ones to the caller.
+ */
+__attribute__((target("avx2"))) uint8_t unpackSlotsAVX2(uint64_t word,
+                                                        uint8_t shift,
+                                                        uint8_t slotBits,
+                                                        uint8_t count,
+                                                        uint64_t mask,
+                                                        uint8_t countBits,
+                                                        uint8_t countMultiplier,
+                                                        uint64_t* out) {
+    const uint64_t countMask = (1ull << countBits) - 1;
+    const __m256i vword = _mm256_set1_epi64x(word);
+    const __m256i vmask = _mm256_set1_epi64x(mask);
+    const __m256i vcountMask = _mm256_set1_epi64x(countMask);
+    const __m256i vcountMultiplier = _mm256_set1_epi64x(countMultiplier);
+    const __m128i vcountBits = _mm_cvtsi32_si128(countBits);
+    const __m256i vstep = _mm256_set1_epi64x(4 * slotBits);
+    __m256i vshift =
+        _mm256_setr_epi64x(shift, shift + slotBits, shift + 2 * slotBits, shift + 3 * slotBits);
+    uint8_t idx = 0;
+    for (; idx + 4 <= count; idx += 4) {
+        const __m256i slots = _mm256_and_si256(_mm256_srlv_epi64(vword, vshift), vmask);
+        const __m256i skips = _mm256_cmpeq_epi64(slots, vmask);
+        const __m256i zeros =
+            _mm256_mul_epu32(_mm256_and_si256(slots, vcountMask), vcountMultiplier);
+        const __m256i values = _mm256_sllv_epi64(_mm256_srl_epi64(slots, vcountBits), zeros);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + idx), _mm256_or_si256(values, skips));
+        vshift = _mm256_add_epi64(vshift, vstep);
+    }
+    return idx;
+}
+#endif
+
+/**
+ * Unpacks the 'count' slots of a Simple8b block 'word' into 'out', starting 'shift' bits into the
+ * word. Each slot is 'slotBits' wide and is extracted with 'mask'. For the extended selectors the
+ * low 'countBits' of a slot hold a trailing zero count which is scaled by 'countMultiplier'. Slots
+ * with all bits set are skips and are written as a value with all bits set.
+ */
+template <typename T>
+void unpackSlots(uint64_t word,
+                 uint8_t shift,
+                 uint8_t slotBits,
+                 uint8_t count,
+                 uint64_t mask,
+                 uint8_t countBits,
+                 uint8_t countMultiplier,
+                 T* out) {
+    const uint64_t countMask = (1ull << countBits) - 1;
+    uint8_t idx = 0;
+
+#ifdef MONGO_SIMPLE8B_HAS_AVX2_KERNEL
+    if constexpr (std::is_same_v<T, uint64_t>) {
+        if (count >= 4 && cpuSupportsAVX2()) {
+            idx = unpackSlotsAVX2(
+                word, shift, slotBits, count, mask, countBits, countMultiplier, out);
+            shift += idx * slotBits;
+        }
+    }
+#endif
+
+    for (; idx < count; ++idx, shift += slotBits) {
+        const uint64_t slot = (word >> shift) & mask;
+        out[idx] = slot == mask
+            ? ~T{0}
+            : static_cast<T>(slot >> countBits) << ((slot & countMask) * countMultiplier);
+    }
+}
+
 /*
  * This method takes a number of intsNeeded and an extensionType and returns the selector index for
  * that type. This method should never fail as it is called when we are encoding a largest value.
@@ -909,6 +999,54 @@ typename Simple8b<T>::Iterator Simple8b<T>::end() const {
     return {_buffer + _size, _buffer + _size, boost::none};
 }
 
+template <typename T>
+void Simple8b<T>::decode(std::vector<T>& values) const {
+    // The value repeated by an RLE block is the last value decoded before it.
+    T last = _previous ? *_previous : skipValue();
+
+    for (const char *pos = _buffer, *end = _buffer + _size; pos != end; pos += sizeof(uint64_t)) {
+        const uint64_t word = ConstDataView(pos).read<LittleEndian<uint64_t>>();
+        uint8_t selector = word & kBaseSelectorMask;
+        const uint8_t selectorExtension = (word >> kSelectorBits) & kBaseSelectorMask;
+
+        if (selector == kRleSelector) {
+            values.insert(values.end(), (selectorExtension + 1) * kRleMultiplier, last);
+            continue;
+        }
+
+        // Selectors 7 and 8 always reserve the bits after the base selector for an extension, see
+        // Iterator::_loadBlock().
+        uint8_t extensionType = kBaseSelector;
+        uint8_t shift = kSelectorBits;
+        if (selector == 7 || selector == 8) {
+            uassert(6707000,
+                    "Invalid Simple-8b selector extension",
+                    selectorExtension < kSelectorToExtension[selector - 7].size());
+            extensionType = kSelectorToExtension[selector - 7][selectorExtension];
+            if (extensionType != kBaseSelector) {
+                selector = selectorExtension;
+            }
+            shift += kSelectorBits;
+        }
+
+        const uint8_t count = kIntsStoreForSelector[extensionType][selector];
+        uassert(6707001, "Invalid Simple-8b selector", count > 0);
+
+        const uint8_t countBits = kTrailingZeroBitSize[extensionType];
+        const size_t offset = values.size();
+        values.resize(offset + count);
+        unpackSlots(word,
+                    shift,
+                    kBitsPerIntForSelector[extensionType][selector] + countBits,
+                    count,
+                    kDecodeMask[extensionType][selector],
+                    countBits,
+                    kTrailingZerosMultiplier[extensionType],
+                    values.data() + offset);
+        last = values.back();
+    }
+}
+
 template class Simple8b<uint64_t>;
 template class Simple8b<uint128_t>;
 template class Simple8bBuilder<uint64_t>;
@@ -403,6 +403,23 @@ public:
     Iterator begin() const;
     Iterator end() const;
 
+    /**
+     * Value written by decode() in place of skipped values. No selector can store a value with all
+     * bits set, so it never collides with a real value.
+     */
+    static T skipValue() {
+        return ~T{0};
+    }
+
+    /**
+     * Appends all values in the buffer to 'values', writing skipValue() for skipped values. This
+     * unpacks a whole Simple8b block at a time rather than stepping the iterator value by value,
+     * and uses SIMD instructions to do so where the target supports them.
+     *
+     * Throws if an invalid Simple8b block is encountered.
+     */
+    void decode(std::vector<T>& values) const;
+
 private:
     const char* _buffer;
     int _size;
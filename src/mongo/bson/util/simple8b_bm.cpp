@@ -109,12 +109,11 @@ void BM_selectorSeven(benchmark::State& state) {
     state.SetBytesProcessed(totalBytes);
 }
 
-void BM_decode(benchmark::State& state) {
-    size_t totalBytes = 0;
-
-    BufBuilder _buffer;
+// Builds a buffer mixing small values, RLE and large values for the decoding benchmarks.
+BufBuilder buildMixedSimple8bBuffer() {
+    BufBuilder buffer;
     Simple8bBuilder<uint64_t> s8bBuilder(
-        [&_buffer](uint64_t simple8bBlock) { _buffer.appendNum(simple8bBlock); });
+        [&buffer](uint64_t simple8bBlock) { buffer.appendNum(simple8bBlock); });
 
     // Small values.
     for (auto j = 0; j < 100; j++)
@@ -131,7 +130,13 @@ void BM_decode(benchmark::State& state) {
     }
 
     s8bBuilder.flush();
+    return buffer;
+}
 
+void BM_decode(benchmark::State& state) {
+    size_t totalBytes = 0;
+
+    BufBuilder _buffer = buildMixedSimple8bBuffer();
     auto size = _buffer.len();
     auto buf = _buffer.release();
     Simple8b<uint64_t> s8b(buf.get(), size);
@@ -146,11 +151,32 @@ void BM_decode(benchmark::State& state) {
     state.SetBytesProcessed(totalBytes);
 }
 
+void BM_decodeBulk(benchmark::State& state) {
+    size_t totalBytes = 0;
+
+    BufBuilder _buffer = buildMixedSimple8bBuffer();
+    auto size = _buffer.len();
+    auto buf = _buffer.release();
+    Simple8b<uint64_t> s8b(buf.get(), size);
+
+    std::vector<uint64_t> values;
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        values.clear();
+        s8b.decode(values);
+        benchmark::DoNotOptimize(values.data());
+        totalBytes += size;
+    }
+
+    state.SetBytesProcessed(totalBytes);
+}
+
 BENCHMARK(BM_increasingValues)->Arg(100);
 BENCHMARK(BM_rle)->Arg(100);
 BENCHMARK(BM_changingSmallValues)->Arg(100);
 BENCHMARK(BM_changingLargeValues)->Arg(100);
 BENCHMARK(BM_selectorSeven)->Arg(100);
 BENCHMARK(BM_decode);
+BENCHMARK(BM_decodeBulk);
 
 }  // namespace mongo
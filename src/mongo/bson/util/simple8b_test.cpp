@@ -48,6 +48,14 @@ void assertValuesEqual(const Simple8b<T>& actual, const std::vector<boost::optio
 
     ASSERT(it == end);
     ASSERT_EQ(i, expected.size());
+
+    // Bulk decoding must give the same values as the iterator.
+    std::vector<T> decoded;
+    actual.decode(decoded);
+    ASSERT_EQ(decoded.size(), expected.size());
+    for (i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(decoded[i], expected[i].value_or(Simple8b<T>::skipValue()));
+    }
 }
 
 template <typename T>
@@ -1396,3 +1404,15 @@ TEST(Simple8b, ValueTooLargeBitCountUsedForExtendedSelectors) {
     });
     ASSERT_FALSE(builder.append(value));
 }
+
+TEST(Simple8b, LeadingRleRepeatsPreviousValue) {
+    // RLE block with the smallest count, 120 repeats of the value before it.
+    std::vector<uint8_t> rleBinary{0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    auto buffer = reinterpret_cast<const char*>(rleBinary.data());
+
+    Simple8b<uint64_t> s8b(buffer, rleBinary.size(), uint64_t{7});
+    assertValuesEqual(s8b, std::vector<boost::optional<uint64_t>>(120, uint64_t{7}));
+
+    Simple8b<uint64_t> s8bAfterSkip(buffer, rleBinary.size(), boost::none);
+    assertValuesEqual(s8bAfterSkip, std::vector<boost::optional<uint64_t>>(120, boost::none));
+}
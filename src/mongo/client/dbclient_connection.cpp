@@ -79,6 +79,7 @@
 #include "mongo/util/net/ssl_peer_info.h"
 #include "mongo/util/password_digest.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 
 namespace mongo {
@@ -729,7 +730,9 @@ Status DBClientConnection::recv(Message& m, int lastRequestId) {
             m.header().getResponseToMsgId() == lastRequestId);
 
     if (m.operation() == dbCompressed) {
+        Timer timer;
         m = uassertStatusOK(_compressorManager.decompressMessage(m));
+        _decompressionTime += Microseconds(timer.micros());
     }
 
     killSessionOnError.dismiss();
@@ -787,7 +790,9 @@ bool DBClientConnection::call(Message& toSend,
     }
 
     if (response.operation() == dbCompressed) {
+        Timer timer;
         response = uassertStatusOK(_compressorManager.decompressMessage(response));
+        _decompressionTime += Microseconds(timer.micros());
     }
 
     killSessionOnError.dismiss();
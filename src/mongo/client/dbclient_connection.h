@@ -53,6 +53,7 @@
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer.h"
+#include "mongo/util/duration.h"
 #include "mongo/util/hierarchical_acquisition.h"
 #include "mongo/util/str.h"
 
@@ -275,6 +276,13 @@ public:
         return _compressorManager;
     }
 
+    /**
+     * Returns the total time this connection has spent decompressing the messages it received.
+     */
+    Microseconds getDecompressionTime() const {
+        return _decompressionTime;
+    }
+
     // throws a NetworkException if in failed state and not reconnecting or if waiting to reconnect
     void checkConnection() override {
         if (_failed.load())
@@ -362,6 +370,7 @@ private:
     HandshakeValidationHook _hook;
 
     MessageCompressorManager _compressorManager;
+    Microseconds _decompressionTime{0};
 
     MongoURI _uri;
 
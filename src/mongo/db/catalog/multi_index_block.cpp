@@ -76,6 +76,11 @@ MONGO_FAIL_POINT_DEFINE(leaveIndexBuildUnfinishedForShutdown);
 
 namespace {
 
+// Limits on the documents of the collection scan that are batched together for their keys to be
+// generated concurrently.
+constexpr size_t kKeyGenerationBatchMaxDocs = 1000;
+constexpr size_t kKeyGenerationBatchMaxBytes = 4 * 1024 * 1024;
+
 size_t getEachIndexBuildMaxMemoryUsageBytes(size_t numIndexSpecs) {
     if (numIndexSpecs == 0) {
         return 0;
@@ -103,6 +108,11 @@ Status timeseriesMixedSchemaDataFailure(const Collection* collection) {
 
 MultiIndexBlock::~MultiIndexBlock() {
     invariant(_buildIsCleanedUp);
+
+    if (_consumerPool) {
+        _consumerPool->shutdown();
+        _consumerPool->join();
+    }
 }
 
 MultiIndexBlock::OnCleanUpFn MultiIndexBlock::kNoopOnCleanUpFn = []() {};
@@ -232,8 +242,15 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(
 
         std::vector<BSONObj> indexInfoObjs;
         indexInfoObjs.reserve(indexSpecs.size());
+        // When the memory limit is split adaptively, the sorter of each index may use all of it
+        // and the sorters holding the most memory are spilled once their total exceeds it. Indexes
+        // with small keys then keep more of their keys in memory than an equal split would allow.
+        _sharedMaxMemoryUsageBytes =
+            (indexSpecs.size() > 1 && useAdaptiveIndexBuildMemorySplit.load())
+            ? getEachIndexBuildMaxMemoryUsageBytes(1)
+            : 0;
         std::size_t eachIndexBuildMaxMemoryUsageBytes =
-            getEachIndexBuildMaxMemoryUsageBytes(indexSpecs.size());
+            _getEachIndexBuildMaxMemoryUsageBytes(indexSpecs.size());
 
         // Initializing individual index build blocks below performs un-timestamped writes to the
         // durable catalog. It's possible for the onInit function to set multiple timestamps
@@ -505,7 +522,7 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(
                 _lastRecordIdInserted = boost::none;
                 for (auto& index : _indexes) {
                     index.bulk = index.real->initiateBulk(
-                        getEachIndexBuildMaxMemoryUsageBytes(_indexes.size()),
+                        _getEachIndexBuildMaxMemoryUsageBytes(_indexes.size()),
                         /*stateInfo=*/boost::none,
                         collection->ns().db());
                 }
@@ -605,6 +622,50 @@ void MultiIndexBlock::_doCollectionScan(OperationContext* opCtx,
               IndexBuildPhase_serializer(_phase).toString());
     _phase = IndexBuildPhaseEnum::kCollectionScan;
 
+    // When more than one thread generates keys, the scanned documents are copied into a batch
+    // whose keys are generated once it is full. The scan does not advance, and therefore does not
+    // yield, while the keys of a batch are being generated.
+    const size_t keyGenerationThreads = maxIndexBuildKeyGenerationThreads.load();
+    const bool batchDocuments = keyGenerationThreads > 1 ||
+        (_indexes.size() > 1 && useIndexBuildConsumerThreads.load());
+    std::vector<std::pair<BSONObj, RecordId>> batch;
+    size_t batchBytes = 0;
+
+    auto insertBatch = [&] {
+        if (batch.empty()) {
+            return;
+        }
+
+        std::vector<BsonRecord> records;
+        records.reserve(batch.size());
+        for (const auto& [doc, id] : batch) {
+            records.push_back(BsonRecord{id, Timestamp(), &doc});
+        }
+
+        // The documents of the batch are owned, so only the cursor needs to be saved and restored
+        // around a side table write.
+        uassertStatusOK(_insertBatch(opCtx,
+                                     collection,
+                                     records,
+                                     keyGenerationThreads,
+                                     /*saveCursorBeforeWrite*/ [&exec] { exec->saveState(); },
+                                     /*restoreCursorAfterWrite*/
+                                     [&] { exec->restoreState(&collection); }));
+
+        for (const auto& [doc, id] : batch) {
+            _failPointHangDuringBuild(opCtx,
+                                      &hangIndexBuildDuringCollectionScanPhaseAfterInsertion,
+                                      "after",
+                                      doc,
+                                      (*progress)->hits())
+                .ignore();
+            progress->hit();
+        }
+
+        batch.clear();
+        batchBytes = 0;
+    };
+
     BSONObj objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -623,7 +684,17 @@ void MultiIndexBlock::_doCollectionScan(OperationContext* opCtx,
                                       &hangIndexBuildDuringCollectionScanPhaseBeforeInsertion,
                                       "before",
                                       objToIndex,
-                                      (*progress)->hits()));
+                                      (*progress)->hits() + batch.size()));
+
+        if (batchDocuments) {
+            batchBytes += objToIndex.objsize();
+            batch.emplace_back(objToIndex.getOwned(), loc);
+            if (batch.size() >= kKeyGenerationBatchMaxDocs ||
+                batchBytes >= kKeyGenerationBatchMaxBytes) {
+                insertBatch();
+            }
+            continue;
+        }
 
         // The external sorter is not part of the storage engine and therefore does not need
         // a WriteUnitOfWork to write keys.
@@ -659,6 +730,8 @@ void MultiIndexBlock::_doCollectionScan(OperationContext* opCtx,
         // Go to the next document.
         progress->hit();
     }
+
+    insertBatch();
 }
 
 Status MultiIndexBlock::insertSingleDocumentForInitialSyncOrRecovery(
@@ -680,32 +753,10 @@ Status MultiIndexBlock::_insert(OperationContext* opCtx,
     invariant(!_buildIsCleanedUp);
 
     // The detection of mixed-schema data needs to be done before applying the partial filter
-    // expression below. Only check for mixed-schema data if it's possible for the time-series
-    // collection to have it.
-    if (_containsIndexBuildOnTimeseriesMeasurement &&
-        *collection->getTimeseriesBucketsMayHaveMixedSchemaData()) {
-        bool docHasMixedSchemaData =
-            collection->doesTimeseriesBucketsDocContainMixedSchemaData(doc);
-
-        if (docHasMixedSchemaData) {
-            LOGV2(6057700,
-                  "Detected mixed-schema data in time-series bucket collection",
-                  logAttrs(collection->ns()),
-                  logAttrs(collection->uuid()),
-                  "recordId"_attr = loc,
-                  "control"_attr = redact(doc.getObjectField(timeseries::kBucketControlFieldName)));
-
-            _timeseriesBucketContainsMixedSchemaData = true;
-        }
-
-        // Only enforce the mixed-schema data constraint on the primary. Index builds may not fail
-        // on the secondaries. The primary will replicate an abortIndexBuild oplog entry.
-        auto replCoord = repl::ReplicationCoordinator::get(opCtx);
-        const bool replSetAndNotPrimary = !replCoord->canAcceptWritesFor(opCtx, collection->ns());
-
-        if (docHasMixedSchemaData && !replSetAndNotPrimary) {
-            return timeseriesMixedSchemaDataFailure(collection.get());
-        }
+    // expression below.
+    Status status = _checkForTimeseriesMixedSchemaData(opCtx, collection, doc, loc);
+    if (!status.isOK()) {
+        return status;
     }
 
     for (size_t i = 0; i < _indexes.size(); i++) {
@@ -734,11 +785,232 @@ Status MultiIndexBlock::_insert(OperationContext* opCtx,
             return idxStatus;
     }
 
+    // Summing the memory used by every sorter after each document is wasteful, so the documents
+    // inserted one at a time are checked in batches as large as the ones of _insertBatch().
+    _bytesSinceSpillCheck += doc.objsize();
+    if (++_docsSinceSpillCheck >= kKeyGenerationBatchMaxDocs ||
+        _bytesSinceSpillCheck >= kKeyGenerationBatchMaxBytes) {
+        _docsSinceSpillCheck = 0;
+        _bytesSinceSpillCheck = 0;
+        status = _spillToRespectMemoryLimit();
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
     _lastRecordIdInserted = loc;
 
     return Status::OK();
 }
 
+Status MultiIndexBlock::_insertBatch(OperationContext* opCtx,
+                                     const CollectionPtr& collection,
+                                     const std::vector<BsonRecord>& records,
+                                     size_t numThreads,
+                                     const std::function<void()>& saveCursorBeforeWrite,
+                                     const std::function<void()>& restoreCursorAfterWrite) {
+    invariant(!_buildIsCleanedUp);
+
+    for (const auto& record : records) {
+        Status status =
+            _checkForTimeseriesMixedSchemaData(opCtx, collection, *record.docPtr, record.id);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    // Partial indexes only index the documents of the batch matching their filter.
+    std::vector<std::vector<BsonRecord>> filteredRecords(_indexes.size());
+    std::vector<const std::vector<BsonRecord>*> indexRecords(_indexes.size(), &records);
+    for (size_t i = 0; i < _indexes.size(); i++) {
+        if (_indexes[i].filterExpression) {
+            std::copy_if(records.begin(),
+                         records.end(),
+                         std::back_inserter(filteredRecords[i]),
+                         [&](const BsonRecord& record) {
+                             return _indexes[i].filterExpression->matchesBSON(*record.docPtr);
+                         });
+            indexRecords[i] = &filteredRecords[i];
+        }
+    }
+
+    std::vector<Status> statuses(_indexes.size(), Status::OK());
+    auto insertIntoIndex = [&](size_t i) {
+        // When calling insertBatch, BulkBuilderImpl's Sorter performs file I/O that may result in
+        // an exception.
+        try {
+            statuses[i] = _indexes[i].bulk->insertBatch(
+                opCtx, collection, *indexRecords[i], _indexes[i].options, numThreads);
+        } catch (...) {
+            statuses[i] = exceptionToStatus();
+        }
+    };
+
+    // Every index consumes the batch on a thread of its own, including the spills of its sorter,
+    // while this thread consumes it for the first index and then waits for the others.
+    if (_indexes.size() > 1 && useIndexBuildConsumerThreads.load()) {
+        if (!_consumerPool) {
+            ThreadPool::Options options;
+            options.threadNamePrefix = "IndexBuildConsumer-";
+            options.poolName = "IndexBuildConsumerThreadPool";
+            options.minThreads = 0;
+            options.maxThreads = _indexes.size() - 1;
+            options.onCreateThread = [](const std::string& threadName) {
+                Client::initThread(threadName);
+            };
+            _consumerPool = std::make_unique<ThreadPool>(options);
+            _consumerPool->startup();
+        }
+
+        for (size_t i = 1; i < _indexes.size(); i++) {
+            _consumerPool->schedule([&, i](Status status) {
+                if (!status.isOK()) {
+                    statuses[i] = std::move(status);
+                    return;
+                }
+                insertIntoIndex(i);
+            });
+        }
+        insertIntoIndex(0);
+        _consumerPool->waitForIdle();
+    } else {
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            insertIntoIndex(i);
+        }
+    }
+
+    for (const auto& status : statuses) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    try {
+        for (auto& index : _indexes) {
+            index.bulk->recordSkippedRecords(opCtx, saveCursorBeforeWrite, restoreCursorAfterWrite);
+        }
+    } catch (...) {
+        return exceptionToStatus();
+    }
+
+    Status status = _spillToRespectMemoryLimit();
+    if (!status.isOK()) {
+        return status;
+    }
+
+    if (!records.empty()) {
+        _lastRecordIdInserted = records.back().id;
+    }
+
+    return Status::OK();
+}
+
+size_t MultiIndexBlock::_getEachIndexBuildMaxMemoryUsageBytes(size_t numIndexes) const {
+    return _sharedMaxMemoryUsageBytes ? _sharedMaxMemoryUsageBytes
+                                      : getEachIndexBuildMaxMemoryUsageBytes(numIndexes);
+}
+
+Status MultiIndexBlock::_spillToRespectMemoryLimit() {
+    if (!_sharedMaxMemoryUsageBytes) {
+        return Status::OK();
+    }
+
+    size_t memUsed = 0;
+    std::vector<std::pair<size_t, IndexAccessMethod::BulkBuilder*>> bulkBuilders;
+    for (auto& index : _indexes) {
+        auto bulkMemUsed = index.bulk->memUsed();
+        memUsed += bulkMemUsed;
+        bulkBuilders.emplace_back(bulkMemUsed, index.bulk.get());
+    }
+
+    if (memUsed <= _sharedMaxMemoryUsageBytes) {
+        return Status::OK();
+    }
+
+    std::sort(bulkBuilders.begin(), bulkBuilders.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    std::vector<IndexAccessMethod::BulkBuilder*> toSpill;
+    for (const auto& [bulkMemUsed, bulk] : bulkBuilders) {
+        if (memUsed <= _sharedMaxMemoryUsageBytes) {
+            break;
+        }
+        toSpill.push_back(bulk);
+        memUsed -= bulkMemUsed;
+    }
+
+    // The spills of different sorters write to different files, so they proceed concurrently.
+    std::vector<Status> statuses(toSpill.size(), Status::OK());
+    auto spill = [&](size_t i) {
+        try {
+            toSpill[i]->spill();
+        } catch (...) {
+            statuses[i] = exceptionToStatus();
+        }
+    };
+
+    if (_consumerPool) {
+        for (size_t i = 1; i < toSpill.size(); i++) {
+            _consumerPool->schedule([&, i](Status status) {
+                if (!status.isOK()) {
+                    statuses[i] = std::move(status);
+                    return;
+                }
+                spill(i);
+            });
+        }
+        spill(0);
+        _consumerPool->waitForIdle();
+    } else {
+        for (size_t i = 0; i < toSpill.size(); i++) {
+            spill(i);
+        }
+    }
+
+    for (const auto& status : statuses) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    return Status::OK();
+}
+
+Status MultiIndexBlock::_checkForTimeseriesMixedSchemaData(OperationContext* opCtx,
+                                                           const CollectionPtr& collection,
+                                                           const BSONObj& doc,
+                                                           const RecordId& loc) {
+    // Only check for mixed-schema data if it's possible for the time-series collection to have it.
+    if (_containsIndexBuildOnTimeseriesMeasurement &&
+        *collection->getTimeseriesBucketsMayHaveMixedSchemaData()) {
+        bool docHasMixedSchemaData =
+            collection->doesTimeseriesBucketsDocContainMixedSchemaData(doc);
+
+        if (docHasMixedSchemaData) {
+            LOGV2(6057700,
+                  "Detected mixed-schema data in time-series bucket collection",
+                  logAttrs(collection->ns()),
+                  logAttrs(collection->uuid()),
+                  "recordId"_attr = loc,
+                  "control"_attr = redact(doc.getObjectField(timeseries::kBucketControlFieldName)));
+
+            _timeseriesBucketContainsMixedSchemaData = true;
+        }
+
+        // Only enforce the mixed-schema data constraint on the primary. Index builds may not fail
+        // on the secondaries. The primary will replicate an abortIndexBuild oplog entry.
+        auto replCoord = repl::ReplicationCoordinator::get(opCtx);
+        const bool replSetAndNotPrimary = !replCoord->canAcceptWritesFor(opCtx, collection->ns());
+
+        if (docHasMixedSchemaData && !replSetAndNotPrimary) {
+            return timeseriesMixedSchemaDataFailure(collection.get());
+        }
+    }
+
+    return Status::OK();
+}
+
 Status MultiIndexBlock::dumpInsertsFromBulk(OperationContext* opCtx,
                                             const CollectionPtr& collection) {
     return dumpInsertsFromBulk(opCtx, collection, nullptr);
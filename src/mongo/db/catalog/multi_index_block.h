@@ -49,6 +49,7 @@
 #include "mongo/db/record_id.h"
 #include "mongo/db/resumable_index_builds_gen.h"
 #include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
 
 namespace mongo {
@@ -336,6 +337,38 @@ private:
                    const std::function<void()>& saveCursorBeforeWrite,
                    const std::function<void()>& restoreCursorAfterWrite);
 
+    /**
+     * Inserts the keys of a batch of documents into the external sorter, generating them with up
+     * to 'numThreads' threads.
+     */
+    Status _insertBatch(OperationContext* opCtx,
+                        const CollectionPtr& collection,
+                        const std::vector<BsonRecord>& records,
+                        size_t numThreads,
+                        const std::function<void()>& saveCursorBeforeWrite,
+                        const std::function<void()>& restoreCursorAfterWrite);
+
+    /**
+     * Returns the memory limit of the sorter of each index of an index build of 'numIndexes'
+     * indexes.
+     */
+    size_t _getEachIndexBuildMaxMemoryUsageBytes(size_t numIndexes) const;
+
+    /**
+     * Keeps the memory used by the sorters of all indexes within '_sharedMaxMemoryUsageBytes' by
+     * spilling the sorters that hold the most memory.
+     */
+    Status _spillToRespectMemoryLimit();
+
+    /**
+     * Returns an error if 'doc' contains mixed-schema data that prevents the index build from
+     * succeeding on a time-series collection.
+     */
+    Status _checkForTimeseriesMixedSchemaData(OperationContext* opCtx,
+                                              const CollectionPtr& collection,
+                                              const BSONObj& doc,
+                                              const RecordId& loc);
+
     /**
      * Performs a collection scan on the given collection and inserts the relevant index keys into
      * the external sorter.
@@ -350,6 +383,19 @@ private:
 
     std::vector<IndexToBuild> _indexes;
 
+    // The memory limit shared by the sorters of all indexes, which may each grow up to it, or zero
+    // if each sorter has a limit of its own. Set during init().
+    size_t _sharedMaxMemoryUsageBytes = 0;
+
+    // The documents and bytes inserted one at a time since the memory used by the sorters was
+    // last checked against '_sharedMaxMemoryUsageBytes'.
+    size_t _docsSinceSpillCheck = 0;
+    size_t _bytesSinceSpillCheck = 0;
+
+    // Generates the keys of the indexes other than the first one when the batches of documents of
+    // the collection scan are consumed by one thread per index.
+    std::unique_ptr<ThreadPool> _consumerPool;
+
     IndexBuildMethod _method = IndexBuildMethod::kHybrid;
 
     bool _ignoreUnique = false;
@@ -35,6 +35,7 @@
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -163,6 +164,112 @@ TEST_F(MultiIndexBlockTest, AbortWithoutCleanupAfterInsertingSingleDocument) {
     indexer->abortWithoutCleanup(operationContext(), coll.get(), isResumable);
 }
 
+TEST_F(MultiIndexBlockTest, InsertAllDocumentsWithKeyGenerationThreads) {
+    RAIIServerParameterControllerForTest controller{"maxIndexBuildKeyGenerationThreads", 4};
+
+    // Enough documents to fill several key generation batches, each of which generates two keys.
+    const int numDocs = 2500;
+    {
+        AutoGetCollection autoColl(operationContext(), getNSS(), MODE_IX);
+        WriteUnitOfWork wunit(operationContext());
+        for (int i = 0; i < numDocs; ++i) {
+            auto doc = BSON("_id" << i << "a" << BSON_ARRAY(i << -i - 1));
+            ASSERT_OK(autoColl->insertDocument(operationContext(), InsertStatement(doc), nullptr));
+        }
+        wunit.commit();
+    }
+
+    auto indexer = getIndexer();
+
+    AutoGetCollection autoColl(operationContext(), getNSS(), MODE_X);
+    CollectionWriter coll(operationContext(), autoColl);
+
+    auto spec = BSON("v" << 2 << "key" << BSON("a" << 1) << "name"
+                         << "a_1");
+    auto specs = unittest::assertGet(
+        indexer->init(operationContext(), coll, spec, MultiIndexBlock::kNoopOnInitFn));
+    ASSERT_EQUALS(1U, specs.size());
+
+    ASSERT_OK(indexer->insertAllDocumentsInCollection(operationContext(), coll.get()));
+    ASSERT_OK(indexer->dumpInsertsFromBulk(operationContext(), coll.get()));
+    ASSERT_OK(indexer->checkConstraints(operationContext(), coll.get()));
+
+    {
+        WriteUnitOfWork wunit(operationContext());
+        ASSERT_OK(indexer->commit(operationContext(),
+                                  coll.getWritableCollection(),
+                                  MultiIndexBlock::kNoopOnCreateEachFn,
+                                  MultiIndexBlock::kNoopOnCommitFn));
+        wunit.commit();
+    }
+
+    auto indexCatalog = coll->getIndexCatalog();
+    auto entry = indexCatalog->getEntry(indexCatalog->findIndexByName(operationContext(), "a_1"));
+    ASSERT(entry->isMultikey(operationContext(), coll.get()));
+    ASSERT_EQUALS(2 * numDocs,
+                  entry->accessMethod()->asSortedData()->getSortedDataInterface()->numEntries(
+                      operationContext()));
+}
+
+TEST_F(MultiIndexBlockTest, InsertAllDocumentsWithConsumerThreadPerIndex) {
+    RAIIServerParameterControllerForTest consumerThreadsController{"useIndexBuildConsumerThreads",
+                                                                   true};
+    RAIIServerParameterControllerForTest memorySplitController{"useAdaptiveIndexBuildMemorySplit",
+                                                               true};
+
+    const int numDocs = 2500;
+    {
+        AutoGetCollection autoColl(operationContext(), getNSS(), MODE_IX);
+        WriteUnitOfWork wunit(operationContext());
+        for (int i = 0; i < numDocs; ++i) {
+            auto doc = BSON("_id" << i << "a" << i << "b" << BSON_ARRAY(i << -i - 1));
+            ASSERT_OK(autoColl->insertDocument(operationContext(), InsertStatement(doc), nullptr));
+        }
+        wunit.commit();
+    }
+
+    auto indexer = getIndexer();
+
+    AutoGetCollection autoColl(operationContext(), getNSS(), MODE_X);
+    CollectionWriter coll(operationContext(), autoColl);
+
+    std::vector<BSONObj> indexSpecs{
+        BSON("v" << 2 << "key" << BSON("a" << 1) << "name"
+                 << "a_1"),
+        BSON("v" << 2 << "key" << BSON("b" << 1) << "name"
+                 << "b_1"),
+        BSON("v" << 2 << "key" << BSON("a" << -1) << "name"
+                 << "a_-1"
+                 << "partialFilterExpression" << BSON("a" << BSON("$lt" << 100)))};
+    auto specs = unittest::assertGet(
+        indexer->init(operationContext(), coll, indexSpecs, MultiIndexBlock::kNoopOnInitFn));
+    ASSERT_EQUALS(3U, specs.size());
+
+    ASSERT_OK(indexer->insertAllDocumentsInCollection(operationContext(), coll.get()));
+    ASSERT_OK(indexer->dumpInsertsFromBulk(operationContext(), coll.get()));
+    ASSERT_OK(indexer->checkConstraints(operationContext(), coll.get()));
+
+    {
+        WriteUnitOfWork wunit(operationContext());
+        ASSERT_OK(indexer->commit(operationContext(),
+                                  coll.getWritableCollection(),
+                                  MultiIndexBlock::kNoopOnCreateEachFn,
+                                  MultiIndexBlock::kNoopOnCommitFn));
+        wunit.commit();
+    }
+
+    auto numEntries = [&](StringData indexName) {
+        auto indexCatalog = coll->getIndexCatalog();
+        auto entry =
+            indexCatalog->getEntry(indexCatalog->findIndexByName(operationContext(), indexName));
+        return entry->accessMethod()->asSortedData()->getSortedDataInterface()->numEntries(
+            operationContext());
+    };
+    ASSERT_EQUALS(numDocs, numEntries("a_1"));
+    ASSERT_EQUALS(2 * numDocs, numEntries("b_1"));
+    ASSERT_EQUALS(100, numEntries("a_-1"));
+}
+
 TEST_F(MultiIndexBlockTest, InitWriteConflictException) {
     auto indexer = getIndexer();
 
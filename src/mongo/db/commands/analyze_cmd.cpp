@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/commands/analyze_cmd_gen.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/ops/write_ops.h"
+#include "mongo/db/query/ce/array_histogram.h"
+#include "mongo/db/query/ce/stats_cache.h"
+#include "mongo/db/query/query_feature_flags_gen.h"
+#include "mongo/db/query/query_knobs_gen.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Adds up to 'internalQueryStatsAnalyzeMaxSampleSize' documents of the collection 'nss' to
+ * 'builder', which keeps only the values along its path. Larger collections are sampled randomly
+ * when the storage engine supports it. Returns the UUID of the collection.
+ */
+UUID readSample(OperationContext* opCtx,
+                const NamespaceString& nss,
+                ce::ArrayHistogram::Builder* builder) {
+    AutoGetCollectionForReadCommand collection(opCtx, nss);
+    uassert(ErrorCodes::NamespaceNotFound,
+            str::stream() << "Collection " << nss << " does not exist",
+            collection);
+
+    const auto maxSampleSize = internalQueryStatsAnalyzeMaxSampleSize.load();
+    std::unique_ptr<RecordCursor> cursor;
+    if (collection->numRecords(opCtx) > maxSampleSize) {
+        cursor = collection->getRecordStore()->getRandomCursor(opCtx);
+    }
+    if (!cursor) {
+        cursor = collection->getCursor(opCtx);
+    }
+
+    for (long long numDocs = 0; numDocs < maxSampleSize;) {
+        auto record = cursor->next();
+        if (!record) {
+            break;
+        }
+        builder->addDocument(record->data.toBson());
+
+        if (++numDocs % 1024 == 0) {
+            opCtx->checkForInterrupt();
+        }
+    }
+
+    return collection->uuid();
+}
+
+/**
+ * Builds the statistics of one path of a collection and persists them to the statistics
+ * collection, where the histogram-based cardinality estimation of the Cascades optimizer finds
+ * them.
+ *
+ * {
+ *     analyze: coll,
+ *     key: "a.b",
+ *     numberBuckets: 100,
+ * }
+ */
+class AnalyzeCmd final : public TypedCommand<AnalyzeCmd> {
+public:
+    using Request = AnalyzeCommandRequest;
+
+    std::string help() const override {
+        std::stringstream ss;
+        ss << "Builds the statistics of a path of a collection for the Cascades optimizer. Usage:"
+           << std::endl
+           << "{" << std::endl
+           << "    analyze: <string> collection name," << std::endl
+           << "    key: <string> dotted path to build statistics for," << std::endl
+           << "    numberBuckets: <number> maximum number of buckets of the histograms"
+           << std::endl
+           << "}";
+        return ss.str();
+    }
+
+    bool adminOnly() const override {
+        return false;
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kNever;
+    }
+
+    class Invocation final : public InvocationBase {
+    public:
+        using InvocationBase::InvocationBase;
+
+        void typedRun(OperationContext* opCtx) {
+            uassert(ErrorCodes::CommandNotSupported,
+                    "analyze requires the Common Query Framework feature flag",
+                    feature_flags::gfeatureFlagCommonQueryFramework.isEnabled(
+                        serverGlobalParams.featureCompatibility));
+
+            const auto& nss = request().getNamespace();
+            const std::string path = request().getKey().toString();
+            uassert(ErrorCodes::InvalidOptions,
+                    str::stream() << "Invalid key: '" << path << "'",
+                    !path.empty() && path.front() != '$' &&
+                        path.find("..") == std::string::npos && path.front() != '.' &&
+                        path.back() != '.');
+
+            ce::ArrayHistogram::Builder builder(path);
+            const auto collectionUUID = readSample(opCtx, nss, &builder);
+            const auto histogram = builder.done(request().getNumberBuckets());
+
+            write_ops::UpdateCommandRequest updateOp(nss.makeStatisticsNamespace());
+            write_ops::UpdateOpEntry updateEntry(
+                BSON("_id" << path),
+                write_ops::UpdateModification::parseFromClassicUpdate(
+                    BSON("_id" << path << ce::StatsCache::kCollectionUUIDField << collectionUUID
+                               << ce::StatsCache::kStatisticsField << histogram.serialize())));
+            updateEntry.setUpsert(true);
+            updateOp.setUpdates({updateEntry});
+
+            // StatsCacheOpObserver invalidates the cached statistics once the update commits, on
+            // this node and on every node applying it from the oplog.
+            DBDirectClient client(opCtx);
+            write_ops::checkWriteErrors(client.update(updateOp));
+        }
+
+    private:
+        NamespaceString ns() const override {
+            return request().getNamespace();
+        }
+
+        bool supportsWriteConcern() const override {
+            return true;
+        }
+
+        void doCheckAuthorization(OperationContext* opCtx) const override {
+            uassert(ErrorCodes::Unauthorized,
+                    "Unauthorized",
+                    AuthorizationSession::get(opCtx->getClient())
+                        ->isAuthorizedForActionsOnResource(
+                            ResourcePattern::forExactNamespace(request().getNamespace()),
+                            ActionType::analyze));
+        }
+    };
+
+} analyzeCmd;
+
+}  // namespace
+}  // namespace mongo
@@ -32,6 +32,7 @@
 #include "mongo/db/exec/sbe/abt/abt_lower.h"
 #include "mongo/db/pipeline/abt/abt_document_source_visitor.h"
 #include "mongo/db/pipeline/abt/match_expression_visitor.h"
+#include "mongo/db/query/ce/ce_histogram.h"
 #include "mongo/db/query/ce/ce_sampling.h"
 #include "mongo/db/query/optimizer/cascades/ce_heuristic.h"
 #include "mongo/db/query/optimizer/cascades/cost_derivation.h"
@@ -233,7 +234,9 @@ static std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> optimizeAndCreateExe
                       ids,
                       phaseManager.getMetadata(),
                       phaseManager.getNodeToGroupPropsMap(),
-                      phaseManager.getRIDProjections()};
+                      phaseManager.getRIDProjections(),
+                      false /*randomScan*/,
+                      expCtx->allowDiskUse};
     auto sbePlan = g.optimize(abtTree);
 
     uassert(6624253, "Lowering failed: did not produce a plan.", sbePlan != nullptr);
@@ -386,6 +389,21 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> getSBEExecutorViaCascadesOp
     std::cerr << ExplainGenerator::explainV2(abtTree) << std::endl;
     std::cerr << "******* Translated ABT **********\n";
 
+    if (collectionExists && numRecords > 0 &&
+        internalQueryEnableHistogramCardinalityEstimator.load()) {
+        OptPhaseManager phaseManager{OptPhaseManager::getAllRewritesSet(),
+                                     prefixId,
+                                     false /*requireRID*/,
+                                     std::move(metadata),
+                                     std::make_unique<CEHistogramTransport>(opCtx),
+                                     std::make_unique<DefaultCosting>(),
+                                     DebugInfo::kDefaultForProd};
+        phaseManager.getHints() = queryHints;
+
+        return optimizeAndCreateExecutor(
+            phaseManager, std::move(abtTree), opCtx, expCtx, nss, collection);
+    }
+
     if (collectionExists && numRecords > 0 &&
         internalQueryEnableSamplingCardinalityEstimator.load()) {
         Metadata metadataForSampling = metadata;
@@ -38,6 +38,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/str.h"
 
@@ -57,7 +58,8 @@ FetchStage::FetchStage(ExpressionContext* expCtx,
     : RequiresCollectionStage(kStageType, expCtx, collection),
       _ws(ws),
       _filter((filter && !filter->isTriviallyTrue()) ? filter : nullptr),
-      _idRetrying(WorkingSet::INVALID_ID) {
+      _idRetrying(WorkingSet::INVALID_ID),
+      _readAheadDepth(internalQueryFetchReadAheadDepth.load()) {
     _children.emplace_back(std::move(child));
 }
 
@@ -69,6 +71,10 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_readAheadBuffer.empty()) {
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -80,12 +86,14 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
+    if (_idRetrying != WorkingSet::INVALID_ID) {
         status = ADVANCED;
         id = _idRetrying;
         _idRetrying = WorkingSet::INVALID_ID;
+    } else if (_readAheadDepth > 0) {
+        status = readAhead(&id);
+    } else {
+        status = child()->work(&id);
     }
 
     if (PlanStage::ADVANCED == status) {
@@ -126,6 +134,54 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState FetchStage::readAhead(WorkingSetID* out) {
+    if (!_readAheadDraining) {
+        if (_readAheadBuffer.size() < _readAheadDepth && !child()->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            StageState status = child()->work(&id);
+            if (PlanStage::ADVANCED == status) {
+                _readAheadBuffer.push_back(id);
+            } else if (PlanStage::IS_EOF != status) {
+                *out = id;
+                return status;
+            }
+
+            if (_readAheadBuffer.size() < _readAheadDepth && !child()->isEOF()) {
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        if (_readAheadBuffer.empty()) {
+            // The child is exhausted and there is nothing left to fetch.
+            return PlanStage::NEED_TIME;
+        }
+
+        std::vector<RecordId> ids;
+        ids.reserve(_readAheadBuffer.size());
+        for (auto id : _readAheadBuffer) {
+            WorkingSetMember* member = _ws->get(id);
+            if (!member->hasObj() && member->hasRecordId()) {
+                ids.push_back(member->recordId);
+            }
+        }
+
+        if (!ids.empty()) {
+            if (!_cursor) {
+                _cursor = collection()->getCursor(opCtx());
+            }
+            _specificStats.docsPrefetched += _cursor->prefetch(ids);
+        }
+        _readAheadDraining = true;
+    }
+
+    *out = _readAheadBuffer.front();
+    _readAheadBuffer.pop_front();
+    if (_readAheadBuffer.empty()) {
+        _readAheadDraining = false;
+    }
+    return PlanStage::ADVANCED;
+}
+
 void FetchStage::doSaveStateRequiresCollection() {
     if (_cursor) {
         _cursor->saveUnpositioned();
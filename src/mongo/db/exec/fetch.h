@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "mongo/db/exec/requires_collection_stage.h"
@@ -46,6 +47,11 @@ class SeekableRecordCursor;
  * In WorkingSetMember terms, it transitions from RID_AND_IDX to RID_AND_OBJ by reading
  * the record at the provided RecordId.  Returns verbatim any data that already has an object.
  *
+ * When read-ahead is enabled, the stage buffers up to 'internalQueryFetchReadAheadDepth' members
+ * from its child and hands their RecordIds to the storage engine before fetching them, so that the
+ * storage engine can load the upcoming records in the background. Members are still returned in
+ * the order the child produced them.
+ *
  * Preconditions: Valid RecordId.
  */
 class FetchStage : public RequiresCollectionStage {
@@ -86,6 +92,13 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Fills the read-ahead buffer from our child and, once it is full or the child is exhausted,
+     * asks the storage engine to read ahead the buffered records. Then returns the buffered members
+     * one at a time, in order. Passes NEED_YIELD through from the child.
+     */
+    StageState readAhead(WorkingSetID* out);
+
     // Used to fetch Records from _collection.
     std::unique_ptr<SeekableRecordCursor> _cursor;
 
@@ -98,6 +111,18 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // The maximum number of members to buffer from our child for read-ahead. Zero disables
+    // read-ahead.
+    const size_t _readAheadDepth;
+
+    // Members returned by our child which have not been fetched yet, in the order the child
+    // returned them.
+    std::deque<WorkingSetID> _readAheadBuffer;
+
+    // True once the storage engine has been asked to read ahead the buffered members, and until
+    // the buffer has been drained.
+    bool _readAheadDraining = false;
+
     // Stats
     FetchStats _specificStats;
 };
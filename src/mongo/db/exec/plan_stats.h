@@ -503,6 +503,9 @@ struct FetchStats : public SpecificStats {
 
     // The total number of full documents touched by the fetch stage.
     size_t docsExamined = 0u;
+
+    // The number of documents the storage engine was asked to read ahead of being fetched.
+    size_t docsPrefetched = 0u;
 };
 
 struct IDHackStats : public SpecificStats {
@@ -784,6 +787,9 @@ struct SortStats : public SpecificStats {
 
     // The number of times that we spilled data to disk during the execution of this query.
     uint64_t spills = 0u;
+
+    // The number of bytes written to disk by those spills, after compression.
+    uint64_t spilledDataStorageSize = 0u;
 };
 
 struct MergeSortStats : public SpecificStats {
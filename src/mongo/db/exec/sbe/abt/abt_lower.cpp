@@ -668,6 +668,7 @@ std::unique_ptr<sbe::PlanStage> SBENodeLowering::walk(const HashJoinNode& n,
                                           std::move(innerKeys),
                                           std::move(innerProjects),
                                           collatorSlot,
+                                          _allowDiskUse,
                                           planNodeId);
 }
 
@@ -737,7 +738,8 @@ std::unique_ptr<sbe::PlanStage> SBENodeLowering::walk(const UnionNode& n,
                                       _metadata,
                                       _nodeToGroupPropsMap,
                                       _ridProjections,
-                                      _randomScan);
+                                      _randomScan,
+                                      _allowDiskUse);
         auto loweredChild = localLowering.optimize(child);
 
         if (children.size() == 1) {
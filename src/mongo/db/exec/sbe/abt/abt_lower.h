@@ -95,14 +95,16 @@ public:
                     const Metadata& metadata,
                     const NodeToGroupPropsMap& nodeToGroupPropsMap,
                     const RIDProjectionsMap& ridProjections,
-                    const bool randomScan = false)
+                    const bool randomScan = false,
+                    const bool allowDiskUse = false)
         : _env(env),
           _slotMap(slotMap),
           _slotIdGenerator(ids),
           _metadata(metadata),
           _nodeToGroupPropsMap(nodeToGroupPropsMap),
           _ridProjections(ridProjections),
-          _randomScan(randomScan) {}
+          _randomScan(randomScan),
+          _allowDiskUse(allowDiskUse) {}
 
     // The default noop transport.
     template <typename T, typename... Ts>
@@ -201,6 +203,10 @@ private:
     // Currently only supported for single-threaded (non parallel-scanned) mongod collections.
     // TODO: handle cases where we have more than one collection scan.
     const bool _randomScan;
+
+    // Whether stages which can spill, such as hash joins, may do so once they exceed their memory
+    // limit, rather than fail.
+    const bool _allowDiskUse;
 };
 
 }  // namespace mongo::optimizer
@@ -499,6 +499,14 @@ static stdx::unordered_map<std::string, BuiltinFn> kBuiltinFunctions = {
      BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::generateSortKey, false}},
     {"tsSecond", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::tsSecond, false}},
     {"tsIncrement", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::tsIncrement, false}},
+    {"valueBlockFromArray",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::valueBlockFromArray, false}},
+    {"valueBlockToArray",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::valueBlockToArray, false}},
+    {"valueBlockMin",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::valueBlockMin, false}},
+    {"valueBlockMax",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::valueBlockMax, false}},
 };
 
 /**
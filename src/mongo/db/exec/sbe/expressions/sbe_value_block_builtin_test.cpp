@@ -0,0 +1,186 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "mongo/bson/util/bsoncolumnbuilder.h"
+#include "mongo/db/exec/sbe/expression_test_base.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/exec/sbe/values/value_block.h"
+
+namespace mongo::sbe {
+
+class SBEValueBlockBuiltinTest : public EExpressionTestFixture {
+protected:
+    using TypedValue = std::pair<value::TypeTags, value::Value>;
+
+    static std::unique_ptr<EExpression> makeConstant(TypedValue value) {
+        return makeE<EConstant>(value.first, value.second);
+    }
+
+    static std::unique_ptr<EExpression> makeBlock(const BSONArray& arr) {
+        return makeE<EFunction>("valueBlockFromArray", makeEs(makeConstant(makeBsonArray(arr))));
+    }
+
+    /**
+     * Assert that the result of 'expr' is equal to 'expectedRes' and has the same type.
+     * NOTE: The value behind 'expectedRes' is owned by the caller.
+     */
+    void runAndAssertExpression(const EExpression& expr, TypedValue expectedRes) {
+        auto compiledExpr = compileExpression(expr);
+        auto [actualTag, actualValue] = runCompiledExpression(compiledExpr.get());
+        value::ValueGuard actualValueGuard{actualTag, actualValue};
+
+        assertSameValue({actualTag, actualValue}, expectedRes);
+    }
+
+    /**
+     * Assert that 'expr' produces a block which holds the 'expected' values, including the
+     * positions which hold Nothing.
+     */
+    void runAndAssertBlock(const EExpression& expr, const std::vector<TypedValue>& expected) {
+        auto compiledExpr = compileExpression(expr);
+        auto [actualTag, actualValue] = runCompiledExpression(compiledExpr.get());
+        value::ValueGuard actualValueGuard{actualTag, actualValue};
+
+        ASSERT_EQ(actualTag, value::TypeTags::valueBlock);
+        auto block = value::getValueBlockView(actualValue);
+        ASSERT_EQ(block->size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            assertSameValue(block->getAt(i), expected[i]);
+        }
+    }
+
+    static void assertSameValue(TypedValue actual, TypedValue expected) {
+        ASSERT_EQ(actual.first, expected.first);
+        if (expected.first == value::TypeTags::Nothing) {
+            return;
+        }
+
+        auto [compareTag, compareValue] =
+            value::compareValue(actual.first, actual.second, expected.first, expected.second);
+        ASSERT_EQ(compareTag, value::TypeTags::NumberInt32);
+        ASSERT_EQ(compareValue, 0);
+    }
+};
+
+TEST_F(SBEValueBlockBuiltinTest, FromArrayAndObject) {
+    auto fromArray = makeBlock(BSON_ARRAY(1 << 2.5 << "abc"));
+    auto toArray = makeE<EFunction>("valueBlockToArray", makeEs(std::move(fromArray)));
+    auto expected = makeBsonArray(BSON_ARRAY(1 << 2.5 << "abc"));
+    value::ValueGuard expectedGuard{expected};
+    runAndAssertExpression(*toArray, expected);
+
+    // The data fields of time-series buckets are objects keyed by the position.
+    BSONObj bucketField = BSON("0" << 7 << "1" << 8);
+    auto [objTag, objVal] = value::copyValue(
+        value::TypeTags::bsonObject, value::bitcastFrom<const char*>(bucketField.objdata()));
+    auto fromObject =
+        makeE<EFunction>("valueBlockFromArray", makeEs(makeE<EConstant>(objTag, objVal)));
+    runAndAssertBlock(*fromObject, {makeInt32(7), makeInt32(8)});
+
+    auto notArray = makeE<EFunction>("valueBlockFromArray", makeEs(makeConstant(makeInt32(1))));
+    runAndAssertExpression(*notArray, makeNothing());
+}
+
+TEST_F(SBEValueBlockBuiltinTest, FromColumnKeepsSkippedPositions) {
+    BSONColumnBuilder builder("0");
+    BSONObj values = BSON("a" << 1 << "b" << 3);
+    builder.append(values["a"]);
+    builder.skip();
+    builder.append(values["b"]);
+    BSONObjBuilder bob;
+    bob.append("column", builder.finalize());
+    BSONObj obj = bob.obj();
+
+    auto [columnTag, columnVal] = bson::convertFrom<false>(obj["column"]);
+    auto fromColumn =
+        makeE<EFunction>("valueBlockFromArray", makeEs(makeE<EConstant>(columnTag, columnVal)));
+    runAndAssertBlock(*fromColumn, {makeInt32(1), makeNothing(), makeInt32(3)});
+}
+
+TEST_F(SBEValueBlockBuiltinTest, MinMax) {
+    // Homogeneous blocks use the typed loops.
+    auto minInt32 =
+        makeE<EFunction>("valueBlockMin", makeEs(makeBlock(BSON_ARRAY(3 << -2 << 4))));
+    runAndAssertExpression(*minInt32, makeInt32(-2));
+
+    auto maxInt64 =
+        makeE<EFunction>("valueBlockMax", makeEs(makeBlock(BSON_ARRAY(3LL << -2LL << 4LL))));
+    runAndAssertExpression(*maxInt64, makeInt64(4));
+
+    // Mixed types are compared like the row-based aggregates do.
+    auto minMixed =
+        makeE<EFunction>("valueBlockMin", makeEs(makeBlock(BSON_ARRAY(3 << 2.5 << 4LL))));
+    runAndAssertExpression(*minMixed, makeDouble(2.5));
+
+    auto maxMixed =
+        makeE<EFunction>("valueBlockMax", makeEs(makeBlock(BSON_ARRAY(3 << "abc" << 4LL))));
+    auto expected = value::makeNewString("abc");
+    value::ValueGuard expectedGuard{expected};
+    runAndAssertExpression(*maxMixed, expected);
+
+    // NaN is smaller than any number, so it only wins for min.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto minNaN = makeE<EFunction>("valueBlockMin", makeEs(makeBlock(BSON_ARRAY(1.0 << nan))));
+    runAndAssertExpression(*minNaN, makeDouble(nan));
+
+    auto maxNaN = makeE<EFunction>("valueBlockMax", makeEs(makeBlock(BSON_ARRAY(nan << 1.0))));
+    runAndAssertExpression(*maxNaN, makeDouble(1.0));
+}
+
+TEST_F(SBEValueBlockBuiltinTest, MinMaxSkipNothing) {
+    BSONColumnBuilder builder("0");
+    BSONObj values = BSON("a" << 5 << "b" << 3);
+    builder.skip();
+    builder.append(values["a"]);
+    builder.skip();
+    builder.append(values["b"]);
+    BSONObjBuilder bob;
+    bob.append("column", builder.finalize());
+    BSONObj obj = bob.obj();
+
+    auto makeColumnBlock = [&] {
+        auto [columnTag, columnVal] = bson::convertFrom<false>(obj["column"]);
+        return makeE<EFunction>("valueBlockFromArray",
+                                makeEs(makeE<EConstant>(columnTag, columnVal)));
+    };
+
+    auto min = makeE<EFunction>("valueBlockMin", makeEs(makeColumnBlock()));
+    runAndAssertExpression(*min, makeInt32(3));
+
+    auto max = makeE<EFunction>("valueBlockMax", makeEs(makeColumnBlock()));
+    runAndAssertExpression(*max, makeInt32(5));
+
+    auto minEmpty = makeE<EFunction>("valueBlockMin", makeEs(makeBlock(BSONArray())));
+    runAndAssertExpression(*minEmpty, makeNothing());
+}
+
+}  // namespace mongo::sbe
@@ -0,0 +1,140 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::BlockPackStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/block_pack.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
+
+namespace mongo::sbe {
+
+using BlockPackStageTest = PlanStageTestFixture;
+
+TEST_F(BlockPackStageTest, PacksRowsIntoBlocks) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(
+        BSON_ARRAY(BSON_ARRAY(1 << 2) << BSON_ARRAY(3 << 4) << BSON_ARRAY(5)));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto makeStageFn = [this](value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage) {
+        auto blockSlot = generateSlotId();
+        auto blockPackStage = makeS<BlockPackStage>(
+            std::move(scanStage), makeSV(scanSlot), makeSV(blockSlot), 2, kEmptyPlanNodeId);
+
+        auto outSlot = generateSlotId();
+        auto projectStage = makeProjectStage(
+            std::move(blockPackStage),
+            kEmptyPlanNodeId,
+            outSlot,
+            stage_builder::makeFunction("valueBlockToArray", makeE<EVariable>(blockSlot)));
+
+        return std::make_pair(outSlot, std::move(projectStage));
+    };
+
+    inputGuard.reset();
+    expectedGuard.reset();
+    runTest(inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
+}
+
+TEST_F(BlockPackStageTest, EmptyInputProducesNoBlocks) {
+    auto [inputTag, inputVal] = value::makeNewArray();
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    auto [expectedTag, expectedVal] = value::makeNewArray();
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto makeStageFn = [this](value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage) {
+        auto blockSlot = generateSlotId();
+        auto blockPackStage = makeS<BlockPackStage>(
+            std::move(scanStage), makeSV(scanSlot), makeSV(blockSlot), 2, kEmptyPlanNodeId);
+
+        return std::make_pair(blockSlot, std::move(blockPackStage));
+    };
+
+    inputGuard.reset();
+    expectedGuard.reset();
+    runTest(inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
+}
+
+TEST_F(BlockPackStageTest, HashAggOverBlocks) {
+    auto [inputTag, inputVal] = stage_builder::makeValue(
+        BSON_ARRAY(5 << 2.5 << "b" << 7LL << -3 << "a" << 4 << 1.5));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(BSON_ARRAY(BSON_ARRAY(-3 << "b")));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto makeStageFn = [this](value::SlotId scanSlot, std::unique_ptr<PlanStage> scanStage) {
+        // Aggregate blocks of three rows, the last one of which is only partially filled.
+        auto blockSlot = generateSlotId();
+        auto blockPackStage = makeS<BlockPackStage>(
+            std::move(scanStage), makeSV(scanSlot), makeSV(blockSlot), 3, kEmptyPlanNodeId);
+
+        auto minSlot = generateSlotId();
+        auto maxSlot = generateSlotId();
+        auto hashAggStage = makeS<HashAggStage>(
+            std::move(blockPackStage),
+            makeSV(),
+            makeEM(minSlot,
+                   stage_builder::makeFunction(
+                       "min",
+                       stage_builder::makeFunction("valueBlockMin", makeE<EVariable>(blockSlot))),
+                   maxSlot,
+                   stage_builder::makeFunction(
+                       "max",
+                       stage_builder::makeFunction("valueBlockMax", makeE<EVariable>(blockSlot)))),
+            makeSV(),
+            true,
+            boost::none,
+            false /* allowDiskUse */,
+            kEmptyPlanNodeId);
+
+        auto outSlot = generateSlotId();
+        auto projectStage =
+            makeProjectStage(std::move(hashAggStage),
+                             kEmptyPlanNodeId,
+                             outSlot,
+                             stage_builder::makeFunction(
+                                 "newArray", makeE<EVariable>(minSlot), makeE<EVariable>(maxSlot)));
+
+        return std::make_pair(outSlot, std::move(projectStage));
+    };
+
+    inputGuard.reset();
+    expectedGuard.reset();
+    runTest(inputTag, inputVal, expectedTag, expectedVal, makeStageFn);
+}
+}  // namespace mongo::sbe
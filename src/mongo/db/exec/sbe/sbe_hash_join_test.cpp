@@ -37,10 +37,89 @@
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
 
-using HashJoinStageTest = PlanStageTestFixture;
+class HashJoinStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Joins 'outer' and 'inner', both arrays of [key, payload] pairs, on their keys and returns the
+     * sorted [outer payload, inner payload] pairs produced by the HashJoinStage.
+     */
+    std::vector<std::pair<int, int>> runJoin(const BSONArray& outer,
+                                             const BSONArray& inner,
+                                             bool allowDiskUse,
+                                             HashJoinStats* stats) {
+        auto ctx = makeCompileCtx();
+
+        auto [outerSlots, outerStage] = generateVirtualScanMulti(2, outer);
+        auto [innerSlots, innerStage] = generateVirtualScanMulti(2, inner);
+        auto stage = makeS<HashJoinStage>(std::move(outerStage),
+                                          std::move(innerStage),
+                                          makeSV(outerSlots[0]),
+                                          makeSV(outerSlots[1]),
+                                          makeSV(innerSlots[0]),
+                                          makeSV(innerSlots[1]),
+                                          boost::none,
+                                          allowDiskUse,
+                                          kEmptyPlanNodeId);
+
+        auto accessors =
+            prepareTree(ctx.get(),
+                        stage.get(),
+                        makeSV(outerSlots[0], innerSlots[0], outerSlots[1], innerSlots[1]));
+
+        std::vector<std::pair<int, int>> results;
+        while (stage->getNext() == PlanState::ADVANCED) {
+            auto [outerKeyTag, outerKeyVal] = accessors[0]->getViewOfValue();
+            auto [innerKeyTag, innerKeyVal] = accessors[1]->getViewOfValue();
+            assertValuesEqual(outerKeyTag, outerKeyVal, innerKeyTag, innerKeyVal);
+
+            auto [outerTag, outerVal] = accessors[2]->getViewOfValue();
+            auto [innerTag, innerVal] = accessors[3]->getViewOfValue();
+            ASSERT_EQ(value::TypeTags::NumberInt32, outerTag);
+            ASSERT_EQ(value::TypeTags::NumberInt32, innerTag);
+            results.emplace_back(value::bitcastTo<int32_t>(outerVal),
+                                 value::bitcastTo<int32_t>(innerVal));
+        }
+
+        *stats = *static_cast<const HashJoinStats*>(stage->getSpecificStats());
+        stage->close();
+
+        std::sort(results.begin(), results.end());
+        return results;
+    }
+
+    /**
+     * Builds 'numRows' [key, payload] pairs where the keys cycle through [0, 'numKeys') and the
+     * payload is unique to each row.
+     */
+    static BSONArray makeInput(int numRows, int numKeys, int payloadBase) {
+        BSONArrayBuilder bab;
+        for (int i = 0; i < numRows; ++i) {
+            bab.append(BSON_ARRAY((i % numKeys) << (payloadBase + i)));
+        }
+        return bab.arr();
+    }
+
+    static std::vector<std::pair<int, int>> expectedJoin(int numOuter,
+                                                         int numInner,
+                                                         int numKeys,
+                                                         int outerBase,
+                                                         int innerBase) {
+        std::vector<std::pair<int, int>> expected;
+        for (int o = 0; o < numOuter; ++o) {
+            for (int i = 0; i < numInner; ++i) {
+                if (o % numKeys == i % numKeys) {
+                    expected.emplace_back(outerBase + o, innerBase + i);
+                }
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        return expected;
+    }
+};
 
 TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     using namespace std::literals;
@@ -79,6 +158,7 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
                                      makeSV(innerCondSlot),
                                      makeSV(),
                                      boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                     false /* allowDiskUse */,
                                      kEmptyPlanNodeId);
 
             return std::make_pair(makeSV(innerCondSlot, outerCondSlot), std::move(hashJoinStage));
@@ -137,4 +217,58 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     }
 }
 
+TEST_F(HashJoinStageTest, HashJoinNoSpill) {
+    // We shouldn't spill to disk if memory is plentiful (which by default it is), even if we are
+    // allowed to.
+    HashJoinStats stats;
+    auto results = runJoin(makeInput(100, 20, 1000), makeInput(60, 30, 2000), true, &stats);
+
+    ASSERT(results == expectedJoin(100, 60, 20, 1000, 2000));
+    ASSERT_FALSE(stats.usedDisk);
+    ASSERT_EQ(0, stats.spilledPartitions);
+    ASSERT_EQ(0, stats.spilledBuildRecords);
+    ASSERT_EQ(0, stats.spilledProbeRecords);
+}
+
+TEST_F(HashJoinStageTest, HashJoinSpill) {
+    // Use a budget which only fits a handful of rows, so that every partition is spilled and the
+    // build partitions have to be loaded back in several chunks.
+    auto defaultMemoryLimit = internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    auto defaultNumPartitions = internalQuerySBEHashJoinNumPartitions.load();
+    internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(256);
+    internalQuerySBEHashJoinNumPartitions.store(4);
+    ON_BLOCK_EXIT([&] {
+        internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(defaultMemoryLimit);
+        internalQuerySBEHashJoinNumPartitions.store(defaultNumPartitions);
+    });
+
+    HashJoinStats stats;
+    auto results = runJoin(makeInput(100, 20, 1000), makeInput(60, 30, 2000), true, &stats);
+
+    ASSERT(results == expectedJoin(100, 60, 20, 1000, 2000));
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_GT(stats.spilledPartitions, 0);
+    ASSERT_LTE(stats.spilledPartitions, 4);
+    ASSERT_GT(stats.spilledBuildRecords, 0);
+    ASSERT_LTE(stats.spilledBuildRecords, 100);
+    ASSERT_GT(stats.spilledProbeRecords, 0);
+    ASSERT_LTE(stats.spilledProbeRecords, 60);
+    ASSERT_GT(stats.spilledBytes, 0);
+    ASSERT_GT(stats.spilledProbePasses, 0);
+}
+
+TEST_F(HashJoinStageTest, HashJoinSpillNoDiskUseAllowed) {
+    auto defaultMemoryLimit = internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(256);
+    ON_BLOCK_EXIT([&] {
+        internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.store(defaultMemoryLimit);
+    });
+
+    HashJoinStats stats;
+    ASSERT_THROWS_CODE(
+        runJoin(makeInput(100, 20, 1000), makeInput(60, 30, 2000), false, &stats),
+        DBException,
+        ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
 }  // namespace mongo::sbe
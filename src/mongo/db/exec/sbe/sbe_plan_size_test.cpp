@@ -27,6 +27,7 @@
  *    it in the license file.
  */
 
+#include "mongo/db/exec/sbe/stages/block_pack.h"
 #include "mongo/db/exec/sbe/stages/branch.h"
 #include "mongo/db/exec/sbe/stages/bson_scan.h"
 #include "mongo/db/exec/sbe/stages/check_bounds.h"
@@ -96,6 +97,11 @@ private:
     std::unique_ptr<value::SlotIdGenerator> _slotIdGenerator;
 };
 
+TEST_F(PlanSizeTest, BlockPack) {
+    auto stage = makeS<BlockPackStage>(mockS(), mockSV(), mockSV(), 128, kEmptyPlanNodeId);
+    assertPlanSize(*stage);
+}
+
 TEST_F(PlanSizeTest, Branch) {
     auto stage = makeS<BranchStage>(
         mockS(), mockS(), mockE(), mockSV(), mockSV(), mockSV(), kEmptyPlanNodeId);
@@ -156,6 +162,7 @@ TEST_F(PlanSizeTest, HashJoin) {
                                       mockSV(),
                                       makeSV(),
                                       generateSlotId(),
+                                      false /* allowDiskUse */,
                                       kEmptyPlanNodeId);
     assertPlanSize(*stage);
 }
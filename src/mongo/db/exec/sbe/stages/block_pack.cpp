@@ -0,0 +1,192 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/block_pack.h"
+
+#include "mongo/db/exec/sbe/size_estimator.h"
+#include "mongo/db/exec/sbe/values/value_block.h"
+#include "mongo/util/str.h"
+
+namespace mongo::sbe {
+BlockPackStage::BlockPackStage(std::unique_ptr<PlanStage> input,
+                               value::SlotVector inSlots,
+                               value::SlotVector outSlots,
+                               size_t blockSize,
+                               PlanNodeId planNodeId)
+    : PlanStage("blockpack"_sd, planNodeId),
+      _inSlots(std::move(inSlots)),
+      _outSlots(std::move(outSlots)),
+      _blockSize(blockSize) {
+    invariant(_inSlots.size() == _outSlots.size());
+    invariant(_blockSize > 0);
+    _children.emplace_back(std::move(input));
+}
+
+std::unique_ptr<PlanStage> BlockPackStage::clone() const {
+    return std::make_unique<BlockPackStage>(
+        _children[0]->clone(), _inSlots, _outSlots, _blockSize, _commonStats.nodeId);
+}
+
+void BlockPackStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+
+    for (auto slot : _inSlots) {
+        _inAccessors.push_back(_children[0]->getAccessor(ctx, slot));
+    }
+
+    _outAccessors.resize(_outSlots.size());
+    for (size_t idx = 0; idx < _outSlots.size(); ++idx) {
+        auto [it, inserted] = _outAccessorsMap.emplace(_outSlots[idx], idx);
+        uassert(6703000, str::stream() << "duplicate field: " << _outSlots[idx], inserted);
+    }
+}
+
+value::SlotAccessor* BlockPackStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _outAccessorsMap.find(slot); it != _outAccessorsMap.end()) {
+        return &_outAccessors[it->second];
+    }
+
+    return ctx.getAccessor(slot);
+}
+
+void BlockPackStage::open(bool reOpen) {
+    auto optTimer(getOptTimer(_opCtx));
+
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+    _isEOF = false;
+}
+
+PlanState BlockPackStage::getNext() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    if (_isEOF) {
+        return trackPlanState(PlanState::IS_EOF);
+    }
+
+    std::vector<std::unique_ptr<value::ValueBlock>> blocks;
+    blocks.reserve(_inAccessors.size());
+    for (size_t idx = 0; idx < _inAccessors.size(); ++idx) {
+        blocks.push_back(std::make_unique<value::ValueBlock>());
+        blocks.back()->reserve(_blockSize);
+    }
+
+    // The blocks own copies of the values of the child, so they stay valid if the child yields
+    // while we fill them, and we do not need to save our state.
+    disableSlotAccess();
+
+    size_t rows = 0;
+    for (; rows < _blockSize; ++rows) {
+        if (_children[0]->getNext() == PlanState::IS_EOF) {
+            _isEOF = true;
+            break;
+        }
+
+        for (size_t idx = 0; idx < _inAccessors.size(); ++idx) {
+            auto [tag, val] = _inAccessors[idx]->copyOrMoveValue();
+            blocks[idx]->push_back(tag, val);
+        }
+    }
+
+    if (rows == 0) {
+        return trackPlanState(PlanState::IS_EOF);
+    }
+
+    for (size_t idx = 0; idx < blocks.size(); ++idx) {
+        _outAccessors[idx].reset(true,
+                                 value::TypeTags::valueBlock,
+                                 value::bitcastFrom<value::ValueBlock*>(blocks[idx].release()));
+    }
+
+    return trackPlanState(PlanState::ADVANCED);
+}
+
+void BlockPackStage::close() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    trackClose();
+    _children[0]->close();
+
+    for (auto& accessor : _outAccessors) {
+        accessor.reset();
+    }
+}
+
+std::unique_ptr<PlanStageStats> BlockPackStage::getStats(bool includeDebugInfo) const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        bob.append("inSlots", _inSlots.begin(), _inSlots.end());
+        bob.append("outSlots", _outSlots.begin(), _outSlots.end());
+        bob.appendNumber("blockSize", static_cast<long long>(_blockSize));
+        ret->debugInfo = bob.obj();
+    }
+
+    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    return ret;
+}
+
+const SpecificStats* BlockPackStage::getSpecificStats() const {
+    return nullptr;
+}
+
+std::vector<DebugPrinter::Block> BlockPackStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    auto addSlots = [&](const value::SlotVector& slots) {
+        ret.emplace_back(DebugPrinter::Block("[`"));
+        for (size_t idx = 0; idx < slots.size(); ++idx) {
+            if (idx) {
+                ret.emplace_back(DebugPrinter::Block("`,"));
+            }
+            DebugPrinter::addIdentifier(ret, slots[idx]);
+        }
+        ret.emplace_back(DebugPrinter::Block("`]"));
+    };
+    addSlots(_outSlots);
+    addSlots(_inSlots);
+    ret.emplace_back(std::to_string(_blockSize));
+
+    DebugPrinter::addNewLine(ret);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+
+    return ret;
+}
+
+size_t BlockPackStage::estimateCompileTimeSize() const {
+    size_t size = sizeof(*this);
+    size += size_estimator::estimate(_children);
+    size += size_estimator::estimate(_inSlots);
+    size += size_estimator::estimate(_outSlots);
+    return size;
+}
+}  // namespace mongo::sbe
@@ -328,7 +328,19 @@ void HashAggStage::checkMemoryUsageAndSpillIfNecessary(MemoryCheckData& mcd) {
             (static_cast<double>(estimatedTotalSize - mcd.lastEstimatedMemoryUsage) /
              mcd.memoryCheckpointCounter);
 
-        if (estimatedTotalSize >= _approxMemoryUseInBytesBeforeSpill) {
+        // The process-wide query memory budget may be used up before this stage reaches its own
+        // limit. In that case the memory already granted to '_ht' becomes the limit, unless we are
+        // not allowed to spill, in which case we wait for other queries to release memory.
+        long long memoryLimit = _approxMemoryUseInBytesBeforeSpill;
+        if (!_memoryGrant.tryResize(std::min(estimatedTotalSize, memoryLimit))) {
+            if (_allowDiskUse) {
+                memoryLimit = _memoryGrant.bytes();
+            } else {
+                _memoryGrant.resizeOrWait(_opCtx, std::min(estimatedTotalSize, memoryLimit));
+            }
+        }
+
+        if (estimatedTotalSize >= memoryLimit) {
             uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
                     "Exceeded memory limit for $group, but didn't allow external spilling."
                     " Pass allowDiskUse:true to opt in.",
@@ -338,14 +350,14 @@ void HashAggStage::checkMemoryUsageAndSpillIfNecessary(MemoryCheckData& mcd) {
             }
 
             // Evict enough rows into the temporary store to drop below the memory constraint.
-            const long rowsToEvictCount =
-                1 + (estimatedTotalSize - _approxMemoryUseInBytesBeforeSpill) / estimatedRowSize;
+            const long rowsToEvictCount = 1 + (estimatedTotalSize - memoryLimit) / estimatedRowSize;
             for (long i = 0; !_ht->empty() && i < rowsToEvictCount; i++) {
                 spillRowToDisk(_htIt->first, _htIt->second);
                 _ht->erase(_htIt);
                 _htIt = _ht->begin();
             }
             estimatedTotalSize = _ht->size() * estimatedRowSize;
+            _memoryGrant.tryResize(estimatedTotalSize);
         }
 
         // Calculate the next memory checkpoint. We estimate it based on the prior growth of the
@@ -355,7 +367,7 @@ void HashAggStage::checkMemoryUsageAndSpillIfNecessary(MemoryCheckData& mcd) {
         // evicted any records. And a value close to zero indicates a stable size of '_ht' so can
         // delay the next check progressively.
         const long nextCheckpointCandidate = (estimatedGainPerChildAdvance > 0.1)
-            ? mcd.checkpointMargin * (_approxMemoryUseInBytesBeforeSpill - estimatedTotalSize) /
+            ? mcd.checkpointMargin * (memoryLimit - estimatedTotalSize) /
                 estimatedGainPerChildAdvance
             : (estimatedGainPerChildAdvance < -0.1) ? mcd.atMostCheckFrequency
                                                     : mcd.nextMemoryCheckpoint * 2;
@@ -396,6 +408,8 @@ void HashAggStage::open(bool reOpen) {
         value::MaterializedRow defaultVal{_outAggAccessors.size()};
         bool updateAggStateHt = false;
         MemoryCheckData memoryCheckData;
+        _memoryGrant =
+            QueryMemoryBroker::get(_opCtx).makeGrant(QueryMemoryBroker::Consumer::kHashAgg);
 
         while (_children[0]->getNext() == PlanState::ADVANCED) {
             value::MaterializedRow key{_inKeyAccessors.size()};
@@ -601,6 +615,7 @@ void HashAggStage::close() {
 
     trackClose();
     _ht = boost::none;
+    _memoryGrant.release();
     if (_recordStore) {
         // A record store was created to spill to disk. Clean it up.
         _recordStore.reset();
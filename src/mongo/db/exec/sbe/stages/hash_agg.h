@@ -35,6 +35,7 @@
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_memory_broker.h"
 #include "mongo/db/storage/temporary_record_store.h"
 #include "mongo/stdx/unordered_map.h"
 
@@ -211,6 +212,8 @@ private:
         internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load();
     std::unique_ptr<TemporaryRecordStore> _recordStore;
     bool _drainingRecordStore{false};
+    // The share of the process-wide query memory budget held by '_ht'.
+    QueryMemoryBroker::Grant _memoryGrant;
     std::unique_ptr<SeekableRecordCursor> _rsCursor;
 
     HashAggStats _specificStats;
@@ -33,10 +33,31 @@
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/size_estimator.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/write_unit_of_work.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
 namespace sbe {
+namespace {
+// Spilled rows of a partition get consecutive RecordIds starting at '(partition + 1) << shift', so
+// a partition can be read back with a single seek followed by a sequential scan.
+constexpr int kSpilledPartitionShift = 40;
+
+RecordId makeSpilledRecordId(size_t partition, long long pos) {
+    return RecordId(((static_cast<int64_t>(partition) + 1) << kSpilledPartitionShift) | pos);
+}
+
+// See the comment on the function of the same name in hash_agg.cpp.
+void assertIgnorePrepareConflictsBehavior(OperationContext* opCtx) {
+    tassert(6702000,
+            "The operation must be ignoring conflicts and allowing writes or enforcing prepare "
+            "conflicts entirely",
+            opCtx->recoveryUnit()->getPrepareConflictBehavior() !=
+                PrepareConflictBehavior::kIgnoreConflicts);
+}
+}  // namespace
+
 HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              std::unique_ptr<PlanStage> inner,
                              value::SlotVector outerCond,
@@ -44,6 +65,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              value::SlotVector innerCond,
                              value::SlotVector innerProjects,
                              boost::optional<value::SlotId> collatorSlot,
+                             bool allowDiskUse,
                              PlanNodeId planNodeId)
     : PlanStage("hj"_sd, planNodeId),
       _outerCond(std::move(outerCond)),
@@ -51,6 +73,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
       _innerCond(std::move(innerCond)),
       _innerProjects(std::move(innerProjects)),
       _collatorSlot(collatorSlot),
+      _allowDiskUse(allowDiskUse),
       _probeKey(0) {
     if (_outerCond.size() != _innerCond.size()) {
         uasserted(4822823, "left and right size do not match");
@@ -68,9 +91,41 @@ std::unique_ptr<PlanStage> HashJoinStage::clone() const {
                                            _innerCond,
                                            _innerProjects,
                                            _collatorSlot,
+                                           _allowDiskUse,
                                            _commonStats.nodeId);
 }
 
+void HashJoinStage::doSaveState(bool relinquishCursor) {
+    if (relinquishCursor) {
+        if (_probeCursor) {
+            _probeCursor->save();
+        }
+    }
+    if (_probeCursor) {
+        _probeCursor->setSaveStorageCursorOnDetachFromOperationContext(!relinquishCursor);
+    }
+}
+
+void HashJoinStage::doRestoreState(bool relinquishCursor) {
+    invariant(_opCtx);
+    if (_probeCursor && relinquishCursor) {
+        auto couldRestore = _probeCursor->restore();
+        uassert(6702001, "HashJoinStage could not restore cursor", couldRestore);
+    }
+}
+
+void HashJoinStage::doDetachFromOperationContext() {
+    if (_probeCursor) {
+        _probeCursor->detachFromOperationContext();
+    }
+}
+
+void HashJoinStage::doAttachToOperationContext(OperationContext* opCtx) {
+    if (_probeCursor) {
+        _probeCursor->reattachToOperationContext(opCtx);
+    }
+}
+
 void HashJoinStage::prepare(CompileCtx& ctx) {
     _children[0]->prepare(ctx);
     _children[1]->prepare(ctx);
@@ -114,6 +169,30 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
 
     _probeKey.resize(_inInnerKeyAccessors.size());
 
+    // Inner values can come either from the inner child or from the spilled inner rows.
+    _spilledProbeKey.resize(_innerCond.size());
+    for (size_t idx = 0; idx < _innerCond.size(); ++idx) {
+        _outInnerSpilledAccessors.emplace_back(
+            std::make_unique<value::MaterializedSingleRowAccessor>(_spilledProbeKey, idx));
+        _outInnerSwitchAccessors.emplace_back(
+            std::make_unique<value::SwitchAccessor>(std::vector<value::SlotAccessor*>{
+                _inInnerKeyAccessors[idx], _outInnerSpilledAccessors.back().get()}));
+        _outInnerAccessors[_innerCond[idx]] = _outInnerSwitchAccessors.back().get();
+    }
+
+    _spilledProbeProject.resize(_innerProjects.size());
+    for (size_t idx = 0; idx < _innerProjects.size(); ++idx) {
+        _inInnerProjectAccessors.emplace_back(_children[1]->getAccessor(ctx, _innerProjects[idx]));
+        _outInnerSpilledAccessors.emplace_back(
+            std::make_unique<value::MaterializedSingleRowAccessor>(_spilledProbeProject, idx));
+        _outInnerSwitchAccessors.emplace_back(
+            std::make_unique<value::SwitchAccessor>(std::vector<value::SlotAccessor*>{
+                _inInnerProjectAccessors.back(), _outInnerSpilledAccessors.back().get()}));
+        // A slot which is both an inner condition and an inner projection keeps the accessor of
+        // the condition.
+        _outInnerAccessors.emplace(_innerProjects[idx], _outInnerSwitchAccessors.back().get());
+    }
+
     _compiled = true;
 }
 
@@ -123,15 +202,252 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
             return it->second;
         }
 
+        if (auto it = _outInnerAccessors.find(slot); it != _outInnerAccessors.end()) {
+            return it->second;
+        }
+
         return _children[1]->getAccessor(ctx, slot);
     }
 
     return ctx.getAccessor(slot);
 }
 
+size_t HashJoinStage::getPartition(const value::MaterializedRow& key) const {
+    // Mix the hash and take its high bits, so that the partitioning is independent of the bucket
+    // placement in '_ht' which uses the low bits of the same hash.
+    const uint64_t hash = _ht->hash_function()(key);
+    return ((hash * 0x9E3779B97F4A7C15ull) >> 32) % _numPartitions;
+}
+
+void HashJoinStage::spillRowToDisk(TemporaryRecordStore* rs,
+                                   std::vector<long long>& partitionCounts,
+                                   size_t partition,
+                                   const value::MaterializedRow& key,
+                                   const value::MaterializedRow& project) {
+    BufBuilder buf;
+    key.serializeForSorter(buf);
+    project.serializeForSorter(buf);
+
+    auto rid = makeSpilledRecordId(partition, ++partitionCounts[partition]);
+    auto status = rs->rs()->insertRecord(_opCtx, rid, buf.buf(), buf.len(), Timestamp{});
+    tassert(6702002,
+            str::stream() << "Failed to write to disk because " << status.getStatus().reason(),
+            status.isOK());
+
+    _specificStats.spilledBytes += buf.len();
+}
+
+void HashJoinStage::spillPartition(size_t partition) {
+    assertIgnorePrepareConflictsBehavior(_opCtx);
+
+    WriteUnitOfWork wuow(_opCtx);
+    for (auto it = _ht->begin(); it != _ht->end();) {
+        if (getPartition(it->first) == partition) {
+            spillRowToDisk(
+                _buildRecordStore.get(), _buildPartitionCounts, partition, it->first, it->second);
+            _specificStats.spilledBuildRecords++;
+            it = _ht->erase(it);
+        } else {
+            ++it;
+        }
+    }
+    wuow.commit();
+
+    _memoryUsage -= _partitionMemoryUsage[partition];
+    _partitionMemoryUsage[partition] = 0;
+    _partitionSpilled[partition] = true;
+    _specificStats.spilledPartitions++;
+}
+
+void HashJoinStage::spillProbeRow(size_t partition) {
+    value::MaterializedRow project{_inInnerProjectAccessors.size()};
+    size_t idx = 0;
+    for (auto& p : _inInnerProjectAccessors) {
+        auto [tag, val] = p->getViewOfValue();
+        project.reset(idx++, false, tag, val);
+    }
+
+    assertIgnorePrepareConflictsBehavior(_opCtx);
+
+    WriteUnitOfWork wuow(_opCtx);
+    spillRowToDisk(_probeRecordStore.get(), _probePartitionCounts, partition, _probeKey, project);
+    wuow.commit();
+
+    _specificStats.spilledProbeRecords++;
+}
+
+void HashJoinStage::checkMemoryUsageAndSpillIfNecessary(const value::MaterializedRow& key,
+                                                        long long rowSize) {
+    _memoryUsage += rowSize;
+    if (!_partitionMemoryUsage.empty()) {
+        _partitionMemoryUsage[getPartition(key)] += rowSize;
+    }
+
+    // The process-wide query memory budget may be used up before the hash table reaches its own
+    // limit. In that case the memory already granted to the hash table becomes the limit, unless
+    // we are not allowed to spill, in which case we wait for other queries to release memory.
+    auto memoryLimit = _approxMemoryUseInBytesBeforeSpill;
+    if (_memoryUsage < memoryLimit) {
+        if (_memoryGrant.tryResize(_memoryUsage)) {
+            return;
+        }
+        if (!_allowDiskUse) {
+            _memoryGrant.resizeOrWait(_opCtx, _memoryUsage);
+            return;
+        }
+        memoryLimit = _memoryGrant.bytes();
+    }
+
+    uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+            "Exceeded memory limit for hash join, but didn't allow external spilling."
+            " Pass allowDiskUse:true to opt in.",
+            _allowDiskUse);
+
+    if (!_buildRecordStore) {
+        tassert(6702003,
+                "HashJoinStage attempted to write to disk in an environment which is not prepared "
+                "to do so",
+                _opCtx->getServiceContext());
+        tassert(6702004,
+                "No storage engine so HashJoinStage cannot spill to disk",
+                _opCtx->getServiceContext()->getStorageEngine());
+        assertIgnorePrepareConflictsBehavior(_opCtx);
+
+        auto storageEngine = _opCtx->getServiceContext()->getStorageEngine();
+        _buildRecordStore = storageEngine->makeTemporaryRecordStore(_opCtx, KeyFormat::Long);
+        _probeRecordStore = storageEngine->makeTemporaryRecordStore(_opCtx, KeyFormat::Long);
+
+        _partitionMemoryUsage.assign(_numPartitions, 0);
+        _partitionSpilled.assign(_numPartitions, false);
+        _buildPartitionCounts.assign(_numPartitions, 0);
+        _probePartitionCounts.assign(_numPartitions, 0);
+        for (auto& [htKey, htProject] : *_ht) {
+            _partitionMemoryUsage[getPartition(htKey)] +=
+                htKey.memUsageForSorter() + htProject.memUsageForSorter();
+        }
+
+        _specificStats.usedDisk = true;
+    }
+
+    // Evict the largest partitions still held in memory until we fit into the budget again.
+    while (_memoryUsage >= memoryLimit) {
+        boost::optional<size_t> victim;
+        for (size_t partition = 0; partition < _numPartitions; ++partition) {
+            if (!_partitionSpilled[partition] && _partitionMemoryUsage[partition] > 0 &&
+                (!victim || _partitionMemoryUsage[partition] > _partitionMemoryUsage[*victim])) {
+                victim = partition;
+            }
+        }
+        if (!victim) {
+            break;
+        }
+        spillPartition(*victim);
+    }
+    _memoryGrant.tryResize(_memoryUsage);
+}
+
+void HashJoinStage::loadBuildPartitionChunk() {
+    const auto partition = _currentPartition;
+
+    _ht->clear();
+    _memoryUsage = 0;
+    _memoryGrant.tryResize(_memoryUsage);
+    _htIt = _ht->end();
+    _htItEnd = _ht->end();
+
+    auto cursor = _buildRecordStore->rs()->getCursor(_opCtx);
+    auto record = cursor->seekExact(makeSpilledRecordId(partition, _buildPartitionPos + 1));
+
+    // Always load at least one row so that we make progress even if a single row does not fit into
+    // the memory budget.
+    while (true) {
+        tassert(6702005, "HashJoinStage could not read back a spilled outer row", record);
+        auto reader = BufReader(record->data.data(), record->data.size());
+        auto key = value::MaterializedRow::deserializeForSorter(reader, {});
+        auto project = value::MaterializedRow::deserializeForSorter(reader, {});
+        _memoryUsage += key.memUsageForSorter() + project.memUsageForSorter();
+        _ht->emplace(std::move(key), std::move(project));
+
+        if (++_buildPartitionPos == _buildPartitionCounts[partition] ||
+            _memoryUsage >= _approxMemoryUseInBytesBeforeSpill ||
+            !_memoryGrant.tryResize(_memoryUsage)) {
+            break;
+        }
+        record = cursor->next();
+    }
+
+    _htIt = _ht->end();
+    _htItEnd = _ht->end();
+}
+
+bool HashJoinStage::nextSpilledProbeRow() {
+    while (_currentPartition < _numPartitions) {
+        const auto partition = _currentPartition;
+        if (_probePartitionPos < _probePartitionCounts[partition]) {
+            auto record = _probePartitionPos == 0
+                ? _probeCursor->seekExact(makeSpilledRecordId(partition, 1))
+                : _probeCursor->next();
+            tassert(6702006, "HashJoinStage could not read back a spilled inner row", record);
+            ++_probePartitionPos;
+
+            auto reader = BufReader(record->data.data(), record->data.size());
+            _spilledProbeKey = value::MaterializedRow::deserializeForSorter(reader, {});
+            _spilledProbeProject = value::MaterializedRow::deserializeForSorter(reader, {});
+            return true;
+        }
+
+        if (_probePartitionCounts[partition] > 0 &&
+            _buildPartitionPos < _buildPartitionCounts[partition]) {
+            // Either this is the first chunk of the build partition, or the build partition did not
+            // fit into memory at once and the inner rows have to be scanned again.
+            if (_buildPartitionPos > 0) {
+                _specificStats.spilledProbePasses++;
+            }
+            loadBuildPartitionChunk();
+            _probePartitionPos = 0;
+            continue;
+        }
+
+        // Partitions which were never spilled have no rows on disk and are skipped here.
+        if (++_currentPartition < _numPartitions) {
+            _buildPartitionPos = 0;
+            _probePartitionPos = _probePartitionCounts[_currentPartition];
+        }
+    }
+
+    _ht->clear();
+    _htIt = _ht->end();
+    _htItEnd = _ht->end();
+    _probeCursor.reset();
+    return false;
+}
+
+void HashJoinStage::resetSpillState() {
+    _probeCursor.reset();
+    _buildRecordStore.reset();
+    _probeRecordStore.reset();
+
+    _memoryUsage = 0;
+    _partitionMemoryUsage.clear();
+    _partitionSpilled.clear();
+    _buildPartitionCounts.clear();
+    _probePartitionCounts.clear();
+
+    _probingSpilledPartitions = false;
+    _currentPartition = 0;
+    _buildPartitionPos = 0;
+    _probePartitionPos = 0;
+    for (auto& accessor : _outInnerSwitchAccessors) {
+        accessor->setIndex(0);
+    }
+}
+
 void HashJoinStage::open(bool reOpen) {
     auto optTimer(getOptTimer(_opCtx));
 
+    resetSpillState();
+    _memoryGrant = QueryMemoryBroker::get(_opCtx).makeGrant(QueryMemoryBroker::Consumer::kHashJoin);
+
     if (_collatorAccessor) {
         auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
         uassert(5402504, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
@@ -164,7 +480,22 @@ void HashJoinStage::open(bool reOpen) {
             project.reset(idx++, true, tag, val);
         }
 
-        _ht->emplace(std::move(key), std::move(project));
+        if (_buildRecordStore) {
+            // Rows of partitions which have already been evicted go straight to disk.
+            auto partition = getPartition(key);
+            if (_partitionSpilled[partition]) {
+                WriteUnitOfWork wuow(_opCtx);
+                spillRowToDisk(
+                    _buildRecordStore.get(), _buildPartitionCounts, partition, key, project);
+                wuow.commit();
+                _specificStats.spilledBuildRecords++;
+                continue;
+            }
+        }
+
+        const long long rowSize = key.memUsageForSorter() + project.memUsageForSorter();
+        auto it = _ht->emplace(std::move(key), std::move(project));
+        checkMemoryUsageAndSpillIfNecessary(it->first, rowSize);
     }
 
     _children[0]->close();
@@ -184,10 +515,33 @@ PlanState HashJoinStage::getNext() {
 
     if (_htIt == _htItEnd) {
         while (_htIt == _htItEnd) {
+            if (_probingSpilledPartitions) {
+                if (!nextSpilledProbeRow()) {
+                    return trackPlanState(PlanState::IS_EOF);
+                }
+
+                auto [low, hi] = _ht->equal_range(_spilledProbeKey);
+                _htIt = low;
+                _htItEnd = hi;
+                continue;
+            }
+
             auto state = _children[1]->getNext();
             if (state == PlanState::IS_EOF) {
-                // LEFT and OUTER joins should enumerate "non-returned" rows here.
-                return trackPlanState(state);
+                if (!_buildRecordStore) {
+                    // LEFT and OUTER joins should enumerate "non-returned" rows here.
+                    return trackPlanState(state);
+                }
+
+                // The inner side is exhausted, now join the spilled partitions pairwise. Start at
+                // the end of the first inner partition so that its build rows are loaded first.
+                _probingSpilledPartitions = true;
+                _probeCursor = _probeRecordStore->rs()->getCursor(_opCtx);
+                _probePartitionPos = _probePartitionCounts[_currentPartition];
+                for (auto& accessor : _outInnerSwitchAccessors) {
+                    accessor->setIndex(1);
+                }
+                continue;
             }
 
             // Copy keys in order to do the lookup.
@@ -197,6 +551,14 @@ PlanState HashJoinStage::getNext() {
                 _probeKey.reset(idx++, false, tag, val);
             }
 
+            if (_buildRecordStore) {
+                auto partition = getPartition(_probeKey);
+                if (_partitionSpilled[partition]) {
+                    spillProbeRow(partition);
+                    continue;
+                }
+            }
+
             auto [low, hi] = _ht->equal_range(_probeKey);
             _htIt = low;
             _htItEnd = hi;
@@ -214,17 +576,33 @@ void HashJoinStage::close() {
     trackClose();
     _children[1]->close();
     _ht = boost::none;
+    resetSpillState();
+    _memoryGrant.release();
 }
 
 std::unique_ptr<PlanStageStats> HashJoinStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashJoinStats>(_specificStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        // Spilling stats.
+        bob.appendBool("usedDisk", _specificStats.usedDisk);
+        bob.appendNumber("spilledPartitions", _specificStats.spilledPartitions);
+        bob.appendNumber("spilledBuildRecords", _specificStats.spilledBuildRecords);
+        bob.appendNumber("spilledProbeRecords", _specificStats.spilledProbeRecords);
+        bob.appendNumber("spilledBytes", _specificStats.spilledBytes);
+        bob.appendNumber("spilledProbePasses", _specificStats.spilledProbePasses);
+        ret->debugInfo = bob.obj();
+    }
+
     ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
     ret->children.emplace_back(_children[1]->getStats(includeDebugInfo));
     return ret;
 }
 
 const SpecificStats* HashJoinStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
@@ -33,6 +33,9 @@
 
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_memory_broker.h"
+#include "mongo/db/storage/temporary_record_store.h"
 
 namespace mongo::sbe {
 /**
@@ -51,6 +54,14 @@ namespace mongo::sbe {
  * for string equality. For example, this can be used to perform a case-insensitive join on string
  * values.
  *
+ * When the hash table grows beyond 'internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill' and
+ * 'allowDiskUse' is true, the stage turns into a hybrid hash join: rows are split into hash
+ * partitions, and whole partitions are evicted from the hash table into a temporary record store
+ * until the table fits into the memory budget again. Inner rows which hash to an evicted partition
+ * are spilled as well and joined against their build partition once the inner side is exhausted.
+ * Only the 'innerCond' and 'innerProjects' slots are carried over for the spilled inner rows, so
+ * these are the only inner slots that stages higher in the tree may depend on.
+ *
  * Debug string representation:
  *
  *   hj collatorSlot?
@@ -66,6 +77,7 @@ public:
                   value::SlotVector innerCond,
                   value::SlotVector innerProjects,
                   boost::optional<value::SlotId> collatorSlot,
+                  bool allowDiskUse,
                   PlanNodeId planNodeId);
 
     std::unique_ptr<PlanStage> clone() const final;
@@ -81,6 +93,12 @@ public:
     std::vector<DebugPrinter::Block> debugPrint() const final;
     size_t estimateCompileTimeSize() const final;
 
+protected:
+    void doSaveState(bool relinquishCursor) override;
+    void doRestoreState(bool relinquishCursor) override;
+    void doDetachFromOperationContext() override;
+    void doAttachToOperationContext(OperationContext* opCtx) override;
+
 private:
     using TableType = std::unordered_multimap<value::MaterializedRow,  // NOLINT
                                               value::MaterializedRow,
@@ -90,11 +108,45 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashProjectAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    size_t getPartition(const value::MaterializedRow& key) const;
+
+    /**
+     * Accounts for a row which has just been inserted into the hash table and, if the memory budget
+     * is exceeded, evicts whole partitions into '_buildRecordStore' until it is met again.
+     */
+    void checkMemoryUsageAndSpillIfNecessary(const value::MaterializedRow& key, long long rowSize);
+    void spillPartition(size_t partition);
+
+    /**
+     * Appends the serialized 'key' and 'project' rows under the next RecordId of 'partition' in
+     * 'rs'. Must be called inside of a WriteUnitOfWork.
+     */
+    void spillRowToDisk(TemporaryRecordStore* rs,
+                        std::vector<long long>& partitionCounts,
+                        size_t partition,
+                        const value::MaterializedRow& key,
+                        const value::MaterializedRow& project);
+    void spillProbeRow(size_t partition);
+
+    /**
+     * Refills the hash table with the next chunk of rows from the current spilled build partition,
+     * stopping once the memory budget is reached.
+     */
+    void loadBuildPartitionChunk();
+
+    /**
+     * Advances to the next spilled inner row, moving on to the next build chunk or partition as
+     * needed. Returns false when all spilled partitions have been joined.
+     */
+    bool nextSpilledProbeRow();
+    void resetSpillState();
+
     const value::SlotVector _outerCond;
     const value::SlotVector _outerProjects;
     const value::SlotVector _innerCond;
     const value::SlotVector _innerProjects;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
 
     // All defined values from the outer side (i.e. they come from the hash table).
     value::SlotAccessorMap _outOuterAccessors;
@@ -114,6 +166,16 @@ private:
     // Accessors of input condition values (keys) that are being inserted into the hash table.
     std::vector<value::SlotAccessor*> _inInnerKeyAccessors;
 
+    // Accessors of inner projection values.
+    std::vector<value::SlotAccessor*> _inInnerProjectAccessors;
+
+    // Accessors of the inner condition and projection slots. A SwitchAccessor is used so we can
+    // produce the inner values either from the inner child or from a row read back from
+    // '_probeRecordStore'.
+    value::SlotAccessorMap _outInnerAccessors;
+    std::vector<std::unique_ptr<value::SwitchAccessor>> _outInnerSwitchAccessors;
+    std::vector<std::unique_ptr<value::MaterializedSingleRowAccessor>> _outInnerSpilledAccessors;
+
     // Accessor for collator. Only set if collatorSlot provided during construction.
     value::SlotAccessor* _collatorAccessor = nullptr;
 
@@ -127,5 +189,35 @@ private:
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    // Memory tracking and spilling to disk.
+    const long long _approxMemoryUseInBytesBeforeSpill =
+        internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load();
+    const size_t _numPartitions = internalQuerySBEHashJoinNumPartitions.load();
+    long long _memoryUsage{0};
+    // The share of the process-wide query memory budget held by '_ht'.
+    QueryMemoryBroker::Grant _memoryGrant;
+
+    // Per partition state, only populated once the stage starts spilling.
+    std::vector<long long> _partitionMemoryUsage;
+    std::vector<bool> _partitionSpilled;
+    std::vector<long long> _buildPartitionCounts;
+    std::vector<long long> _probePartitionCounts;
+
+    std::unique_ptr<TemporaryRecordStore> _buildRecordStore;
+    std::unique_ptr<TemporaryRecordStore> _probeRecordStore;
+
+    // Position within the spilled partitions once the inner child has been exhausted.
+    bool _probingSpilledPartitions{false};
+    size_t _currentPartition{0};
+    long long _buildPartitionPos{0};
+    long long _probePartitionPos{0};
+    std::unique_ptr<SeekableRecordCursor> _probeCursor;
+
+    // The inner row currently read back from '_probeRecordStore'.
+    value::MaterializedRow _spilledProbeKey{0};
+    value::MaterializedRow _spilledProbeProject{0};
+
+    HashJoinStats _specificStats;
 };
 }  // namespace mongo::sbe
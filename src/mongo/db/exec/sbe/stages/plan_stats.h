@@ -282,6 +282,34 @@ struct HashAggStats : public SpecificStats {
     long long lastSpilledRecordSize{0};
 };
 
+struct HashJoinStats : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashJoinStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    void acceptVisitor(PlanStatsConstVisitor* visitor) const final {
+        visitor->visit(this);
+    }
+
+    void acceptVisitor(PlanStatsMutableVisitor* visitor) final {
+        visitor->visit(this);
+    }
+
+    bool usedDisk{false};
+    // Number of hash partitions whose rows were moved out of memory.
+    long long spilledPartitions{0};
+    long long spilledBuildRecords{0};
+    long long spilledProbeRecords{0};
+    long long spilledBytes{0};
+    // Number of times a spilled probe partition had to be rescanned because its build partition
+    // did not fit in memory at once.
+    long long spilledProbePasses{0};
+};
+
 /**
  * Visitor for calculating the number of storage reads during plan execution.
  */
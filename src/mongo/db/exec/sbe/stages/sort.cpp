@@ -148,6 +148,26 @@ void SortStage::makeSorter() {
 
     _sorter.reset(Sorter<value::MaterializedRow, value::MaterializedRow>::make(opts, comp, {}));
     _mergeIt.reset();
+
+    // A sort with a limit of one only ever holds a single row, so it does not need a grant.
+    if (opts.limit != 1) {
+        _memoryGrant = QueryMemoryBroker::get(_opCtx).makeGrant(QueryMemoryBroker::Consumer::kSort);
+    }
+}
+
+void SortStage::reserveSorterMemory() {
+    if (_memoryGrant.tryResize(_sorter->memUsed())) {
+        return;
+    }
+
+    // Other queries are holding the rest of the process-wide memory budget. Spill the rows sorted
+    // so far to free our share of it, or wait for memory if we are not allowed to use the disk.
+    if (_allowDiskUse) {
+        _sorter->spill();
+        _memoryGrant.tryResize(_sorter->memUsed());
+    } else {
+        _memoryGrant.resizeOrWait(_opCtx, _sorter->memUsed());
+    }
 }
 
 void SortStage::doDetachFromTrialRunTracker() {
@@ -195,6 +215,7 @@ void SortStage::open(bool reOpen) {
         }
 
         _sorter->emplace(std::move(keys), std::move(vals));
+        reserveSorterMemory();
 
         if (_tracker && _tracker->trackProgress<TrialRunTracker::kNumResults>(1)) {
             // If we either hit the maximum number of document to return during the trial run, or
@@ -214,6 +235,7 @@ void SortStage::open(bool reOpen) {
     _specificStats.totalDataSizeBytes += _sorter->totalDataSizeSorted();
     _mergeIt.reset(_sorter->done());
     _specificStats.spills += _sorter->numSpills();
+    _specificStats.spilledDataStorageSize += _sorter->spillStats().bytesWritten;
     _specificStats.keysSorted += _sorter->numSorted();
     auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
     metricsCollector.incrementKeysSorted(_sorter->numSorted());
@@ -241,6 +263,7 @@ void SortStage::close() {
     trackClose();
     _mergeIt.reset();
     _sorter.reset();
+    _memoryGrant.release();
 }
 
 std::unique_ptr<PlanStageStats> SortStage::getStats(bool includeDebugInfo) const {
@@ -254,6 +277,8 @@ std::unique_ptr<PlanStageStats> SortStage::getStats(bool includeDebugInfo) const
                          static_cast<long long>(_specificStats.totalDataSizeBytes));
         bob.appendBool("usedDisk", _specificStats.spills > 0);
         bob.appendNumber("spills", static_cast<long long>(_specificStats.spills));
+        bob.appendNumber("spilledDataStorageSize",
+                         static_cast<long long>(_specificStats.spilledDataStorageSize));
 
         BSONObjBuilder childrenBob(bob.subobjStart("orderBySlots"));
         for (size_t idx = 0; idx < _obs.size(); ++idx) {
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/query_memory_broker.h"
 
 namespace mongo {
 template <typename Key, typename Value>
@@ -94,6 +95,7 @@ protected:
 
 private:
     void makeSorter();
+    void reserveSorterMemory();
 
     using SorterIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
     using SorterData = std::pair<value::MaterializedRow, value::MaterializedRow>;
@@ -114,6 +116,9 @@ private:
     SorterData* _mergeDataIt{&_mergeData};
     std::unique_ptr<Sorter<value::MaterializedRow, value::MaterializedRow>> _sorter;
 
+    // The share of the process-wide query memory budget held by the sorter.
+    QueryMemoryBroker::Grant _memoryGrant;
+
     // If provided, used during a trial run to accumulate certain execution stats. Once the trial
     // run is complete, this pointer is reset to nullptr.
     TrialRunTracker* _tracker{nullptr};
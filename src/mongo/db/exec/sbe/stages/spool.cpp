@@ -82,6 +82,8 @@ void SpoolEagerProducerStage::open(bool reOpen) {
     if (reOpen) {
         _buffer->clear();
     }
+    _bufferMemUsage = 0;
+    _memoryGrant = QueryMemoryBroker::get(_opCtx).makeGrant(QueryMemoryBroker::Consumer::kSpool);
 
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow vals{_inAccessors.size()};
@@ -92,7 +94,9 @@ void SpoolEagerProducerStage::open(bool reOpen) {
             vals.reset(idx++, true, tag, val);
         }
 
+        _bufferMemUsage += vals.memUsageForSorter();
         _buffer->emplace_back(std::move(vals));
+        _memoryGrant.resizeOrWait(_opCtx, _bufferMemUsage);
     }
 
     _children[0]->close();
@@ -120,6 +124,8 @@ void SpoolEagerProducerStage::close() {
     trackClose();
 
     _buffer->clear();
+    _bufferMemUsage = 0;
+    _memoryGrant.release();
 }
 
 std::unique_ptr<PlanStageStats> SpoolEagerProducerStage::getStats(bool includeDebugInfo) const {
@@ -32,6 +32,7 @@
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/size_estimator.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/query_memory_broker.h"
 
 namespace mongo::sbe {
 /**
@@ -47,6 +48,9 @@ namespace mongo::sbe {
  * This stage will be responsible for populating the buffer, while consumers will read from the
  * buffer once its populated, each using its own read pointer.
  *
+ * The buffer cannot be spilled to disk, so when the process-wide query memory budget is used up
+ * this stage waits for other queries to release memory before buffering more rows.
+ *
  * Debug string representation:
  *
  *   espool spoolId [<vals>] childStage
@@ -76,6 +80,11 @@ private:
     size_t _bufferIt{0};
     const SpoolId _spoolId;
 
+    // The approximate size of the rows in '_buffer', and the share of the process-wide query memory
+    // budget held for them.
+    long long _bufferMemUsage{0};
+    QueryMemoryBroker::Grant _memoryGrant;
+
     const value::SlotVector _vals;
     std::vector<value::SlotAccessor*> _inAccessors;
     value::SlotMap<value::MaterializedRowAccessor<SpoolBuffer>> _outAccessors;
@@ -36,6 +36,7 @@
 #include "mongo/db/exec/js_function.h"
 #include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/exec/sbe/values/sort_spec.h"
+#include "mongo/db/exec/sbe/values/value_block.h"
 #include "mongo/db/exec/sbe/values/value_builder.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/util/bufreader.h"
@@ -704,6 +705,15 @@ int getApproximateSize(TypeTags tag, Value val) {
         case TypeTags::sortSpec:
             result += getSortSpecView(val)->getApproximateSize();
             break;
+        case TypeTags::valueBlock: {
+            auto block = getValueBlockView(val);
+            result += sizeof(*block);
+            for (size_t idx = 0; idx < block->size(); ++idx) {
+                auto [elemTag, elemVal] = block->getAt(idx);
+                result += getApproximateSize(elemTag, elemVal);
+            }
+            break;
+        }
         default:
             MONGO_UNREACHABLE;
     }
@@ -35,6 +35,7 @@
 #include "mongo/db/exec/js_function.h"
 #include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/exec/sbe/values/sort_spec.h"
+#include "mongo/db/exec/sbe/values/value_block.h"
 #include "mongo/db/exec/sbe/values/value_builder.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/datetime/date_time_support.h"
@@ -243,6 +244,11 @@ std::pair<TypeTags, Value> makeCopySortSpec(const SortSpec& ss) {
     return {TypeTags::sortSpec, ssCopy};
 }
 
+std::pair<TypeTags, Value> makeCopyValueBlock(const ValueBlock& block) {
+    auto blockCopy = bitcastFrom<ValueBlock*>(new ValueBlock(block));
+    return {TypeTags::valueBlock, blockCopy};
+}
+
 std::pair<TypeTags, Value> makeCopyCollator(const CollatorInterface& collator) {
     auto collatorCopy = bitcastFrom<CollatorInterface*>(collator.clone().release());
     return {TypeTags::collator, collatorCopy};
@@ -316,6 +322,9 @@ void releaseValue(TypeTags tag, Value val) noexcept {
         case TypeTags::sortSpec:
             delete getSortSpecView(val);
             break;
+        case TypeTags::valueBlock:
+            delete getValueBlockView(val);
+            break;
         case TypeTags::collator:
             delete getCollatorView(val);
             break;
@@ -441,6 +450,9 @@ void writeTagToStream(T& stream, const TypeTags tag) {
         case TypeTags::sortSpec:
             stream << "sortSpec";
             break;
+        case TypeTags::valueBlock:
+            stream << "valueBlock";
+            break;
         default:
             stream << "unknown tag";
             break;
@@ -495,6 +507,23 @@ void writeArrayToStream(T& stream, TypeTags tag, Value val, size_t depth = 1) {
     stream << ']';
 }
 
+template <typename T>
+void writeValueBlockToStream(T& stream, const ValueBlock& block, size_t depth = 1) {
+    stream << "Block[";
+    for (size_t idx = 0; idx < block.size(); ++idx) {
+        if (idx == kArrayObjectOrNestingMaxDepth) {
+            stream << "...";
+            break;
+        }
+        if (idx > 0) {
+            stream << ", ";
+        }
+        auto [tag, val] = block.getAt(idx);
+        writeValueToStream(stream, tag, val, depth + 1);
+    }
+    stream << ']';
+}
+
 template <typename T>
 void writeObjectToStream(T& stream, TypeTags tag, Value val, size_t depth = 1) {
     stream << '{';
@@ -723,6 +752,9 @@ void writeValueToStream(T& stream, TypeTags tag, Value val, size_t depth = 1) {
             writeCollatorToStream(stream, getSortSpecView(val)->getCollator());
             stream << ')';
             break;
+        case TypeTags::valueBlock:
+            writeValueBlockToStream(stream, *getValueBlockView(val), depth);
+            break;
         default:
             MONGO_UNREACHABLE;
     }
@@ -76,6 +76,7 @@ using IndexKeysInclusionSet = std::bitset<Ordering::kMaxCompoundIndexKeys>;
 
 namespace value {
 class SortSpec;
+class ValueBlock;
 
 static constexpr size_t kStringMaxDisplayLength = 160;
 static constexpr size_t kBinDataMaxDisplayLength = 80;
@@ -154,6 +155,9 @@ enum class TypeTags : uint8_t {
 
     // Pointer to a SortSpec object.
     sortSpec,
+
+    // Pointer to a ValueBlock holding a batch of values.
+    valueBlock,
 };
 
 inline constexpr bool isNumber(TypeTags tag) noexcept {
@@ -1241,6 +1245,10 @@ inline SortSpec* getSortSpecView(Value val) noexcept {
     return reinterpret_cast<SortSpec*>(val);
 }
 
+inline ValueBlock* getValueBlockView(Value val) noexcept {
+    return reinterpret_cast<ValueBlock*>(val);
+}
+
 /**
  * Pattern and flags of Regex are stored in BSON as two C strings written one after another.
  *
@@ -1359,6 +1367,8 @@ std::pair<TypeTags, Value> makeCopyFtsMatcher(const fts::FTSMatcher&);
 
 std::pair<TypeTags, Value> makeCopySortSpec(const SortSpec&);
 
+std::pair<TypeTags, Value> makeCopyValueBlock(const ValueBlock&);
+
 std::pair<TypeTags, Value> makeCopyCollator(const CollatorInterface& collator);
 
 /**
@@ -1436,6 +1446,8 @@ inline std::pair<TypeTags, Value> copyValue(TypeTags tag, Value val) {
             return makeCopyFtsMatcher(*getFtsMatcherView(val));
         case TypeTags::sortSpec:
             return makeCopySortSpec(*getSortSpecView(val));
+        case TypeTags::valueBlock:
+            return makeCopyValueBlock(*getValueBlockView(val));
         case TypeTags::collator:
             return makeCopyCollator(*getCollatorView(val));
         default:
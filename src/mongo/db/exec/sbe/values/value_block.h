@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "mongo/db/exec/sbe/values/value.h"
+
+namespace mongo::sbe::value {
+/**
+ * A ValueBlock holds a batch of values which are processed together by the 'valueBlock*' builtins,
+ * for example all the values of one field across the measurements of a time-series bucket. This
+ * lets a single getNext() call move a whole batch through a plan instead of one row.
+ *
+ * Unlike Array, a block keeps Nothing values, so that the positions in blocks created from the same
+ * source line up with each other.
+ *
+ * The block also tracks whether all of its values have the same type tag. The builtins use this to
+ * run tight loops directly over the values of homogeneous numeric blocks.
+ */
+class ValueBlock {
+public:
+    ValueBlock() = default;
+
+    /**
+     * Creates a homogeneous block of 'values' which all have the type 'tag'. Used by the builtins to
+     * produce the output of their typed loops, so 'tag' must be a shallow type.
+     */
+    ValueBlock(TypeTags tag, std::vector<Value> values)
+        : _typeTags(values.size(), tag), _values(std::move(values)) {
+        invariant(isShallowType(tag));
+    }
+
+    ValueBlock(const ValueBlock& other) : _homogeneous(other._homogeneous) {
+        reserve(other.size());
+        for (size_t idx = 0; idx < other.size(); ++idx) {
+            const auto [tag, val] = copyValue(other._typeTags[idx], other._values[idx]);
+            _typeTags.push_back(tag);
+            _values.push_back(val);
+        }
+    }
+    ValueBlock(ValueBlock&&) = default;
+    ValueBlock& operator=(const ValueBlock&) = delete;
+    ~ValueBlock() {
+        for (size_t idx = 0; idx < _typeTags.size(); ++idx) {
+            releaseValue(_typeTags[idx], _values[idx]);
+        }
+    }
+
+    /**
+     * Appends a value to the block, taking ownership of it.
+     */
+    void push_back(TypeTags tag, Value val) {
+        ValueGuard guard{tag, val};
+        // Grow both vectors before appending to either of them, so that they still have the same
+        // size if the allocation throws.
+        if (_typeTags.size() == _typeTags.capacity() || _values.size() == _values.capacity()) {
+            reserve(2 * _values.size() + 1);
+        }
+        if (!_typeTags.empty() && _typeTags.back() != tag) {
+            _homogeneous = false;
+        }
+        _typeTags.push_back(tag);
+        _values.push_back(val);
+        guard.reset();
+    }
+
+    size_t size() const noexcept {
+        return _values.size();
+    }
+
+    std::pair<TypeTags, Value> getAt(size_t idx) const {
+        if (idx >= _values.size()) {
+            return {TypeTags::Nothing, 0};
+        }
+
+        return {_typeTags[idx], _values[idx]};
+    }
+
+    const TypeTags* tags() const noexcept {
+        return _typeTags.data();
+    }
+
+    const Value* values() const noexcept {
+        return _values.data();
+    }
+
+    /**
+     * Returns the type tag shared by all the values in the block, or boost::none if the block is
+     * empty or holds values of different types.
+     */
+    boost::optional<TypeTags> getHomogeneousTag() const {
+        if (_typeTags.empty() || !_homogeneous) {
+            return boost::none;
+        }
+        return _typeTags.front();
+    }
+
+    void reserve(size_t s) {
+        _typeTags.reserve(s);
+        _values.reserve(s);
+    }
+
+private:
+    std::vector<TypeTags> _typeTags;
+    std::vector<Value> _values;
+    bool _homogeneous{true};
+};
+}  // namespace mongo::sbe::value
@@ -0,0 +1,237 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+#include "mongo/bson/util/bsoncolumn.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/exec/sbe/values/value_block.h"
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+
+using namespace value;
+
+namespace {
+
+std::tuple<bool, TypeTags, Value> makeBlockResult(std::unique_ptr<ValueBlock> block) {
+    return {true, TypeTags::valueBlock, bitcastFrom<ValueBlock*>(block.release())};
+}
+
+/**
+ * Folds the values of a block with one of the row-based aggregate steps, for the blocks which
+ * cannot use a typed loop.
+ */
+template <typename AggFn>
+std::tuple<bool, TypeTags, Value> accumulateBlock(const ValueBlock& block, AggFn aggFn) {
+    auto accTag = TypeTags::Nothing;
+    Value accVal = 0;
+    for (size_t i = 0; i < block.size(); ++i) {
+        ValueGuard accGuard{accTag, accVal};
+        auto [owned, tag, val] = aggFn(accTag, accVal, block.tags()[i], block.values()[i]);
+        accTag = tag;
+        accVal = val;
+    }
+    return {true, accTag, accVal};
+}
+
+template <typename T, typename Less>
+T integerMinMax(const Value* values, size_t count, Less less) {
+    T result = bitcastTo<T>(values[0]);
+    for (size_t i = 1; i < count; ++i) {
+        const T value = bitcastTo<T>(values[i]);
+        result = less(value, result) ? value : result;
+    }
+    return result;
+}
+
+/**
+ * Computes the minimum or maximum of a non-empty array of doubles the same way as a sequence of
+ * aggMin or aggMax steps would: NaN is smaller than any number, and among equal values the last
+ * one wins, which matters for the sign of zero.
+ */
+template <bool IsMin>
+Value doubleMinMax(const Value* values, size_t count) {
+    double result = IsMin ? std::numeric_limits<double>::infinity()
+                          : -std::numeric_limits<double>::infinity();
+    bool hasNaN = false;
+    bool hasNumber = false;
+    for (size_t i = 0; i < count; ++i) {
+        const double value = bitcastTo<double>(values[i]);
+        hasNaN |= value != value;
+        hasNumber |= value == value;
+        // Comparisons with NaN are false, so NaN never replaces the current result here.
+        if constexpr (IsMin) {
+            result = value <= result ? value : result;
+        } else {
+            result = value >= result ? value : result;
+        }
+    }
+
+    if (IsMin ? hasNaN : !hasNumber) {
+        // The result is NaN, and like the row-based aggregate we return the last one we have seen.
+        for (size_t i = count; i-- > 0;) {
+            if (std::isnan(bitcastTo<double>(values[i]))) {
+                return values[i];
+            }
+        }
+    }
+    return bitcastFrom<double>(result);
+}
+}  // namespace
+
+std::tuple<bool, TypeTags, Value> ByteCode::builtinValueBlockFromArray(ArityType arity) {
+    invariant(arity == 1);
+    auto [owned, tag, val] = getFromStack(0);
+
+    auto block = std::make_unique<ValueBlock>();
+    if (isArray(tag)) {
+        for (ArrayEnumerator enumerator(tag, val); !enumerator.atEnd(); enumerator.advance()) {
+            auto [elemTag, elemVal] = enumerator.getViewOfValue();
+            auto [copyTag, copyVal] = copyValue(elemTag, elemVal);
+            block->push_back(copyTag, copyVal);
+        }
+    } else if (isObject(tag)) {
+        // The data fields of a time-series bucket are stored as objects keyed by the position of
+        // the measurement.
+        for (ObjectEnumerator enumerator(tag, val); !enumerator.atEnd(); enumerator.advance()) {
+            auto [elemTag, elemVal] = enumerator.getViewOfValue();
+            auto [copyTag, copyVal] = copyValue(elemTag, elemVal);
+            block->push_back(copyTag, copyVal);
+        }
+    } else if (tag == TypeTags::bsonBinData &&
+               getBSONBinDataSubtype(tag, val) == BinDataType::Column) {
+        // Compressed time-series bucket columns are decoded in one go. Skipped positions are
+        // represented by EOO elements and become Nothing in the block.
+        BSONColumn column{BSONBinData{getBSONBinData(tag, val),
+                                      static_cast<int>(getBSONBinDataSize(tag, val)),
+                                      BinDataType::Column},
+                          ""_sd};
+        for (auto&& elem : column) {
+            if (elem.eoo()) {
+                block->push_back(TypeTags::Nothing, 0);
+            } else {
+                auto [elemTag, elemVal] = bson::convertFrom<false>(elem);
+                block->push_back(elemTag, elemVal);
+            }
+        }
+    } else {
+        return {false, TypeTags::Nothing, 0};
+    }
+
+    return makeBlockResult(std::move(block));
+}
+
+std::tuple<bool, TypeTags, Value> ByteCode::builtinValueBlockToArray(ArityType arity) {
+    invariant(arity == 1);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    if (blockTag != TypeTags::valueBlock) {
+        return {false, TypeTags::Nothing, 0};
+    }
+    const auto block = getValueBlockView(blockVal);
+
+    auto [arrTag, arrVal] = makeNewArray();
+    ValueGuard guard{arrTag, arrVal};
+    auto arr = getArrayView(arrVal);
+    arr->reserve(block->size());
+    for (size_t i = 0; i < block->size(); ++i) {
+        auto [tag, val] = block->getAt(i);
+        auto [copyTag, copyVal] = copyValue(tag, val);
+        // Array does not keep Nothing values.
+        arr->push_back(copyTag, copyVal);
+    }
+    guard.reset();
+    return {true, arrTag, arrVal};
+}
+
+std::tuple<bool, TypeTags, Value> ByteCode::builtinValueBlockMin(ArityType arity) {
+    invariant(arity == 1);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    if (blockTag != TypeTags::valueBlock) {
+        return {false, TypeTags::Nothing, 0};
+    }
+    const auto block = getValueBlockView(blockVal);
+
+    const Value* values = block->values();
+    switch (block->getHomogeneousTag().value_or(TypeTags::Nothing)) {
+        case TypeTags::NumberInt32:
+            return {false,
+                    TypeTags::NumberInt32,
+                    bitcastFrom<int32_t>(
+                        integerMinMax<int32_t>(values, block->size(), std::less<>{}))};
+        case TypeTags::NumberInt64:
+            return {false,
+                    TypeTags::NumberInt64,
+                    bitcastFrom<int64_t>(
+                        integerMinMax<int64_t>(values, block->size(), std::less<>{}))};
+        case TypeTags::NumberDouble:
+            return {false, TypeTags::NumberDouble, doubleMinMax<true>(values, block->size())};
+        default:
+            break;
+    }
+
+    return accumulateBlock(*block, [this](TypeTags accTag, Value accVal, TypeTags tag, Value val) {
+        return aggMin(accTag, accVal, tag, val);
+    });
+}
+
+std::tuple<bool, TypeTags, Value> ByteCode::builtinValueBlockMax(ArityType arity) {
+    invariant(arity == 1);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    if (blockTag != TypeTags::valueBlock) {
+        return {false, TypeTags::Nothing, 0};
+    }
+    const auto block = getValueBlockView(blockVal);
+
+    const Value* values = block->values();
+    switch (block->getHomogeneousTag().value_or(TypeTags::Nothing)) {
+        case TypeTags::NumberInt32:
+            return {false,
+                    TypeTags::NumberInt32,
+                    bitcastFrom<int32_t>(
+                        integerMinMax<int32_t>(values, block->size(), std::greater<>{}))};
+        case TypeTags::NumberInt64:
+            return {false,
+                    TypeTags::NumberInt64,
+                    bitcastFrom<int64_t>(
+                        integerMinMax<int64_t>(values, block->size(), std::greater<>{}))};
+        case TypeTags::NumberDouble:
+            return {false, TypeTags::NumberDouble, doubleMinMax<false>(values, block->size())};
+        default:
+            break;
+    }
+
+    return accumulateBlock(*block, [this](TypeTags accTag, Value accVal, TypeTags tag, Value val) {
+        return aggMax(accTag, accVal, tag, val);
+    });
+}
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
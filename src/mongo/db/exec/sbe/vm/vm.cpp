@@ -4139,6 +4139,14 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builti
             return builtinTsSecond(arity);
         case Builtin::tsIncrement:
             return builtinTsIncrement(arity);
+        case Builtin::valueBlockFromArray:
+            return builtinValueBlockFromArray(arity);
+        case Builtin::valueBlockToArray:
+            return builtinValueBlockToArray(arity);
+        case Builtin::valueBlockMin:
+            return builtinValueBlockMin(arity);
+        case Builtin::valueBlockMax:
+            return builtinValueBlockMax(arity);
     }
 
     MONGO_UNREACHABLE;
@@ -567,6 +567,10 @@ enum class Builtin : uint8_t {
     generateSortKey,
     tsSecond,
     tsIncrement,
+    valueBlockFromArray,
+    valueBlockToArray,
+    valueBlockMin,
+    valueBlockMax,
 };
 
 /**
@@ -1165,6 +1169,10 @@ private:
     std::tuple<bool, value::TypeTags, value::Value> builtinGenerateSortKey(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinTsSecond(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinTsIncrement(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockFromArray(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockToArray(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMin(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMax(ArityType arity);
 
     std::tuple<bool, value::TypeTags, value::Value> dispatchBuiltin(Builtin f, ArityType arity);
 
@@ -141,6 +141,7 @@ public:
         _stats.keysSorted += _sorter->numSorted();
         _stats.spills += _sorter->numSpills();
         _stats.totalDataSizeBytes += _sorter->totalDataSizeSorted();
+        _stats.spilledDataStorageSize += _sorter->spillStats().bytesWritten;
         _sorter.reset();
     }
 
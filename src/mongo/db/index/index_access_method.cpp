@@ -53,6 +53,7 @@
 #include "mongo/db/storage/execution_context.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/logv2/log.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/stacktrace.h"
@@ -593,6 +594,20 @@ public:
                   const std::function<void()>& saveCursorBeforeWrite,
                   const std::function<void()>& restoreCursorAfterWrite) final;
 
+    Status insertBatch(OperationContext* opCtx,
+                       const CollectionPtr& collection,
+                       const std::vector<BsonRecord>& records,
+                       const InsertDeleteOptions& options,
+                       size_t numThreads) final;
+
+    void recordSkippedRecords(OperationContext* opCtx,
+                              const std::function<void()>& saveCursorBeforeWrite,
+                              const std::function<void()>& restoreCursorAfterWrite) final;
+
+    size_t memUsed() const final;
+
+    void spill() final;
+
     Status commit(OperationContext* opCtx,
                   const CollectionPtr& collection,
                   bool dupsAllowed,
@@ -606,12 +621,61 @@ public:
 
     IndexStateInfo persistDataForShutdown() final;
 
+    ~BulkBuilderImpl();
+
 private:
+    /**
+     * Key generation state of one slice of the batches passed to insertBatch(). The first lane is
+     * processed by the thread calling insertBatch() and every other lane by a thread of
+     * '_keyGenerationPool'. The keys of a lane are sorted into a run of their own, which is merged
+     * with the runs of the other lanes when the bulk build is committed.
+     */
+    struct Lane {
+        std::unique_ptr<Sorter> sorter;
+        SharedBufferFragmentBuilder pooledBuilder{
+            KeyString::HeapBuilder::kHeapAllocatorDefaultBytes};
+
+        // Results of the slice last processed by this lane, folded into the state of the bulk
+        // builder by the thread calling insertBatch() once every lane is done.
+        int64_t keysInserted = 0;
+        bool isMultiKey = false;
+        MultikeyPaths multikeyPaths;
+        KeyStringSet multikeyMetadataKeys;
+        std::vector<std::pair<RecordId, Status>> suppressedErrors;
+        Status status = Status::OK();
+    };
+
     void _yield(OperationContext* opCtx,
                 const Yieldable* yieldable,
                 const NamespaceString& ns) const;
     void _insertMultikeyMetadataKeysIntoSorter();
 
+    /**
+     * Generates the keys of the documents in ['begin', 'end') into 'lane'. Safe to call from a
+     * thread other than the one owning 'opCtx', as key generation for a bulk build does not use
+     * it.
+     */
+    void _generateKeysForSlice(OperationContext* opCtx,
+                               const CollectionPtr& collection,
+                               const BsonRecord* begin,
+                               const BsonRecord* end,
+                               const InsertDeleteOptions& options,
+                               Lane* lane) const;
+
+    void _mergeMultikeyPaths(const MultikeyPaths& multikeyPaths);
+
+    /**
+     * Returns an iterator over every key added to the bulk builder, merging the runs of the
+     * lanes, if any, with the keys added through insert().
+     */
+    std::unique_ptr<Sorter::Iterator> _finishSorting();
+
+    /**
+     * Moves the keys sorted by the lanes into '_sorter', so that the state persisted for a
+     * resumable index build is a single sorter file.
+     */
+    void _drainLanesIntoSorter();
+
     Sorter* _makeSorter(
         size_t maxMemoryUsageBytes,
         StringData dbName,
@@ -621,9 +685,19 @@ private:
     Sorter::Settings _makeSorterSettings() const;
 
     SortedDataIndexAccessMethod* _iam;
+    const size_t _maxMemoryUsageBytes;
+    const std::string _dbName;
     std::unique_ptr<Sorter> _sorter;
     int64_t _keysInserted = 0;
 
+    // Created by the first call to insertBatch() that asks for more than one thread.
+    std::vector<std::unique_ptr<Lane>> _lanes;
+    std::unique_ptr<ThreadPool> _keyGenerationPool;
+
+    // Documents whose key generation errors were suppressed by insertBatch(), waiting for
+    // recordSkippedRecords().
+    std::vector<std::pair<RecordId, Status>> _skippedRecords;
+
     // Set to true if any document added to the BulkBuilder causes the index to become multikey.
     bool _isMultiKey = false;
 
@@ -649,19 +723,31 @@ std::unique_ptr<IndexAccessMethod::BulkBuilder> SortedDataIndexAccessMethod::ini
 SortedDataIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(SortedDataIndexAccessMethod* iam,
                                                               size_t maxMemoryUsageBytes,
                                                               StringData dbName)
-    : _iam(iam), _sorter(_makeSorter(maxMemoryUsageBytes, dbName)) {}
+    : _iam(iam),
+      _maxMemoryUsageBytes(maxMemoryUsageBytes),
+      _dbName(dbName.toString()),
+      _sorter(_makeSorter(maxMemoryUsageBytes, dbName)) {}
 
 SortedDataIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(SortedDataIndexAccessMethod* iam,
                                                               size_t maxMemoryUsageBytes,
                                                               const IndexStateInfo& stateInfo,
                                                               StringData dbName)
     : _iam(iam),
+      _maxMemoryUsageBytes(maxMemoryUsageBytes),
+      _dbName(dbName.toString()),
       _sorter(
           _makeSorter(maxMemoryUsageBytes, dbName, stateInfo.getFileName(), stateInfo.getRanges())),
       _keysInserted(stateInfo.getNumKeys().value_or(0)),
       _isMultiKey(stateInfo.getIsMultikey()),
       _indexMultikeyPaths(createMultikeyPaths(stateInfo.getMultikeyPaths())) {}
 
+SortedDataIndexAccessMethod::BulkBuilderImpl::~BulkBuilderImpl() {
+    if (_keyGenerationPool) {
+        _keyGenerationPool->shutdown();
+        _keyGenerationPool->join();
+    }
+}
+
 Status SortedDataIndexAccessMethod::BulkBuilderImpl::insert(
     OperationContext* opCtx,
     const CollectionPtr& collection,
@@ -713,18 +799,7 @@ Status SortedDataIndexAccessMethod::BulkBuilderImpl::insert(
         return exceptionToStatus();
     }
 
-    if (!multikeyPaths->empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = *multikeyPaths;
-        } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths->size());
-            for (size_t i = 0; i < multikeyPaths->size(); ++i) {
-                _indexMultikeyPaths[i].insert(boost::container::ordered_unique_range_t(),
-                                              (*multikeyPaths)[i].begin(),
-                                              (*multikeyPaths)[i].end());
-            }
-        }
-    }
+    _mergeMultikeyPaths(*multikeyPaths);
 
     for (const auto& keyString : *keys) {
         _sorter->add(keyString, mongo::NullValue());
@@ -737,6 +812,268 @@ Status SortedDataIndexAccessMethod::BulkBuilderImpl::insert(
     return Status::OK();
 }
 
+Status SortedDataIndexAccessMethod::BulkBuilderImpl::insertBatch(
+    OperationContext* opCtx,
+    const CollectionPtr& collection,
+    const std::vector<BsonRecord>& records,
+    const InsertDeleteOptions& options,
+    size_t numThreads) {
+    if (_lanes.empty()) {
+        numThreads = std::max(numThreads, size_t(1));
+
+        // Each lane sorts its keys into a run of its own, so the memory budget of the bulk build
+        // is shared between them.
+        for (size_t i = 0; i < numThreads; ++i) {
+            auto lane = std::make_unique<Lane>();
+            lane->sorter.reset(_makeSorter(_maxMemoryUsageBytes / numThreads, _dbName));
+            _lanes.push_back(std::move(lane));
+        }
+
+        if (numThreads > 1) {
+            ThreadPool::Options opts;
+            opts.threadNamePrefix = "IndexBuildKeyGen-";
+            opts.poolName = "IndexBuildKeyGenThreadPool";
+            opts.minThreads = 0;
+            opts.maxThreads = numThreads - 1;
+            opts.onCreateThread = [](const std::string& threadName) {
+                Client::initThread(threadName);
+            };
+            _keyGenerationPool = std::make_unique<ThreadPool>(opts);
+            _keyGenerationPool->startup();
+        }
+    }
+
+    if (records.empty()) {
+        return Status::OK();
+    }
+
+    // Splits the batch into contiguous slices of nearly equal size, one for each lane.
+    const size_t numSlices = std::min(_lanes.size(), records.size());
+    const size_t sliceSize = records.size() / numSlices;
+    const size_t remainder = records.size() % numSlices;
+    const BsonRecord* begin = records.data();
+    std::vector<std::pair<const BsonRecord*, const BsonRecord*>> slices;
+    for (size_t i = 0; i < numSlices; ++i) {
+        const BsonRecord* end = begin + sliceSize + (i < remainder ? 1 : 0);
+        slices.emplace_back(begin, end);
+        begin = end;
+    }
+
+    for (size_t i = 1; i < numSlices; ++i) {
+        auto lane = _lanes[i].get();
+        _keyGenerationPool->schedule([&, lane, slice = slices[i]](Status status) {
+            if (!status.isOK()) {
+                lane->status = std::move(status);
+                return;
+            }
+            _generateKeysForSlice(opCtx, collection, slice.first, slice.second, options, lane);
+        });
+    }
+    _generateKeysForSlice(
+        opCtx, collection, slices[0].first, slices[0].second, options, _lanes[0].get());
+    if (numSlices > 1) {
+        _keyGenerationPool->waitForIdle();
+    }
+
+    // Fold the results of every lane into the state of the bulk builder. Suppressed key generation
+    // errors are held until recordSkippedRecords(), as only the thread owning 'opCtx' may write to
+    // the skipped record tracker.
+    Status result = Status::OK();
+    for (size_t i = 0; i < numSlices; ++i) {
+        auto& lane = *_lanes[i];
+
+        if (result.isOK() && !lane.status.isOK()) {
+            result = lane.status;
+        }
+
+        _mergeMultikeyPaths(lane.multikeyPaths);
+        _multikeyMetadataKeys.insert(lane.multikeyMetadataKeys.begin(),
+                                     lane.multikeyMetadataKeys.end());
+        _keysInserted += lane.keysInserted;
+        _isMultiKey = _isMultiKey || lane.isMultiKey;
+        std::move(lane.suppressedErrors.begin(),
+                  lane.suppressedErrors.end(),
+                  std::back_inserter(_skippedRecords));
+
+        lane.keysInserted = 0;
+        lane.isMultiKey = false;
+        lane.multikeyPaths.clear();
+        lane.multikeyMetadataKeys.clear();
+        lane.suppressedErrors.clear();
+        lane.status = Status::OK();
+    }
+
+    return result;
+}
+
+void SortedDataIndexAccessMethod::BulkBuilderImpl::recordSkippedRecords(
+    OperationContext* opCtx,
+    const std::function<void()>& saveCursorBeforeWrite,
+    const std::function<void()>& restoreCursorAfterWrite) {
+    auto skippedRecords = std::exchange(_skippedRecords, {});
+
+    auto interceptor = _iam->_indexCatalogEntry->indexBuildInterceptor();
+    if (!interceptor || !interceptor->getSkippedRecordTracker()) {
+        return;
+    }
+
+    for (const auto& [loc, status] : skippedRecords) {
+        LOGV2_DEBUG(6721000,
+                    1,
+                    "Recording suppressed key generation error to retry later",
+                    "error"_attr = status,
+                    "loc"_attr = loc);
+
+        // Save and restore the cursor around the write in case it throws a WCE internally and
+        // causes the cursor to be unpositioned.
+        saveCursorBeforeWrite();
+        interceptor->getSkippedRecordTracker()->record(opCtx, loc);
+        restoreCursorAfterWrite();
+    }
+}
+
+size_t SortedDataIndexAccessMethod::BulkBuilderImpl::memUsed() const {
+    size_t memUsed = _sorter->memUsed();
+    for (const auto& lane : _lanes) {
+        memUsed += lane->sorter->memUsed();
+    }
+    return memUsed;
+}
+
+void SortedDataIndexAccessMethod::BulkBuilderImpl::spill() {
+    _sorter->spill();
+    for (auto& lane : _lanes) {
+        lane->sorter->spill();
+    }
+}
+
+void SortedDataIndexAccessMethod::BulkBuilderImpl::_generateKeysForSlice(
+    OperationContext* opCtx,
+    const CollectionPtr& collection,
+    const BsonRecord* begin,
+    const BsonRecord* end,
+    const InsertDeleteOptions& options,
+    Lane* lane) const {
+    KeyStringSet keys;
+    MultikeyPaths multikeyPaths;
+
+    try {
+        for (auto record = begin; record != end; ++record) {
+            keys.clear();
+            multikeyPaths.clear();
+
+            _iam->getKeys(opCtx,
+                          collection,
+                          lane->pooledBuilder,
+                          *record->docPtr,
+                          options.getKeysMode,
+                          GetKeysContext::kAddingKeys,
+                          &keys,
+                          &lane->multikeyMetadataKeys,
+                          &multikeyPaths,
+                          record->id,
+                          [&](Status status, const BSONObj&, boost::optional<RecordId>) {
+                              lane->suppressedErrors.emplace_back(record->id, std::move(status));
+                          });
+
+            if (!multikeyPaths.empty()) {
+                if (lane->multikeyPaths.empty()) {
+                    lane->multikeyPaths = multikeyPaths;
+                } else {
+                    for (size_t i = 0; i < multikeyPaths.size(); ++i) {
+                        lane->multikeyPaths[i].insert(boost::container::ordered_unique_range_t(),
+                                                      multikeyPaths[i].begin(),
+                                                      multikeyPaths[i].end());
+                    }
+                }
+            }
+
+            for (const auto& keyString : keys) {
+                lane->sorter->add(keyString, mongo::NullValue());
+                ++lane->keysInserted;
+            }
+
+            lane->isMultiKey = lane->isMultiKey ||
+                _iam->shouldMarkIndexAsMultikey(
+                    keys.size(), lane->multikeyMetadataKeys, multikeyPaths);
+        }
+    } catch (...) {
+        lane->status = exceptionToStatus();
+    }
+}
+
+void SortedDataIndexAccessMethod::BulkBuilderImpl::_mergeMultikeyPaths(
+    const MultikeyPaths& multikeyPaths) {
+    if (multikeyPaths.empty()) {
+        return;
+    }
+
+    if (_indexMultikeyPaths.empty()) {
+        _indexMultikeyPaths = multikeyPaths;
+        return;
+    }
+
+    invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
+    for (size_t i = 0; i < multikeyPaths.size(); ++i) {
+        _indexMultikeyPaths[i].insert(boost::container::ordered_unique_range_t(),
+                                      multikeyPaths[i].begin(),
+                                      multikeyPaths[i].end());
+    }
+}
+
+std::unique_ptr<SortedDataIndexAccessMethod::BulkBuilderImpl::Sorter::Iterator>
+SortedDataIndexAccessMethod::BulkBuilderImpl::_finishSorting() {
+    if (_lanes.empty()) {
+        return std::unique_ptr<Sorter::Iterator>(_sorter->done());
+    }
+
+    // Sorting what each lane still holds in memory is independent of the other lanes, so the
+    // lanes are finished in parallel before their runs are merged.
+    std::vector<std::shared_ptr<Sorter::Iterator>> iters(_lanes.size() + 1);
+    std::vector<Status> statuses(_lanes.size(), Status::OK());
+    for (size_t i = 1; i < _lanes.size(); ++i) {
+        _keyGenerationPool->schedule([&, i](Status status) {
+            if (!status.isOK()) {
+                statuses[i] = std::move(status);
+                return;
+            }
+            try {
+                iters[i + 1].reset(_lanes[i]->sorter->done());
+            } catch (...) {
+                statuses[i] = exceptionToStatus();
+            }
+        });
+    }
+    try {
+        iters[0].reset(_sorter->done());
+        iters[1].reset(_lanes[0]->sorter->done());
+    } catch (...) {
+        statuses[0] = exceptionToStatus();
+    }
+    if (_keyGenerationPool) {
+        _keyGenerationPool->waitForIdle();
+    }
+
+    for (const auto& status : statuses) {
+        uassertStatusOK(status);
+    }
+
+    return std::unique_ptr<Sorter::Iterator>(
+        Sorter::Iterator::merge(iters,
+                                makeSortOptions(_maxMemoryUsageBytes, _dbName),
+                                BtreeExternalSortComparison()));
+}
+
+void SortedDataIndexAccessMethod::BulkBuilderImpl::_drainLanesIntoSorter() {
+    for (auto& lane : _lanes) {
+        std::unique_ptr<Sorter::Iterator> it(lane->sorter->done());
+        while (it->more()) {
+            _sorter->add(it->next().first, mongo::NullValue());
+        }
+    }
+    _lanes.clear();
+}
+
 const MultikeyPaths& SortedDataIndexAccessMethod::BulkBuilderImpl::getMultikeyPaths() const {
     return _indexMultikeyPaths;
 }
@@ -747,6 +1084,7 @@ bool SortedDataIndexAccessMethod::BulkBuilderImpl::isMultikey() const {
 
 IndexStateInfo SortedDataIndexAccessMethod::BulkBuilderImpl::persistDataForShutdown() {
     _insertMultikeyMetadataKeysIntoSorter();
+    _drainLanesIntoSorter();
     auto state = _sorter->persistDataForShutdown();
 
     IndexStateInfo stateInfo;
@@ -837,7 +1175,7 @@ Status SortedDataIndexAccessMethod::BulkBuilderImpl::commit(
     auto ns = _iam->_indexCatalogEntry->getNSSFromCatalog(opCtx);
 
     _insertMultikeyMetadataKeysIntoSorter();
-    std::unique_ptr<Sorter::Iterator> it(_sorter->done());
+    std::unique_ptr<Sorter::Iterator> it = _finishSorting();
 
     static constexpr char message[] = "Index Build: inserting keys from external sorter into index";
     ProgressMeterHolder pm;
@@ -944,6 +1282,11 @@ Status SortedDataIndexAccessMethod::BulkBuilderImpl::commit(
 
     pm.finished();
 
+    SorterSpillStats spillStats = _sorter->spillStats();
+    for (const auto& lane : _lanes) {
+        spillStats += lane->sorter->spillStats();
+    }
+
     LOGV2(20685,
           "Index build: inserted {bulk_getKeysInserted} keys from external sorter into index in "
           "{timer_seconds} seconds",
@@ -951,7 +1294,11 @@ Status SortedDataIndexAccessMethod::BulkBuilderImpl::commit(
           logAttrs(ns),
           "index"_attr = descriptor->indexName(),
           "keysInserted"_attr = _keysInserted,
-          "duration"_attr = Milliseconds(Seconds(timer.seconds())));
+          "duration"_attr = Milliseconds(Seconds(timer.seconds())),
+          "spilledDataSizeBytes"_attr = spillStats.spilledDataSizeBytes,
+          "spilledDataStorageSize"_attr = spillStats.bytesWritten,
+          "spillBytesRead"_attr = spillStats.bytesRead,
+          "spillReadDuration"_attr = duration_cast<Milliseconds>(spillStats.readTime));
     return Status::OK();
 }
 
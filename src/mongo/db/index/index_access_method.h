@@ -48,6 +48,7 @@ namespace mongo {
 
 class BSONObjBuilder;
 class MatchExpression;
+struct BsonRecord;
 struct UpdateTicket;
 struct InsertDeleteOptions;
 class SortedDataIndexAccessMethod;
@@ -193,6 +194,45 @@ public:
                               const std::function<void()>& saveCursorBeforeWrite,
                               const std::function<void()>& restoreCursorAfterWrite) = 0;
 
+        /**
+         * Inserts a batch of documents as-if by calling insert() on each of them, generating the
+         * keys of up to 'numThreads' slices of the batch concurrently. Each slice is sorted into
+         * its own run, and the runs are merged when the bulk build is committed.
+         *
+         * Nothing is written through 'opCtx', so this may be called on a thread other than the one
+         * owning 'opCtx' while that thread waits for it to return. Documents whose key generation
+         * errors were suppressed are held until recordSkippedRecords() is called.
+         *
+         * The documents in 'records' must remain valid until this function returns. The number of
+         * threads is fixed by the first call.
+         */
+        virtual Status insertBatch(OperationContext* opCtx,
+                                   const CollectionPtr& collection,
+                                   const std::vector<BsonRecord>& records,
+                                   const InsertDeleteOptions& options,
+                                   size_t numThreads) = 0;
+
+        /**
+         * Records the documents held by insertBatch() as skipped, so that the index builder can
+         * retry them at a point when data is consistent. Must be called on the thread owning
+         * 'opCtx', with the same cursor save and restore functions as insert().
+         */
+        virtual void recordSkippedRecords(OperationContext* opCtx,
+                                          const std::function<void()>& saveCursorBeforeWrite,
+                                          const std::function<void()>& restoreCursorAfterWrite) = 0;
+
+        /**
+         * Returns the approximate number of bytes held in memory by the keys that have not been
+         * spilled to disk yet.
+         */
+        virtual size_t memUsed() const = 0;
+
+        /**
+         * Spills the keys held in memory to disk, for callers sharing one memory budget between
+         * several bulk builders.
+         */
+        virtual void spill() = 0;
+
         /**
          * Call this when you are ready to finish your bulk work.
          * @param dupsAllowed - If false and 'dupRecords' is not null, append with the RecordIds of
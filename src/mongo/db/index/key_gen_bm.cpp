@@ -31,6 +31,7 @@
 
 #include <benchmark/benchmark.h>
 #include <random>
+#include <vector>
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/index/btree_key_generator.h"
@@ -165,6 +166,52 @@ void BM_KeyGenArrayOfArray(benchmark::State& state, int32_t elements) {
     }
 }
 
+// Documents shared by every thread of BM_KeyGenCompound, like the batch of documents scanned by an
+// index build generating keys with several threads.
+const std::vector<BSONObj>& compoundKeyDocs() {
+    static const auto docs = [] {
+        std::mt19937 gen(numGen());
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < 1000; ++i) {
+            docs.push_back(BSON("a" << static_cast<int32_t>(gen()) << "b"
+                                    << std::to_string(gen()) << "c"
+                                    << static_cast<double>(gen())));
+        }
+        return docs;
+    }();
+    return docs;
+}
+
+void BM_KeyGenCompound(benchmark::State& state) {
+    const auto& docs = compoundKeyDocs();
+    const auto keyPattern = BSON("a" << 1 << "b" << 1 << "c" << 1);
+
+    // Each thread has its own key generator and allocator, as each key generation thread of an
+    // index build does.
+    BtreeKeyGenerator generator({"a", "b", "c"},
+                                {BSONElement{}, BSONElement{}, BSONElement{}},
+                                false,
+                                nullptr,
+                                KeyString::Version::kLatestVersion,
+                                Ordering::make(keyPattern));
+
+    SharedBufferFragmentBuilder allocator(kMemBlockSize,
+                                          SharedBufferFragmentBuilder::ConstantGrowStrategy());
+    KeyStringSet keys;
+    MultikeyPaths multikeyPaths;
+
+    // Threads start at different documents so that each walks the shared batch in its own order.
+    size_t i = state.thread_index * docs.size() / state.threads;
+    for (auto _ : state) {
+        generator.getKeys(allocator, docs[i], false, &keys, &multikeyPaths);
+        benchmark::ClobberMemory();
+        keys.clear();
+        multikeyPaths.clear();
+        i = (i + 1) % docs.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
 BENCHMARK_CAPTURE(BM_KeyGenBasic, Generic, false);
 BENCHMARK_CAPTURE(BM_KeyGenBasic, SkipMultikey, true);
 
@@ -180,5 +227,7 @@ BENCHMARK_CAPTURE(BM_KeyGenArrayOfArray, 10x10, 10);
 BENCHMARK_CAPTURE(BM_KeyGenArrayOfArray, 100x100, 100);
 BENCHMARK_CAPTURE(BM_KeyGenArrayOfArray, 1Kx1K, 1000);
 
+BENCHMARK(BM_KeyGenCompound)->ThreadRange(1, 16)->UseRealTime();
+
 }  // namespace
 }  // namespace mongo
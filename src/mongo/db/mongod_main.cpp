@@ -110,6 +110,7 @@
 #include "mongo/db/periodic_runner_job_abort_expired_transactions.h"
 #include "mongo/db/pipeline/change_stream_expired_pre_image_remover.h"
 #include "mongo/db/pipeline/process_interface/replica_set_node_process_interface.h"
+#include "mongo/db/query/ce/stats_cache_op_observer.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/read_write_concern_defaults_cache_lookup_mongod.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
@@ -1133,6 +1134,7 @@ void setUpObservers(ServiceContext* serviceContext) {
     opObserverRegistry->addObserver(
         std::make_unique<repl::PrimaryOnlyServiceOpObserver>(serviceContext));
     opObserverRegistry->addObserver(std::make_unique<FcvOpObserver>());
+    opObserverRegistry->addObserver(std::make_unique<ce::StatsCacheOpObserver>());
 
     if (gFeatureFlagClusterWideConfig.isEnabledAndIgnoreFCV()) {
         opObserverRegistry->addObserver(std::make_unique<ClusterServerParameterOpObserver>());
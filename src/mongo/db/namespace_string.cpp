@@ -201,6 +201,10 @@ bool NamespaceString::isLegalClientSystemNS(
     if (isChangeStreamPreImagesCollection()) {
         return true;
     }
+    if (isSystemStatsCollection() &&
+        validCollectionName(coll().substr(kStatisticsCollectionPrefix.size()))) {
+        return true;
+    }
 
     return false;
 }
@@ -351,6 +355,10 @@ bool NamespaceString::isTimeseriesBucketsCollection() const {
     return coll().startsWith(kTimeseriesBucketsCollectionPrefix);
 }
 
+bool NamespaceString::isSystemStatsCollection() const {
+    return coll().startsWith(kStatisticsCollectionPrefix);
+}
+
 bool NamespaceString::isChangeStreamPreImagesCollection() const {
     return ns() == kChangeStreamPreImagesNamespace.ns();
 }
@@ -367,6 +375,10 @@ NamespaceString NamespaceString::makeTimeseriesBucketsNamespace() const {
     return {db(), kTimeseriesBucketsCollectionPrefix.toString() + coll()};
 }
 
+NamespaceString NamespaceString::makeStatisticsNamespace() const {
+    return {db(), kStatisticsCollectionPrefix.toString() + coll()};
+}
+
 NamespaceString NamespaceString::getTimeseriesViewNamespace() const {
     invariant(isTimeseriesBucketsCollection(), ns());
     return {db(), coll().substr(kTimeseriesBucketsCollectionPrefix.size())};
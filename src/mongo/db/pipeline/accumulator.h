@@ -264,6 +264,13 @@ public:
     Value getValue(bool toBeMerged) final;
     void reset() final;
 
+    /**
+     * Like getValue(true), except that a sum of doubles is also output as a document holding the
+     * two parts of its DoubleDouble total, so merging the partial sums is as precise as summing
+     * all of their values with a single accumulator.
+     */
+    Value getUnroundedValueToBeMerged();
+
     static boost::intrusive_ptr<AccumulatorState> create(ExpressionContext* expCtx);
 
     bool isAssociative() const final {
@@ -133,6 +133,19 @@ Value AccumulatorSum::getValue(bool toBeMerged) {
     }
 }
 
+Value AccumulatorSum::getUnroundedValueToBeMerged() {
+    if (totalType != NumberDouble) {
+        return getValue(true);
+    }
+
+    // Merging adds 'subTotal' without adjusting the type of the sum, and then 'subTotalError',
+    // whose type makes the merged sum a double.
+    double total;
+    double error;
+    std::tie(total, error) = nonDecimalTotal.getDoubleDouble();
+    return Value(DOC(subTotalName << total << subTotalErrorName << error));
+}
+
 AccumulatorSum::AccumulatorSum(ExpressionContext* const expCtx) : AccumulatorState(expCtx) {
     // This is a fixed size AccumulatorState so we never need to update this.
     _memUsageBytes = sizeof(*this);
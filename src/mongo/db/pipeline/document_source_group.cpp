@@ -148,6 +148,18 @@ bool DocumentSourceGroup::shouldSpillWithAttemptToSaveMemory() {
         _memoryTracker.resetCurrent();
         return true;
     }
+
+    if (!_memoryGrant) {
+        _memoryGrant = QueryMemoryBroker::get(pExpCtx->opCtx)
+                           .makeGrant(QueryMemoryBroker::Consumer::kGroup);
+    }
+    if (!_memoryGrant->tryResize(_memoryTracker.currentMemoryBytes())) {
+        if (_memoryTracker._allowDiskUse) {
+            _memoryTracker.resetCurrent();
+            return true;
+        }
+        _memoryGrant->resizeOrWait(pExpCtx->opCtx, _memoryTracker.currentMemoryBytes());
+    }
     return false;
 }
 
@@ -249,6 +261,7 @@ void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _memoryGrant = boost::none;
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -639,6 +652,7 @@ MONGO_COMPILER_NOINLINE DocumentSource::GetNextResult DocumentSourceGroup::initi
 
                 // We won't be using groups again so free its memory.
                 _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+                _memoryGrant = boost::none;
 
                 _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
                     _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
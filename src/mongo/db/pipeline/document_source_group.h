@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/memory_usage_tracker.h"
 #include "mongo/db/pipeline/transformer_interface.h"
+#include "mongo/db/query/query_memory_broker.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -268,7 +269,8 @@ private:
 
     /**
      * Cleans up any pending memory usage. Throws error, if memory usage is above
-     * 'maxMemoryUsageBytes' and cannot spill to disk.
+     * 'maxMemoryUsageBytes' and cannot spill to disk. Also asks for spilling when the process-wide
+     * query memory budget is used up, or waits for it to free up if spilling is not allowed.
      *
      * Returns true, if the caller should spill to disk, false otherwise.
      */
@@ -280,6 +282,10 @@ private:
 
     MemoryUsageTracker _memoryTracker;
 
+    // The share of the process-wide query memory budget held by '_groups'. Taken when the first
+    // document is added.
+    boost::optional<QueryMemoryBroker::Grant> _memoryGrant;
+
     GroupStats _stats;
 
     std::shared_ptr<Sorter<Value, Value>::File> _file;
@@ -37,8 +37,10 @@
 #include <string>
 #include <type_traits>
 
+#include "mongo/base/parse_number.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsontypes.h"
+#include "mongo/bson/util/bsoncolumn.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_algo.h"
@@ -46,6 +48,9 @@
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/matcher/expression_internal_bucket_geo_within.h"
 #include "mongo/db/matcher/expression_internal_expr_comparison.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source_add_fields.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
 #include "mongo/db/pipeline/document_source_group.h"
@@ -87,6 +92,149 @@ REGISTER_DOCUMENT_SOURCE(_unpackBucket,
                          AllowedWithApiStrict::kAlways);
 
 namespace {
+using BucketLevelAccumulator = DocumentSourceInternalUnpackBucket::BucketLevelAccumulator;
+
+constexpr StringData kBucketLevelCountOpName = "$count"_sd;
+constexpr StringData kBucketLevelCountNumericOpName = "$countNumeric"_sd;
+
+// Prefix of the helper field holding the number of values averaged by a rewritten $avg.
+constexpr StringData kBucketLevelAvgCountPrefix = "__count_"_sd;
+
+StringData bucketLevelOpName(BucketLevelAccumulator::Op op) {
+    switch (op) {
+        case BucketLevelAccumulator::Op::kSum:
+            return AccumulatorSum::kName;
+        case BucketLevelAccumulator::Op::kMin:
+            return AccumulatorMin::kName;
+        case BucketLevelAccumulator::Op::kMax:
+            return AccumulatorMax::kName;
+        case BucketLevelAccumulator::Op::kCount:
+            return kBucketLevelCountOpName;
+        case BucketLevelAccumulator::Op::kCountNumeric:
+            return kBucketLevelCountNumericOpName;
+    }
+    MONGO_UNREACHABLE;
+}
+
+BucketLevelAccumulator parseBucketLevelAccumulator(const BSONElement& elem) {
+    uassert(6708001,
+            str::stream() << "bucket-level accumulator must be an object with a single field, got: "
+                          << elem,
+            elem.type() == BSONType::Object && elem.embeddedObject().nFields() == 1);
+
+    auto opElem = elem.embeddedObject().firstElement();
+    auto opName = opElem.fieldNameStringData();
+    if (opName == kBucketLevelCountOpName) {
+        uassert(6708002,
+                str::stream() << "bucket-level " << kBucketLevelCountOpName
+                              << " accumulator takes an empty object, got: " << opElem,
+                opElem.type() == BSONType::Object && opElem.embeddedObject().isEmpty());
+        return {elem.fieldName(), BucketLevelAccumulator::Op::kCount, ""};
+    }
+
+    uassert(6708003,
+            str::stream() << "bucket-level accumulator argument must be a field name, got: "
+                          << opElem,
+            opElem.type() == BSONType::String &&
+                opElem.valueStringData().find('.') == std::string::npos);
+    for (auto op : {BucketLevelAccumulator::Op::kSum,
+                    BucketLevelAccumulator::Op::kMin,
+                    BucketLevelAccumulator::Op::kMax,
+                    BucketLevelAccumulator::Op::kCountNumeric}) {
+        if (opName == bucketLevelOpName(op)) {
+            return {elem.fieldName(), op, opElem.str()};
+        }
+    }
+    uasserted(6708004, str::stream() << "unrecognized bucket-level accumulator: " << opName);
+}
+
+boost::intrusive_ptr<AccumulatorState> makeBucketLevelAccumulatorState(
+    BucketLevelAccumulator::Op op, ExpressionContext* expCtx) {
+    switch (op) {
+        case BucketLevelAccumulator::Op::kMin:
+            return AccumulatorMin::create(expCtx);
+        case BucketLevelAccumulator::Op::kMax:
+            return AccumulatorMax::create(expCtx);
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+/**
+ * Gives access to the values of one top-level field across the measurements of a bucket, reading
+ * them straight from the data region of either an uncompressed or a compressed bucket.
+ */
+class BucketDataColumn {
+public:
+    BucketDataColumn(const BSONObj& dataRegion, StringData field, int measurementCount)
+        : _data(dataRegion[field]), _measurementCount(measurementCount) {}
+
+    BucketDataColumn(const BucketDataColumn&) = delete;
+    BucketDataColumn& operator=(const BucketDataColumn&) = delete;
+
+    /**
+     * Returns the values of the field indexed by measurement, with EOO for the measurements which
+     * don't have the field.
+     */
+    const std::vector<BSONElement>& elements() {
+        if (_elements) {
+            return *_elements;
+        }
+
+        _elements.emplace(_measurementCount);
+        if (isCompressed()) {
+            _compressed.emplace(_data);
+            size_t idx = 0;
+            for (auto&& elem : *_compressed) {
+                uassert(6708006,
+                        "Time-series bucket column has more values than the bucket has "
+                        "measurements",
+                        idx < _elements->size());
+                (*_elements)[idx++] = elem;
+            }
+        } else if (_data.type() == BSONType::Object) {
+            for (auto&& elem : _data.embeddedObject()) {
+                int idx = 0;
+                uassert(6708007,
+                        str::stream() << "Invalid measurement index in time-series bucket: "
+                                      << elem.fieldNameStringData(),
+                        NumberParser{}(elem.fieldNameStringData(), &idx).isOK() && idx >= 0 &&
+                            idx < static_cast<int>(_elements->size()));
+                (*_elements)[idx] = elem;
+            }
+        }
+        return *_elements;
+    }
+
+    /**
+     * Returns the values of the field decoded as doubles, or nullptr unless the field is a
+     * compressed column holding nothing but doubles. Decoding a column in bulk is much cheaper than
+     * producing a BSONElement for each value.
+     */
+    const std::vector<boost::optional<double>>* doubles() {
+        if (!_doubles && isCompressed()) {
+            _doubles.emplace();
+            _decodedDoubles = BSONColumn(_data).decodeTo(*_doubles);
+        }
+        return _decodedDoubles ? &*_doubles : nullptr;
+    }
+
+private:
+    bool isCompressed() const {
+        return _data.type() == BSONType::BinData && _data.binDataType() == BinDataType::Column;
+    }
+
+    BSONElement _data;
+    int _measurementCount;
+
+    // The compressed column, which owns the elements produced from it.
+    boost::optional<BSONColumn> _compressed;
+    boost::optional<std::vector<BSONElement>> _elements;
+
+    boost::optional<std::vector<boost::optional<double>>> _doubles;
+    bool _decodedDoubles = false;
+};
+
 /**
  * A projection can be internalized if every field corresponds to a boolean value. Note that this
  * correctly rejects dotted fieldnames, which are mapped to objects internally.
@@ -229,6 +377,8 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createF
     auto bucketMaxSpanSeconds = 0;
     auto assumeClean = false;
     std::vector<std::string> computedMetaProjFields;
+    boost::optional<std::vector<BucketLevelAccumulator>> bucketLevelAccumulators;
+    BSONObj bucketLevelFilter;
     for (auto&& elem : specElem.embeddedObject()) {
         auto fieldName = elem.fieldNameStringData();
         if (fieldName == kInclude || fieldName == kExclude) {
@@ -304,6 +454,32 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createF
                         field.find('.') == std::string::npos);
                 bucketSpec.addComputedMetaProjFields(field);
             }
+        } else if (fieldName == kBucketLevelAggregation) {
+            uassert(6708000,
+                    str::stream() << "bucketLevelAggregation field must be an object, got: "
+                                  << elem.type(),
+                    elem.type() == BSONType::Object);
+
+            bucketLevelAccumulators.emplace();
+            for (auto&& aggElem : elem.embeddedObject()) {
+                auto aggFieldName = aggElem.fieldNameStringData();
+                uassert(6708008,
+                        str::stream() << "bucketLevelAggregation parameter '" << aggFieldName
+                                      << "' must be an object, got: " << aggElem.type(),
+                        aggElem.type() == BSONType::Object);
+                if (aggFieldName == "accumulators"_sd) {
+                    for (auto&& accElem : aggElem.embeddedObject()) {
+                        bucketLevelAccumulators->push_back(parseBucketLevelAccumulator(accElem));
+                    }
+                } else if (aggFieldName == "filter"_sd) {
+                    bucketLevelFilter = aggElem.embeddedObject();
+                } else {
+                    uasserted(6708009,
+                              str::stream()
+                                  << "unrecognized bucketLevelAggregation parameter: "
+                                  << aggFieldName);
+                }
+            }
         } else {
             uasserted(5346506,
                       str::stream()
@@ -318,11 +494,15 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createF
             "The $_internalUnpackBucket stage requires a bucketMaxSpanSeconds parameter",
             hasBucketMaxSpanSeconds);
 
-    return make_intrusive<DocumentSourceInternalUnpackBucket>(
+    auto unpack = make_intrusive<DocumentSourceInternalUnpackBucket>(
         expCtx,
         BucketUnpacker{std::move(bucketSpec), unpackerBehavior},
         bucketMaxSpanSeconds,
         assumeClean);
+    if (bucketLevelAccumulators) {
+        unpack->setBucketLevelAggregation(std::move(*bucketLevelAccumulators), bucketLevelFilter);
+    }
+    return unpack;
 }
 
 boost::intrusive_ptr<DocumentSource> DocumentSourceInternalUnpackBucket::createFromBsonExternal(
@@ -412,6 +592,22 @@ void DocumentSourceInternalUnpackBucket::serializeToArray(
                          return compFields;
                      }()});
 
+    if (_bucketLevelAccumulators) {
+        MutableDocument accumulators;
+        for (auto&& acc : *_bucketLevelAccumulators) {
+            auto arg = acc.op == BucketLevelAccumulator::Op::kCount ? Value{Document{}}
+                                                                    : Value{acc.inputField};
+            accumulators.addField(acc.outputField, Value{DOC(bucketLevelOpName(acc.op) << arg)});
+        }
+
+        MutableDocument bucketLevelAggregation;
+        bucketLevelAggregation.addField("accumulators", accumulators.freezeToValue());
+        if (!_bucketLevelFilterBson.isEmpty()) {
+            bucketLevelAggregation.addField("filter", Value{_bucketLevelFilterBson});
+        }
+        out.addField(kBucketLevelAggregation, bucketLevelAggregation.freezeToValue());
+    }
+
     if (!explain) {
         array.push_back(Value(DOC(getSourceName() << out.freeze())));
         if (_sampleSize) {
@@ -430,6 +626,19 @@ void DocumentSourceInternalUnpackBucket::serializeToArray(
 DocumentSource::GetNextResult DocumentSourceInternalUnpackBucket::doGetNext() {
     tassert(5521502, "calling doGetNext() when '_sampleSize' is set is disallowed", !_sampleSize);
 
+    if (_bucketLevelAccumulators) {
+        // Reduce each bucket to its partial aggregates, skipping the buckets where no measurement
+        // matched the filter.
+        auto nextResult = pSource->getNext();
+        while (nextResult.isAdvanced()) {
+            if (auto aggregates = computeBucketLevelAggregates(nextResult.getDocument().toBson())) {
+                return std::move(*aggregates);
+            }
+            nextResult = pSource->getNext();
+        }
+        return nextResult;
+    }
+
     // Otherwise, fallback to unpacking every measurement in all buckets until the child stage is
     // exhausted.
     if (_bucketUnpacker.hasNext()) {
@@ -685,6 +894,318 @@ bool DocumentSourceInternalUnpackBucket::haveComputedMetaField() const {
             _bucketUnpacker.bucketSpec().metaField().get());
 }
 
+void DocumentSourceInternalUnpackBucket::setBucketLevelAggregation(
+    std::vector<BucketLevelAccumulator> accumulators, BSONObj filter) {
+    _bucketLevelAccumulators = std::move(accumulators);
+    _bucketLevelFilterBson = filter.getOwned();
+    _bucketLevelFilter.reset();
+    _bucketLevelFilterFields.clear();
+    if (_bucketLevelFilterBson.isEmpty()) {
+        return;
+    }
+
+    _bucketLevelFilter =
+        uassertStatusOK(MatchExpressionParser::parse(_bucketLevelFilterBson,
+                                                     pExpCtx,
+                                                     ExtensionsCallbackNoop(),
+                                                     Pipeline::kAllowedMatcherFeatures));
+
+    // The filter is evaluated against documents built from the top-level fields it reads.
+    DepsTracker deps;
+    _bucketLevelFilter->addDependencies(&deps);
+    uassert(6708010,
+            "bucketLevelAggregation filter may only depend on top-level measurement fields",
+            !deps.needWholeDocument && !deps.getNeedsAnyMetadata());
+    std::set<std::string> fields;
+    for (auto&& path : deps.fields) {
+        fields.insert(FieldPath(path).getFieldName(0).toString());
+    }
+    _bucketLevelFilterFields.assign(fields.begin(), fields.end());
+}
+
+boost::optional<Document> DocumentSourceInternalUnpackBucket::computeBucketLevelAggregates(
+    const BSONObj& bucket) const {
+    const auto& spec = _bucketUnpacker.bucketSpec();
+    const auto measurementCount = BucketUnpacker::computeMeasurementCount(bucket, spec.timeField());
+    if (measurementCount == 0) {
+        return boost::none;
+    }
+
+    const auto dataElem = bucket[timeseries::kBucketDataFieldName];
+    const auto dataRegion = dataElem.type() == BSONType::Object ? dataElem.Obj() : BSONObj();
+    const auto metaElem = bucket[timeseries::kBucketMetaFieldName];
+    const bool hasMeta = spec.metaField() && metaElem;
+
+    // Columns are decoded at most once per bucket, however many accumulators or filter paths read
+    // them.
+    std::map<std::string, BucketDataColumn> columns;
+    auto column = [&](const std::string& field) -> BucketDataColumn& {
+        return columns.try_emplace(field, dataRegion, field, measurementCount).first->second;
+    };
+
+    // Indexes of the measurements matching the filter. Not used when there is no filter, in which
+    // case every measurement of the bucket is aggregated.
+    std::vector<int> selected;
+    if (_bucketLevelFilter) {
+        std::vector<std::pair<StringData, const std::vector<BSONElement>*>> filterColumns;
+        for (auto&& field : _bucketLevelFilterFields) {
+            if (!spec.metaField() || field != *spec.metaField()) {
+                filterColumns.emplace_back(field, &column(field).elements());
+            }
+        }
+
+        for (int idx = 0; idx < measurementCount; ++idx) {
+            // Only the fields read by the filter are put in the measurement.
+            BSONObjBuilder measurement;
+            if (hasMeta) {
+                measurement.appendAs(metaElem, *spec.metaField());
+            }
+            for (auto&& [field, values] : filterColumns) {
+                if (auto&& elem = (*values)[idx]; !elem.eoo()) {
+                    measurement.appendAs(elem, field);
+                }
+            }
+            if (_bucketLevelFilter->matchesBSON(measurement.done())) {
+                selected.push_back(idx);
+            }
+        }
+
+        if (selected.empty()) {
+            return boost::none;
+        }
+    }
+
+    // Calls 'fn' with each value of 'field' in the selected measurements.
+    auto forEachValue = [&](const std::string& field, auto&& fn) {
+        auto& values = column(field);
+        if (!_bucketLevelFilter) {
+            if (auto doubles = values.doubles()) {
+                for (auto&& value : *doubles) {
+                    if (value) {
+                        fn(Value{*value});
+                    }
+                }
+                return;
+            }
+            for (auto&& elem : values.elements()) {
+                if (!elem.eoo()) {
+                    fn(Value{elem});
+                }
+            }
+            return;
+        }
+
+        auto&& elements = values.elements();
+        for (auto idx : selected) {
+            if (!elements[idx].eoo()) {
+                fn(Value{elements[idx]});
+            }
+        }
+    };
+
+    MutableDocument aggregates;
+    if (hasMeta) {
+        aggregates.addField(*spec.metaField(), Value{metaElem});
+    }
+
+    for (auto&& acc : *_bucketLevelAccumulators) {
+        Value result;
+        switch (acc.op) {
+            case BucketLevelAccumulator::Op::kCount:
+                result = Value{_bucketLevelFilter ? static_cast<int>(selected.size())
+                                                  : measurementCount};
+                break;
+            case BucketLevelAccumulator::Op::kCountNumeric: {
+                int count = 0;
+                forEachValue(acc.inputField, [&](const Value& value) { count += value.numeric(); });
+                result = Value{count};
+                break;
+            }
+            case BucketLevelAccumulator::Op::kSum: {
+                // The partial sums are merged without being rounded, so that the rewrite returns
+                // the same sum as accumulating every measurement would.
+                AccumulatorSum state(pExpCtx.get());
+                forEachValue(acc.inputField,
+                             [&](const Value& value) { state.process(value, false); });
+                result = state.getUnroundedValueToBeMerged();
+                break;
+            }
+            default: {
+                auto state = makeBucketLevelAccumulatorState(acc.op, pExpCtx.get());
+                forEachValue(acc.inputField,
+                             [&](const Value& value) { state->process(value, false); });
+                result = state->getValue(false);
+                break;
+            }
+        }
+
+        if (!result.missing()) {
+            aggregates.addField(acc.outputField, std::move(result));
+        }
+    }
+    return aggregates.freeze();
+}
+
+bool DocumentSourceInternalUnpackBucket::rewriteGroupToBucketLevelAggregation(
+    Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
+    const auto& spec = _bucketUnpacker.bucketSpec();
+    if (_bucketLevelAccumulators || _sampleSize || !spec.computedMetaProjFields().empty()) {
+        return false;
+    }
+
+    auto groupItr = std::next(itr);
+    auto match = dynamic_cast<DocumentSourceMatch*>(groupItr->get());
+    if (match && ++groupItr == container->end()) {
+        return false;
+    }
+    auto group = dynamic_cast<DocumentSourceGroup*>(groupItr->get());
+    if (!group || group->doingMerge()) {
+        return false;
+    }
+
+    // Returns true if the measurements produced by this stage include the top-level 'field'.
+    auto isUnpacked = [&](StringData field) {
+        if (spec.metaField() && field == *spec.metaField()) {
+            return _bucketUnpacker.includeMetaField();
+        }
+        if (field == spec.timeField()) {
+            return _bucketUnpacker.includeTimeField();
+        }
+        auto inFieldSet = spec.fieldSet().count(field.toString()) > 0;
+        return _bucketUnpacker.behavior() == BucketUnpacker::Behavior::kInclude ? inFieldSet
+                                                                                : !inFieldSet;
+    };
+
+    // Every measurement of a bucket has the same metaField, so the group key must depend on nothing
+    // else.
+    DepsTracker idDeps;
+    for (auto&& idField : group->getIdFields()) {
+        idField.second->addDependencies(&idDeps);
+    }
+    if (idDeps.needWholeDocument || idDeps.getNeedsAnyMetadata()) {
+        return false;
+    }
+    for (auto&& path : idDeps.fields) {
+        if (!spec.metaField() || FieldPath(path).getFieldName(0) != *spec.metaField() ||
+            !isUnpacked(*spec.metaField())) {
+            return false;
+        }
+    }
+
+    BSONObj filter;
+    if (match) {
+        DepsTracker matchDeps;
+        match->getDependencies(&matchDeps);
+        if (matchDeps.needWholeDocument || matchDeps.getNeedsAnyMetadata()) {
+            return false;
+        }
+        for (auto&& path : matchDeps.fields) {
+            if (!isUnpacked(FieldPath(path).getFieldName(0))) {
+                return false;
+            }
+        }
+        filter = match->getQuery();
+    }
+
+    // The partial aggregates are stored next to the metaField and the helper fields of $avg next
+    // to the output fields, so all of these names must be distinct.
+    std::set<std::string> fieldNames;
+    if (spec.metaField()) {
+        fieldNames.insert(*spec.metaField());
+    }
+    auto addFieldName = [&](const std::string& name) {
+        return fieldNames.insert(name).second;
+    };
+
+    std::vector<BucketLevelAccumulator> accumulators;
+    BSONObjBuilder mergeGroupSpec;
+    mergeGroupSpec.append(group->serialize().getDocument().toBson().firstElement().Obj()["_id"]);
+    BSONObjBuilder avgFields;
+    BSONObjBuilder avgCountFields;
+    for (auto&& stmt : group->getAccumulatedFields()) {
+        const auto& op = stmt.expr.name;
+        const auto* argument = stmt.expr.argument.get();
+        if (!addFieldName(stmt.fieldName)) {
+            return false;
+        }
+
+        // A count, as produced by {$count: ...} or {$sum: 1}.
+        if (auto constant = dynamic_cast<const ExpressionConstant*>(argument);
+            constant && op == AccumulatorSum::kName) {
+            if (constant->getValue().getType() != BSONType::NumberInt ||
+                constant->getValue().getInt() != 1) {
+                return false;
+            }
+            accumulators.push_back({stmt.fieldName, BucketLevelAccumulator::Op::kCount, ""});
+            mergeGroupSpec.append(stmt.fieldName,
+                                  BSON(AccumulatorSum::kName << "$" + stmt.fieldName));
+            continue;
+        }
+
+        // Otherwise the argument must be a top-level measurement field other than the metaField.
+        auto path = dynamic_cast<const ExpressionFieldPath*>(argument);
+        if (!path || path->isVariableReference() || path->getFieldPath().getPathLength() != 2) {
+            return false;
+        }
+        auto field = path->getFieldPath().getFieldName(1).toString();
+        if ((spec.metaField() && field == *spec.metaField()) || !isUnpacked(field)) {
+            return false;
+        }
+
+        if (op == AccumulatorSum::kName || op == AccumulatorMin::kName ||
+            op == AccumulatorMax::kName) {
+            auto accOp = op == AccumulatorSum::kName ? BucketLevelAccumulator::Op::kSum
+                : op == AccumulatorMin::kName        ? BucketLevelAccumulator::Op::kMin
+                                                     : BucketLevelAccumulator::Op::kMax;
+            accumulators.push_back({stmt.fieldName, accOp, field});
+            mergeGroupSpec.append(stmt.fieldName, BSON(op << "$" + stmt.fieldName));
+        } else if (op == AccumulatorAvg::kName) {
+            // An average is rewritten into a sum and a count of the numeric values.
+            auto countField = kBucketLevelAvgCountPrefix.toString() + stmt.fieldName;
+            if (!addFieldName(countField)) {
+                return false;
+            }
+            accumulators.push_back({stmt.fieldName, BucketLevelAccumulator::Op::kSum, field});
+            accumulators.push_back(
+                {countField, BucketLevelAccumulator::Op::kCountNumeric, field});
+            mergeGroupSpec.append(stmt.fieldName,
+                                  BSON(AccumulatorSum::kName << "$" + stmt.fieldName));
+            mergeGroupSpec.append(countField, BSON(AccumulatorSum::kName << "$" + countField));
+            avgFields.append(
+                stmt.fieldName,
+                BSON("$cond" << BSON_ARRAY(BSON("$eq" << BSON_ARRAY("$" + countField << 0))
+                                           << BSONNULL
+                                           << BSON("$divide" << BSON_ARRAY("$" + stmt.fieldName
+                                                                           << "$" + countField)))));
+            avgCountFields.append(countField, false);
+        } else {
+            return false;
+        }
+    }
+
+    // The partial sums may be documents holding the unrounded total, which $sum only accepts when
+    // merging.
+    mergeGroupSpec.append("$doingMerge", true);
+
+    setBucketLevelAggregation(std::move(accumulators), filter);
+
+    // Replace the $match and $group with the $group merging the partial aggregates, followed by the
+    // stages computing the averages.
+    auto insertPos = container->erase(std::next(itr), std::next(groupItr));
+    container->insert(insertPos,
+                      DocumentSourceGroup::createFromBson(
+                          BSON("$group" << mergeGroupSpec.obj()).firstElement(), pExpCtx));
+    if (auto avgSpec = avgFields.obj(); !avgSpec.isEmpty()) {
+        container->insert(insertPos,
+                          DocumentSourceAddFields::createFromBson(
+                              BSON("$addFields" << avgSpec).firstElement(), pExpCtx));
+        container->insert(insertPos,
+                          DocumentSourceProject::createFromBson(
+                              BSON("$project" << avgCountFields.obj()).firstElement(), pExpCtx));
+    }
+    return true;
+}
+
 void addStagesToRetrieveEventLevelFields(Pipeline::SourceContainer& sources,
                                          const Pipeline::SourceContainer::const_iterator unpackIt,
                                          boost::intrusive_ptr<ExpressionContext> expCtx,
@@ -846,6 +1367,12 @@ Pipeline::SourceContainer::iterator DocumentSourceInternalUnpackBucket::doOptimi
         return container->end();
     }
 
+    // The stages after this one already consume partial aggregates rather than measurements, none
+    // of the rewrites below apply anymore.
+    if (_bucketLevelAccumulators) {
+        return std::next(itr);
+    }
+
     // Some optimizations may not be safe to do if we have computed the metaField via an $addFields
     // or a computed $project. We won't do those optimizations if 'haveComputedMetaField' is true.
     bool haveComputedMetaField = this->haveComputedMetaField();
@@ -1028,10 +1555,21 @@ Pipeline::SourceContainer::iterator DocumentSourceInternalUnpackBucket::doOptimi
         }
     }
 
+    // Attempt to compute the aggregates of a following $group per bucket, instead of unpacking.
+    if (feature_flags::gFeatureFlagTimeseriesBucketLevelAggregation.isEnabled(
+            serverGlobalParams.featureCompatibility) &&
+        rewriteGroupToBucketLevelAggregation(itr, container)) {
+        // Give the new $group a chance to optimize.
+        return std::next(itr);
+    }
+
     return container->end();
 }
 
 DocumentSource::GetModPathsReturn DocumentSourceInternalUnpackBucket::getModifiedPaths() const {
+    if (_bucketLevelAccumulators) {
+        return {GetModPathsReturn::Type::kAllPaths, std::set<std::string>{}, {}};
+    }
     if (_bucketUnpacker.includeMetaField()) {
         StringMap<std::string> renames;
         renames.emplace(*_bucketUnpacker.bucketSpec().metaField(),
@@ -45,6 +45,27 @@ public:
     static constexpr StringData kExclude = "exclude"_sd;
     static constexpr StringData kAssumeNoMixedSchemaData = "assumeNoMixedSchemaData"_sd;
     static constexpr StringData kBucketMaxSpanSeconds = "bucketMaxSpanSeconds"_sd;
+    static constexpr StringData kBucketLevelAggregation = "bucketLevelAggregation"_sd;
+
+    /**
+     * A partial aggregate computed over the measurements of each bucket when this stage runs in
+     * bucket-level aggregation mode. See 'rewriteGroupToBucketLevelAggregation()'.
+     */
+    struct BucketLevelAccumulator {
+        enum class Op {
+            kSum,
+            kMin,
+            kMax,
+            // The number of measurements, 'inputField' is empty.
+            kCount,
+            // The number of measurements with a numeric value for 'inputField'.
+            kCountNumeric,
+        };
+
+        std::string outputField;
+        Op op;
+        std::string inputField;
+    };
 
     static boost::intrusive_ptr<DocumentSource> createFromBsonInternal(
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx);
@@ -215,12 +236,58 @@ public:
     bool optimizeLastpoint(Pipeline::SourceContainer::iterator itr,
                            Pipeline::SourceContainer* container);
 
+    /**
+     * If the stage after $_internalUnpackBucket is a $group whose _id depends on nothing but the
+     * metaField, and whose accumulators are $sum, $min, $max or $avg of top-level measurement
+     * fields or a count, we can avoid building a document per measurement. This stage then reduces
+     * every bucket to one document holding the metaField and partial aggregates computed directly
+     * from the data columns, and the $group is rewritten to combine the partial aggregates. A
+     * $match on measurement fields between the two stages is evaluated against the data columns as
+     * well.
+     *
+     * Ex: user aggregation of
+     * [{_internalUnpackBucket: {...}},
+     *  {$match: {temp: {$gt: 0}}},
+     *  {$group: {_id: "$myMeta.sensor", avgTemp: {$avg: "$temp"}, n: {$sum: 1}}}]
+     *
+     * will be rewritten into:
+     * [{_internalUnpackBucket: {..., bucketLevelAggregation: {
+     *      accumulators: {avgTemp: {$sum: "temp"}, __count_avgTemp: {$countNumeric: "temp"},
+     *                     n: {$count: {}}},
+     *      filter: {temp: {$gt: 0}}}}},
+     *  {$group: {_id: "$myMeta.sensor", avgTemp: {$sum: "$avgTemp"},
+     *            __count_avgTemp: {$sum: "$__count_avgTemp"}, n: {$sum: "$n"}}},
+     *  {$addFields: {avgTemp: <"$avgTemp" divided by "$__count_avgTemp", or null if no values>}},
+     *  {$project: {__count_avgTemp: false}}]
+     *
+     * Returns true if 'container' was modified.
+     */
+    bool rewriteGroupToBucketLevelAggregation(Pipeline::SourceContainer::iterator itr,
+                                              Pipeline::SourceContainer* container);
+
+    bool isBucketLevelAggregation() const {
+        return _bucketLevelAccumulators.has_value();
+    }
+
     GetModPathsReturn getModifiedPaths() const final override;
 
 private:
     GetNextResult doGetNext() final;
     bool haveComputedMetaField() const;
 
+    /**
+     * Switches this stage to bucket-level aggregation mode, computing 'accumulators' for the
+     * measurements of each bucket which match 'filter'. An empty 'filter' matches everything.
+     */
+    void setBucketLevelAggregation(std::vector<BucketLevelAccumulator> accumulators,
+                                   BSONObj filter);
+
+    /**
+     * Computes the partial aggregates of 'bucket' in bucket-level aggregation mode. Returns
+     * boost::none if no measurement of the bucket matches the filter.
+     */
+    boost::optional<Document> computeBucketLevelAggregates(const BSONObj& bucket) const;
+
     // If buckets contained a mixed type schema along some path, we have to push down special
     // predicates in order to ensure correctness.
     bool _assumeNoMixedSchemaData = false;
@@ -236,5 +303,16 @@ private:
     bool _triedBucketLevelFieldsPredicatesPushdown = false;
     bool _optimizedEndOfPipeline = false;
     bool _triedInternalizeProject = false;
+
+    // Set when this stage runs in bucket-level aggregation mode. Instead of unpacking buckets into
+    // measurements, each bucket is then reduced to a single document with these partial aggregates.
+    boost::optional<std::vector<BucketLevelAccumulator>> _bucketLevelAccumulators;
+
+    // Filter applied to the measurements of a bucket before computing the partial aggregates, along
+    // with its BSON form and the top-level fields it reads. Only used in bucket-level aggregation
+    // mode.
+    std::unique_ptr<MatchExpression> _bucketLevelFilter;
+    BSONObj _bucketLevelFilterBson;
+    std::vector<std::string> _bucketLevelFilterFields;
 };
 }  // namespace mongo
@@ -0,0 +1,368 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/timeseries/bucket_compression.h"
+#include "mongo/idl/server_parameter_test_util.h"
+
+namespace mongo {
+namespace {
+
+class InternalUnpackBucketBucketLevelAggregationTest : public AggregationContextFixture {
+protected:
+    static constexpr auto kUnpackSpec =
+        "{$_internalUnpackBucket: {exclude: [], timeField: 'time', metaField: 'myMeta', "
+        "bucketMaxSpanSeconds: 3600}}";
+
+    /**
+     * Returns the buckets used by the execution tests. When 'compressed' is true, the buckets are
+     * compressed so that their data fields are BSONColumns.
+     */
+    std::vector<BSONObj> buckets(bool compressed) {
+        std::vector<BSONObj> buckets{
+            fromjson("{control: {version: 1, min: {time: {$date: 1000}, temp: 10, status: 'fail'}, "
+                     "max: {time: {$date: 3000}, temp: 30, status: 'ok'}}, meta: {sensor: 'a'}, "
+                     "data: {time: {'0': {$date: 1000}, '1': {$date: 2000}, '2': {$date: 3000}}, "
+                     "temp: {'0': 10, '1': 20.5, '2': 30}, status: {'0': 'ok', '2': 'fail'}}}"),
+            fromjson("{control: {version: 1, min: {time: {$date: 1000}, temp: -5, status: 'ok'}, "
+                     "max: {time: {$date: 2000}, temp: 'broken', status: 'ok'}}, "
+                     "meta: {sensor: 'b'}, "
+                     "data: {time: {'0': {$date: 1000}, '1': {$date: 2000}}, "
+                     "temp: {'0': -5, '1': 'broken'}, status: {'1': 'ok'}}}"),
+            fromjson("{control: {version: 1, min: {time: {$date: 4000}, temp: 2.25}, "
+                     "max: {time: {$date: 5000}, temp: 2.25}}, meta: {sensor: 'a'}, "
+                     "data: {time: {'0': {$date: 4000}, '1': {$date: 5000}}, "
+                     "temp: {'1': 2.25}}}"),
+            fromjson("{control: {version: 1, min: {time: {$date: 1000}, temp: 1.5}, "
+                     "max: {time: {$date: 3000}, temp: 3.5}}, meta: {sensor: 'c'}, "
+                     "data: {time: {'0': {$date: 1000}, '1': {$date: 2000}, '2': {$date: 3000}}, "
+                     "temp: {'0': 1.5, '1': 2.5, '2': 3.5}}}")};
+        if (compressed) {
+            for (auto& bucket : buckets) {
+                bucket = *timeseries::compressBucket(bucket, "time"_sd, {}, false).compressedBucket;
+            }
+        }
+        return buckets;
+    }
+
+    /**
+     * Optimizes and runs the pipeline made of 'kUnpackSpec' followed by 'stages' over 'buckets'.
+     * Sets 'rewritten' to whether the $_internalUnpackBucket stage computes bucket-level
+     * aggregates.
+     */
+    std::vector<Document> runPipeline(const std::vector<BSONObj>& stages,
+                                     const std::vector<BSONObj>& buckets,
+                                     bool* rewritten) {
+        std::vector<BSONObj> rawPipeline{fromjson(kUnpackSpec)};
+        rawPipeline.insert(rawPipeline.end(), stages.begin(), stages.end());
+        rawPipeline.push_back(fromjson("{$sort: {_id: 1}}"));
+        auto pipeline = Pipeline::parse(rawPipeline, getExpCtx());
+        pipeline->optimizePipeline();
+
+        *rewritten = false;
+        for (auto&& stage : pipeline->getSources()) {
+            if (auto unpack = dynamic_cast<DocumentSourceInternalUnpackBucket*>(stage.get())) {
+                *rewritten = unpack->isBucketLevelAggregation();
+            }
+        }
+
+        std::deque<DocumentSource::GetNextResult> inputs;
+        for (auto&& bucket : buckets) {
+            inputs.emplace_back(Document{bucket});
+        }
+        pipeline->addInitialSource(DocumentSourceMock::createForTest(inputs, getExpCtx()));
+
+        std::vector<Document> results;
+        while (auto next = pipeline->getNext()) {
+            results.push_back(*next);
+        }
+        return results;
+    }
+
+    /**
+     * Checks that the pipeline gets rewritten to compute bucket-level aggregates and that it
+     * returns the same results as when the measurements are unpacked.
+     */
+    void assertSameResultsAsUnpacking(const std::vector<BSONObj>& stages) {
+        for (auto compressed : {false, true}) {
+            bool rewritten = false;
+            std::vector<Document> expected;
+            {
+                RAIIServerParameterControllerForTest controller(
+                    "featureFlagTimeseriesBucketLevelAggregation", false);
+                expected = runPipeline(stages, buckets(compressed), &rewritten);
+                ASSERT_FALSE(rewritten);
+            }
+
+            RAIIServerParameterControllerForTest controller(
+                "featureFlagTimeseriesBucketLevelAggregation", true);
+            auto results = runPipeline(stages, buckets(compressed), &rewritten);
+            ASSERT_TRUE(rewritten);
+            ASSERT_EQ(expected.size(), results.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                ASSERT_DOCUMENT_EQ(expected[i], results[i]);
+            }
+        }
+    }
+};
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, OptimizeGroupOnMeta) {
+    RAIIServerParameterControllerForTest controller("featureFlagTimeseriesBucketLevelAggregation",
+                                                    true);
+    auto unpackSpecObj = fromjson(
+        "{$_internalUnpackBucket: {include: ['a', 'b', 'meta'], metaField: 'meta', timeField: 't', "
+        "bucketMaxSpanSeconds: 3600}}");
+    auto groupSpecObj =
+        fromjson("{$group: {_id: '$meta.x', s: {$sum: '$a'}, lo: {$min: '$b'}, n: {$sum: 1}}}");
+
+    auto pipeline = Pipeline::parse(makeVector(unpackSpecObj, groupSpecObj), getExpCtx());
+    pipeline->optimizePipeline();
+
+    auto serialized = pipeline->serializeToBson();
+    ASSERT_EQ(2, serialized.size());
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{$_internalUnpackBucket: {include: ['a', 'b', 'meta'], timeField: 't', "
+                 "metaField: 'meta', bucketMaxSpanSeconds: 3600, bucketLevelAggregation: "
+                 "{accumulators: {s: {$sum: 'a'}, lo: {$min: 'b'}, n: {$count: {}}}}}}"),
+        serialized[0]);
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{$group: {_id: '$meta.x', s: {$sum: '$s'}, lo: {$min: '$lo'}, n: {$sum: '$n'}, "
+                 "$doingMerge: true}}"),
+        serialized[1]);
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, OptimizeAvgIntoSumAndCount) {
+    RAIIServerParameterControllerForTest controller("featureFlagTimeseriesBucketLevelAggregation",
+                                                    true);
+    auto unpackSpecObj = fromjson(
+        "{$_internalUnpackBucket: {include: ['a'], timeField: 't', bucketMaxSpanSeconds: 3600}}");
+    auto groupSpecObj = fromjson("{$group: {_id: null, avg: {$avg: '$a'}}}");
+
+    auto pipeline = Pipeline::parse(makeVector(unpackSpecObj, groupSpecObj), getExpCtx());
+    pipeline->optimizePipeline();
+
+    auto serialized = pipeline->serializeToBson();
+    ASSERT_EQ(4, serialized.size());
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{$_internalUnpackBucket: {include: ['a'], timeField: 't', "
+                 "bucketMaxSpanSeconds: 3600, bucketLevelAggregation: {accumulators: "
+                 "{avg: {$sum: 'a'}, __count_avg: {$countNumeric: 'a'}}}}}"),
+        serialized[0]);
+    ASSERT_BSONOBJ_EQ(fromjson("{$group: {_id: {$const: null}, avg: {$sum: '$avg'}, "
+                               "__count_avg: {$sum: '$__count_avg'}, $doingMerge: true}}"),
+                      serialized[1]);
+    ASSERT_EQ("$addFields"_sd, serialized[2].firstElementFieldNameStringData());
+    ASSERT_EQ("$project"_sd, serialized[3].firstElementFieldNameStringData());
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, OptimizeAbsorbsMatchOnMeasurements) {
+    RAIIServerParameterControllerForTest controller("featureFlagTimeseriesBucketLevelAggregation",
+                                                    true);
+    auto unpackSpecObj = fromjson(
+        "{$_internalUnpackBucket: {include: ['a', 'meta'], metaField: 'meta', timeField: 't', "
+        "bucketMaxSpanSeconds: 3600}}");
+    auto matchSpecObj = fromjson("{$match: {a: {$gt: 1}}}");
+    auto groupSpecObj = fromjson("{$group: {_id: '$meta', s: {$sum: '$a'}}}");
+
+    auto pipeline =
+        Pipeline::parse(makeVector(unpackSpecObj, matchSpecObj, groupSpecObj), getExpCtx());
+    pipeline->optimizePipeline();
+
+    // The predicate on the control fields is still pushed before the unpacking, while the
+    // measurement-level $match is evaluated as part of the bucket-level aggregation.
+    auto serialized = pipeline->serializeToBson();
+    ASSERT_EQ(3, serialized.size());
+    ASSERT_EQ("$match"_sd, serialized[0].firstElementFieldNameStringData());
+    ASSERT_BSONOBJ_EQ(
+        fromjson("{$_internalUnpackBucket: {include: ['a', 'meta'], timeField: 't', "
+                 "metaField: 'meta', bucketMaxSpanSeconds: 3600, bucketLevelAggregation: "
+                 "{accumulators: {s: {$sum: 'a'}}, filter: {a: {$gt: 1}}}}}"),
+        serialized[1]);
+    ASSERT_BSONOBJ_EQ(fromjson("{$group: {_id: '$meta', s: {$sum: '$s'}, $doingMerge: true}}"),
+                      serialized[2]);
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, OptimizeNegative) {
+    RAIIServerParameterControllerForTest controller("featureFlagTimeseriesBucketLevelAggregation",
+                                                    true);
+    auto unpackSpecObj = fromjson(
+        "{$_internalUnpackBucket: {include: ['a', 'b', 'meta'], metaField: 'meta', timeField: 't', "
+        "bucketMaxSpanSeconds: 3600}}");
+    for (auto&& groupSpecObj : {
+             // Grouping on a measurement field.
+             fromjson("{$group: {_id: '$a', s: {$sum: '$b'}}}"),
+             // Unsupported accumulator.
+             fromjson("{$group: {_id: '$meta', p: {$push: '$a'}}}"),
+             // Accumulating a nested field.
+             fromjson("{$group: {_id: '$meta', s: {$sum: '$a.b'}}}"),
+             // Accumulating an expression.
+             fromjson("{$group: {_id: '$meta', s: {$sum: {$add: ['$a', '$b']}}}}"),
+             // Summing a constant other than 1.
+             fromjson("{$group: {_id: '$meta', s: {$sum: 2}}}"),
+             // An output field with the name of the metaField.
+             fromjson("{$group: {_id: null, meta: {$sum: '$a'}}}"),
+         }) {
+        auto pipeline = Pipeline::parse(makeVector(unpackSpecObj, groupSpecObj), getExpCtx());
+        pipeline->optimizePipeline();
+
+        auto unpack =
+            dynamic_cast<DocumentSourceInternalUnpackBucket*>(pipeline->getSources().front().get());
+        ASSERT(unpack);
+        ASSERT_FALSE(unpack->isBucketLevelAggregation()) << groupSpecObj;
+    }
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, NotOptimizedWhenFeatureFlagIsDisabled) {
+    RAIIServerParameterControllerForTest controller("featureFlagTimeseriesBucketLevelAggregation",
+                                                    false);
+    auto unpackSpecObj = fromjson(
+        "{$_internalUnpackBucket: {include: ['a', 'meta'], timeField: 't', metaField: 'meta', "
+        "bucketMaxSpanSeconds: 3600}}");
+    auto groupSpecObj = fromjson("{$group: {_id: '$meta', s: {$sum: '$a'}}}");
+
+    auto pipeline = Pipeline::parse(makeVector(unpackSpecObj, groupSpecObj), getExpCtx());
+    pipeline->optimizePipeline();
+
+    auto serialized = pipeline->serializeToBson();
+    ASSERT_EQ(2, serialized.size());
+    ASSERT_BSONOBJ_EQ(unpackSpecObj, serialized[0]);
+    ASSERT_BSONOBJ_EQ(groupSpecObj, serialized[1]);
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, ParseAndSerializeRoundTrip) {
+    auto spec = fromjson(
+        "{$_internalUnpackBucket: {exclude: [], timeField: 't', metaField: 'meta', "
+        "bucketMaxSpanSeconds: 3600, bucketLevelAggregation: {accumulators: {s: {$sum: 'a'}, "
+        "lo: {$min: 'a'}, hi: {$max: 'b'}, n: {$count: {}}, c: {$countNumeric: 'a'}}, "
+        "filter: {b: {$gt: 1}}}}}");
+    auto unpack = DocumentSourceInternalUnpackBucket::createFromBsonInternal(spec.firstElement(),
+                                                                             getExpCtx());
+    std::vector<Value> serialized;
+    unpack->serializeToArray(serialized);
+    ASSERT_EQ(1, serialized.size());
+    ASSERT_BSONOBJ_EQ(spec, serialized[0].getDocument().toBson());
+
+    auto badSpec = fromjson(
+        "{$_internalUnpackBucket: {exclude: [], timeField: 't', bucketMaxSpanSeconds: 3600, "
+        "bucketLevelAggregation: {accumulators: {s: {$avg: 'a'}}}}}");
+    ASSERT_THROWS_CODE(DocumentSourceInternalUnpackBucket::createFromBsonInternal(
+                           badSpec.firstElement(), getExpCtx()),
+                       AssertionException,
+                       6708004);
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, ComputesPartialAggregatesPerBucket) {
+    auto spec = fromjson(
+        "{$_internalUnpackBucket: {exclude: [], timeField: 'time', metaField: 'myMeta', "
+        "bucketMaxSpanSeconds: 3600, bucketLevelAggregation: {accumulators: {s: {$sum: 'temp'}, "
+        "hi: {$max: 'temp'}, n: {$count: {}}, c: {$countNumeric: 'temp'}}, "
+        "filter: {status: 'ok'}}}}");
+
+    for (auto compressed : {false, true}) {
+        auto unpack = DocumentSourceInternalUnpackBucket::createFromBsonInternal(
+            spec.firstElement(), getExpCtx());
+        std::deque<DocumentSource::GetNextResult> inputs;
+        for (auto&& bucket : buckets(compressed)) {
+            inputs.emplace_back(Document{bucket});
+        }
+        auto source = DocumentSourceMock::createForTest(inputs, getExpCtx());
+        unpack->setSource(source.get());
+
+        // The buckets where no measurement matches the filter are skipped.
+        auto next = unpack->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(
+            next.getDocument(),
+            Document(fromjson("{myMeta: {sensor: 'a'}, s: 10, hi: 10, n: 1, c: 1}")));
+
+        next = unpack->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_DOCUMENT_EQ(
+            next.getDocument(),
+            Document(fromjson("{myMeta: {sensor: 'b'}, s: 0, hi: 'broken', n: 1, c: 0}")));
+
+        ASSERT_TRUE(unpack->getNext().isEOF());
+    }
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, GroupOnMeta) {
+    assertSameResultsAsUnpacking({fromjson(
+        "{$group: {_id: '$myMeta.sensor', total: {$sum: '$temp'}, lo: {$min: '$temp'}, "
+        "hi: {$max: '$temp'}, avg: {$avg: '$temp'}, n: {$sum: 1}}}")});
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, GroupAfterMatchOnMeasurements) {
+    assertSameResultsAsUnpacking(
+        {fromjson("{$match: {temp: {$gt: 0}}}"),
+         fromjson("{$group: {_id: '$myMeta', total: {$sum: '$temp'}, avg: {$avg: '$temp'}}}")});
+    assertSameResultsAsUnpacking(
+        {fromjson("{$match: {status: 'ok'}}"),
+         fromjson("{$group: {_id: null, n: {$sum: 1}, avg: {$avg: '$temp'}}}")});
+    assertSameResultsAsUnpacking(
+        {fromjson("{$match: {time: {$gte: {$date: 2000}}, 'myMeta.sensor': {$ne: 'c'}}}"),
+         fromjson("{$group: {_id: '$myMeta.sensor', hi: {$max: '$time'}, n: {$sum: 1}}}")});
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, SumOfDoublesIsNotRoundedPerBucket) {
+    // Rounding the sum of the first bucket to a double would lose the 1.
+    const std::vector<BSONObj> buckets{
+        BSON("control" << BSON("version" << 1) << "meta" << BSON("sensor"
+                                                                 << "a")
+                       << "data"
+                       << BSON("time" << BSON("0" << Date_t::fromMillisSinceEpoch(1000) << "1"
+                                                  << Date_t::fromMillisSinceEpoch(2000))
+                                      << "temp" << BSON("0" << 1e16 << "1" << 1.0))),
+        BSON("control" << BSON("version" << 1) << "meta" << BSON("sensor"
+                                                                 << "a")
+                       << "data"
+                       << BSON("time" << BSON("0" << Date_t::fromMillisSinceEpoch(3000))
+                                      << "temp" << BSON("0" << -1e16)))};
+    const std::vector<BSONObj> stages{fromjson("{$group: {_id: null, total: {$sum: '$temp'}}}")};
+
+    bool rewritten = false;
+    RAIIServerParameterControllerForTest controller("featureFlagTimeseriesBucketLevelAggregation",
+                                                    true);
+    auto results = runPipeline(stages, buckets, &rewritten);
+    ASSERT_TRUE(rewritten);
+    ASSERT_EQ(1, results.size());
+    ASSERT_DOCUMENT_EQ(Document(BSON("_id" << BSONNULL << "total" << 1.0)), results[0]);
+}
+
+TEST_F(InternalUnpackBucketBucketLevelAggregationTest, Count) {
+    assertSameResultsAsUnpacking({fromjson("{$count: 'n'}")});
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,235 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/ce/array_histogram.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/bson/dotted_path_support.h"
+
+namespace mongo::ce {
+namespace {
+using SBEValue = std::pair<sbe::value::TypeTags, sbe::value::Value>;
+
+constexpr auto kDocumentsField = "documents"_sd;
+constexpr auto kMissingField = "missing"_sd;
+constexpr auto kArrayCountField = "arrayCount"_sd;
+constexpr auto kEmptyArrayCountField = "emptyArrayCount"_sd;
+constexpr auto kTypeCountsField = "typeCounts"_sd;
+constexpr auto kScalarHistogramField = "scalarHistogram"_sd;
+constexpr auto kArrayUniqueHistogramField = "arrayUniqueHistogram"_sd;
+
+int compareToNull(const SBEValue& value) {
+    const auto [tag, val] =
+        sbe::value::compareValue(value.first, value.second, sbe::value::TypeTags::Null, 0);
+    uassert(6705006, "Interval bound must be comparable", tag == sbe::value::TypeTags::NumberInt32);
+    return sbe::value::bitcastTo<int32_t>(val);
+}
+
+/**
+ * Returns whether the interval between the given bounds contains null.
+ */
+bool intervalContainsNull(const boost::optional<SBEValue>& low,
+                          bool lowInclusive,
+                          const boost::optional<SBEValue>& high,
+                          bool highInclusive) {
+    if (low) {
+        const int cmp = compareToNull(*low);
+        if (cmp > 0 || (cmp == 0 && !lowInclusive)) {
+            return false;
+        }
+    }
+    if (high) {
+        const int cmp = compareToNull(*high);
+        if (cmp < 0 || (cmp == 0 && !highInclusive)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double getCount(const BSONObj& obj, StringData field) {
+    const auto elem = obj[field];
+    uassert(6705007,
+            str::stream() << "Invalid statistics field '" << field << "': " << obj,
+            elem.isNumber() && elem.numberDouble() >= 0);
+    return elem.numberDouble();
+}
+
+BSONObj getHistogramObj(const BSONObj& obj, StringData field) {
+    const auto elem = obj[field];
+    uassert(6705008,
+            str::stream() << "Invalid statistics field '" << field << "': " << obj,
+            elem.type() == Object);
+    return elem.Obj();
+}
+}  // namespace
+
+ArrayHistogram::ArrayHistogram(ScalarHistogram scalar,
+                               ScalarHistogram arrayUnique,
+                               TypeCounts typeCounts,
+                               double documents,
+                               double missing,
+                               double arrayCount,
+                               double emptyArrayCount)
+    : _scalar(std::move(scalar)),
+      _arrayUnique(std::move(arrayUnique)),
+      _typeCounts(std::move(typeCounts)),
+      _documents(documents),
+      _missing(missing),
+      _arrayCount(arrayCount),
+      _emptyArrayCount(emptyArrayCount) {}
+
+ArrayHistogram::Builder::Builder(StringData path) : _path(path.toString()) {}
+
+void ArrayHistogram::Builder::addDocument(const BSONObj& doc) {
+    ++_documents;
+
+    BSONElementSet elements;
+    MultikeyComponents arrayComponents;
+    dotted_path_support::extractAllElementsAlongPath(
+        doc, _path, elements, true /* expandArrayOnTrailingField */, &arrayComponents);
+
+    for (auto&& elem : elements) {
+        _typeCounts[elem.type()] += 1;
+    }
+
+    if (arrayComponents.empty()) {
+        // Without arrays along the path there is at most one value.
+        if (elements.empty()) {
+            ++_missing;
+        } else {
+            _scalarValues.push_back(elements.begin()->wrap(""));
+        }
+        return;
+    }
+
+    ++_arrayCount;
+    if (elements.empty()) {
+        ++_emptyArrayCount;
+        return;
+    }
+
+    BSONObjBuilder valuesBuilder;
+    for (auto&& elem : elements) {
+        valuesBuilder.appendAs(elem, "");
+    }
+    _arrayUniqueValues.push_back(valuesBuilder.obj());
+}
+
+ArrayHistogram ArrayHistogram::Builder::done(size_t numBuckets) const {
+    std::vector<BSONElement> scalarValues;
+    scalarValues.reserve(_scalarValues.size());
+    for (auto&& values : _scalarValues) {
+        scalarValues.push_back(values.firstElement());
+    }
+
+    std::vector<BSONElement> arrayUniqueValues;
+    for (auto&& values : _arrayUniqueValues) {
+        for (auto&& elem : values) {
+            arrayUniqueValues.push_back(elem);
+        }
+    }
+
+    return {ScalarHistogram::make(std::move(scalarValues), numBuckets),
+            ScalarHistogram::make(std::move(arrayUniqueValues), numBuckets),
+            _typeCounts,
+            _documents,
+            _missing,
+            _arrayCount,
+            _emptyArrayCount};
+}
+
+ArrayHistogram ArrayHistogram::make(const std::vector<BSONObj>& docs,
+                                    StringData path,
+                                    size_t numBuckets) {
+    Builder builder(path);
+    for (auto&& doc : docs) {
+        builder.addDocument(doc);
+    }
+    return builder.done(numBuckets);
+}
+
+ArrayHistogram ArrayHistogram::parse(const BSONObj& obj) {
+    TypeCounts typeCounts;
+    for (auto&& elem : getHistogramObj(obj, kTypeCountsField)) {
+        const auto type = findBSONTypeAlias(elem.fieldNameStringData());
+        uassert(6705009,
+                str::stream() << "Invalid type in statistics: " << elem.fieldNameStringData(),
+                type && elem.isNumber());
+        typeCounts[*type] = elem.numberDouble();
+    }
+
+    return {ScalarHistogram::parse(getHistogramObj(obj, kScalarHistogramField)),
+            ScalarHistogram::parse(getHistogramObj(obj, kArrayUniqueHistogramField)),
+            std::move(typeCounts),
+            getCount(obj, kDocumentsField),
+            getCount(obj, kMissingField),
+            getCount(obj, kArrayCountField),
+            getCount(obj, kEmptyArrayCountField)};
+}
+
+BSONObj ArrayHistogram::serialize() const {
+    BSONObjBuilder builder;
+    builder.append(kDocumentsField, _documents);
+    builder.append(kMissingField, _missing);
+    builder.append(kArrayCountField, _arrayCount);
+    builder.append(kEmptyArrayCountField, _emptyArrayCount);
+
+    BSONObjBuilder typeCountsBuilder(builder.subobjStart(kTypeCountsField));
+    for (auto&& [type, count] : _typeCounts) {
+        typeCountsBuilder.append(typeName(type), count);
+    }
+    typeCountsBuilder.doneFast();
+
+    builder.append(kScalarHistogramField, _scalar.serialize());
+    builder.append(kArrayUniqueHistogramField, _arrayUnique.serialize());
+    return builder.obj();
+}
+
+double ArrayHistogram::estimateInterval(const boost::optional<SBEValue>& low,
+                                        bool lowInclusive,
+                                        const boost::optional<SBEValue>& high,
+                                        bool highInclusive) const {
+    double result = _scalar.estimateInterval(low, lowInclusive, high, highInclusive);
+
+    // An array document matches once no matter how many of its values fall in the interval, and
+    // empty arrays never match.
+    result += std::min(_arrayUnique.estimateInterval(low, lowInclusive, high, highInclusive),
+                       _arrayCount - _emptyArrayCount);
+
+    if (intervalContainsNull(low, lowInclusive, high, highInclusive)) {
+        result += _missing;
+    }
+
+    return std::min(result, _documents);
+}
+
+}  // namespace mongo::ce
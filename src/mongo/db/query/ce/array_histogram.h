@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/db/query/ce/scalar_histogram.h"
+
+namespace mongo::ce {
+
+/**
+ * Number of values of each BSON type found along a path.
+ */
+using TypeCounts = std::map<BSONType, double>;
+
+/**
+ * The statistics of one path of a collection. The values found along the path are split by the
+ * shape of the documents they come from:
+ *  - documents holding a single value along the path feed the scalar histogram;
+ *  - documents reaching arrays along the path feed the array histogram, which counts each distinct
+ *    value once per document, the way a multikey predicate matches them.
+ * The documents without any value along the path are counted as missing, or as empty arrays when
+ * the path traversed an array.
+ */
+class ArrayHistogram {
+public:
+    /**
+     * Accumulates the statistics of one path one document at a time. Only the values found along
+     * the path are kept, so that the documents can be discarded as soon as they were added.
+     */
+    class Builder {
+    public:
+        explicit Builder(StringData path);
+
+        void addDocument(const BSONObj& doc);
+
+        /**
+         * Builds the statistics of the documents added so far, with histograms of at most
+         * 'numBuckets' buckets.
+         */
+        ArrayHistogram done(size_t numBuckets) const;
+
+    private:
+        std::string _path;
+
+        // Owned copies of the values found along the path, one object per document holding
+        // them, split by whether an array was traversed.
+        std::vector<BSONObj> _scalarValues;
+        std::vector<BSONObj> _arrayUniqueValues;
+
+        TypeCounts _typeCounts;
+        double _documents{0};
+        double _missing{0};
+        double _arrayCount{0};
+        double _emptyArrayCount{0};
+    };
+
+    ArrayHistogram() = default;
+    ArrayHistogram(ScalarHistogram scalar,
+                   ScalarHistogram arrayUnique,
+                   TypeCounts typeCounts,
+                   double documents,
+                   double missing,
+                   double arrayCount,
+                   double emptyArrayCount);
+
+    /**
+     * Builds the statistics of the dotted 'path' over 'docs', with histograms of at most
+     * 'numBuckets' buckets.
+     */
+    static ArrayHistogram make(const std::vector<BSONObj>& docs,
+                               StringData path,
+                               size_t numBuckets);
+
+    /**
+     * Parses statistics serialized by 'serialize()'. Throws if 'obj' is malformed.
+     */
+    static ArrayHistogram parse(const BSONObj& obj);
+
+    BSONObj serialize() const;
+
+    /**
+     * Estimates the number of documents with a value along the path in the interval between the
+     * given bounds, following the MQL semantics where a null bound also matches missing values. A
+     * missing bound stands for an unbounded side of the interval.
+     */
+    double estimateInterval(
+        const boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>>& low,
+        bool lowInclusive,
+        const boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>>& high,
+        bool highInclusive) const;
+
+    const ScalarHistogram& getScalar() const {
+        return _scalar;
+    }
+
+    const ScalarHistogram& getArrayUnique() const {
+        return _arrayUnique;
+    }
+
+    const TypeCounts& getTypeCounts() const {
+        return _typeCounts;
+    }
+
+    double getDocuments() const {
+        return _documents;
+    }
+
+    double getMissing() const {
+        return _missing;
+    }
+
+    double getArrayCount() const {
+        return _arrayCount;
+    }
+
+    double getEmptyArrayCount() const {
+        return _emptyArrayCount;
+    }
+
+private:
+    ScalarHistogram _scalar;
+    ScalarHistogram _arrayUnique;
+    TypeCounts _typeCounts;
+
+    // Number of documents the statistics were built from.
+    double _documents{0};
+
+    // Number of documents without the path.
+    double _missing{0};
+
+    // Number of documents with an array along the path, and how many of them hold no values.
+    double _arrayCount{0};
+    double _emptyArrayCount{0};
+};
+
+}  // namespace mongo::ce
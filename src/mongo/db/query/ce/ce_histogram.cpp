@@ -0,0 +1,255 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/ce/ce_histogram.h"
+
+#include "mongo/db/query/ce/stats_cache.h"
+#include "mongo/db/query/optimizer/cascades/ce_heuristic.h"
+#include "mongo/db/query/optimizer/utils/memo_utils.h"
+
+namespace mongo::optimizer::cascades {
+
+using namespace properties;
+
+namespace {
+using SBEValue = std::pair<sbe::value::TypeTags, sbe::value::Value>;
+
+// Selectivity of a requirement which cannot be estimated from statistics. Matches the selectivity
+// the heuristic estimation assigns to a filter.
+constexpr SelectivityType kDefaultSelectivity = 0.1;
+
+/**
+ * Converts a requirement path into the dotted path the statistics are keyed by. Only paths which
+ * traverse arrays at every step, the way the statistics are collected, are supported.
+ */
+boost::optional<std::string> getDottedPath(const ABT& path) {
+    std::string result;
+    const ABT* current = &path;
+    while (!current->is<PathIdentity>()) {
+        const auto get = current->cast<PathGet>();
+        if (get == nullptr) {
+            return boost::none;
+        }
+        const auto traverse = get->getPath().cast<PathTraverse>();
+        if (traverse == nullptr) {
+            return boost::none;
+        }
+
+        if (!result.empty()) {
+            result += '.';
+        }
+        result += get->name();
+        current = &traverse->getPath();
+    }
+
+    if (result.empty()) {
+        return boost::none;
+    }
+    return result;
+}
+
+/**
+ * Returns the constant value of 'bound', boost::none for an infinite bound, or fails if the bound
+ * is not known at optimization time.
+ */
+bool getBoundValue(const BoundRequirement& bound, boost::optional<SBEValue>& value) {
+    if (bound.isInfinite()) {
+        value = boost::none;
+        return true;
+    }
+
+    const auto constant = bound.getBound().cast<Constant>();
+    if (constant == nullptr) {
+        return false;
+    }
+
+    const auto [tag, val] = constant->get();
+    if (tag == sbe::value::TypeTags::Nothing || sbe::value::isArray(tag)) {
+        // Arrays are matched as a whole, which the statistics of individual values cannot answer.
+        return false;
+    }
+    value = SBEValue{tag, val};
+    return true;
+}
+}  // namespace
+
+class CEHistogramTransportImpl {
+public:
+    CEHistogramTransportImpl(OperationContext* opCtx) : _opCtx(opCtx), _heuristicCE() {}
+
+    CEType transport(const ABT& n,
+                     const SargableNode& node,
+                     const Memo& memo,
+                     const LogicalProps& logicalProps,
+                     CEType childResult,
+                     CEType /*bindResult*/,
+                     CEType /*refsResult*/) {
+        if (!hasProperty<IndexingAvailability>(logicalProps)) {
+            return _heuristicCE.deriveCE(memo, logicalProps, n.ref());
+        }
+
+        const auto& indexingAvailability = getPropertyConst<IndexingAvailability>(logicalProps);
+        const auto& scanDef =
+            memo.getMetadata()._scanDefs.at(indexingAvailability.getScanDefName());
+        const auto collection = getCollection(scanDef);
+
+        // Estimate individual requirements separately, assuming they are independent.
+        CEType result = childResult;
+        for (const auto& [key, req] : node.getReqMap()) {
+            if (isIntervalReqFullyOpenDNF(req.getIntervals())) {
+                continue;
+            }
+
+            std::shared_ptr<const ce::ArrayHistogram> histogram;
+            if (collection && key._projectionName == indexingAvailability.getScanProjection()) {
+                if (auto path = getDottedPath(key._path)) {
+                    histogram = ce::StatsCache::get(_opCtx).getHistogram(
+                        _opCtx, collection->first, collection->second, *path);
+                }
+            }
+
+            result *= histogram ? estimateIntervals(*histogram, req.getIntervals())
+                                : kDefaultSelectivity;
+        }
+
+        return result;
+    }
+
+    /**
+     * Other ABT types.
+     */
+    template <typename T, typename... Ts>
+    CEType transport(const ABT& n,
+                     const T& /*node*/,
+                     const Memo& memo,
+                     const LogicalProps& logicalProps,
+                     Ts&&...) {
+        if (canBeLogicalNode<T>()) {
+            return _heuristicCE.deriveCE(memo, logicalProps, n.ref());
+        }
+        return 0.0;
+    }
+
+    CEType derive(const Memo& memo,
+                  const properties::LogicalProps& logicalProps,
+                  const ABT::reference_type logicalNodeRef) {
+        return algebra::transport<true>(logicalNodeRef, *this, memo, logicalProps);
+    }
+
+private:
+    /**
+     * Returns the namespace and UUID of the collection behind 'scanDef', if it exists.
+     */
+    static boost::optional<std::pair<NamespaceString, UUID>> getCollection(
+        const ScanDefinition& scanDef) {
+        const auto& options = scanDef.getOptionsMap();
+        const auto dbIt = options.find("database");
+        const auto collIt = options.find(ScanNode::kDefaultCollectionNameSpec);
+        const auto uuidIt = options.find("uuid");
+        if (dbIt == options.cend() || collIt == options.cend() || uuidIt == options.cend()) {
+            return boost::none;
+        }
+
+        auto uuid = UUID::parse(uuidIt->second);
+        if (!uuid.isOK()) {
+            return boost::none;
+        }
+        return std::make_pair(NamespaceString(dbIt->second, collIt->second), uuid.getValue());
+    }
+
+    /**
+     * Estimates the selectivity of intervals in disjunctive normal form: the selectivities of the
+     * intervals of a conjunction are multiplied, and those of a disjunction are added.
+     */
+    static SelectivityType estimateIntervals(const ce::ArrayHistogram& histogram,
+                                             const IntervalReqExpr::Node& intervals) {
+        const double documents = histogram.getDocuments();
+        if (documents <= 0) {
+            return kDefaultSelectivity;
+        }
+
+        const auto disjunction = intervals.cast<IntervalReqExpr::Disjunction>();
+        if (disjunction == nullptr) {
+            return kDefaultSelectivity;
+        }
+
+        SelectivityType disjunctionSel = 0.0;
+        for (const auto& conjunctionNode : disjunction->nodes()) {
+            const auto conjunction = conjunctionNode.cast<IntervalReqExpr::Conjunction>();
+            if (conjunction == nullptr) {
+                return kDefaultSelectivity;
+            }
+
+            SelectivityType conjunctionSel = 1.0;
+            for (const auto& atomNode : conjunction->nodes()) {
+                const auto atom = atomNode.cast<IntervalReqExpr::Atom>();
+                if (atom == nullptr) {
+                    return kDefaultSelectivity;
+                }
+
+                const auto& interval = atom->getExpr();
+                boost::optional<SBEValue> low;
+                boost::optional<SBEValue> high;
+                if (!getBoundValue(interval.getLowBound(), low) ||
+                    !getBoundValue(interval.getHighBound(), high)) {
+                    conjunctionSel *= kDefaultSelectivity;
+                    continue;
+                }
+
+                const double estimate =
+                    histogram.estimateInterval(low,
+                                               interval.getLowBound().isInclusive(),
+                                               high,
+                                               interval.getHighBound().isInclusive());
+                conjunctionSel *= estimate / documents;
+            }
+            disjunctionSel += conjunctionSel;
+        }
+
+        return std::min(disjunctionSel, 1.0);
+    }
+
+    // We don't own this.
+    OperationContext* _opCtx;
+
+    HeuristicCE _heuristicCE;
+};
+
+CEHistogramTransport::CEHistogramTransport(OperationContext* opCtx)
+    : _impl(std::make_unique<CEHistogramTransportImpl>(opCtx)) {}
+
+CEHistogramTransport::~CEHistogramTransport() {}
+
+CEType CEHistogramTransport::deriveCE(const Memo& memo,
+                                      const LogicalProps& logicalProps,
+                                      const ABT::reference_type logicalNodeRef) const {
+    return _impl->derive(memo, logicalProps, logicalNodeRef);
+}
+
+}  // namespace mongo::optimizer::cascades
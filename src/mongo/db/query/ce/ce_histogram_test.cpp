@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/ce/array_histogram.h"
+
+#include "mongo/bson/json.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo::ce {
+namespace {
+using SBEValue = std::pair<sbe::value::TypeTags, sbe::value::Value>;
+
+constexpr double kErrorBound = 0.01;
+
+SBEValue makeInt(int32_t value) {
+    return {sbe::value::TypeTags::NumberInt32, sbe::value::bitcastFrom<int32_t>(value)};
+}
+
+std::vector<BSONElement> elementsOf(const BSONObj& arr) {
+    std::vector<BSONElement> result;
+    for (auto&& elem : arr) {
+        result.push_back(elem);
+    }
+    return result;
+}
+
+std::vector<BSONObj> docsFromJson(const std::vector<std::string>& jsonDocs) {
+    std::vector<BSONObj> docs;
+    for (auto&& json : jsonDocs) {
+        docs.push_back(fromjson(json));
+    }
+    return docs;
+}
+
+TEST(ScalarHistogramTest, EmptyHistogram) {
+    const auto hist = ScalarHistogram::make({}, ScalarHistogram::kDefaultNumBuckets);
+    ASSERT_TRUE(hist.empty());
+    ASSERT_EQ(0.0, hist.getCardinality());
+
+    const auto [tag, val] = makeInt(1);
+    const auto result = hist.estimate(tag, val);
+    ASSERT_EQ(0.0, result._equality);
+    ASSERT_EQ(0.0, result._less);
+}
+
+TEST(ScalarHistogramTest, LowCardinalityValuesAreExact) {
+    // Fewer distinct values than buckets: every value gets a bucket of its own.
+    const auto arr = BSON_ARRAY(3 << 1 << 2 << 3 << 3 << 1);
+    const auto hist = ScalarHistogram::make(elementsOf(arr), 10);
+    ASSERT_EQ(3U, hist.getBuckets().size());
+    ASSERT_EQ(6.0, hist.getCardinality());
+
+    for (int32_t value = 1; value <= 3; ++value) {
+        const auto [tag, val] = makeInt(value);
+        const auto result = hist.estimate(tag, val);
+        ASSERT_EQ(value == 3 ? 3.0 : (value == 1 ? 2.0 : 1.0), result._equality);
+    }
+
+    const auto [tag, val] = makeInt(3);
+    ASSERT_EQ(3.0, hist.estimate(tag, val)._less);
+}
+
+TEST(ScalarHistogramTest, EquiDepthBuckets) {
+    BSONArrayBuilder builder;
+    for (int i = 0; i < 1000; ++i) {
+        builder.append(i);
+    }
+    const auto arr = builder.arr();
+    const auto hist = ScalarHistogram::make(elementsOf(arr), 10);
+    ASSERT_LTE(hist.getBuckets().size(), 10U);
+    ASSERT_EQ(1000.0, hist.getCardinality());
+
+    // Uniform data is interpolated within the buckets.
+    const auto result = hist.estimateInterval(makeInt(100), true, makeInt(300), false);
+    ASSERT_APPROX_EQUAL(200.0, result, 200.0 * kErrorBound);
+
+    ASSERT_EQ(1000.0, hist.estimateInterval(boost::none, false, boost::none, false));
+    ASSERT_EQ(0.0, hist.estimateInterval(makeInt(2000), true, boost::none, false));
+    ASSERT_EQ(0.0, hist.estimateInterval(boost::none, false, makeInt(-1), true));
+}
+
+TEST(ScalarHistogramTest, SkewedValuesGetTheirOwnBuckets) {
+    BSONArrayBuilder builder;
+    for (int i = 0; i < 900; ++i) {
+        builder.append(42);
+    }
+    for (int i = 0; i < 100; ++i) {
+        builder.append(i);
+    }
+    const auto arr = builder.arr();
+    const auto hist = ScalarHistogram::make(elementsOf(arr), 10);
+
+    const auto [tag, val] = makeInt(42);
+    ASSERT_EQ(901.0, hist.estimate(tag, val)._equality);
+}
+
+TEST(ScalarHistogramTest, MixedTypes) {
+    const auto arr = BSON_ARRAY(1 << "a" << 2 << "b" << true << 3.5);
+    const auto hist = ScalarHistogram::make(elementsOf(arr), 10);
+
+    // The numbers sort before the strings, which sort before the booleans.
+    const auto emptyStr = sbe::value::makeSmallString(""_sd);
+    ASSERT_EQ(3.0, hist.estimateInterval(boost::none, false, emptyStr, false));
+    const SBEValue falseValue{sbe::value::TypeTags::Boolean, sbe::value::bitcastFrom<bool>(false)};
+    ASSERT_EQ(2.0, hist.estimateInterval(emptyStr, true, falseValue, true));
+}
+
+TEST(ScalarHistogramTest, SerializationRoundTrip) {
+    const auto arr = BSON_ARRAY(5 << "x" << 1 << 5 << 7.5 << BSONNULL);
+    const auto hist = ScalarHistogram::make(elementsOf(arr), 3);
+    const auto parsed = ScalarHistogram::parse(hist.serialize());
+    ASSERT_BSONOBJ_EQ(hist.serialize(), parsed.serialize());
+    ASSERT_EQ(hist.getCardinality(), parsed.getCardinality());
+
+    ASSERT_THROWS_CODE(ScalarHistogram::parse(BSON("bounds" << BSON_ARRAY(1) << "buckets"
+                                                            << BSONArray())),
+                       DBException,
+                       6705005);
+}
+
+TEST(ArrayHistogramTest, ScalarsArraysAndMissing) {
+    const auto docs = docsFromJson({"{a: 1}",
+                                    "{a: 2}",
+                                    "{a: 2}",
+                                    "{a: [2, 3, 3]}",
+                                    "{a: []}",
+                                    "{b: 1}",
+                                    "{a: null}",
+                                    "{a: 'str'}"});
+    const auto hist = ArrayHistogram::make(docs, "a", 10);
+    ASSERT_EQ(8.0, hist.getDocuments());
+    ASSERT_EQ(1.0, hist.getMissing());
+    ASSERT_EQ(2.0, hist.getArrayCount());
+    ASSERT_EQ(1.0, hist.getEmptyArrayCount());
+
+    const auto& typeCounts = hist.getTypeCounts();
+    ASSERT_EQ(5.0, typeCounts.at(NumberInt));
+    ASSERT_EQ(1.0, typeCounts.at(jstNULL));
+    ASSERT_EQ(1.0, typeCounts.at(String));
+
+    // {a: 2} matches two scalars and one array.
+    ASSERT_EQ(3.0, hist.estimateInterval(makeInt(2), true, makeInt(2), true));
+
+    // An array matches once even if several of its values fall in the interval.
+    ASSERT_EQ(3.0, hist.estimateInterval(makeInt(2), true, makeInt(3), true));
+
+    // {a: null} matches the missing values.
+    const SBEValue null{sbe::value::TypeTags::Null, 0};
+    ASSERT_EQ(2.0, hist.estimateInterval(null, true, null, true));
+}
+
+TEST(ArrayHistogramTest, NestedPaths) {
+    const auto docs = docsFromJson({"{a: {b: 1}}", "{a: [{b: 1}, {b: 2}]}", "{a: {c: 1}}"});
+    const auto hist = ArrayHistogram::make(docs, "a.b", 10);
+    ASSERT_EQ(1.0, hist.getMissing());
+    ASSERT_EQ(1.0, hist.getArrayCount());
+    ASSERT_EQ(2.0, hist.estimateInterval(makeInt(1), true, makeInt(1), true));
+}
+
+TEST(ArrayHistogramTest, SerializationRoundTrip) {
+    const auto docs = docsFromJson({"{a: 1}", "{a: [1, 2]}", "{a: []}", "{}", "{a: 'x'}"});
+    const auto hist = ArrayHistogram::make(docs, "a", 4);
+    const auto parsed = ArrayHistogram::parse(hist.serialize());
+    ASSERT_BSONOBJ_EQ(hist.serialize(), parsed.serialize());
+    ASSERT_EQ(hist.estimateInterval(makeInt(1), true, makeInt(1), true),
+              parsed.estimateInterval(makeInt(1), true, makeInt(1), true));
+
+    ASSERT_THROWS_CODE(ArrayHistogram::parse(BSON("documents" << 1)), DBException, 6705008);
+}
+
+}  // namespace
+}  // namespace mongo::ce
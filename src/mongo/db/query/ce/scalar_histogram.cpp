@@ -0,0 +1,289 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/query/ce/scalar_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+
+namespace mongo::ce {
+namespace {
+using SBEValue = std::pair<sbe::value::TypeTags, sbe::value::Value>;
+
+constexpr auto kBoundsField = "bounds"_sd;
+constexpr auto kBucketsField = "buckets"_sd;
+constexpr auto kEqualFreqField = "equalFreq"_sd;
+constexpr auto kRangeFreqField = "rangeFreq"_sd;
+constexpr auto kCumulativeFreqField = "cumulativeFreq"_sd;
+constexpr auto kNdvField = "ndv"_sd;
+
+int compareValues(const SBEValue& lhs, const SBEValue& rhs) {
+    const auto [tag, val] = sbe::value::compareValue(lhs.first, lhs.second, rhs.first, rhs.second);
+    uassert(6705000,
+            "Histogram values must be comparable",
+            tag == sbe::value::TypeTags::NumberInt32);
+    return sbe::value::bitcastTo<int32_t>(val);
+}
+
+/**
+ * Maps numbers and dates onto a line, so that the position of a value between two bucket bounds can
+ * be interpolated.
+ */
+boost::optional<double> interpolationKey(const SBEValue& value) {
+    const auto [tag, val] = value;
+    switch (tag) {
+        case sbe::value::TypeTags::NumberInt32:
+        case sbe::value::TypeTags::NumberInt64:
+        case sbe::value::TypeTags::NumberDouble:
+            return sbe::value::numericCast<double>(tag, val);
+        case sbe::value::TypeTags::NumberDecimal:
+            return sbe::value::bitcastTo<Decimal128>(val).toDouble();
+        case sbe::value::TypeTags::Date:
+            return static_cast<double>(sbe::value::bitcastTo<int64_t>(val));
+        default:
+            return boost::none;
+    }
+}
+
+/**
+ * Returns which fraction of the range between 'low' and 'high' lies below 'value'. Falls back to
+ * the middle of the range when the values cannot be placed on a common line.
+ */
+double rangeFraction(const SBEValue& low, const SBEValue& high, const SBEValue& value) {
+    constexpr double kDefaultFraction = 0.5;
+
+    const bool isNumber = sbe::value::isNumber(value.first);
+    if (isNumber != sbe::value::isNumber(low.first) ||
+        isNumber != sbe::value::isNumber(high.first)) {
+        return kDefaultFraction;
+    }
+    if (!isNumber && (value.first != low.first || value.first != high.first)) {
+        return kDefaultFraction;
+    }
+
+    const auto lowKey = interpolationKey(low);
+    const auto highKey = interpolationKey(high);
+    const auto valueKey = interpolationKey(value);
+    if (!lowKey || !highKey || !valueKey || *highKey <= *lowKey) {
+        return kDefaultFraction;
+    }
+
+    const double fraction = (*valueKey - *lowKey) / (*highKey - *lowKey);
+    if (!std::isfinite(fraction)) {
+        return kDefaultFraction;
+    }
+    return std::clamp(fraction, 0.0, 1.0);
+}
+}  // namespace
+
+Bucket::Bucket(double equalFreq, double rangeFreq, double cumulativeFreq, double ndv)
+    : _equalFreq(equalFreq), _rangeFreq(rangeFreq), _cumulativeFreq(cumulativeFreq), _ndv(ndv) {}
+
+ScalarHistogram::ScalarHistogram() : ScalarHistogram(BSONArray(), {}) {}
+
+ScalarHistogram::ScalarHistogram(BSONObj boundsArray, std::vector<Bucket> buckets)
+    : _boundsArray(std::move(boundsArray)), _buckets(std::move(buckets)) {
+    for (auto&& elem : _boundsArray) {
+        _bounds.push_back(sbe::bson::convertFrom<true>(elem));
+    }
+    invariant(_bounds.size() == _buckets.size());
+}
+
+ScalarHistogram ScalarHistogram::make(std::vector<BSONElement> values, size_t numBuckets) {
+    uassert(6705001, "A histogram requires at least two buckets", numBuckets >= 2);
+    if (values.empty()) {
+        return {};
+    }
+
+    std::vector<std::pair<BSONElement, SBEValue>> sorted;
+    sorted.reserve(values.size());
+    for (auto&& elem : values) {
+        sorted.emplace_back(elem, sbe::bson::convertFrom<true>(elem));
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+        return compareValues(lhs.second, rhs.second) < 0;
+    });
+
+    // Collapse the sorted values into runs of equal values.
+    std::vector<std::pair<BSONElement, double>> runs;
+    for (size_t idx = 0; idx < sorted.size(); ++idx) {
+        if (idx > 0 && compareValues(sorted[idx - 1].second, sorted[idx].second) == 0) {
+            runs.back().second += 1;
+        } else {
+            runs.emplace_back(sorted[idx].first, 1);
+        }
+    }
+
+    // The smallest value always closes the first bucket, so that every other bucket has a lower
+    // bound to interpolate from. The largest value always closes the last bucket. In between, a
+    // bucket is closed once it holds its share of the values, or once the remaining distinct values
+    // can each get a bucket of their own.
+    const double depth = static_cast<double>(values.size()) / numBuckets;
+    BSONArrayBuilder bounds;
+    std::vector<Bucket> buckets;
+    double cumulativeFreq = 0;
+    double rangeFreq = 0;
+    double ndv = 0;
+    for (size_t idx = 0; idx < runs.size(); ++idx) {
+        const auto& [elem, count] = runs[idx];
+        const bool isLast = idx + 1 == runs.size();
+        const size_t bucketsLeft = numBuckets - buckets.size();
+        const size_t valuesLeft = runs.size() - idx;
+        const bool closeBucket = isLast ||
+            (bucketsLeft > 1 &&
+             (idx == 0 || rangeFreq + count >= depth || valuesLeft <= bucketsLeft));
+
+        if (!closeBucket) {
+            rangeFreq += count;
+            ndv += 1;
+            continue;
+        }
+
+        cumulativeFreq += rangeFreq + count;
+        buckets.emplace_back(count, rangeFreq, cumulativeFreq, ndv);
+        bounds.append(elem);
+        rangeFreq = 0;
+        ndv = 0;
+    }
+
+    return {bounds.arr(), std::move(buckets)};
+}
+
+ScalarHistogram ScalarHistogram::parse(const BSONObj& obj) {
+    const auto boundsElem = obj[kBoundsField];
+    const auto bucketsElem = obj[kBucketsField];
+    uassert(6705002,
+            str::stream() << "Invalid histogram: " << obj,
+            boundsElem.type() == Array && bucketsElem.type() == Array);
+
+    auto getFreq = [](const BSONObj& bucketObj, StringData field) {
+        const auto elem = bucketObj[field];
+        uassert(6705003,
+                str::stream() << "Invalid histogram bucket: " << bucketObj,
+                elem.isNumber() && elem.numberDouble() >= 0);
+        return elem.numberDouble();
+    };
+
+    std::vector<Bucket> buckets;
+    for (auto&& bucketElem : bucketsElem.Obj()) {
+        uassert(6705004,
+                str::stream() << "Invalid histogram bucket: " << bucketElem,
+                bucketElem.type() == Object);
+        const auto bucketObj = bucketElem.Obj();
+        buckets.emplace_back(getFreq(bucketObj, kEqualFreqField),
+                             getFreq(bucketObj, kRangeFreqField),
+                             getFreq(bucketObj, kCumulativeFreqField),
+                             getFreq(bucketObj, kNdvField));
+    }
+
+    auto boundsArray = boundsElem.Obj().getOwned();
+    uassert(6705005,
+            str::stream() << "Histogram bounds do not match its buckets: " << obj,
+            static_cast<size_t>(boundsArray.nFields()) == buckets.size());
+    return {std::move(boundsArray), std::move(buckets)};
+}
+
+BSONObj ScalarHistogram::serialize() const {
+    BSONObjBuilder builder;
+    builder.appendArray(kBoundsField, _boundsArray);
+
+    BSONArrayBuilder bucketsBuilder(builder.subarrayStart(kBucketsField));
+    for (auto&& bucket : _buckets) {
+        BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+        bucketBuilder.append(kEqualFreqField, bucket._equalFreq);
+        bucketBuilder.append(kRangeFreqField, bucket._rangeFreq);
+        bucketBuilder.append(kCumulativeFreqField, bucket._cumulativeFreq);
+        bucketBuilder.append(kNdvField, bucket._ndv);
+    }
+    bucketsBuilder.doneFast();
+
+    return builder.obj();
+}
+
+EstimationResult ScalarHistogram::estimate(sbe::value::TypeTags tag,
+                                           sbe::value::Value val) const {
+    if (_buckets.empty()) {
+        return {0.0, 0.0};
+    }
+
+    const SBEValue value{tag, val};
+    const auto it = std::lower_bound(
+        _bounds.begin(), _bounds.end(), value, [](const SBEValue& bound, const SBEValue& target) {
+            return compareValues(bound, target) < 0;
+        });
+    if (it == _bounds.end()) {
+        // The value is greater than all the values of the histogram.
+        return {0.0, getCardinality()};
+    }
+
+    const size_t idx = std::distance(_bounds.begin(), it);
+    const Bucket& bucket = _buckets[idx];
+    const double prevCumulativeFreq = idx == 0 ? 0.0 : _buckets[idx - 1]._cumulativeFreq;
+    if (compareValues(*it, value) == 0) {
+        return {bucket._equalFreq, prevCumulativeFreq + bucket._rangeFreq};
+    }
+    if (idx == 0) {
+        // The value is smaller than all the values of the histogram.
+        return {0.0, 0.0};
+    }
+
+    // The value falls strictly inside the range of the bucket. Assume the values of the range are
+    // uniformly distributed.
+    const double equality = bucket._ndv > 0 ? bucket._rangeFreq / bucket._ndv : 0.0;
+    const double fraction = rangeFraction(_bounds[idx - 1], *it, value);
+    return {equality, prevCumulativeFreq + fraction * bucket._rangeFreq};
+}
+
+double ScalarHistogram::estimateInterval(const boost::optional<SBEValue>& low,
+                                         bool lowInclusive,
+                                         const boost::optional<SBEValue>& high,
+                                         bool highInclusive) const {
+    if (_buckets.empty()) {
+        return 0.0;
+    }
+
+    double belowHigh = getCardinality();
+    if (high) {
+        const auto result = estimate(high->first, high->second);
+        belowHigh = result._less + (highInclusive ? result._equality : 0.0);
+    }
+
+    double belowLow = 0.0;
+    if (low) {
+        const auto result = estimate(low->first, low->second);
+        belowLow = result._less + (lowInclusive ? 0.0 : result._equality);
+    }
+
+    return std::max(0.0, belowHigh - belowLow);
+}
+
+}  // namespace mongo::ce
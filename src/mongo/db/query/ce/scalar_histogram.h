@@ -0,0 +1,140 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/exec/sbe/values/value.h"
+
+namespace mongo::ce {
+
+/**
+ * A histogram bucket. The bucket covers all the values greater than the upper bound of the previous
+ * bucket, up to and including its own upper bound.
+ */
+struct Bucket {
+    Bucket(double equalFreq, double rangeFreq, double cumulativeFreq, double ndv);
+
+    // Number of occurrences of the upper bound value.
+    double _equalFreq;
+
+    // Number of occurrences of the values strictly between the previous bound and this bound.
+    double _rangeFreq;
+
+    // Number of occurrences of the values up to and including this bound.
+    double _cumulativeFreq;
+
+    // Number of distinct values strictly between the previous bound and this bound.
+    double _ndv;
+};
+
+/**
+ * The estimated number of occurrences of the values equal to, and less than, a given value.
+ */
+struct EstimationResult {
+    double _equality;
+    double _less;
+};
+
+/**
+ * An equi-depth histogram over a set of values of arbitrary types, ordered by the SBE value
+ * comparison. Each bucket holds roughly the same number of values, so frequent values get buckets
+ * of their own and their frequencies are recorded exactly.
+ *
+ * The bucket bounds are kept in a BSON array. The histogram hands out SBE views of its elements, so
+ * copies of a histogram share the same underlying buffer.
+ */
+class ScalarHistogram {
+public:
+    static constexpr size_t kDefaultNumBuckets = 100;
+
+    ScalarHistogram();
+
+    /**
+     * Builds a histogram of at most 'numBuckets' buckets over 'values'. The elements are not
+     * required to be sorted or distinct, but must stay valid for the duration of the call.
+     */
+    static ScalarHistogram make(std::vector<BSONElement> values, size_t numBuckets);
+
+    /**
+     * Parses a histogram serialized by 'serialize()'. Throws if 'obj' is not a valid histogram.
+     */
+    static ScalarHistogram parse(const BSONObj& obj);
+
+    BSONObj serialize() const;
+
+    /**
+     * Estimates how many of the values are equal to, and less than, the value 'tag'/'val'.
+     */
+    EstimationResult estimate(sbe::value::TypeTags tag, sbe::value::Value val) const;
+
+    /**
+     * Estimates how many of the values fall in the interval between the given bounds. A missing
+     * bound stands for an unbounded side of the interval.
+     */
+    double estimateInterval(
+        const boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>>& low,
+        bool lowInclusive,
+        const boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>>& high,
+        bool highInclusive) const;
+
+    /**
+     * Returns the number of values the histogram was built from.
+     */
+    double getCardinality() const {
+        return _buckets.empty() ? 0.0 : _buckets.back()._cumulativeFreq;
+    }
+
+    bool empty() const {
+        return _buckets.empty();
+    }
+
+    const std::vector<Bucket>& getBuckets() const {
+        return _buckets;
+    }
+
+    std::pair<sbe::value::TypeTags, sbe::value::Value> getBound(size_t idx) const {
+        return _bounds.at(idx);
+    }
+
+private:
+    ScalarHistogram(BSONObj boundsArray, std::vector<Bucket> buckets);
+
+    // Owns the memory of the bounds.
+    BSONObj _boundsArray;
+
+    // Views of the elements of '_boundsArray', one per bucket.
+    std::vector<std::pair<sbe::value::TypeTags, sbe::value::Value>> _bounds;
+
+    std::vector<Bucket> _buckets;
+};
+
+}  // namespace mongo::ce
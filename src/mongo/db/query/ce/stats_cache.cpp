@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/db/query/ce/stats_cache.h"
+
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo::ce {
+namespace {
+const auto statsCacheDecoration = ServiceContext::declareDecoration<StatsCache>();
+}  // namespace
+
+StatsCache& StatsCache::get(ServiceContext* serviceContext) {
+    return statsCacheDecoration(serviceContext);
+}
+
+StatsCache& StatsCache::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+StatsCache::StatsCache() : _cache(internalQueryStatsCacheMaxEntries.load()) {}
+
+std::shared_ptr<const ArrayHistogram> StatsCache::getHistogram(OperationContext* opCtx,
+                                                               const NamespaceString& nss,
+                                                               const UUID& collectionUUID,
+                                                               const std::string& path) {
+    Key key{nss, path};
+    uint64_t epoch;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (auto it = _cache.find(key); it != _cache.end()) {
+            const auto& entry = it->second;
+            return entry.collectionUUID == collectionUUID ? entry.histogram : nullptr;
+        }
+        epoch = _epoch;
+    }
+
+    // Read the statistics without holding the mutex, then publish them unless an invalidation
+    // happened in the meantime.
+    auto entry = load(opCtx, nss, path);
+    if (!entry) {
+        return nullptr;
+    }
+
+    auto histogram = entry->collectionUUID == collectionUUID ? entry->histogram : nullptr;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (epoch == _epoch) {
+            _cache.add(key, std::move(*entry));
+        }
+    }
+    return histogram;
+}
+
+void StatsCache::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    ++_epoch;
+    _cache.clear();
+}
+
+boost::optional<StatsCache::Entry> StatsCache::load(OperationContext* opCtx,
+                                                    const NamespaceString& nss,
+                                                    const std::string& path) {
+    try {
+        DBDirectClient client(opCtx);
+        const auto doc = client.findOne(nss.makeStatisticsNamespace(), BSON("_id" << path));
+        if (doc.isEmpty()) {
+            return Entry{};
+        }
+
+        auto uuid = uassertStatusOK(UUID::parse(doc[kCollectionUUIDField]));
+        const auto statsElem = doc[kStatisticsField];
+        uassert(6705010,
+                str::stream() << "Invalid statistics document: " << doc,
+                statsElem.type() == Object);
+        return Entry{
+            std::move(uuid),
+            std::make_shared<const ArrayHistogram>(ArrayHistogram::parse(statsElem.Obj()))};
+    } catch (const DBException& ex) {
+        // Cardinality estimation falls back to heuristics for this path. The failure is not cached,
+        // so the next query retries the load.
+        LOGV2_WARNING(6705011,
+                      "Failed to load path statistics",
+                      "namespace"_attr = nss,
+                      "path"_attr = path,
+                      "error"_attr = ex.toStatus());
+        return boost::none;
+    }
+}
+
+}  // namespace mongo::ce
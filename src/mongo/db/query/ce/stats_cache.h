@@ -0,0 +1,104 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/ce/array_histogram.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/lru_cache.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo::ce {
+
+/**
+ * In-memory cache of the path statistics persisted by the 'analyze' command, so that cardinality
+ * estimation does not read the statistics collections for every query.
+ *
+ * The statistics of the collection 'db.coll' live in 'db.system.statistics.coll', one document per
+ * path:
+ *   {_id: <path>, collectionUUID: <uuid>, statistics: <serialized ArrayHistogram>}
+ * The collection UUID guards against using the statistics of a dropped collection for a new one of
+ * the same name.
+ */
+class StatsCache {
+public:
+    static constexpr auto kCollectionUUIDField = "collectionUUID"_sd;
+    static constexpr auto kStatisticsField = "statistics"_sd;
+
+    static StatsCache& get(ServiceContext* serviceContext);
+    static StatsCache& get(OperationContext* opCtx);
+
+    StatsCache();
+
+    /**
+     * Returns the statistics of 'path' in the collection 'nss' with the given UUID, loading them on
+     * a cache miss. Returns nullptr if the path has not been analyzed.
+     */
+    std::shared_ptr<const ArrayHistogram> getHistogram(OperationContext* opCtx,
+                                                       const NamespaceString& nss,
+                                                       const UUID& collectionUUID,
+                                                       const std::string& path);
+
+    /**
+     * Drops all the cached statistics. Called by StatsCacheOpObserver whenever a statistics
+     * collection changes.
+     */
+    void clear();
+
+private:
+    using Key = std::pair<NamespaceString, std::string>;
+
+    struct Entry {
+        // The collection the statistics belong to. Not set if the path has not been analyzed.
+        boost::optional<UUID> collectionUUID;
+        std::shared_ptr<const ArrayHistogram> histogram;
+    };
+
+    /**
+     * Reads the statistics of 'path' from the statistics collection of 'nss'. Returns boost::none
+     * if they could not be read.
+     */
+    static boost::optional<Entry> load(OperationContext* opCtx,
+                                       const NamespaceString& nss,
+                                       const std::string& path);
+
+    Mutex _mutex = MONGO_MAKE_LATCH("StatsCache::_mutex");
+
+    // Bumped by every invalidation, so that a load racing with an invalidation is not cached.
+    uint64_t _epoch{0};
+
+    LRUCache<Key, Entry> _cache;
+};
+
+}  // namespace mongo::ce
@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/ce/stats_cache_op_observer.h"
+
+#include "mongo/db/concurrency/locker.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/ce/stats_cache.h"
+
+namespace mongo::ce {
+namespace {
+
+/**
+ * Clears the StatsCache once the write of 'opCtx' commits, or right away outside of a write unit
+ * of work. Clearing after the commit makes the cache drop any entry loaded from the statistics as
+ * they were before the write.
+ */
+void clearStatsCache(OperationContext* opCtx) {
+    if (!opCtx->lockState()->inAWriteUnitOfWork()) {
+        StatsCache::get(opCtx).clear();
+        return;
+    }
+
+    auto serviceContext = opCtx->getServiceContext();
+    opCtx->recoveryUnit()->onCommit(
+        [serviceContext](boost::optional<Timestamp>) { StatsCache::get(serviceContext).clear(); });
+}
+
+}  // namespace
+
+void StatsCacheOpObserver::onInserts(OperationContext* opCtx,
+                                     const NamespaceString& nss,
+                                     const UUID& uuid,
+                                     std::vector<InsertStatement>::const_iterator first,
+                                     std::vector<InsertStatement>::const_iterator last,
+                                     bool fromMigrate) {
+    if (nss.isSystemStatsCollection()) {
+        clearStatsCache(opCtx);
+    }
+}
+
+void StatsCacheOpObserver::onUpdate(OperationContext* opCtx, const OplogUpdateEntryArgs& args) {
+    if (args.nss.isSystemStatsCollection()) {
+        clearStatsCache(opCtx);
+    }
+}
+
+void StatsCacheOpObserver::onDelete(OperationContext* opCtx,
+                                    const NamespaceString& nss,
+                                    const UUID& uuid,
+                                    StmtId stmtId,
+                                    const OplogDeleteEntryArgs& args) {
+    if (nss.isSystemStatsCollection()) {
+        clearStatsCache(opCtx);
+    }
+}
+
+void StatsCacheOpObserver::onDropDatabase(OperationContext* opCtx, const std::string& dbName) {
+    clearStatsCache(opCtx);
+}
+
+repl::OpTime StatsCacheOpObserver::onDropCollection(OperationContext* opCtx,
+                                                    const NamespaceString& collectionName,
+                                                    const UUID& uuid,
+                                                    std::uint64_t numRecords,
+                                                    CollectionDropType dropType) {
+    if (collectionName.isSystemStatsCollection()) {
+        clearStatsCache(opCtx);
+    }
+    return {};
+}
+
+void StatsCacheOpObserver::postRenameCollection(OperationContext* opCtx,
+                                                const NamespaceString& fromCollection,
+                                                const NamespaceString& toCollection,
+                                                const UUID& uuid,
+                                                const boost::optional<UUID>& dropTargetUUID,
+                                                bool stayTemp) {
+    if (fromCollection.isSystemStatsCollection() || toCollection.isSystemStatsCollection()) {
+        clearStatsCache(opCtx);
+    }
+}
+
+void StatsCacheOpObserver::onImportCollection(OperationContext* opCtx,
+                                              const UUID& importUUID,
+                                              const NamespaceString& nss,
+                                              long long numRecords,
+                                              long long dataSize,
+                                              const BSONObj& catalogEntry,
+                                              const BSONObj& storageMetadata,
+                                              bool isDryRun) {
+    if (!isDryRun && nss.isSystemStatsCollection()) {
+        clearStatsCache(opCtx);
+    }
+}
+
+void StatsCacheOpObserver::_onReplicationRollback(OperationContext* opCtx,
+                                                  const RollbackObserverInfo& rbInfo) {
+    for (const auto& nss : rbInfo.rollbackNamespaces) {
+        if (nss.isSystemStatsCollection()) {
+            StatsCache::get(opCtx).clear();
+            return;
+        }
+    }
+}
+
+}  // namespace mongo::ce
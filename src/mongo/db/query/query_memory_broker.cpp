@@ -0,0 +1,266 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_memory_broker.h"
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/concurrency/locker.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+const auto queryMemoryBrokerDecoration = ServiceContext::declareDecoration<QueryMemoryBroker>();
+
+StringData consumerName(QueryMemoryBroker::Consumer consumer) {
+    switch (consumer) {
+        case QueryMemoryBroker::Consumer::kSort:
+            return "sort"_sd;
+        case QueryMemoryBroker::Consumer::kHashAgg:
+            return "hashAgg"_sd;
+        case QueryMemoryBroker::Consumer::kHashJoin:
+            return "hashJoin"_sd;
+        case QueryMemoryBroker::Consumer::kSpool:
+            return "spool"_sd;
+        case QueryMemoryBroker::Consumer::kGroup:
+            return "group"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+long long roundUpToChunk(long long bytes) {
+    const auto chunk = QueryMemoryBroker::kGrantChunkBytes;
+    return (std::max(bytes, 0LL) + chunk - 1) / chunk * chunk;
+}
+
+// Returns whether 'opCtx' holds a lock in a mode which conflicts with the intent modes other
+// operations take, so that waiting with it held would stall them.
+bool holdsNonIntentLock(OperationContext* opCtx) {
+    const auto locker = opCtx->lockState();
+    if (!locker) {
+        return false;
+    }
+    const auto lockerInfo = locker->getLockerInfo(boost::none);
+    if (!lockerInfo) {
+        return false;
+    }
+    return std::any_of(lockerInfo->locks.begin(), lockerInfo->locks.end(), [](const auto& lock) {
+        return lock.mode == MODE_S || lock.mode == MODE_X;
+    });
+}
+
+class QueryMemoryBrokerSSS : public ServerStatusSection {
+public:
+    QueryMemoryBrokerSSS() : ServerStatusSection("queryMemoryBroker") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx, const BSONElement&) const override {
+        BSONObjBuilder builder;
+        QueryMemoryBroker::get(opCtx).appendStats(&builder);
+        return builder.obj();
+    }
+} queryMemoryBrokerSSS;
+}  // namespace
+
+QueryMemoryBroker& QueryMemoryBroker::get(ServiceContext* serviceContext) {
+    return queryMemoryBrokerDecoration(serviceContext);
+}
+
+QueryMemoryBroker& QueryMemoryBroker::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+QueryMemoryBroker::Grant::Grant(Grant&& other)
+    : _broker(std::exchange(other._broker, nullptr)),
+      _consumer(other._consumer),
+      _bytes(std::exchange(other._bytes, 0)) {}
+
+QueryMemoryBroker::Grant& QueryMemoryBroker::Grant::operator=(Grant&& other) {
+    if (this != &other) {
+        release();
+        _broker = std::exchange(other._broker, nullptr);
+        _consumer = other._consumer;
+        _bytes = std::exchange(other._bytes, 0);
+    }
+    return *this;
+}
+
+bool QueryMemoryBroker::Grant::_resize(long long bytes) {
+    if (!_broker) {
+        return true;
+    }
+
+    const auto target = roundUpToChunk(bytes);
+    if (target > _bytes) {
+        if (!_broker->_acquire(_consumer, _bytes, target - _bytes)) {
+            return false;
+        }
+        _bytes = target;
+    } else if (target + kGrantChunkBytes < _bytes) {
+        // Keep one spare chunk so that a stage hovering around a chunk boundary does not go back
+        // to the broker on every row.
+        _broker->_release(_consumer, _bytes - target - kGrantChunkBytes);
+        _bytes = target + kGrantChunkBytes;
+    }
+    return true;
+}
+
+bool QueryMemoryBroker::Grant::tryResize(long long bytes) {
+    if (_resize(bytes)) {
+        return true;
+    }
+    _broker->_stats(_consumer).denied.addAndFetch(1);
+    return false;
+}
+
+void QueryMemoryBroker::Grant::resizeOrWait(OperationContext* opCtx, long long bytes) {
+    if (tryResize(bytes)) {
+        return;
+    }
+
+    uassert(ErrorCodes::ExceededMemoryLimit,
+            str::stream() << "Exceeded the process-wide query memory budget of "
+                          << _broker->budgetBytes()
+                          << " bytes, and cannot wait for memory while holding a lock that blocks "
+                             "other operations. Pass allowDiskUse:true to let the query spill to "
+                             "disk instead.",
+            !holdsNonIntentLock(opCtx));
+
+    auto& stats = _broker->_stats(_consumer);
+    stats.waits.addAndFetch(1);
+    _broker->_numWaiters.addAndFetch(1);
+    Timer timer;
+    ON_BLOCK_EXIT([&] {
+        _broker->_numWaiters.subtractAndFetch(1);
+        stats.waitTimeMicros.addAndFetch(timer.micros());
+    });
+
+    // The grant can only be growing here, as shrinking always succeeds above, so the predicate
+    // never calls back into _release() while holding the mutex.
+    stdx::unique_lock<Latch> lk(_broker->_mutex);
+    const auto deadline =
+        Date_t::now() + Milliseconds(internalQueryMemoryBrokerMaxWaitMillis.load());
+    const bool granted = opCtx->waitForConditionOrInterruptUntil(
+        _broker->_memoryReleased, lk, deadline, [&] { return _resize(bytes); });
+    if (!granted) {
+        stats.waitTimeouts.addAndFetch(1);
+        uasserted(ErrorCodes::ExceededMemoryLimit,
+                  str::stream() << "Exceeded the process-wide query memory budget of "
+                                << _broker->budgetBytes()
+                                << " bytes. Pass allowDiskUse:true to let the query spill to disk "
+                                   "instead of waiting for memory.");
+    }
+}
+
+void QueryMemoryBroker::Grant::release() {
+    if (!_broker) {
+        return;
+    }
+
+    if (_bytes > 0) {
+        _broker->_release(_consumer, _bytes);
+    }
+    _broker->_stats(_consumer).activeGrants.subtractAndFetch(1);
+    _broker = nullptr;
+    _bytes = 0;
+}
+
+QueryMemoryBroker::Grant QueryMemoryBroker::makeGrant(Consumer consumer) {
+    auto& stats = _stats(consumer);
+    stats.activeGrants.addAndFetch(1);
+    stats.totalGrants.addAndFetch(1);
+    return Grant{this, consumer};
+}
+
+long long QueryMemoryBroker::budgetBytes() const {
+    if (_fixedBudgetBytes) {
+        return *_fixedBudgetBytes;
+    }
+    const auto memSizeBytes = static_cast<double>(ProcessInfo::getMemSizeMB()) * 1024 * 1024;
+    return static_cast<long long>(memSizeBytes *
+                                  internalQueryMemoryBrokerMaxMemoryUsagePercent.load() / 100);
+}
+
+bool QueryMemoryBroker::_acquire(Consumer consumer, long long held, long long delta) {
+    const auto budget = budgetBytes();
+    long long used;
+    if (budget > 0 && held + delta > kGrantChunkBytes) {
+        used = _usedBytes.load();
+        do {
+            if (used + delta > budget) {
+                return false;
+            }
+        } while (!_usedBytes.compareAndSwap(&used, used + delta));
+        used += delta;
+    } else {
+        used = _usedBytes.addAndFetch(delta);
+    }
+
+    auto peak = _peakBytes.load();
+    while (used > peak && !_peakBytes.compareAndSwap(&peak, used)) {
+    }
+    _stats(consumer).grantedBytes.addAndFetch(delta);
+    return true;
+}
+
+void QueryMemoryBroker::_release(Consumer consumer, long long delta) {
+    _usedBytes.subtractAndFetch(delta);
+    _stats(consumer).grantedBytes.subtractAndFetch(delta);
+    if (_numWaiters.load() > 0) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _memoryReleased.notify_all();
+    }
+}
+
+void QueryMemoryBroker::appendStats(BSONObjBuilder* builder) const {
+    builder->appendNumber("budgetBytes", budgetBytes());
+    builder->appendNumber("usedBytes", usedBytes());
+    builder->appendNumber("peakBytes", _peakBytes.load());
+    for (size_t idx = 0; idx < kNumConsumers; ++idx) {
+        const auto& stats = _consumerStats[idx];
+        BSONObjBuilder consumerBuilder(
+            builder->subobjStart(consumerName(static_cast<Consumer>(idx))));
+        consumerBuilder.appendNumber("activeGrants", stats.activeGrants.load());
+        consumerBuilder.appendNumber("grantedBytes", stats.grantedBytes.load());
+        consumerBuilder.appendNumber("totalGrants", stats.totalGrants.load());
+        consumerBuilder.appendNumber("denied", stats.denied.load());
+        consumerBuilder.appendNumber("waits", stats.waits.load());
+        consumerBuilder.appendNumber("waitTimeMicros", stats.waitTimeMicros.load());
+        consumerBuilder.appendNumber("waitTimeouts", stats.waitTimeouts.load());
+    }
+}
+}  // namespace mongo
@@ -0,0 +1,185 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+
+#include <boost/optional.hpp>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+
+namespace mongo {
+/**
+ * The QueryMemoryBroker keeps the memory held by the blocking stages of all the queries running in
+ * the process within a single budget, a percentage of the memory available to the process (see
+ * 'internalQueryMemoryBrokerMaxMemoryUsagePercent'). Each blocking stage still has its own memory
+ * limit, but it also reports its memory use to the broker through a Grant. When the broker refuses
+ * to grow a grant, the stage spills to disk just as if it had reached its own limit. A stage which
+ * is not allowed to spill instead waits for other queries to release memory, and fails with
+ * ExceededMemoryLimit if that does not happen in time.
+ *
+ * Grants grow in chunks of 'kGrantChunkBytes', so that the shared counters are only touched once
+ * per chunk rather than once per row. The first chunk of every grant is always handed out, even
+ * above the budget, so that a stage is never forced to spill a handful of rows at a time.
+ */
+class QueryMemoryBroker {
+public:
+    /**
+     * The kinds of stages which take grants. Used to break the statistics down by stage.
+     */
+    enum class Consumer { kSort, kHashAgg, kHashJoin, kSpool, kGroup };
+    static constexpr size_t kNumConsumers = 5;
+
+    static constexpr long long kGrantChunkBytes = 1024 * 1024;
+
+    /**
+     * The memory held by one stage. A default-constructed Grant is not attached to a broker and
+     * allows any size. The memory held by a grant is returned to the broker when the grant is
+     * released or destroyed.
+     */
+    class Grant {
+    public:
+        Grant() = default;
+        Grant(Grant&& other);
+        Grant& operator=(Grant&& other);
+        Grant(const Grant&) = delete;
+        Grant& operator=(const Grant&) = delete;
+        ~Grant() {
+            release();
+        }
+
+        /**
+         * Resizes the grant to cover 'bytes'. Shrinking always succeeds. Returns false, and leaves
+         * the grant unchanged, if growing it would take the process over its budget; the caller is
+         * then expected to free memory, typically by spilling to disk.
+         */
+        bool tryResize(long long bytes);
+
+        /**
+         * Like tryResize(), but for callers which cannot free memory: waits for other grants to
+         * shrink for up to 'internalQueryMemoryBrokerMaxWaitMillis'. Throws ExceededMemoryLimit if
+         * the grant still cannot grow after that. If the operation is interrupted while waiting,
+         * throws the interruption error instead.
+         *
+         * The wait happens with the caller's locks held. Only intent locks may be held, as they are
+         * by any query between yields; if the operation holds a lock in MODE_S or MODE_X, which
+         * would block other operations for the duration of the wait, this throws
+         * ExceededMemoryLimit right away instead of waiting.
+         */
+        void resizeOrWait(OperationContext* opCtx, long long bytes);
+
+        /**
+         * Returns the memory held by this grant to the broker and detaches the grant from it.
+         */
+        void release();
+
+        long long bytes() const {
+            return _bytes;
+        }
+
+    private:
+        friend class QueryMemoryBroker;
+
+        Grant(QueryMemoryBroker* broker, Consumer consumer)
+            : _broker(broker), _consumer(consumer) {}
+
+        // Attempts to resize the grant without recording a denial in the statistics.
+        bool _resize(long long bytes);
+
+        QueryMemoryBroker* _broker{nullptr};
+        Consumer _consumer{Consumer::kSort};
+        long long _bytes{0};
+    };
+
+    static QueryMemoryBroker& get(ServiceContext* serviceContext);
+    static QueryMemoryBroker& get(OperationContext* opCtx);
+
+    /**
+     * The broker normally derives its budget from the memory available to the process. Tests may
+     * instead pass a fixed budget in bytes.
+     */
+    explicit QueryMemoryBroker(boost::optional<long long> budgetBytes = boost::none)
+        : _fixedBudgetBytes(budgetBytes) {}
+
+    /**
+     * Returns a new, empty grant for a stage of the given kind.
+     */
+    Grant makeGrant(Consumer consumer);
+
+    /**
+     * Returns the current budget in bytes, or 0 if the budget is disabled.
+     */
+    long long budgetBytes() const;
+
+    long long usedBytes() const {
+        return _usedBytes.load();
+    }
+
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    struct ConsumerStats {
+        AtomicWord<long long> activeGrants;
+        AtomicWord<long long> grantedBytes;
+        AtomicWord<long long> totalGrants;
+        AtomicWord<long long> denied;
+        AtomicWord<long long> waits;
+        AtomicWord<long long> waitTimeMicros;
+        AtomicWord<long long> waitTimeouts;
+    };
+
+    ConsumerStats& _stats(Consumer consumer) {
+        return _consumerStats[static_cast<size_t>(consumer)];
+    }
+
+    // Takes 'delta' more bytes out of the budget for a grant which currently holds 'held' bytes.
+    bool _acquire(Consumer consumer, long long held, long long delta);
+
+    // Returns 'delta' bytes to the budget and wakes up any waiting grants.
+    void _release(Consumer consumer, long long delta);
+
+    const boost::optional<long long> _fixedBudgetBytes;
+
+    AtomicWord<long long> _usedBytes{0};
+    AtomicWord<long long> _peakBytes{0};
+    std::array<ConsumerStats, kNumConsumers> _consumerStats;
+
+    // Grants waiting in resizeOrWait() block on '_memoryReleased'. '_numWaiters' lets releases skip
+    // the mutex when nobody is waiting.
+    AtomicWord<int> _numWaiters{0};
+    Mutex _mutex = MONGO_MAKE_LATCH("QueryMemoryBroker::_mutex");
+    stdx::condition_variable _memoryReleased;
+};
+}  // namespace mongo
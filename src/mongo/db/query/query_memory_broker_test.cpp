@@ -0,0 +1,219 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_memory_broker.h"
+
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/concurrency/lock_state.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+constexpr auto kChunk = QueryMemoryBroker::kGrantChunkBytes;
+
+using Consumer = QueryMemoryBroker::Consumer;
+
+class QueryMemoryBrokerTest : public ServiceContextTest {
+protected:
+    BSONObj stats(const QueryMemoryBroker& broker) {
+        BSONObjBuilder builder;
+        broker.appendStats(&builder);
+        return builder.obj();
+    }
+};
+
+TEST_F(QueryMemoryBrokerTest, DetachedGrantAllowsAnySize) {
+    QueryMemoryBroker::Grant grant;
+    ASSERT_TRUE(grant.tryResize(100 * kChunk));
+    ASSERT_EQ(grant.bytes(), 0);
+}
+
+TEST_F(QueryMemoryBrokerTest, GrantGrowsInChunks) {
+    QueryMemoryBroker broker{4 * kChunk};
+    auto grant = broker.makeGrant(Consumer::kSort);
+
+    ASSERT_TRUE(grant.tryResize(1));
+    ASSERT_EQ(grant.bytes(), kChunk);
+    ASSERT_TRUE(grant.tryResize(kChunk + 1));
+    ASSERT_EQ(grant.bytes(), 2 * kChunk);
+    ASSERT_EQ(broker.usedBytes(), 2 * kChunk);
+
+    grant.release();
+    ASSERT_EQ(grant.bytes(), 0);
+    ASSERT_EQ(broker.usedBytes(), 0);
+}
+
+TEST_F(QueryMemoryBrokerTest, GrowingOverBudgetIsDenied) {
+    QueryMemoryBroker broker{4 * kChunk};
+    auto sortGrant = broker.makeGrant(Consumer::kSort);
+    auto groupGrant = broker.makeGrant(Consumer::kGroup);
+
+    ASSERT_TRUE(sortGrant.tryResize(3 * kChunk));
+    ASSERT_FALSE(groupGrant.tryResize(2 * kChunk));
+    ASSERT_EQ(groupGrant.bytes(), 0);
+    ASSERT_EQ(broker.usedBytes(), 3 * kChunk);
+
+    // Once the sort shrinks, the group gets its memory.
+    ASSERT_TRUE(sortGrant.tryResize(0));
+    ASSERT_TRUE(groupGrant.tryResize(2 * kChunk));
+    ASSERT_EQ(broker.usedBytes(), 3 * kChunk);
+
+    auto groupStats = stats(broker)["group"].Obj();
+    ASSERT_EQ(groupStats["denied"].numberLong(), 1);
+    ASSERT_EQ(groupStats["grantedBytes"].numberLong(), 2 * kChunk);
+}
+
+TEST_F(QueryMemoryBrokerTest, FirstChunkIsGrantedOverBudget) {
+    QueryMemoryBroker broker{kChunk};
+    auto first = broker.makeGrant(Consumer::kHashAgg);
+    auto second = broker.makeGrant(Consumer::kHashJoin);
+
+    ASSERT_TRUE(first.tryResize(kChunk));
+    ASSERT_TRUE(second.tryResize(kChunk));
+    ASSERT_FALSE(second.tryResize(kChunk + 1));
+    ASSERT_EQ(broker.usedBytes(), 2 * kChunk);
+}
+
+TEST_F(QueryMemoryBrokerTest, ShrinkingKeepsOneSpareChunk) {
+    QueryMemoryBroker broker{10 * kChunk};
+    auto grant = broker.makeGrant(Consumer::kSort);
+
+    ASSERT_TRUE(grant.tryResize(5 * kChunk));
+    ASSERT_TRUE(grant.tryResize(4 * kChunk));
+    ASSERT_EQ(grant.bytes(), 5 * kChunk);
+    ASSERT_TRUE(grant.tryResize(0));
+    ASSERT_EQ(grant.bytes(), kChunk);
+    ASSERT_EQ(broker.usedBytes(), kChunk);
+}
+
+TEST_F(QueryMemoryBrokerTest, ZeroBudgetDisablesLimit) {
+    QueryMemoryBroker broker{0};
+    auto grant = broker.makeGrant(Consumer::kSpool);
+
+    ASSERT_TRUE(grant.tryResize(1000 * kChunk));
+    ASSERT_EQ(broker.usedBytes(), 1000 * kChunk);
+}
+
+TEST_F(QueryMemoryBrokerTest, GrantsAreReleasedOnDestructionAndMove) {
+    QueryMemoryBroker broker{10 * kChunk};
+    {
+        auto grant = broker.makeGrant(Consumer::kSort);
+        ASSERT_TRUE(grant.tryResize(3 * kChunk));
+
+        QueryMemoryBroker::Grant other;
+        other = std::move(grant);
+        ASSERT_EQ(other.bytes(), 3 * kChunk);
+        ASSERT_EQ(broker.usedBytes(), 3 * kChunk);
+        ASSERT_EQ(stats(broker)["sort"]["activeGrants"].numberLong(), 1);
+    }
+    ASSERT_EQ(broker.usedBytes(), 0);
+
+    auto sortStats = stats(broker)["sort"].Obj();
+    ASSERT_EQ(sortStats["activeGrants"].numberLong(), 0);
+    ASSERT_EQ(sortStats["totalGrants"].numberLong(), 1);
+}
+
+TEST_F(QueryMemoryBrokerTest, ResizeOrWaitTimesOut) {
+    RAIIServerParameterControllerForTest maxWait{"internalQueryMemoryBrokerMaxWaitMillis", 0};
+    auto opCtx = makeOperationContext();
+    QueryMemoryBroker broker{2 * kChunk};
+    auto sortGrant = broker.makeGrant(Consumer::kSort);
+    auto spoolGrant = broker.makeGrant(Consumer::kSpool);
+
+    ASSERT_TRUE(sortGrant.tryResize(2 * kChunk));
+    ASSERT_THROWS_CODE(spoolGrant.resizeOrWait(opCtx.get(), 2 * kChunk),
+                       DBException,
+                       ErrorCodes::ExceededMemoryLimit);
+
+    auto spoolStats = stats(broker)["spool"].Obj();
+    ASSERT_EQ(spoolStats["waits"].numberLong(), 1);
+    ASSERT_EQ(spoolStats["waitTimeouts"].numberLong(), 1);
+}
+
+TEST_F(QueryMemoryBrokerTest, ResizeOrWaitWakesUpWhenMemoryIsReleased) {
+    RAIIServerParameterControllerForTest maxWait{"internalQueryMemoryBrokerMaxWaitMillis",
+                                                 60 * 1000};
+    auto opCtx = makeOperationContext();
+    QueryMemoryBroker broker{2 * kChunk};
+    auto sortGrant = broker.makeGrant(Consumer::kSort);
+    auto spoolGrant = broker.makeGrant(Consumer::kSpool);
+    ASSERT_TRUE(sortGrant.tryResize(2 * kChunk));
+
+    stdx::thread releaser([&] {
+        sleepmillis(10);
+        sortGrant.release();
+    });
+    spoolGrant.resizeOrWait(opCtx.get(), 2 * kChunk);
+    releaser.join();
+
+    ASSERT_EQ(spoolGrant.bytes(), 2 * kChunk);
+    auto spoolStats = stats(broker)["spool"].Obj();
+    ASSERT_EQ(spoolStats["waits"].numberLong(), 1);
+    ASSERT_EQ(spoolStats["waitTimeouts"].numberLong(), 0);
+}
+
+TEST_F(QueryMemoryBrokerTest, ResizeOrWaitThrowsInterruptionError) {
+    RAIIServerParameterControllerForTest maxWait{"internalQueryMemoryBrokerMaxWaitMillis",
+                                                 60 * 1000};
+    auto opCtx = makeOperationContext();
+    QueryMemoryBroker broker{2 * kChunk};
+    auto sortGrant = broker.makeGrant(Consumer::kSort);
+    auto spoolGrant = broker.makeGrant(Consumer::kSpool);
+    ASSERT_TRUE(sortGrant.tryResize(2 * kChunk));
+
+    opCtx->markKilled(ErrorCodes::Interrupted);
+    ASSERT_THROWS_CODE(spoolGrant.resizeOrWait(opCtx.get(), 2 * kChunk),
+                       DBException,
+                       ErrorCodes::Interrupted);
+    ASSERT_EQ(spoolGrant.bytes(), 0);
+}
+
+TEST_F(QueryMemoryBrokerTest, ResizeOrWaitDoesNotWaitWhileHoldingNonIntentLock) {
+    RAIIServerParameterControllerForTest maxWait{"internalQueryMemoryBrokerMaxWaitMillis",
+                                                 60 * 1000};
+    auto opCtx = makeOperationContext();
+    opCtx->setLockState(std::make_unique<LockerImpl>());
+    QueryMemoryBroker broker{2 * kChunk};
+    auto sortGrant = broker.makeGrant(Consumer::kSort);
+    auto spoolGrant = broker.makeGrant(Consumer::kSpool);
+    ASSERT_TRUE(sortGrant.tryResize(2 * kChunk));
+
+    Lock::GlobalLock globalLock(opCtx.get(), MODE_S);
+    ASSERT_THROWS_CODE(spoolGrant.resizeOrWait(opCtx.get(), 2 * kChunk),
+                       DBException,
+                       ErrorCodes::ExceededMemoryLimit);
+    ASSERT_EQ(stats(broker)["spool"].Obj()["waits"].numberLong(), 0);
+}
+}  // namespace
+}  // namespace mongo
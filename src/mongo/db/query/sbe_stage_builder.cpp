@@ -37,6 +37,7 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/sbe/abt/abt_lower.h"
+#include "mongo/db/exec/sbe/stages/block_pack.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
 #include "mongo/db/exec/sbe/stages/column_scan.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
@@ -65,6 +66,7 @@
 #include "mongo/db/query/expression_walker.h"
 #include "mongo/db/query/optimizer/rewrites/const_eval.h"
 #include "mongo/db/query/optimizer/rewrites/path_lower.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder_accumulator.h"
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
 #include "mongo/db/query/sbe_stage_builder_expression.h"
@@ -2068,6 +2070,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                         innerCondSlots,
                                                         innerProjectSlots,
                                                         collatorSlot,
+                                                        _cq.getExpCtx()->allowDiskUse,
                                                         root->nodeId());
 
     // If there are more than 2 children, iterate all remaining children and hash
@@ -2090,6 +2093,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                        innerCondSlots,
                                                        innerProjectSlots,
                                                        collatorSlot,
+                                                       _cq.getExpCtx()->allowDiskUse,
                                                        root->nodeId());
     }
 
@@ -2463,6 +2467,84 @@ std::tuple<sbe::value::SlotVector, EvalStage> generateAccumulator(
     return {std::move(aggSlots), std::move(accProjEvalStage)};
 }
 
+/**
+ * Returns the number of rows to pack into each block if the GROUP node can be run a block at a
+ * time, or 0 otherwise. The group-by key must be a constant, so that all the rows of a block belong
+ * to the same group, and all the accumulators must be computable from blocks.
+ */
+size_t getGroupBlockSize(StageBuilderState& state, const GroupNode* groupNode) {
+    const auto blockSize = internalQuerySBEGroupBlockSize.load();
+    if (blockSize <= 0 || groupNode->accumulators.empty() ||
+        !dynamic_cast<ExpressionConstant*>(groupNode->groupByExpression.get())) {
+        return 0;
+    }
+
+    for (const auto& accStmt : groupNode->accumulators) {
+        if (!stage_builder::canBuildBlockAccumulator(state, accStmt)) {
+            return 0;
+        }
+    }
+
+    return blockSize;
+}
+
+/**
+ * Translates the accumulators of a GROUP node which can be run a block at a time. The arguments of
+ * the accumulators are packed into blocks by a BlockPackStage on top of 'childStage', and each
+ * accumulator expression folds a whole block. Returns the accumulator slots of each accumulator
+ * and the BlockPackStage, above which only the block slots are visible.
+ */
+std::tuple<std::vector<sbe::value::SlotVector>, std::unique_ptr<sbe::PlanStage>>
+generateBlockAccumulators(
+    StageBuilderState& state,
+    const std::vector<AccumulationStatement>& accStmts,
+    std::unique_ptr<sbe::PlanStage> childStage,
+    const PlanStageSlots& childOutputs,
+    size_t blockSize,
+    PlanNodeId nodeId,
+    sbe::value::SlotIdGenerator* slotIdGenerator,
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>>& accSlotToExprMap) {
+    auto optionalRootSlot = childOutputs.getIfExists(SlotBasedStageBuilder::kResult);
+    EvalStage evalStage{std::move(childStage),
+                        optionalRootSlot ? sbe::value::SlotVector{*optionalRootSlot}
+                                         : sbe::value::SlotVector{}};
+
+    sbe::value::SlotVector argSlots;
+    sbe::value::SlotVector blockSlots;
+    std::vector<sbe::value::SlotVector> aggSlotsVec;
+    for (const auto& accStmt : accStmts) {
+        evalStage = optimizeFieldPaths(
+            state, accStmt.expr.argument, std::move(evalStage), childOutputs, nodeId);
+        auto [argExpr, argEvalStage] = stage_builder::buildArgument(
+            state, accStmt, std::move(evalStage), optionalRootSlot, nodeId);
+
+        auto blockSlot = slotIdGenerator->generate();
+        auto [blockArgExpr, accExprs] = stage_builder::buildBlockAccumulator(
+            state, accStmt, std::move(argExpr), blockSlot);
+
+        auto [argSlot, argProjEvalStage] = projectEvalExpr(
+            std::move(blockArgExpr), std::move(argEvalStage), nodeId, slotIdGenerator);
+        evalStage = std::move(argProjEvalStage);
+        argSlots.push_back(argSlot);
+        blockSlots.push_back(blockSlot);
+
+        sbe::value::SlotVector aggSlots;
+        for (auto& accExpr : accExprs) {
+            auto slot = slotIdGenerator->generate();
+            aggSlots.push_back(slot);
+            accSlotToExprMap.emplace(slot, std::move(accExpr));
+        }
+        aggSlotsVec.emplace_back(std::move(aggSlots));
+    }
+
+    auto blockPackStage = sbe::makeS<sbe::BlockPackStage>(std::move(evalStage.stage),
+                                                          std::move(argSlots),
+                                                          std::move(blockSlots),
+                                                          blockSize,
+                                                          nodeId);
+    return {std::move(aggSlotsVec), std::move(blockPackStage)};
+}
+
 std::tuple<std::vector<std::string>, sbe::value::SlotVector, EvalStage> generateGroupFinalStage(
     StageBuilderState& state,
     EvalStage groupEvalStage,
@@ -2603,6 +2685,24 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
             "Expected no optimized expressions but got: {}"_format(_state.preGeneratedExprs.size()),
             _state.preGeneratedExprs.empty());
 
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> accSlotToExprMap;
+    std::vector<sbe::value::SlotVector> aggSlotsVec;
+
+    // When the group can be run a block at a time, translates the accumulators below the group-by
+    // key, which is a constant and so does not need any of the child's slots.
+    const auto blockSize = getGroupBlockSize(_state, groupNode);
+    if (blockSize > 0) {
+        std::tie(aggSlotsVec, childStage) = generateBlockAccumulators(_state,
+                                                                      accStmts,
+                                                                      std::move(childStage),
+                                                                      childOutputs,
+                                                                      blockSize,
+                                                                      nodeId,
+                                                                      &_slotIdGenerator,
+                                                                      accSlotToExprMap);
+        childOutputs = PlanStageSlots{};
+    }
+
     // Translates the group-by expression and wraps it with 'fillEmpty(..., null)' because the
     // missing field value for _id should be mapped to 'Null'.
     auto [groupBySlots, groupByEvalStage, idDocExpr] = generateGroupByKey(
@@ -2611,18 +2711,18 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
     // Translates accumulators which are executed inside the group stage and gets slots for
     // accumulators.
     stage_builder::EvalStage accProjEvalStage = std::move(groupByEvalStage);
-    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> accSlotToExprMap;
-    std::vector<sbe::value::SlotVector> aggSlotsVec;
-    for (const auto& accStmt : accStmts) {
-        auto [aggSlots, tempEvalStage] = generateAccumulator(_state,
-                                                             accStmt,
-                                                             std::move(accProjEvalStage),
-                                                             childOutputs,
-                                                             nodeId,
-                                                             &_slotIdGenerator,
-                                                             accSlotToExprMap);
-        aggSlotsVec.emplace_back(std::move(aggSlots));
-        accProjEvalStage = std::move(tempEvalStage);
+    if (blockSize == 0) {
+        for (const auto& accStmt : accStmts) {
+            auto [aggSlots, tempEvalStage] = generateAccumulator(_state,
+                                                                 accStmt,
+                                                                 std::move(accProjEvalStage),
+                                                                 childOutputs,
+                                                                 nodeId,
+                                                                 &_slotIdGenerator,
+                                                                 accSlotToExprMap);
+            aggSlotsVec.emplace_back(std::move(aggSlots));
+            accProjEvalStage = std::move(tempEvalStage);
+        }
     }
 
     // There might be duplicated expressions and slots. Dedup them before creating a HashAgg
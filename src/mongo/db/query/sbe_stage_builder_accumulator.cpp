@@ -487,6 +487,38 @@ std::pair<std::vector<std::unique_ptr<sbe::EExpression>>, EvalStage> buildAccumu
                        planNodeId);
 }
 
+bool canBuildBlockAccumulator(StageBuilderState& state, const AccumulationStatement& acc) {
+    // The block aggregates compare values without a collator.
+    if (state.env->getSlotIfExists("collator"_sd)) {
+        return false;
+    }
+
+    return acc.expr.name == AccumulatorMin::kName || acc.expr.name == AccumulatorMax::kName;
+}
+
+std::pair<std::unique_ptr<sbe::EExpression>, std::vector<std::unique_ptr<sbe::EExpression>>>
+buildBlockAccumulator(StageBuilderState& state,
+                      const AccumulationStatement& acc,
+                      std::unique_ptr<sbe::EExpression> argExpr,
+                      sbe::value::SlotId blockSlot) {
+    tassert(6703001,
+            str::stream() << "Unsupported Accumulator in SBE block accumulator builder: "
+                          << acc.expr.name,
+            canBuildBlockAccumulator(state, acc));
+
+    // Null and missing values become Nothing before they are packed into the blocks, and the block
+    // aggregates skip Nothing, so that each block is folded like the row-based $min and $max would
+    // fold its rows. Folding the per-block results with min() or max() then gives the same
+    // accumulator state as folding all the rows.
+    const bool isMin = acc.expr.name == AccumulatorMin::kName;
+    std::vector<std::unique_ptr<sbe::EExpression>> aggs;
+    aggs.push_back(
+        makeFunction(isMin ? "min"_sd : "max"_sd,
+                     makeFunction(isMin ? "valueBlockMin"_sd : "valueBlockMax"_sd,
+                                  makeVariable(blockSlot))));
+    return {wrapMinMaxArg(state, std::move(argExpr)), std::move(aggs)};
+}
+
 std::pair<std::unique_ptr<sbe::EExpression>, EvalStage> buildFinalize(
     StageBuilderState& state,
     const AccumulationStatement& acc,
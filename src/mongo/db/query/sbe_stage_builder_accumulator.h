@@ -60,6 +60,24 @@ std::pair<std::vector<std::unique_ptr<sbe::EExpression>>, EvalStage> buildAccumu
     std::unique_ptr<sbe::EExpression> argExpr,
     PlanNodeId planNodeId);
 
+/**
+ * Returns true if the AccumulationStatement can be computed from blocks of its argument values
+ * with buildBlockAccumulator().
+ */
+bool canBuildBlockAccumulator(StageBuilderState& state, const AccumulationStatement& acc);
+
+/**
+ * Translates an input AccumulationStatement, for which canBuildBlockAccumulator() is true, into the
+ * expression whose values are to be packed into blocks, and the SBE EExpressions for accumulation
+ * expressions over the blocks in 'blockSlot'. The accumulator slots have the same contents as the
+ * ones produced by buildAccumulator(), so buildFinalize() can be used to finalize them.
+ */
+std::pair<std::unique_ptr<sbe::EExpression>, std::vector<std::unique_ptr<sbe::EExpression>>>
+buildBlockAccumulator(StageBuilderState& state,
+                      const AccumulationStatement& acc,
+                      std::unique_ptr<sbe::EExpression> argExpr,
+                      sbe::value::SlotId blockSlot);
+
 /**
  * Translates an input AccumulationStatement into an SBE EExpression that represents an
  * AccumulationStatement's finalization step. The 'stage' parameter provides the input subtree to
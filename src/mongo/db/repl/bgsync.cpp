@@ -53,6 +53,7 @@
 #include "mongo/db/repl/replication_consistency_markers_impl.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_impl.h"
+#include "mongo/db/repl/replication_latency_tracker.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/repl/rollback_source_impl.h"
 #include "mongo/db/repl/rs_rollback.h"
@@ -644,6 +645,14 @@ Status BackgroundSync::_enqueueDocuments(OplogFetcher::Documents::const_iterator
 
     auto opCtx = cc().makeOperationContext();
 
+    auto lastWallTimeElem = std::prev(end)->getField(OplogEntry::kWallClockTimeFieldName);
+    if (lastWallTimeElem.type() == BSONType::Date) {
+        ReplicationLatencyTracker::get(opCtx->getServiceContext())
+            ->record(ReplicationLatencyTracker::Stage::kFetched,
+                     lastWallTimeElem.Date(),
+                     Date_t::now());
+    }
+
     // Wait for enough space.
     _oplogApplier->waitForSpace(opCtx.get(), info.toApplyDocumentBytes);
 
@@ -31,9 +31,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/base/string_data.h"
 #include "mongo/db/catalog/clustered_collection_options_gen.h"
 #include "mongo/db/catalog/clustered_collection_util.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/list_collections_filter.h"
 #include "mongo/db/index_build_entry_helpers.h"
 #include "mongo/db/index_builds_coordinator.h"
@@ -41,11 +44,14 @@
 #include "mongo/db/repl/collection_cloner.h"
 #include "mongo/db/repl/database_cloner_gen.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace repl {
@@ -58,6 +64,20 @@ MONGO_FAIL_POINT_DEFINE(initialSyncHangDuringCollectionClone);
 // DBClientConnection, optionally limited to a specific collection.
 MONGO_FAIL_POINT_DEFINE(initialSyncHangCollectionClonerAfterHandlingBatchResponse);
 
+namespace {
+// Number of '_id' values sampled from the source per requested partition. Sampling several values
+// per partition evens out the size of the ranges.
+constexpr size_t kSampledIdsPerPartition = 32;
+
+// Number of batches each partition may have waiting to be inserted before it stops fetching.
+constexpr size_t kMaxPendingBatchesPerPartition = 2;
+
+// How often the thread waiting for the partitions checks whether initial sync was canceled.
+constexpr Milliseconds kPartitionCancellationCheckInterval{100};
+
+const BSONObj kIdIndexKeyPattern = BSON("_id" << 1);
+}  // namespace
+
 CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
                                    const CollectionOptions& collectionOptions,
                                    InitialSyncSharedData* sharedData,
@@ -98,7 +118,9 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
           _dbWorkTaskRunner.schedule(std::move(task));
           return executor::TaskExecutor::CallbackHandle();
       }),
-      _dbWorkTaskRunner(dbPool) {
+      _dbWorkTaskRunner(dbPool),
+      _createClientFn(
+          [] { return std::make_unique<DBClientConnection>(true /* autoReconnect */); }) {
     invariant(sourceNss.isValid());
     invariant(collectionOptions.uuid);
     _sourceDbAndUuid = NamespaceStringOrUUID(sourceNss.db().toString(), *collectionOptions.uuid);
@@ -249,7 +271,12 @@ BaseCloner::AfterStageBehavior CollectionCloner::createCollectionStage() {
 }
 
 BaseCloner::AfterStageBehavior CollectionCloner::queryStage() {
-    runQuery();
+    planPartitions();
+    if (_partitions.empty()) {
+        runQuery();
+    } else {
+        runPartitionedQuery();
+    }
     waitForDatabaseWorkToComplete();
     // We want to free the _collLoader regardless of whether the commit succeeds.
     std::unique_ptr<CollectionBulkLoader> loader = std::move(_collLoader);
@@ -458,6 +485,374 @@ void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::Cal
         });
 }
 
+std::vector<BSONObj> CollectionCloner::choosePartitionBoundaries(std::vector<BSONObj> sampledIds,
+                                                                size_t numPartitions) {
+    std::vector<BSONObj> boundaries;
+    if (numPartitions < 2 || sampledIds.size() < numPartitions) {
+        return boundaries;
+    }
+
+    // The _id index uses the simple collation, so comparing the values without their field names
+    // gives the order in which the index scan on the source returns them.
+    auto idLess = [](const BSONObj& lhs, const BSONObj& rhs) {
+        return lhs["_id"].woCompare(rhs["_id"], false /* considerFieldName */) < 0;
+    };
+    std::sort(sampledIds.begin(), sampledIds.end(), idLess);
+
+    for (size_t i = 1; i < numPartitions; ++i) {
+        const auto& candidate = sampledIds[i * sampledIds.size() / numPartitions];
+        // Duplicate boundaries would produce empty ranges.
+        if (boundaries.empty() || idLess(boundaries.back(), candidate)) {
+            boundaries.push_back(BSON("_id" << candidate["_id"]));
+        }
+    }
+    return boundaries;
+}
+
+void CollectionCloner::planPartitions() {
+    if (_partitionsPlanned) {
+        return;
+    }
+    _partitionsPlanned = true;
+
+    const size_t numPartitions = collectionClonerNumPartitions.load();
+    if (numPartitions < 2) {
+        return;
+    }
+
+    long long bytesToCopy;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        bytesToCopy = _stats.bytesToCopy;
+    }
+    if (bytesToCopy < collectionClonerPartitionMinBytes.load()) {
+        return;
+    }
+
+    // Partitions are read through the _id index, whose order must match the one used to compare
+    // the sampled boundaries. Capped collections must keep their insertion order and clustered
+    // collections have no separate _id index, so both are cloned with a single query.
+    if (_collectionOptions.capped || _collectionOptions.clusteredIndex ||
+        !_collectionOptions.collation.isEmpty() || _idIndexSpec.isEmpty()) {
+        LOGV2_DEBUG(6714000,
+                    1,
+                    "Collection is not eligible for a partitioned clone",
+                    logAttrs(_sourceNss));
+        return;
+    }
+
+    std::vector<BSONObj> boundaries;
+    try {
+        boundaries =
+            choosePartitionBoundaries(sampleIds(numPartitions * kSampledIdsPerPartition),
+                                      numPartitions);
+    } catch (const DBException& e) {
+        LOGV2(6714001,
+              "Failed to sample _id values for a partitioned collection clone, cloning the "
+              "collection with a single query",
+              logAttrs(_sourceNss),
+              "error"_attr = e.toStatus());
+        return;
+    }
+    if (boundaries.empty()) {
+        return;
+    }
+
+    _partitions.resize(boundaries.size() + 1);
+    for (size_t i = 0; i < boundaries.size(); ++i) {
+        _partitions[i].max = boundaries[i];
+        _partitions[i + 1].min = boundaries[i];
+    }
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _stats.partitions.resize(_partitions.size());
+    }
+    LOGV2(6714002,
+          "Cloning collection in partitions",
+          logAttrs(_sourceNss),
+          "numPartitions"_attr = _partitions.size(),
+          "bytesToCopy"_attr = bytesToCopy);
+}
+
+std::vector<BSONObj> CollectionCloner::sampleIds(size_t numSamples) {
+    const auto size = static_cast<long long>(numSamples);
+    BSONObj res;
+    getClient()->runCommand(
+        _sourceNss.db().toString(),
+        BSON("aggregate" << _sourceNss.coll().toString() << "pipeline"
+                         << BSON_ARRAY(BSON("$sample" << BSON("size" << size))
+                                       << BSON("$project" << kIdIndexKeyPattern))
+                         << "cursor" << BSON("batchSize" << size) << "readConcern"
+                         << ReadConcernArgs::kLocal),
+        res,
+        QueryOption_SecondaryOk);
+    uassertStatusOK(getStatusFromCommandResult(res));
+
+    std::vector<BSONObj> sampledIds;
+    for (auto&& elem : res["cursor"]["firstBatch"].Array()) {
+        sampledIds.push_back(elem.Obj().getOwned());
+    }
+    return sampledIds;
+}
+
+void CollectionCloner::runPartitionedQuery() {
+    std::vector<size_t> remaining;
+    for (size_t i = 0; i < _partitions.size(); ++i) {
+        if (!_partitions[i].complete) {
+            remaining.push_back(i);
+        }
+    }
+    if (remaining.empty()) {
+        return;
+    }
+
+    _partitionsAborted.store(false);
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _pendingPartitionBatches = 0;
+        _runningPartitions = remaining.size();
+    }
+
+    ThreadPool::Options options;
+    options.poolName = "CollectionClonerPartitionPool";
+    options.threadNamePrefix = "CollectionClonerPartition-";
+    options.maxThreads = remaining.size();
+    options.onCreateThread = [](const std::string& threadName) {
+        Client::initThread(threadName.c_str());
+    };
+    ThreadPool pool(options);
+    pool.startup();
+
+    auto errorMutex = MONGO_MAKE_LATCH("CollectionCloner::partitionErrorMutex");
+    Status firstError = Status::OK();
+    auto recordError = [&](Status status) {
+        _partitionsAborted.store(true);
+        {
+            // Partitions waiting for inserts to drain check the flag under the mutex, while the
+            // partitions waiting on the network are interrupted by shutting their connections down.
+            stdx::lock_guard<Latch> lk(_mutex);
+            for (auto client : _partitionClients) {
+                client->shutdownAndDisallowReconnect();
+            }
+        }
+        _partitionBatchInserted.notify_all();
+        stdx::lock_guard<Latch> lk(errorMutex);
+        if (firstError.isOK()) {
+            firstError = std::move(status);
+        }
+    };
+
+    for (auto partitionIndex : remaining) {
+        pool.schedule([this, partitionIndex, &recordError](Status status) {
+            ON_BLOCK_EXIT([&] {
+                {
+                    stdx::lock_guard<Latch> lk(_mutex);
+                    --_runningPartitions;
+                }
+                _partitionBatchInserted.notify_all();
+            });
+            if (!status.isOK()) {
+                recordError(std::move(status));
+                return;
+            }
+            try {
+                runPartitionQuery(partitionIndex);
+            } catch (const DBException& e) {
+                recordError(e.toStatus());
+            }
+        });
+    }
+    pool.shutdown();
+
+    // Canceling initial sync only shuts down the main connection of the cloners, so the partitions
+    // are aborted from here if that happens while they run.
+    while (true) {
+        {
+            stdx::unique_lock<Latch> lk(_mutex);
+            if (_partitionBatchInserted.wait_for(
+                    lk, kPartitionCancellationCheckInterval.toSystemDuration(), [&] {
+                        return _runningPartitions == 0;
+                    })) {
+                break;
+            }
+        }
+        if (_partitionsAborted.load()) {
+            continue;
+        }
+        auto status = [&] {
+            stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+            return getSharedData()->getStatus(lk);
+        }();
+        if (!status.isOK()) {
+            recordError(status.withContext("Collection cloning cancelled due to initial sync "
+                                           "failure"));
+        }
+    }
+    pool.join();
+
+    uassertStatusOK(firstError);
+}
+
+void CollectionCloner::runPartitionQuery(size_t partitionIndex) {
+    auto& partition = _partitions[partitionIndex];
+
+    auto client = _createClientFn();
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        uassert(ErrorCodes::CallbackCanceled,
+                "Collection cloning cancelled because another partition failed",
+                !_partitionsAborted.load());
+        _partitionClients.push_back(client.get());
+    }
+    ON_BLOCK_EXIT([&] {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _partitionClients.erase(
+            std::find(_partitionClients.begin(), _partitionClients.end(), client.get()));
+    });
+    uassertStatusOK(client->connect(getSource(), StringData(), boost::none));
+    uassertStatusOK(replAuthenticate(client.get())
+                        .withContext(str::stream() << "Failed to authenticate to " << getSource()));
+
+    // '$min' is inclusive, so a resumed query returns the last document handed off again and
+    // handleNextPartitionBatch() skips it.
+    BSONObjBuilder bounds;
+    if (partition.lastId) {
+        bounds.append("$min", *partition.lastId);
+    } else if (!partition.min.isEmpty()) {
+        bounds.append("$min", partition.min);
+    }
+    if (!partition.max.isEmpty()) {
+        bounds.append("$max", partition.max);
+    }
+    Query query;
+    query.appendElements(bounds.obj()).hint(kIdIndexKeyPattern);
+
+    bool skipResumePoint = partition.lastId.has_value();
+    client->query_DEPRECATED(
+        [&](DBClientCursorBatchIterator& iter) {
+            handleNextPartitionBatch(partitionIndex, &skipResumePoint, iter);
+        },
+        _sourceDbAndUuid,
+        BSONObj{},
+        query,
+        nullptr /* fieldsToReturn */,
+        QueryOption_NoCursorTimeout | QueryOption_SecondaryOk |
+            (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
+        _collectionClonerBatchSize,
+        ReadConcernArgs::kLocal);
+
+    partition.complete = true;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _stats.partitions[partitionIndex].complete = true;
+    }
+    LOGV2_DEBUG(6714003,
+                1,
+                "Finished fetching collection partition",
+                logAttrs(_sourceNss),
+                "partition"_attr = partitionIndex);
+}
+
+void CollectionCloner::handleNextPartitionBatch(size_t partitionIndex,
+                                                bool* skipResumePoint,
+                                                DBClientCursorBatchIterator& iter) {
+    {
+        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+        if (!getSharedData()->getStatus(lk).isOK()) {
+            static constexpr char message[] =
+                "Collection cloning cancelled due to initial sync failure";
+            LOGV2(6714004, message, "error"_attr = getSharedData()->getStatus(lk));
+            uasserted(ErrorCodes::CallbackCanceled,
+                      str::stream() << message << ": " << getSharedData()->getStatus(lk));
+        }
+    }
+    uassert(ErrorCodes::CallbackCanceled,
+            "Collection cloning cancelled because another partition failed",
+            !_partitionsAborted.load());
+
+    auto& partition = _partitions[partitionIndex];
+    std::vector<BSONObj> docs;
+    while (iter.moreInCurrentBatch()) {
+        auto doc = iter.nextSafe();
+        if (*skipResumePoint) {
+            *skipResumePoint = false;
+            if (doc["_id"].woCompare((*partition.lastId)["_id"], false) == 0) {
+                continue;
+            }
+        }
+        docs.emplace_back(std::move(doc));
+    }
+    boost::optional<BSONObj> lastId;
+    if (!docs.empty()) {
+        lastId = BSON("_id" << docs.back()["_id"]);
+    }
+
+    {
+        stdx::unique_lock<Latch> lk(_mutex);
+        _stats.receivedBatches++;
+        _stats.partitions[partitionIndex].receivedBatches++;
+        _partitionBatchInserted.wait(lk, [&] {
+            return _pendingPartitionBatches < kMaxPendingBatchesPerPartition * _partitions.size() ||
+                _partitionsAborted.load();
+        });
+        uassert(ErrorCodes::CallbackCanceled,
+                "Collection cloning cancelled because another partition failed",
+                !_partitionsAborted.load());
+        ++_pendingPartitionBatches;
+    }
+
+    auto&& scheduleResult = _scheduleDbWorkFn(
+        [this, partitionIndex, docs = std::move(docs)](
+            const executor::TaskExecutor::CallbackArgs& cbd) {
+            insertPartitionDocumentsCallback(cbd, partitionIndex, docs);
+        });
+    if (!scheduleResult.isOK()) {
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            --_pendingPartitionBatches;
+        }
+        uassertStatusOK(scheduleResult.getStatus().withContext(
+            str::stream() << "Error cloning collection '" << _sourceNss.ns() << "'"));
+    }
+
+    if (lastId) {
+        partition.lastId = std::move(lastId);
+    }
+}
+
+void CollectionCloner::insertPartitionDocumentsCallback(
+    const executor::TaskExecutor::CallbackArgs& cbd,
+    size_t partitionIndex,
+    const std::vector<BSONObj>& docs) {
+    ON_BLOCK_EXIT([&] {
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            --_pendingPartitionBatches;
+        }
+        _partitionBatchInserted.notify_all();
+    });
+    uassertStatusOK(cbd.status);
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        ++_stats.fetchedBatches;
+        if (docs.empty()) {
+            return;
+        }
+        _stats.documentsCopied += docs.size();
+        _stats.partitions[partitionIndex].documentsCopied += docs.size();
+        _stats.approxBytesCopied = ((long)_stats.documentsCopied) * _stats.avgObjSize;
+        _progressMeter.hit(int(docs.size()));
+        invariant(_collLoader);
+    }
+
+    // CollectionBulkLoader is not thread safe, but the database work task runner runs one task at
+    // a time, so batches from all partitions are inserted one after the other. The insert is done
+    // without the lock so that getStats() and partitions waiting for a free batch slot are not
+    // held up behind it.
+    uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
+}
+
 bool CollectionCloner::isMyFailPoint(const BSONObj& data) const {
     auto nss = data["nss"].str();
     return (nss.empty() || nss == _sourceNss.toString()) && BaseCloner::isMyFailPoint(data);
@@ -503,6 +898,19 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
         }
     }
     builder->appendNumber("receivedBatches", static_cast<long long>(receivedBatches));
+    if (!partitions.empty()) {
+        BSONArrayBuilder partitionsBuilder(builder->subarrayStart("partitions"));
+        for (auto&& partition : partitions) {
+            BSONObjBuilder partitionBuilder(partitionsBuilder.subobjStart());
+            partition.append(&partitionBuilder);
+        }
+    }
+}
+
+void CollectionCloner::Stats::PartitionStats::append(BSONObjBuilder* builder) const {
+    builder->appendNumber(kDocumentsCopiedFieldName, static_cast<long long>(documentsCopied));
+    builder->appendNumber("receivedBatches", static_cast<long long>(receivedBatches));
+    builder->appendBool("complete", complete);
 }
 
 }  // namespace repl
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -36,6 +37,8 @@
 #include "mongo/db/repl/initial_sync_base_cloner.h"
 #include "mongo/db/repl/initial_sync_shared_data.h"
 #include "mongo/db/repl/task_runner.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/progress_meter.h"
 
 namespace mongo {
@@ -52,6 +55,18 @@ public:
         static constexpr StringData kDocumentsToCopyFieldName = "documentsToCopy"_sd;
         static constexpr StringData kDocumentsCopiedFieldName = "documentsCopied"_sd;
 
+        /**
+         * Progress of one _id range when the collection is cloned in partitions.
+         */
+        struct PartitionStats {
+            size_t documentsCopied{0};
+            size_t receivedBatches{0};
+            // Set once every document in the range has been received from the sync source.
+            bool complete{false};
+
+            void append(BSONObjBuilder* builder) const;
+        };
+
         std::string ns;
         Date_t start;
         Date_t end;
@@ -63,6 +78,8 @@ public:
         long long bytesToCopy{0};
         long long avgObjSize{0};
         long long approxBytesCopied{0};
+        // Empty unless the collection is cloned in partitions.
+        std::vector<PartitionStats> partitions;
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -77,6 +94,11 @@ public:
     using ScheduleDbWorkFn = unique_function<StatusWith<executor::TaskExecutor::CallbackHandle>(
         executor::TaskExecutor::CallbackFn)>;
 
+    /**
+     * Type of function to create the connections used to clone the partitions of a collection.
+     */
+    using CreateClientFn = std::function<std::unique_ptr<DBClientConnection>()>;
+
     CollectionCloner(const NamespaceString& ns,
                      const CollectionOptions& collectionOptions,
                      InitialSyncSharedData* sharedData,
@@ -103,6 +125,15 @@ public:
         return *_sourceDbAndUuid.uuid();
     }
 
+    /**
+     * Given '_id' values sampled from a collection, each as a document of the form {_id: <value>},
+     * returns the distinct values that split them into at most 'numPartitions' ranges of roughly
+     * equal size, in ascending order. Returns an empty vector if there are fewer samples than
+     * partitions.
+     */
+    static std::vector<BSONObj> choosePartitionBoundaries(std::vector<BSONObj> sampledIds,
+                                                          size_t numPartitions);
+
     /**
      * Set the cloner batch size.
      *
@@ -122,6 +153,15 @@ public:
         _scheduleDbWorkFn = std::move(scheduleDbWorkFn);
     }
 
+    /**
+     * Overrides how connections for partitioned clones are created.
+     *
+     * For testing only.
+     */
+    void setCreateClientFn_forTest(CreateClientFn createClientFn) {
+        _createClientFn = std::move(createClientFn);
+    }
+
 protected:
     ClonerStages getStages() final;
 
@@ -226,6 +266,44 @@ private:
      */
     void runQuery();
 
+    /**
+     * Decides, once per clone, whether to split the collection into _id ranges. Fills in
+     * _partitions if the collection is eligible and large enough, and leaves it empty otherwise.
+     */
+    void planPartitions();
+
+    /**
+     * Samples '_id' values from the collection on the source to choose partition boundaries.
+     */
+    std::vector<BSONObj> sampleIds(size_t numSamples);
+
+    /**
+     * Clones every partition that has not completed yet, each over its own connection, and waits
+     * for all of them. Throws the first error encountered; partitions resume from the last
+     * document they received when the stage is retried.
+     */
+    void runPartitionedQuery();
+
+    /**
+     * Connects to the source and runs the query for a single partition.
+     */
+    void runPartitionQuery(size_t partitionIndex);
+
+    /**
+     * Schedules the insertion of a batch of results for one partition. Blocks while too many
+     * batches are waiting to be inserted.
+     */
+    void handleNextPartitionBatch(size_t partitionIndex,
+                                  bool* skipResumePoint,
+                                  DBClientCursorBatchIterator& iter);
+
+    /**
+     * Inserts one batch of documents received for a partition.
+     */
+    void insertPartitionDocumentsCallback(const executor::TaskExecutor::CallbackArgs& cbd,
+                                          size_t partitionIndex,
+                                          const std::vector<BSONObj>& docs);
+
     // All member variables are labeled with one of the following codes indicating the
     // synchronization rules for accessing them.
     //
@@ -273,6 +351,39 @@ private:
     // Signifies that there were changes to the collection on the sync source that resulted in
     // our remote cursor getting killed.
     bool _lostNonResumableCursor = false;  // (X)
+
+    // A contiguous _id range of the collection, cloned over its own connection. 'min' and 'max'
+    // are empty for the first and last range respectively.
+    struct Partition {
+        BSONObj min;
+        BSONObj max;
+        // The _id of the last document handed off for insertion, to resume from after an error.
+        boost::optional<BSONObj> lastId;
+        bool complete = false;
+    };
+
+    // Function for creating the connection used by each partition.
+    CreateClientFn _createClientFn;  // (R)
+
+    // Set once planPartitions() has run, so a retried query stage keeps the same plan.
+    bool _partitionsPlanned = false;  // (X)
+
+    // Empty unless the collection is cloned in partitions. While the query stage runs, each entry
+    // is only accessed by the thread cloning that partition.
+    std::vector<Partition> _partitions;  // (X)
+
+    // Set when one partition fails so that the others stop early.
+    AtomicWord<bool> _partitionsAborted{false};  // (S)
+
+    // Number of partition batches scheduled but not yet inserted, bounded so that fetching from
+    // several connections cannot outrun the single-threaded bulk loader.
+    size_t _pendingPartitionBatches = 0;                // (M)
+    stdx::condition_variable _partitionBatchInserted;  // (M)
+
+    // Number of partitions still being cloned, and their connections, which are shut down to
+    // interrupt the partitions waiting on the network when the partitioned query is aborted.
+    size_t _runningPartitions = 0;                       // (M)
+    std::vector<DBClientConnection*> _partitionClients;  // (M)
 };
 
 }  // namespace repl
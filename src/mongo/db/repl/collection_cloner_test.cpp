@@ -39,6 +39,7 @@
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/service_context_test_fixture.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/thread_pool.h"
 
@@ -1006,6 +1007,79 @@ TEST_F(CollectionClonerTestResumable, ResumableQueryTwoResumes) {
     ASSERT_EQUALS(7u, stats.documentsCopied);
 }
 
+TEST_F(CollectionClonerTest, ChoosePartitionBoundariesSplitsSortedSamplesEvenly) {
+    std::vector<BSONObj> sampledIds;
+    for (int i = 99; i >= 0; --i) {
+        sampledIds.push_back(BSON("_id" << i));
+    }
+    auto boundaries = CollectionCloner::choosePartitionBoundaries(std::move(sampledIds), 4);
+    ASSERT_EQUALS(3u, boundaries.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 25), boundaries[0]);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 50), boundaries[1]);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 75), boundaries[2]);
+}
+
+TEST_F(CollectionClonerTest, ChoosePartitionBoundariesOrdersMixedTypesLikeTheIdIndex) {
+    std::vector<BSONObj> sampledIds{BSON("_id"
+                                         << "b"),
+                                    BSON("_id" << 2),
+                                    BSON("_id"
+                                         << "a"),
+                                    BSON("_id" << 1)};
+    auto boundaries = CollectionCloner::choosePartitionBoundaries(std::move(sampledIds), 2);
+    ASSERT_EQUALS(1u, boundaries.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id"
+                           << "a"),
+                      boundaries[0]);
+}
+
+TEST_F(CollectionClonerTest, ChoosePartitionBoundariesSkipsDuplicatesAndTooFewSamples) {
+    std::vector<BSONObj> sameIds(8, BSON("_id" << 7));
+    auto boundaries = CollectionCloner::choosePartitionBoundaries(std::move(sameIds), 4);
+    ASSERT_EQUALS(1u, boundaries.size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 7), boundaries[0]);
+
+    std::vector<BSONObj> tooFew{BSON("_id" << 1), BSON("_id" << 2)};
+    ASSERT_TRUE(CollectionCloner::choosePartitionBoundaries(std::move(tooFew), 4).empty());
+}
+
+TEST_F(CollectionClonerTestResumable, SmallCollectionIsNotPartitioned) {
+    RAIIServerParameterControllerForTest numPartitions{"collectionClonerNumPartitions", 4};
+    setMockServerReplies(BSON("size" << 10),
+                         createCountResponse(2),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 1));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 2));
+
+    auto cloner = makeCollectionCloner();
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQUALS(2, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    auto stats = cloner->getStats();
+    ASSERT_TRUE(stats.partitions.empty());
+    ASSERT_FALSE(stats.toBSON().hasField("partitions"));
+}
+
+TEST_F(CollectionClonerTestResumable, CappedCollectionIsNotPartitioned) {
+    RAIIServerParameterControllerForTest numPartitions{"collectionClonerNumPartitions", 4};
+    RAIIServerParameterControllerForTest minBytes{"collectionClonerPartitionMinBytes", 0LL};
+    setMockServerReplies(BSON("size" << 10),
+                         createCountResponse(2),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 1));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 2));
+
+    CollectionOptions options;
+    options.capped = true;
+    options.cappedSize = 4096;
+    auto cloner = makeCollectionCloner(options);
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQUALS(2, _collectionStats->insertCount);
+    ASSERT_TRUE(cloner->getStats().partitions.empty());
+}
+
 
 }  // namespace repl
 }  // namespace mongo
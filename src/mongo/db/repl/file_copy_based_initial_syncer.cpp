@@ -0,0 +1,1062 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_based_initial_syncer.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+
+#include "mongo/client/dbclient_cursor.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/catalog/catalog_control.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/pipeline/aggregate_command_gen.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/repl/initial_syncer_common_stats.h"
+#include "mongo/db/repl/initial_syncer_factory.h"
+#include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_interface_local.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
+#include "mongo/db/repl/replication_consistency_markers.h"
+#include "mongo/db/repl/replication_recovery.h"
+#include "mongo/db/repl/sync_source_selector.h"
+#include "mongo/db/repl/tenant_migration_access_blocker_util.h"
+#include "mongo/db/repl/tenant_migration_shard_merge_util.h"
+#include "mongo/db/repl/transaction_oplog_application.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/startup_recovery.h"
+#include "mongo/db/storage/storage_engine_init.h"
+#include "mongo/db/storage/storage_file_util.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/db/write_concern_options.h"
+#include "mongo/logv2/log.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/destructor_guard.h"
+#include "mongo/util/str.h"
+#include "mongo/util/version.h"
+
+namespace mongo {
+namespace repl {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// The number of times the copy of a single file is resumed after a transient error.
+constexpr int kMaxFileCloneRetries = 10;
+
+constexpr StringData kMethodName = "fileCopyBased"_sd;
+constexpr StringData kStorageEngineName = "wiredTiger"_sd;
+
+// Options that change the layout of the data files, and so must match on the sync source.
+const std::vector<std::string> kStorageLayoutOptions = {
+    "storage.directoryPerDB",
+    "storage.wiredTiger.engineConfig.directoryForIndexes",
+    "security.enableEncryption"};
+
+ServiceContext::ConstructorActionRegisterer fileCopyBasedInitialSyncerRegisterer(
+    "FileCopyBasedInitialSyncerRegisterer",
+    {"InitialSyncerFactoryRegisterer"} /* dependency list */,
+    [](ServiceContext* service) {
+        InitialSyncerFactory::get(service)->registerInitialSyncer(
+            kMethodName.toString(),
+            [](InitialSyncerInterface::Options opts,
+               std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+               ThreadPool* writerPool,
+               StorageInterface* storage,
+               ReplicationProcess* replicationProcess,
+               const InitialSyncerInterface::OnCompletionFn& onCompletion) {
+                return std::make_shared<FileCopyBasedInitialSyncer>(
+                    opts,
+                    std::move(dataReplicatorExternalState),
+                    storage,
+                    replicationProcess,
+                    onCompletion);
+            },
+            [] {
+                if (!storageGlobalParams.readOnly) {
+                    FileCopyBasedInitialSyncer::recoverFromCrash(storageGlobalParams.dbpath);
+                }
+            });
+    });
+
+/**
+ * Returns whether 'name' is that of a file the storage engine owns, and which must therefore be
+ * replaced by the files of the sync source.
+ */
+bool isStorageFile(const std::string& name) {
+    return StringData(name).startsWith("WiredTiger") || StringData(name).endsWith(".wt") ||
+        name == "storage.bson";
+}
+
+/**
+ * Returns whether the entry 'name' at the top of the dbpath must be left alone when replacing
+ * the data files.
+ */
+bool isReservedDbPathEntry(const std::string& name) {
+    return name == FileCopyBasedInitialSyncer::kStagingDirName ||
+        name == FileCopyBasedInitialSyncer::kDeleteOldFilesMarker ||
+        name == FileCopyBasedInitialSyncer::kMoveStagedFilesMarker || name == "mongod.lock" ||
+        name == "diagnostic.data";
+}
+
+/**
+ * Runs 'fn', turning the filesystem_error thrown by boost::filesystem, for instance when the disk
+ * is full, into a DBException, which is how every caller in this file expects failures.
+ */
+template <typename F>
+void convertFilesystemErrors(F&& fn) {
+    try {
+        fn();
+    } catch (const fs::filesystem_error& ex) {
+        uasserted(6717026, str::stream() << "Filesystem operation failed: " << ex.what());
+    }
+}
+
+std::vector<fs::path> listDirectory(const fs::path& dir) {
+    std::vector<fs::path> entries;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        entries.push_back(entry.path());
+    }
+    return entries;
+}
+
+/**
+ * Deletes the storage files under 'dir', along with any directory left empty by doing so.
+ */
+void deleteStorageFiles(const fs::path& dir, bool isDbPath) {
+    for (const auto& path : listDirectory(dir)) {
+        const auto name = path.filename().string();
+        if (isDbPath && isReservedDbPathEntry(name)) {
+            continue;
+        }
+
+        if (fs::is_directory(path)) {
+            if (name == "journal" || name == "_tmp") {
+                fs::remove_all(path);
+                continue;
+            }
+            deleteStorageFiles(path, false);
+            if (fs::is_empty(path)) {
+                fs::remove(path);
+            }
+        } else if (isStorageFile(name)) {
+            fs::remove(path);
+        }
+    }
+}
+
+void writeMarkerFile(const fs::path& marker) {
+    {
+        std::ofstream markerFile(marker.string(), std::ios_base::out | std::ios_base::trunc);
+        uassert(ErrorCodes::FileOpenFailed,
+                str::stream() << "Failed to create " << marker.string(),
+                markerFile);
+    }
+    uassertStatusOK(fsyncParentDirectory(marker));
+}
+
+void deleteOldFiles(const fs::path& dbPath) {
+    LOGV2(6717001, "Deleting the old data files", "dbPath"_attr = dbPath.string());
+    deleteStorageFiles(dbPath, true);
+
+    const auto deleteMarker = dbPath / FileCopyBasedInitialSyncer::kDeleteOldFilesMarker.toString();
+    const auto moveMarker = dbPath / FileCopyBasedInitialSyncer::kMoveStagedFilesMarker.toString();
+    fs::rename(deleteMarker, moveMarker);
+    uassertStatusOK(fsyncParentDirectory(moveMarker));
+}
+
+void moveStagedFiles(const fs::path& dbPath) {
+    const auto stagingPath = dbPath / FileCopyBasedInitialSyncer::kStagingDirName.toString();
+    LOGV2(6717002,
+          "Moving the staged data files into the dbpath",
+          "stagingPath"_attr = stagingPath.string(),
+          "dbPath"_attr = dbPath.string());
+    if (fs::exists(stagingPath)) {
+        for (const auto& path : listDirectory(stagingPath)) {
+            const auto name = path.filename().string();
+            if (name == "mongod.lock" || name == "diagnostic.data") {
+                continue;
+            }
+            const auto target = dbPath / name;
+            if (fs::exists(target)) {
+                fs::remove_all(target);
+            }
+            fs::rename(path, target);
+        }
+        fs::remove_all(stagingPath);
+    }
+
+    const auto moveMarker = dbPath / FileCopyBasedInitialSyncer::kMoveStagedFilesMarker.toString();
+    uassertStatusOK(fsyncParentDirectory(moveMarker));
+    fs::remove(moveMarker);
+    uassertStatusOK(fsyncParentDirectory(moveMarker));
+}
+
+/**
+ * Returns the path of 'path' relative to 'basePath', with '/' separators.
+ */
+std::string getPathRelativeTo(const std::string& path, const std::string& basePath) {
+    uassert(6717003,
+            str::stream() << "The file " << path << " is not under " << basePath,
+            !basePath.empty() && StringData(path).startsWith(basePath));
+
+    auto result = path.substr(basePath.size());
+    // Skip separators at the beginning of the relative part.
+    if (!result.empty() && (result[0] == '/' || result[0] == '\\')) {
+        result.erase(result.begin());
+    }
+    std::replace(result.begin(), result.end(), '\\', '/');
+    return result;
+}
+
+bool isRetriableCloneError(const Status& status) {
+    return ErrorCodes::isRetriableError(status) || status == ErrorCodes::CursorNotFound;
+}
+
+}  // namespace
+
+BSONObj FileCopyBasedInitialSyncer::Stats::toBSON() const {
+    BSONObjBuilder bob;
+    append(&bob);
+    return bob.obj();
+}
+
+void FileCopyBasedInitialSyncer::Stats::append(BSONObjBuilder* builder) const {
+    builder->append("method", kMethodName);
+    builder->appendNumber("failedInitialSyncAttempts",
+                          static_cast<long long>(failedInitialSyncAttempts));
+    builder->appendNumber("maxFailedInitialSyncAttempts",
+                          static_cast<long long>(maxFailedInitialSyncAttempts));
+    if (initialSyncStart != Date_t()) {
+        builder->appendDate("initialSyncStart", initialSyncStart);
+        if (initialSyncEnd != Date_t()) {
+            builder->appendDate("initialSyncEnd", initialSyncEnd);
+            builder->appendNumber(
+                "totalInitialSyncElapsedMillis",
+                durationCount<Milliseconds>(initialSyncEnd - initialSyncStart));
+        }
+    }
+    if (!syncSource.empty()) {
+        builder->append("syncSource", syncSource.toString());
+    }
+    if (backupId) {
+        backupId->appendToBuilder(builder, "backupId");
+    }
+    if (!phase.empty()) {
+        builder->append("phase", phase);
+    }
+    builder->appendNumber("totalFiles", static_cast<long long>(totalFiles));
+    builder->appendNumber("copiedFiles", static_cast<long long>(copiedFiles));
+    builder->appendNumber("totalBytes", totalBytes);
+    builder->appendNumber("copiedBytes", copiedBytes);
+    builder->appendNumber("backupCursorExtensions", backupCursorExtensions);
+}
+
+FileCopyBasedInitialSyncer::FileCopyBasedInitialSyncer(
+    InitialSyncerInterface::Options opts,
+    std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+    StorageInterface* storage,
+    ReplicationProcess* replicationProcess,
+    const OnCompletionFn& onCompletion)
+    : _opts(opts),
+      _dataReplicatorExternalState(std::move(dataReplicatorExternalState)),
+      _storage(storage),
+      _replicationProcess(replicationProcess),
+      _onCompletion(onCompletion),
+      _dbPath(storageGlobalParams.dbpath) {
+    uassert(ErrorCodes::BadValue,
+            "data replicator external state cannot be null",
+            _dataReplicatorExternalState);
+    uassert(ErrorCodes::BadValue, "invalid storage interface", _storage);
+    uassert(ErrorCodes::BadValue, "invalid replication process", _replicationProcess);
+    uassert(ErrorCodes::BadValue, "invalid getMyLastOptime function", _opts.getMyLastOptime);
+    uassert(ErrorCodes::BadValue, "invalid setMyLastOptime function", _opts.setMyLastOptime);
+    uassert(ErrorCodes::BadValue, "invalid resetOptimes function", _opts.resetOptimes);
+    uassert(ErrorCodes::BadValue, "invalid sync source selector", _opts.syncSourceSelector);
+    uassert(ErrorCodes::BadValue, "callback function cannot be null", _onCompletion);
+}
+
+FileCopyBasedInitialSyncer::~FileCopyBasedInitialSyncer() {
+    DESTRUCTOR_GUARD({
+        shutdown().transitional_ignore();
+        join();
+    });
+}
+
+Status FileCopyBasedInitialSyncer::startup(OperationContext* opCtx,
+                                           std::uint32_t maxAttempts) noexcept {
+    invariant(opCtx);
+    invariant(maxAttempts >= 1U);
+
+    stdx::lock_guard<Latch> lock(_mutex);
+    if (_inShutdown) {
+        return Status(ErrorCodes::ShutdownInProgress, "initial syncer shutting down");
+    }
+    if (_started) {
+        return Status(ErrorCodes::IllegalOperation, "initial syncer already started");
+    }
+    _started = true;
+
+    // As in logical initial sync, the data on this node is unusable until the initial sync flag
+    // is cleared, and no stable checkpoint may be taken before then.
+    auto consistencyMarkers = _replicationProcess->getConsistencyMarkers();
+    consistencyMarkers->setInitialSyncFlag(opCtx);
+    consistencyMarkers->clearInitialSyncId(opCtx);
+    auto serviceCtx = opCtx->getServiceContext();
+    _storage->setInitialDataTimestamp(serviceCtx, Timestamp::kAllowUnstableCheckpointsSentinel);
+    _storage->setStableTimestamp(serviceCtx, Timestamp::min());
+
+    _stats.initialSyncStart = Date_t::now();
+    _stats.maxFailedInitialSyncAttempts = maxAttempts;
+    _thread = stdx::thread([this, maxAttempts] { _runInitialSync(maxAttempts); });
+    return Status::OK();
+}
+
+Status FileCopyBasedInitialSyncer::shutdown() {
+    stdx::lock_guard<Latch> lock(_mutex);
+    _inShutdown = true;
+    _cancelCondition.notify_all();
+    return Status::OK();
+}
+
+void FileCopyBasedInitialSyncer::join() {
+    stdx::thread thread;
+    {
+        stdx::lock_guard<Latch> lock(_mutex);
+        thread = std::move(_thread);
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+BSONObj FileCopyBasedInitialSyncer::getInitialSyncProgress() const {
+    stdx::lock_guard<Latch> lock(_mutex);
+    if (!_started) {
+        return BSONObj();
+    }
+    return _stats.toBSON();
+}
+
+void FileCopyBasedInitialSyncer::cancelCurrentAttempt() {
+    stdx::lock_guard<Latch> lock(_mutex);
+    _attemptCanceled = true;
+    _cancelCondition.notify_all();
+}
+
+std::string FileCopyBasedInitialSyncer::getInitialSyncMethod() const {
+    return kMethodName.toString();
+}
+
+void FileCopyBasedInitialSyncer::moveStagedFilesIntoDbPath(const fs::path& dbPath) {
+    convertFilesystemErrors([&] {
+        writeMarkerFile(dbPath / kDeleteOldFilesMarker.toString());
+        deleteOldFiles(dbPath);
+        moveStagedFiles(dbPath);
+    });
+}
+
+void FileCopyBasedInitialSyncer::recoverFromCrash(const fs::path& dbPath) {
+    convertFilesystemErrors([&] {
+        if (!fs::exists(dbPath)) {
+            return;
+        }
+
+        if (fs::exists(dbPath / kDeleteOldFilesMarker.toString())) {
+            LOGV2(6717004,
+                  "Resuming the deletion of old data files after a file copy based initial sync");
+            deleteOldFiles(dbPath);
+        }
+        if (fs::exists(dbPath / kMoveStagedFilesMarker.toString())) {
+            LOGV2(6717005,
+                  "Resuming the move of staged data files after a file copy based initial sync");
+            moveStagedFiles(dbPath);
+            return;
+        }
+
+        // Without a marker, a staging directory only holds the files of an unfinished attempt.
+        const auto stagingPath = dbPath / kStagingDirName.toString();
+        if (fs::exists(stagingPath)) {
+            LOGV2(6717006,
+                  "Removing the staging directory of an unfinished file copy based initial sync",
+                  "stagingPath"_attr = stagingPath.string());
+            fs::remove_all(stagingPath);
+        }
+    });
+}
+
+void FileCopyBasedInitialSyncer::_runInitialSync(std::uint32_t maxAttempts) noexcept {
+    Client::initThread("FileCopyBasedInitialSyncer");
+
+    StatusWith<OpTimeAndWallTime> result =
+        Status(ErrorCodes::InternalError, "file copy based initial sync did not run");
+    {
+        auto opCtx = cc().makeOperationContext();
+        for (std::uint32_t attempt = 1;; ++attempt) {
+            {
+                stdx::lock_guard<Latch> lock(_mutex);
+                _attemptCanceled = false;
+            }
+            LOGV2(6717007,
+                  "Starting file copy based initial sync attempt",
+                  "attempt"_attr = attempt,
+                  "maxAttempts"_attr = maxAttempts);
+            try {
+                result = _runInitialSyncAttempt(opCtx.get());
+                break;
+            } catch (const DBException& ex) {
+                result = ex.toStatus();
+            } catch (const std::exception& ex) {
+                // This function must not throw, so unexpected errors fail the attempt as well.
+                result = Status(ErrorCodes::UnknownError, ex.what());
+            }
+
+            boost::system::error_code ec;
+            fs::remove_all(_stagingPath(), ec);
+
+            stdx::unique_lock<Latch> lock(_mutex);
+            if (_inShutdown) {
+                result = Status(ErrorCodes::CallbackCanceled, "initial syncer shutting down");
+                break;
+            }
+            if (result.getStatus() == ErrorCodes::InvalidSyncSource) {
+                // The replication coordinator falls back to logical initial sync.
+                LOGV2(6717008,
+                      "Sync source cannot be used for file copy based initial sync",
+                      "error"_attr = result.getStatus());
+                break;
+            }
+
+            ++_stats.failedInitialSyncAttempts;
+            initial_sync_common_stats::initialSyncFailedAttempts.increment();
+            if (_stats.failedInitialSyncAttempts >= maxAttempts) {
+                LOGV2_ERROR(6717009,
+                            "File copy based initial sync attempt failed; no attempts remaining",
+                            "error"_attr = result.getStatus(),
+                            "attempts"_attr = _stats.failedInitialSyncAttempts);
+                initial_sync_common_stats::initialSyncFailures.increment();
+                break;
+            }
+            LOGV2_ERROR(6717010,
+                        "File copy based initial sync attempt failed",
+                        "error"_attr = result.getStatus(),
+                        "attemptsLeft"_attr = maxAttempts - _stats.failedInitialSyncAttempts);
+            _cancelCondition.wait_for(lock, _opts.initialSyncRetryWait.toSystemDuration(), [&] {
+                return _inShutdown;
+            });
+        }
+    }
+
+    {
+        stdx::lock_guard<Latch> lock(_mutex);
+        _stats.initialSyncEnd = Date_t::now();
+    }
+
+    // The completion function makes its own operation context on this thread.
+    _onCompletion(result);
+}
+
+OpTimeAndWallTime FileCopyBasedInitialSyncer::_runInitialSyncAttempt(OperationContext* opCtx) {
+    _opts.resetOptimes();
+    _backupId = boost::none;
+    _backupCursorId = 0;
+    _filesToCopy.clear();
+
+    _setPhase("choosing sync source");
+    const auto source = _chooseSyncSource();
+    {
+        stdx::lock_guard<Latch> lock(_mutex);
+        _stats.syncSource = source;
+        _stats.backupId = boost::none;
+        _stats.totalFiles = 0;
+        _stats.copiedFiles = 0;
+        _stats.totalBytes = 0;
+        _stats.copiedBytes = 0;
+        _stats.backupCursorExtensions = 0;
+    }
+    LOGV2(6717011,
+          "Chose sync source for file copy based initial sync",
+          "syncSource"_attr = source);
+
+    auto client = _connect(source);
+    _checkSyncSource(client.get());
+
+    convertFilesystemErrors([&] {
+        fs::remove_all(_stagingPath());
+        fs::create_directories(_stagingPath());
+    });
+
+    _setPhase("copying files");
+    _openBackupCursor(client.get());
+    {
+        ScopeGuard killBackupCursor([&] { _killBackupCursor(client.get()); });
+        _cloneFiles(source);
+        _extendBackupCursor(client.get());
+    }
+    _checkForCancellation();
+
+    // The copy brings along the replica set state of the sync source; keep that of this node.
+    const auto localConfig =
+        uassertStatusOK(_dataReplicatorExternalState->loadLocalConfigDocument(opCtx));
+    boost::optional<BSONObj> lastVote;
+    auto swLastVote = _storage->findSingleton(opCtx, NamespaceString::kLastVoteNamespace);
+    if (swLastVote.isOK()) {
+        lastVote = swLastVote.getValue().getOwned();
+    } else if (swLastVote != ErrorCodes::CollectionIsEmpty &&
+               swLastVote != ErrorCodes::NamespaceNotFound) {
+        uassertStatusOK(swLastVote);
+    }
+
+    _setPhase("preparing staged files");
+    OpTimeAndWallTime lastApplied;
+    try {
+        _switchStorageLocation(opCtx, _stagingPath().string(), [] {});
+        lastApplied = _prepareStagedFiles(opCtx, localConfig, lastVote);
+    } catch (const DBException&) {
+        // Go back to the old data files, which are still intact. Should that fail, the storage
+        // engine is left on the staging directory or not open at all, which the caller cannot
+        // recover from.
+        try {
+            _switchStorageLocation(opCtx, _dbPath, [] {});
+        } catch (const DBException& ex) {
+            LOGV2_FATAL(6717027,
+                        "Failed to reopen the storage engine on the old data files after a failed "
+                        "file copy based initial sync attempt",
+                        "error"_attr = ex.toStatus());
+        }
+        throw;
+    }
+
+    // Past this point the old data files are being replaced, so there is no way back. A failure
+    // is fatal, and the move is finished by recoverFromCrash() on restart.
+    _setPhase("replacing data files");
+    try {
+        _switchStorageLocation(
+            opCtx, _dbPath, [this] { moveStagedFilesIntoDbPath(fs::path(_dbPath)); });
+    } catch (const DBException& ex) {
+        LOGV2_FATAL(6717012,
+                    "Failed to replace the data files with those copied from the sync source",
+                    "error"_attr = ex.toStatus());
+    }
+
+    _setPhase("finishing");
+    _finishInitialSync(opCtx, lastApplied);
+    return lastApplied;
+}
+
+HostAndPort FileCopyBasedInitialSyncer::_chooseSyncSource() {
+    const auto maxAttempts = numInitialSyncConnectAttempts.load();
+    for (int attempt = 1;; ++attempt) {
+        _checkForCancellation();
+        auto source = _opts.syncSourceSelector->chooseNewSyncSource(OpTime());
+        if (!source.empty()) {
+            return source;
+        }
+        uassert(ErrorCodes::InitialSyncOplogSourceMissing,
+                str::stream() << "No valid sync source found after " << attempt << " attempts",
+                attempt < maxAttempts);
+
+        stdx::unique_lock<Latch> lock(_mutex);
+        _cancelCondition.wait_for(lock, _opts.syncSourceRetryWait.toSystemDuration(), [&] {
+            return _inShutdown || _attemptCanceled;
+        });
+    }
+}
+
+std::unique_ptr<DBClientConnection> FileCopyBasedInitialSyncer::_connect(
+    const HostAndPort& source) {
+    auto client = std::make_unique<DBClientConnection>(true /* autoReconnect */);
+    uassertStatusOK(client->connect(source, "FileCopyBasedInitialSyncer", boost::none));
+    uassertStatusOK(replAuthenticate(client.get())
+                        .withContext(str::stream() << "Failed to authenticate to " << source));
+    return client;
+}
+
+void FileCopyBasedInitialSyncer::_checkSyncSource(DBClientConnection* client) {
+    uassert(ErrorCodes::InvalidSyncSource,
+            str::stream() << "File copy based initial sync requires the " << kStorageEngineName
+                          << " storage engine",
+            storageGlobalParams.engine == kStorageEngineName);
+
+    BSONObj buildInfo;
+    client->runCommand(NamespaceString::kAdminDb.toString(), BSON("buildInfo" << 1), buildInfo);
+    uassertStatusOK(getStatusFromCommandResult(buildInfo));
+    const auto localVersion = VersionInfoInterface::instance().version();
+    uassert(ErrorCodes::InvalidSyncSource,
+            str::stream() << "Sync source runs version " << buildInfo["version"].str()
+                          << ", but this node runs version " << localVersion,
+            buildInfo["version"].str() == localVersion);
+
+    BSONObj serverStatus;
+    client->runCommand(NamespaceString::kAdminDb.toString(),
+                       BSON("serverStatus" << 1 << "storageEngine" << 1),
+                       serverStatus);
+    uassertStatusOK(getStatusFromCommandResult(serverStatus));
+    const auto remoteEngine =
+        dotted_path_support::extractElementAtPath(serverStatus, "storageEngine.name").str();
+    uassert(ErrorCodes::InvalidSyncSource,
+            str::stream() << "Sync source uses the " << remoteEngine << " storage engine",
+            remoteEngine == kStorageEngineName);
+
+    BSONObj cmdLineOpts;
+    client->runCommand(
+        NamespaceString::kAdminDb.toString(), BSON("getCmdLineOpts" << 1), cmdLineOpts);
+    uassertStatusOK(getStatusFromCommandResult(cmdLineOpts));
+    const auto remoteOpts = cmdLineOpts["parsed"].Obj();
+    for (const auto& option : kStorageLayoutOptions) {
+        const bool remote =
+            dotted_path_support::extractElementAtPath(remoteOpts, option).trueValue();
+        const bool local =
+            dotted_path_support::extractElementAtPath(serverGlobalParams.parsedOpts, option)
+                .trueValue();
+        uassert(ErrorCodes::InvalidSyncSource,
+                str::stream() << "The sync source and this node have different values for "
+                              << option,
+                remote == local);
+    }
+}
+
+void FileCopyBasedInitialSyncer::_openBackupCursor(DBClientConnection* client) {
+    BackupAggregationResult result;
+    try {
+        result = _runBackupAggregation(
+            client, BSON("$backupCursor" << BSONObj()), Milliseconds::zero());
+    } catch (const DBException& ex) {
+        // A backup cursor can conflict with a checkpoint in progress; the next attempt retries.
+        if (ErrorCodes::isRetriableError(ex) ||
+            ex.code() == ErrorCodes::BackupCursorOpenConflictWithCheckpoint) {
+            throw;
+        }
+        uasserted(ErrorCodes::InvalidSyncSource,
+                  str::stream() << "Sync source cannot open a backup cursor: " << ex.reason());
+    }
+    _backupCursorId = result.cursorId;
+    _backupCursorNss = result.nss;
+    if (_backupCursorId) {
+        _keepAliveCancellation = CancellationSource();
+        _keepAliveFuture = shard_merge_utils::keepBackupCursorAlive(
+            _keepAliveCancellation,
+            _dataReplicatorExternalState->getSharedTaskExecutor(),
+            client->getServerHostAndPort(),
+            _backupCursorId,
+            _backupCursorNss);
+    }
+
+    uassert(6717013,
+            "Backup cursor did not return its metadata",
+            !result.docs.empty() && result.docs.front()["metadata"].isABSONObj());
+    const auto metadata = result.docs.front()["metadata"].Obj();
+    _backupId = uassertStatusOK(UUID::parse(metadata["backupId"]));
+    _remoteDbPath = metadata["dbpath"].str();
+    uassert(ErrorCodes::InvalidSyncSource,
+            "Backup cursor of the sync source is not at a stable checkpoint",
+            metadata["checkpointTimestamp"].type() == bsonTimestamp);
+    _backupEnd = uassertStatusOK(OpTime::parseFromOplogEntry(metadata["oplogEnd"].Obj()));
+    _filesToCopy.assign(std::next(result.docs.begin()), result.docs.end());
+
+    long long totalBytes = 0;
+    for (const auto& file : _filesToCopy) {
+        totalBytes += file["fileSize"].safeNumberLong();
+    }
+    LOGV2(6717014,
+          "Opened backup cursor on sync source",
+          "backupId"_attr = *_backupId,
+          "files"_attr = _filesToCopy.size(),
+          "bytes"_attr = totalBytes,
+          "backupEnd"_attr = _backupEnd);
+
+    stdx::lock_guard<Latch> lock(_mutex);
+    _stats.backupId = _backupId;
+    _stats.totalFiles += _filesToCopy.size();
+    _stats.totalBytes += totalBytes;
+}
+
+void FileCopyBasedInitialSyncer::_extendBackupCursor(DBClientConnection* client) {
+    const auto& source = client->getServerHostAndPort();
+    for (int cycle = 0;; ++cycle) {
+        _checkForCancellation();
+
+        const auto sourceLastApplied = _getSyncSourceLastApplied(client);
+        const Seconds lag(static_cast<long long>(sourceLastApplied.getTimestamp().getSecs()) -
+                          static_cast<long long>(_backupEnd.getTimestamp().getSecs()));
+        if (lag <= Seconds(fileBasedInitialSyncMaxLagSec)) {
+            return;
+        }
+        if (cycle >= fileBasedInitialSyncMaxCyclesWithoutProgress) {
+            // Steady state replication catches up the rest through the oplog.
+            LOGV2(6717015,
+                  "File copy still lags the sync source after extending the backup cursor; "
+                  "proceeding",
+                  "lag"_attr = lag,
+                  "cycles"_attr = cycle);
+            return;
+        }
+
+        LOGV2(6717016,
+              "Extending backup cursor",
+              "lag"_attr = lag,
+              "backupEnd"_attr = _backupEnd,
+              "extendTo"_attr = sourceLastApplied);
+        auto result = _runBackupAggregation(
+            client,
+            BSON("$backupCursorExtend"
+                 << BSON("backupId" << *_backupId << "timestamp"
+                                    << sourceLastApplied.getTimestamp())),
+            Milliseconds(fileBasedInitialSyncExtendCursorTimeoutMS));
+
+        // The extension only lists journal files, which are copied again in full.
+        _filesToCopy = std::move(result.docs);
+        long long totalBytes = 0;
+        for (const auto& file : _filesToCopy) {
+            totalBytes += file["fileSize"].safeNumberLong();
+        }
+        {
+            stdx::lock_guard<Latch> lock(_mutex);
+            _stats.totalFiles += _filesToCopy.size();
+            _stats.totalBytes += totalBytes;
+            ++_stats.backupCursorExtensions;
+        }
+        _cloneFiles(source);
+        _backupEnd = sourceLastApplied;
+    }
+}
+
+void FileCopyBasedInitialSyncer::_killBackupCursor(DBClientConnection* client) {
+    if (_keepAliveFuture) {
+        _keepAliveCancellation.cancel();
+        auto keepAliveFuture = std::move(*_keepAliveFuture);
+        _keepAliveFuture.reset();
+        keepAliveFuture.getNoThrow().ignore();
+    }
+    if (!_backupCursorId) {
+        return;
+    }
+
+    const auto cursorId = std::exchange(_backupCursorId, 0);
+    Status status = Status::OK();
+    try {
+        BSONObj reply;
+        client->runCommand(_backupCursorNss.db().toString(),
+                           BSON("killCursors" << _backupCursorNss.coll() << "cursors"
+                                              << BSON_ARRAY(cursorId)),
+                           reply);
+        status = getStatusFromCommandResult(reply);
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+    // The sync source closes the backup cursor itself once it times out.
+    if (!status.isOK()) {
+        LOGV2_WARNING(6717017,
+                      "Failed to kill the backup cursor on the sync source",
+                      "cursorId"_attr = cursorId,
+                      "error"_attr = status);
+    }
+}
+
+void FileCopyBasedInitialSyncer::_cloneFiles(const HostAndPort& source) {
+    std::unique_ptr<DBClientConnection> client;
+    for (const auto& file : _filesToCopy) {
+        if (!client) {
+            client = _connect(source);
+        }
+        _cloneFile(source, &client, file);
+
+        stdx::lock_guard<Latch> lock(_mutex);
+        ++_stats.copiedFiles;
+    }
+    _filesToCopy.clear();
+}
+
+void FileCopyBasedInitialSyncer::_cloneFile(const HostAndPort& source,
+                                            std::unique_ptr<DBClientConnection>* client,
+                                            const BSONObj& file) {
+    const auto remoteFileName = file["filename"].str();
+    const auto relativePath = getPathRelativeTo(remoteFileName, _remoteDbPath);
+    const auto stagingPath = _stagingPath();
+    const auto localPath = (stagingPath / relativePath).lexically_normal();
+    uassert(6717018,
+            str::stream() << "Path " << relativePath << " must not escape its parent directory.",
+            !relativePath.empty() &&
+                StringData(localPath.generic_string()).startsWith(stagingPath.generic_string()));
+
+    convertFilesystemErrors([&] { fs::create_directories(localPath.parent_path()); });
+    std::ofstream localFile(localPath.string(),
+                            std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    uassert(ErrorCodes::FileOpenFailed,
+            str::stream() << "Failed to open file " << localPath.string(),
+            localFile);
+
+    long long fileOffset = 0;
+    bool sawEof = false;
+    int retries = 0;
+    while (!sawEof) {
+        _checkForCancellation();
+        try {
+            AggregateCommandRequest aggRequest(
+                NamespaceString::makeCollectionlessAggregateNSS(NamespaceString::kAdminDb),
+                {BSON("$_backupFile" << BSON("backupId" << *_backupId << "file" << remoteFileName
+                                                        << "byteOffset" << fileOffset))});
+            aggRequest.setReadConcern(ReadConcernArgs::kImplicitDefault);
+            aggRequest.setWriteConcern(WriteConcernOptions());
+            auto cursor = uassertStatusOK(
+                DBClientCursor::fromAggregationRequest(client->get(),
+                                                       std::move(aggRequest),
+                                                       true /* secondaryOk */,
+                                                       true /* useExhaust */));
+
+            while (cursor->more()) {
+                const auto doc = cursor->nextSafe();
+                uassert(6717019,
+                        str::stream() << "Received data for " << remoteFileName
+                                      << " out of order",
+                        doc["byteOffset"].safeNumberLong() == fileOffset);
+                const auto& dataElem = doc["data"];
+                uassert(6717020,
+                        str::stream() << "Data field for " << remoteFileName
+                                      << " is not BinData: " << dataElem,
+                        dataElem.type() == BinData && dataElem.binDataType() == BinDataGeneral);
+                int dataLength;
+                auto data = dataElem.binData(dataLength);
+                localFile.write(data, dataLength);
+                uassert(ErrorCodes::FileStreamFailed,
+                        str::stream() << "Unable to write file data for " << localPath.string(),
+                        !localFile.fail());
+                fileOffset += dataLength;
+                sawEof = doc["endOfFile"].booleanSafe();
+
+                stdx::lock_guard<Latch> lock(_mutex);
+                _stats.copiedBytes += dataLength;
+            }
+            uassert(6717021,
+                    str::stream() << "Sync source did not send the end of " << remoteFileName,
+                    sawEof);
+        } catch (const DBException& ex) {
+            if (!isRetriableCloneError(ex.toStatus()) || ++retries > kMaxFileCloneRetries) {
+                throw;
+            }
+            // An exhaust cursor cannot be resumed after an error, so reconnect and copy the rest
+            // of the file from where the last batch ended.
+            LOGV2(6717022,
+                  "Resuming file copy after a transient error",
+                  "file"_attr = remoteFileName,
+                  "byteOffset"_attr = fileOffset,
+                  "error"_attr = ex.toStatus());
+            *client = _connect(source);
+        }
+    }
+
+    localFile.close();
+    uassert(ErrorCodes::FileStreamFailed,
+            str::stream() << "Unable to close file " << localPath.string(),
+            !localFile.fail());
+}
+
+FileCopyBasedInitialSyncer::BackupAggregationResult
+FileCopyBasedInitialSyncer::_runBackupAggregation(DBClientConnection* client,
+                                                  const BSONObj& stage,
+                                                  Milliseconds maxTime) {
+    AggregateCommandRequest aggRequest(
+        NamespaceString::makeCollectionlessAggregateNSS(NamespaceString::kAdminDb), {stage});
+    // We must set a writeConcern on internal commands.
+    aggRequest.setWriteConcern(WriteConcernOptions());
+    if (maxTime > Milliseconds::zero()) {
+        aggRequest.setMaxTimeMS(durationCount<Milliseconds>(maxTime));
+    }
+
+    BSONObj reply;
+    client->runCommand(NamespaceString::kAdminDb.toString(), aggRequest.toBSON(BSONObj()), reply);
+    uassertStatusOK(getStatusFromCommandResult(reply));
+    auto response = uassertStatusOK(CursorResponse::parseFromBSON(reply));
+
+    BackupAggregationResult result;
+    result.cursorId = response.getCursorId();
+    result.nss = response.getNSS();
+    for (const auto& doc : response.getBatch()) {
+        result.docs.push_back(doc.getOwned());
+    }
+
+    // A backup cursor stays open after listing every file; it returns empty batches from then on.
+    while (result.cursorId) {
+        client->runCommand(result.nss.db().toString(),
+                           BSON("getMore" << result.cursorId << "collection" << result.nss.coll()),
+                           reply);
+        uassertStatusOK(getStatusFromCommandResult(reply));
+        auto moreResponse = uassertStatusOK(CursorResponse::parseFromBSON(reply));
+        result.cursorId = moreResponse.getCursorId();
+        if (moreResponse.getBatch().empty()) {
+            break;
+        }
+        for (const auto& doc : moreResponse.getBatch()) {
+            result.docs.push_back(doc.getOwned());
+        }
+    }
+    return result;
+}
+
+OpTime FileCopyBasedInitialSyncer::_getSyncSourceLastApplied(DBClientConnection* client) {
+    BSONObj reply;
+    client->runCommand(NamespaceString::kAdminDb.toString(), BSON("hello" << 1), reply);
+    uassertStatusOK(getStatusFromCommandResult(reply));
+    const auto opTimeElem = dotted_path_support::extractElementAtPath(reply, "lastWrite.opTime");
+    uassert(6717023, "Sync source did not report its last write", opTimeElem.isABSONObj());
+    return uassertStatusOK(OpTime::parseFromOplogEntry(opTimeElem.Obj()));
+}
+
+void FileCopyBasedInitialSyncer::_switchStorageLocation(OperationContext* opCtx,
+                                                        const std::string& dbPath,
+                                                        const std::function<void()>& beforeOpen) {
+    LOGV2(6717024, "Reopening the storage engine", "dbPath"_attr = dbPath);
+
+    Lock::GlobalWrite globalLock(opCtx);
+    catalog::closeCatalog(opCtx);
+    const auto lastShutdownState =
+        reinitializeStorageEngine(opCtx, StorageEngineInitFlags{}, [&] {
+            beforeOpen();
+            if (dbPath == _dbPath) {
+                // Let the storage engine take the lock file back.
+                _dbPathLockFile = boost::none;
+            } else if (!_dbPathLockFile) {
+                _dbPathLockFile.emplace(_dbPath);
+                uassertStatusOK(_dbPathLockFile->open());
+            }
+            storageGlobalParams.dbpath = dbPath;
+        });
+
+    // Reinitializing the storage engine leaves this operation with a no-op recovery unit.
+    auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
+    opCtx->setRecoveryUnit(std::unique_ptr<RecoveryUnit>(storageEngine->newRecoveryUnit()),
+                           WriteUnitOfWork::RecoveryUnitState::kNotInUnitOfWork);
+    storageEngine->setJournalListener(
+        _dataReplicatorExternalState->getReplicationJournalListener());
+
+    startup_recovery::runStartupRecoveryInMode(
+        opCtx, lastShutdownState, startup_recovery::StartupRecoveryMode::kReplicaSetMember);
+    catalog::openCatalogAfterStorageChange(opCtx);
+    storageEngine->notifyStartupComplete();
+    acquireOplogCollectionForLogging(opCtx);
+}
+
+OpTimeAndWallTime FileCopyBasedInitialSyncer::_prepareStagedFiles(
+    OperationContext* opCtx, const BSONObj& localConfig, const boost::optional<BSONObj>& lastVote) {
+    auto serviceCtx = opCtx->getServiceContext();
+    uassert(ErrorCodes::InvalidSyncSource,
+            "The copied files do not have a stable checkpoint to recover from",
+            _storage->getRecoveryTimestamp(serviceCtx));
+
+    // Replays the oplog entries the copy has past its checkpoint, and sets the initial data
+    // timestamp to the top of the oplog.
+    _replicationProcess->getReplicationRecovery()->recoverFromOplogAsStandalone(
+        opCtx, true /* duringInitialSync */);
+
+    auto oplogIter = OplogInterfaceLocal(opCtx).makeIterator();
+    const auto topOfOplog = uassertStatusOK(oplogIter->next()).first;
+    const auto lastApplied =
+        uassertStatusOK(OpTimeAndWallTime::parseOpTimeAndWallTimeFromOplogEntry(topOfOplog));
+    oplogIter.reset();
+
+    uassertStatusOK(_dataReplicatorExternalState->storeLocalConfigDocument(opCtx, localConfig));
+    if (lastVote) {
+        uassertStatusOK(_storage->putSingleton(
+            opCtx, NamespaceString::kLastVoteNamespace, {*lastVote, Timestamp()}));
+    } else {
+        auto status = _storage->truncateCollection(opCtx, NamespaceString::kLastVoteNamespace);
+        if (status != ErrorCodes::NamespaceNotFound) {
+            uassertStatusOK(status);
+        }
+    }
+
+    // Should the process die before the data files are replaced, the next startup must not use
+    // them as they stand.
+    auto consistencyMarkers = _replicationProcess->getConsistencyMarkers();
+    consistencyMarkers->setInitialSyncFlag(opCtx);
+    consistencyMarkers->clearInitialSyncId(opCtx);
+
+    // Let the clean shutdown of the staged files take a stable checkpoint at the top of the
+    // oplog, which is where the storage engine recovers to once they are in the dbpath.
+    _storage->setStableTimestamp(serviceCtx, lastApplied.opTime.getTimestamp());
+    return lastApplied;
+}
+
+void FileCopyBasedInitialSyncer::_finishInitialSync(OperationContext* opCtx,
+                                                    const OpTimeAndWallTime& lastApplied) {
+    const auto initialDataTimestamp = lastApplied.opTime.getTimestamp();
+
+    // Register the top of the oplog so that it is visible to readers.
+    const bool orderedCommit = true;
+    _storage->oplogDiskLocRegister(opCtx, initialDataTimestamp, orderedCommit);
+
+    tenant_migration_access_blocker::recoverTenantMigrationAccessBlockers(opCtx);
+    reconstructPreparedTransactions(opCtx, OplogApplication::Mode::kInitialSync);
+
+    // The copy brings along the rollback id of the sync source.
+    uassertStatusOK(_replicationProcess->refreshRollbackID(opCtx));
+
+    auto consistencyMarkers = _replicationProcess->getConsistencyMarkers();
+    consistencyMarkers->setInitialSyncIdIfNotSet(opCtx);
+    _storage->setInitialDataTimestamp(opCtx->getServiceContext(), initialDataTimestamp);
+    consistencyMarkers->clearInitialSyncFlag(opCtx);
+
+    if (_opts.getMyLastOptime().isNull()) {
+        _opts.setMyLastOptime(lastApplied);
+    }
+
+    initial_sync_common_stats::initialSyncCompletes.increment();
+    stdx::lock_guard<Latch> lock(_mutex);
+    LOGV2(6717025,
+          "File copy based initial sync done",
+          "lastApplied"_attr = lastApplied.opTime,
+          "duration"_attr = Date_t::now() - _stats.initialSyncStart,
+          "copiedBytes"_attr = _stats.copiedBytes);
+}
+
+void FileCopyBasedInitialSyncer::_setPhase(StringData phase) {
+    stdx::lock_guard<Latch> lock(_mutex);
+    _stats.phase = phase.toString();
+}
+
+void FileCopyBasedInitialSyncer::_checkForCancellation() {
+    stdx::lock_guard<Latch> lock(_mutex);
+    uassert(ErrorCodes::CallbackCanceled, "initial syncer shutting down", !_inShutdown);
+    uassert(ErrorCodes::CallbackCanceled, "initial sync attempt canceled", !_attemptCanceled);
+}
+
+fs::path FileCopyBasedInitialSyncer::_stagingPath() const {
+    return fs::path(_dbPath) / kStagingDirName.toString();
+}
+
+}  // namespace repl
+}  // namespace mongo
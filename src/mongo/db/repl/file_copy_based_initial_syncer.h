@@ -0,0 +1,286 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/client/dbclient_connection.h"
+#include "mongo/db/cursor_id.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/repl/data_replicator_external_state.h"
+#include "mongo/db/repl/initial_syncer_interface.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/repl/replication_process.h"
+#include "mongo/db/repl/storage_interface.h"
+#include "mongo/db/storage/storage_engine_lock_file.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/cancellation.h"
+#include "mongo/util/future.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Initial syncer that copies the WiredTiger files of the sync source instead of cloning every
+ * document and rebuilding every index.
+ *
+ * An attempt opens a $backupCursor on the sync source and streams each file it lists with
+ * $_backupFile into a staging directory under the dbpath, extending the backup with
+ * $backupCursorExtend while the copy lags the sync source by more than
+ * 'fileBasedInitialSyncMaxLagSec'. The storage engine is then reopened on the staging directory,
+ * where the copied oplog is replayed and the local replication state of this node (config, last
+ * vote, initial sync flag) is written over that of the sync source. Finally the storage engine is
+ * reopened on the dbpath after the staging files have replaced the old ones, and steady state
+ * replication catches up from the top of the copied oplog.
+ *
+ * The attempt runs on its own thread. Any sync source that cannot serve a compatible backup
+ * fails the attempt with InvalidSyncSource, which makes the replication coordinator fall back to
+ * logical initial sync.
+ */
+class FileCopyBasedInitialSyncer final : public InitialSyncerInterface {
+    FileCopyBasedInitialSyncer(const FileCopyBasedInitialSyncer&) = delete;
+    FileCopyBasedInitialSyncer& operator=(const FileCopyBasedInitialSyncer&) = delete;
+
+public:
+    // Directory under the dbpath that the files of the sync source are copied into.
+    static constexpr StringData kStagingDirName = ".initialsync"_sd;
+
+    // Marker files, kept in the dbpath, recording how far the staging files have got in
+    // replacing the old data files. See moveStagedFilesIntoDbPath().
+    static constexpr StringData kDeleteOldFilesMarker = "initialSyncDeleteOldFiles.marker"_sd;
+    static constexpr StringData kMoveStagedFilesMarker = "initialSyncMoveStagedFiles.marker"_sd;
+
+    struct Stats {
+        std::uint32_t failedInitialSyncAttempts{0};
+        std::uint32_t maxFailedInitialSyncAttempts{0};
+        Date_t initialSyncStart;
+        Date_t initialSyncEnd;
+        HostAndPort syncSource;
+        boost::optional<UUID> backupId;
+        std::string phase;
+        size_t totalFiles{0};
+        size_t copiedFiles{0};
+        long long totalBytes{0};
+        long long copiedBytes{0};
+        int backupCursorExtensions{0};
+
+        BSONObj toBSON() const;
+        void append(BSONObjBuilder* builder) const;
+    };
+
+    FileCopyBasedInitialSyncer(
+        InitialSyncerInterface::Options opts,
+        std::unique_ptr<DataReplicatorExternalState> dataReplicatorExternalState,
+        StorageInterface* storage,
+        ReplicationProcess* replicationProcess,
+        const OnCompletionFn& onCompletion);
+
+    ~FileCopyBasedInitialSyncer() final;
+
+    Status startup(OperationContext* opCtx, std::uint32_t maxAttempts) noexcept final;
+
+    Status shutdown() final;
+
+    void join() final;
+
+    BSONObj getInitialSyncProgress() const final;
+
+    void cancelCurrentAttempt() final;
+
+    std::string getInitialSyncMethod() const final;
+
+    /**
+     * The local database is replaced along with every other database, so it must not be read
+     * while the initial sync is running.
+     */
+    bool allowLocalDbAccess() const final {
+        return false;
+    }
+
+    /**
+     * Replaces the data files in 'dbPath' with the ones in its staging directory. Must be called
+     * while no storage engine is open on 'dbPath'.
+     *
+     * The old files are deleted under kDeleteOldFilesMarker and the staged files are then moved
+     * under kMoveStagedFilesMarker, so that recoverFromCrash() can finish the job if the process
+     * dies part way.
+     */
+    static void moveStagedFilesIntoDbPath(const boost::filesystem::path& dbPath);
+
+    /**
+     * Run at startup, before the storage engine is opened. Finishes replacing the data files if
+     * a previous process died while doing so, and otherwise removes any staging directory left
+     * behind by an interrupted attempt.
+     */
+    static void recoverFromCrash(const boost::filesystem::path& dbPath);
+
+private:
+    /**
+     * Runs attempts until one succeeds, the maximum number of attempts is reached or the
+     * initial syncer is shut down, then calls the completion function.
+     */
+    void _runInitialSync(std::uint32_t maxAttempts) noexcept;
+
+    /**
+     * Runs a single attempt and returns the optime of the top of the copied oplog.
+     */
+    OpTimeAndWallTime _runInitialSyncAttempt(OperationContext* opCtx);
+
+    /**
+     * Waits for the sync source selector to choose a sync source.
+     */
+    HostAndPort _chooseSyncSource();
+
+    std::unique_ptr<DBClientConnection> _connect(const HostAndPort& source);
+
+    /**
+     * Fails with InvalidSyncSource unless 'source' runs the same server version and storage
+     * configuration as this node.
+     */
+    void _checkSyncSource(DBClientConnection* client);
+
+    void _openBackupCursor(DBClientConnection* client);
+
+    /**
+     * Extends the backup cursor to the last applied optime of the sync source, as long as the
+     * copy lags the sync source by more than 'fileBasedInitialSyncMaxLagSec'.
+     */
+    void _extendBackupCursor(DBClientConnection* client);
+
+    void _killBackupCursor(DBClientConnection* client);
+
+    /**
+     * Copies the files listed by the backup cursor that have not been copied yet.
+     */
+    void _cloneFiles(const HostAndPort& source);
+
+    void _cloneFile(const HostAndPort& source,
+                    std::unique_ptr<DBClientConnection>* client,
+                    const BSONObj& file);
+
+    struct BackupAggregationResult {
+        std::vector<BSONObj> docs;
+        CursorId cursorId = 0;
+        NamespaceString nss;
+    };
+
+    /**
+     * Runs a cursor-returning aggregation on the admin database and returns every document of
+     * every batch. The cursor is left open if it has not been exhausted by the time a batch comes
+     * back empty, as a backup cursor is.
+     */
+    BackupAggregationResult _runBackupAggregation(DBClientConnection* client,
+                                                  const BSONObj& stage,
+                                                  Milliseconds maxTime);
+
+    /**
+     * Returns the last applied optime of the sync source, as reported by 'hello'.
+     */
+    OpTime _getSyncSourceLastApplied(DBClientConnection* client);
+
+    /**
+     * Reopens the storage engine on 'dbPath'. 'beforeOpen' runs while no storage engine is open.
+     *
+     * This sets storageGlobalParams.dbpath to 'dbPath', so that anything reading it while the
+     * storage engine runs on the staging directory sees the staging directory. The storage engine
+     * only holds the lock file of the directory it runs on, so while it runs anywhere but the
+     * dbpath of this node, '_dbPathLockFile' keeps another mongod from starting on the dbpath.
+     */
+    void _switchStorageLocation(OperationContext* opCtx,
+                                const std::string& dbPath,
+                                const std::function<void()>& beforeOpen);
+
+    /**
+     * Replays the copied oplog on the staged files and writes the local replication state of
+     * this node over that of the sync source. Returns the top of the copied oplog.
+     */
+    OpTimeAndWallTime _prepareStagedFiles(OperationContext* opCtx,
+                                          const BSONObj& localConfig,
+                                          const boost::optional<BSONObj>& lastVote);
+
+    /**
+     * Clears the initial sync flag and brings the in-memory state in line with the new data, as
+     * the logical initial syncer does when it finishes.
+     */
+    void _finishInitialSync(OperationContext* opCtx, const OpTimeAndWallTime& lastApplied);
+
+    void _setPhase(StringData phase);
+
+    /**
+     * Throws if the initial syncer is shutting down or the current attempt has been cancelled.
+     */
+    void _checkForCancellation();
+
+    boost::filesystem::path _stagingPath() const;
+
+    // All member variables are labeled with one of the following codes indicating the
+    // synchronization rules for accessing them.
+    //
+    // (R)  Read-only in concurrent operation; no synchronization required.
+    // (M)  Reads and writes guarded by _mutex.
+    // (X)  Access only allowed from the initial sync thread.
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("FileCopyBasedInitialSyncer::_mutex");
+    stdx::condition_variable _cancelCondition;                                        // (M)
+    const InitialSyncerInterface::Options _opts;                                      // (R)
+    const std::unique_ptr<DataReplicatorExternalState> _dataReplicatorExternalState;  // (R)
+    StorageInterface* const _storage;                                                 // (R)
+    ReplicationProcess* const _replicationProcess;                                    // (R)
+    const OnCompletionFn _onCompletion;                                               // (R)
+    const std::string _dbPath;                                                        // (R)
+
+    stdx::thread _thread;           // (M)
+    bool _started = false;          // (M)
+    bool _inShutdown = false;       // (M)
+    bool _attemptCanceled = false;  // (M)
+    Stats _stats;                   // (M)
+
+    // State of the backup cursor of the current attempt.
+    boost::optional<UUID> _backupId;                     // (X)
+    CursorId _backupCursorId = 0;                        // (X)
+    NamespaceString _backupCursorNss;                    // (X)
+    std::string _remoteDbPath;                           // (X)
+    OpTime _backupEnd;                                   // (X)
+    std::vector<BSONObj> _filesToCopy;                   // (X)
+    CancellationSource _keepAliveCancellation;           // (X)
+    boost::optional<SemiFuture<void>> _keepAliveFuture;  // (X)
+
+    // Lock file of '_dbPath', held while the storage engine runs on the staging directory.
+    boost::optional<StorageEngineLockFile> _dbPathLockFile;  // (X)
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+
+#include "mongo/db/repl/file_copy_based_initial_syncer.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+namespace fs = boost::filesystem;
+
+void writeFile(const fs::path& path, const std::string& contents) {
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path.string(), std::ios_base::out | std::ios_base::trunc);
+    file << contents;
+}
+
+std::string readFile(const fs::path& path) {
+    std::ifstream file(path.string());
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+class FileCopyBasedInitialSyncerFilesTest : public unittest::Test {
+public:
+    void setUp() override {
+        _dbPath = fs::path(_tempDir.path());
+        _stagingPath = _dbPath / FileCopyBasedInitialSyncer::kStagingDirName.toString();
+
+        // The old data files.
+        writeFile(_dbPath / "WiredTiger", "old");
+        writeFile(_dbPath / "WiredTiger.wt", "old");
+        writeFile(_dbPath / "_mdb_catalog.wt", "old");
+        writeFile(_dbPath / "collection-1-old.wt", "old");
+        writeFile(_dbPath / "storage.bson", "old");
+        writeFile(_dbPath / "journal" / "WiredTigerLog.0000000001", "old");
+        writeFile(_dbPath / "olddb" / "collection-2-old.wt", "old");
+
+        // Files in the dbpath that do not belong to the storage engine.
+        writeFile(_dbPath / "mongod.lock", "lock");
+        writeFile(_dbPath / "diagnostic.data" / "metrics.interim", "ftdc");
+        writeFile(_dbPath / "mongod.log", "log");
+
+        // The files copied from the sync source.
+        writeFile(_stagingPath / "WiredTiger", "new");
+        writeFile(_stagingPath / "WiredTiger.wt", "new");
+        writeFile(_stagingPath / "_mdb_catalog.wt", "new");
+        writeFile(_stagingPath / "collection-3-new.wt", "new");
+        writeFile(_stagingPath / "storage.bson", "new");
+        writeFile(_stagingPath / "journal" / "WiredTigerLog.0000000002", "new");
+        writeFile(_stagingPath / "newdb" / "collection-4-new.wt", "new");
+        writeFile(_stagingPath / "mongod.lock", "staginglock");
+    }
+
+    void assertFilesReplaced() {
+        ASSERT_EQUALS("new", readFile(_dbPath / "WiredTiger"));
+        ASSERT_EQUALS("new", readFile(_dbPath / "WiredTiger.wt"));
+        ASSERT_EQUALS("new", readFile(_dbPath / "_mdb_catalog.wt"));
+        ASSERT_EQUALS("new", readFile(_dbPath / "collection-3-new.wt"));
+        ASSERT_EQUALS("new", readFile(_dbPath / "storage.bson"));
+        ASSERT_EQUALS("new", readFile(_dbPath / "journal" / "WiredTigerLog.0000000002"));
+        ASSERT_EQUALS("new", readFile(_dbPath / "newdb" / "collection-4-new.wt"));
+
+        ASSERT_FALSE(fs::exists(_dbPath / "collection-1-old.wt"));
+        ASSERT_FALSE(fs::exists(_dbPath / "journal" / "WiredTigerLog.0000000001"));
+        ASSERT_FALSE(fs::exists(_dbPath / "olddb"));
+
+        ASSERT_EQUALS("lock", readFile(_dbPath / "mongod.lock"));
+        ASSERT_EQUALS("ftdc", readFile(_dbPath / "diagnostic.data" / "metrics.interim"));
+        ASSERT_EQUALS("log", readFile(_dbPath / "mongod.log"));
+
+        ASSERT_FALSE(fs::exists(_stagingPath));
+        ASSERT_FALSE(
+            fs::exists(_dbPath / FileCopyBasedInitialSyncer::kDeleteOldFilesMarker.toString()));
+        ASSERT_FALSE(
+            fs::exists(_dbPath / FileCopyBasedInitialSyncer::kMoveStagedFilesMarker.toString()));
+    }
+
+protected:
+    unittest::TempDir _tempDir{"file_copy_based_initial_syncer_test"};
+    fs::path _dbPath;
+    fs::path _stagingPath;
+};
+
+TEST_F(FileCopyBasedInitialSyncerFilesTest, MoveStagedFilesReplacesStorageFiles) {
+    FileCopyBasedInitialSyncer::moveStagedFilesIntoDbPath(_dbPath);
+    assertFilesReplaced();
+}
+
+TEST_F(FileCopyBasedInitialSyncerFilesTest, RecoverFromCrashRemovesUnfinishedStagingDirectory) {
+    FileCopyBasedInitialSyncer::recoverFromCrash(_dbPath);
+
+    ASSERT_FALSE(fs::exists(_stagingPath));
+    ASSERT_EQUALS("old", readFile(_dbPath / "WiredTiger.wt"));
+    ASSERT_EQUALS("old", readFile(_dbPath / "collection-1-old.wt"));
+    ASSERT_EQUALS("old", readFile(_dbPath / "olddb" / "collection-2-old.wt"));
+}
+
+TEST_F(FileCopyBasedInitialSyncerFilesTest, RecoverFromCrashFinishesDeletingOldFiles) {
+    // The process died after deleting some of the old files.
+    writeFile(_dbPath / FileCopyBasedInitialSyncer::kDeleteOldFilesMarker.toString(), "");
+    fs::remove(_dbPath / "WiredTiger.wt");
+
+    FileCopyBasedInitialSyncer::recoverFromCrash(_dbPath);
+    assertFilesReplaced();
+}
+
+TEST_F(FileCopyBasedInitialSyncerFilesTest, RecoverFromCrashFinishesMovingStagedFiles) {
+    // The process died after deleting the old files and moving some of the staged ones.
+    writeFile(_dbPath / FileCopyBasedInitialSyncer::kMoveStagedFilesMarker.toString(), "");
+    for (const auto& name : {"WiredTiger",
+                             "WiredTiger.wt",
+                             "_mdb_catalog.wt",
+                             "collection-1-old.wt",
+                             "storage.bson"}) {
+        fs::remove(_dbPath / name);
+    }
+    fs::remove_all(_dbPath / "journal");
+    fs::remove_all(_dbPath / "olddb");
+    fs::rename(_stagingPath / "WiredTiger", _dbPath / "WiredTiger");
+    fs::rename(_stagingPath / "newdb", _dbPath / "newdb");
+
+    FileCopyBasedInitialSyncer::recoverFromCrash(_dbPath);
+    assertFilesReplaced();
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
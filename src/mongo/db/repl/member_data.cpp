@@ -165,6 +165,10 @@ bool MemberData::advanceLastAppliedOpTimeAndWallTime(OpTimeAndWallTime opTime, D
     _lastUpdate = now;
     _lastUpdateStale = false;
     if (_lastAppliedOpTime < opTime.opTime) {
+        // The first optime learned for a member says nothing about how fast it replicates.
+        if (!_lastAppliedOpTime.isNull()) {
+            _appliedLatency.record(opTime.wallTime, now);
+        }
         setLastAppliedOpTimeAndWallTime(opTime, now);
         return true;
     }
@@ -176,6 +180,9 @@ bool MemberData::advanceLastDurableOpTimeAndWallTime(OpTimeAndWallTime opTime, D
     _lastUpdate = now;
     _lastUpdateStale = false;
     if (_lastDurableOpTime < opTime.opTime) {
+        if (!_lastDurableOpTime.isNull()) {
+            _durableLatency.record(opTime.wallTime, now);
+        }
         _lastDurableOpTime = opTime.opTime;
         _lastDurableWallTime = opTime.wallTime;
         return true;
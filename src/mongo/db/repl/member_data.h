@@ -33,6 +33,7 @@
 #include "mongo/db/repl/member_id.h"
 #include "mongo/db/repl/member_state.h"
 #include "mongo/db/repl/repl_set_heartbeat_response.h"
+#include "mongo/db/repl/replication_latency_tracker.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
@@ -258,6 +259,18 @@ public:
         _configTerm = term;
     }
 
+    /**
+     * How long the oplog entries took from being written on the primary to being reported as
+     * applied or durable by this member, as measured when this node learns that the member's
+     * optimes advanced.
+     */
+    const ReplicationLatencyHistogram& getAppliedLatency() const {
+        return _appliedLatency;
+    }
+    const ReplicationLatencyHistogram& getDurableLatency() const {
+        return _durableLatency;
+    }
+
 private:
     bool _checkAndSetLastDurableOpTime(OpTime opTime, Date_t now);
     // -1 = not checked yet, 0 = member is down/unreachable, 1 = member is up
@@ -298,6 +311,10 @@ private:
     OpTime _lastAppliedOpTime;
     Date_t _lastAppliedWallTime = Date_t();
 
+    // Latencies of the advances of the optimes above reported by this member.
+    ReplicationLatencyHistogram _appliedLatency;
+    ReplicationLatencyHistogram _durableLatency;
+
     // Last known configVersion.
     int _configVersion = -1;
 
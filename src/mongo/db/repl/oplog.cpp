@@ -1127,6 +1127,23 @@ StatusWith<OplogApplication::Mode> OplogApplication::parseMode(const std::string
     MONGO_UNREACHABLE;
 }
 
+namespace {
+const auto timestampGroupedWrites = OperationContext::declareDecoration<bool>();
+}  // namespace
+
+TimestampGroupedWritesBlock::TimestampGroupedWritesBlock(OperationContext* opCtx) : _opCtx(opCtx) {
+    invariant(!timestampGroupedWrites(_opCtx));
+    timestampGroupedWrites(_opCtx) = true;
+}
+
+TimestampGroupedWritesBlock::~TimestampGroupedWritesBlock() {
+    timestampGroupedWrites(_opCtx) = false;
+}
+
+bool TimestampGroupedWritesBlock::isActive(OperationContext* opCtx) {
+    return timestampGroupedWrites(opCtx);
+}
+
 // @return failure status if an update should have happened and the document DNE.
 // See replset initial sync code.
 Status applyOperation_inlock(OperationContext* opCtx,
@@ -1219,11 +1236,12 @@ Status applyOperation_inlock(OperationContext* opCtx,
             // of a non-atomic applyOps command, but we ignore it so that we don't violate oplog
             // ordering.
             return false;
-        } else if (haveWrappingWriteUnitOfWork) {
+        } else if (haveWrappingWriteUnitOfWork && !TimestampGroupedWritesBlock::isActive(opCtx)) {
             // We do not assign timestamps to non-replicated writes that have a wrapping
             // WriteUnitOfWork, as they will get the timestamp on that WUOW. Use cases include: (1)
             // Atomic applyOps (used by sharding). (2) Secondary oplog application of prepared
-            // transactions.
+            // transactions. Grouped updates and deletes in secondary oplog application share a
+            // WriteUnitOfWork but each still carries its own timestamp.
             return false;
         } else {
             switch (replMode) {
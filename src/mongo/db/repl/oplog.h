@@ -218,6 +218,26 @@ Status applyOperation_inlock(OperationContext* opCtx,
                              bool isDataConsistent,
                              IncrementOpsAppliedStatsFn incrementOpsAppliedStats = {});
 
+/**
+ * While in scope, applyOperation_inlock() timestamps each update and delete with the 'ts' of its
+ * own oplog entry even though the caller holds a WriteUnitOfWork spanning several operations.
+ * Used by secondary oplog application to apply a group of updates and deletes on one collection
+ * in a single storage transaction.
+ */
+class TimestampGroupedWritesBlock {
+    TimestampGroupedWritesBlock(const TimestampGroupedWritesBlock&) = delete;
+    TimestampGroupedWritesBlock& operator=(const TimestampGroupedWritesBlock&) = delete;
+
+public:
+    explicit TimestampGroupedWritesBlock(OperationContext* opCtx);
+    ~TimestampGroupedWritesBlock();
+
+    static bool isActive(OperationContext* opCtx);
+
+private:
+    OperationContext* const _opCtx;
+};
+
 /**
  * Take a command op and apply it locally
  * Used for applying from an oplog and for applyOps command.
@@ -164,6 +164,7 @@ std::unique_ptr<ThreadPool> makeReplWriterPool(int threadCount,
     options.minThreads =
         replWriterMinThreadCount < threadCount ? replWriterMinThreadCount : threadCount;
     options.maxThreads = static_cast<size_t>(threadCount);
+    options.workStealing = replWriterWorkStealing;
     options.onCreateThread = [isKillableByStepdown](const std::string&) {
         Client::initThread(getThreadName());
         auto client = Client::getCurrent();
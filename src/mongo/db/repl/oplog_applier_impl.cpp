@@ -43,7 +43,9 @@
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/repl/apply_ops.h"
 #include "mongo/db/repl/oplog_applier_utils.h"
+#include "mongo/db/repl/oplog_batch_size_controller.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_latency_tracker.h"
 #include "mongo/db/repl/transaction_oplog_application.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/timer_stats.h"
@@ -52,6 +54,7 @@
 #include "mongo/platform/basic.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log_with_sampling.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace repl {
@@ -73,6 +76,14 @@ ServerStatusMetricField<Counter64> displayOplogApplicationBatchSize("repl.apply.
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+// Number of writer vectors per writer thread when the writer pool uses work stealing.
+constexpr size_t kWriterVectorsPerThreadWithWorkStealing = 4;
+
+// Number of batches that were written to the oplog while the previous batch was being applied.
+Counter64 pipelinedOplogWriteBatches;
+ServerStatusMetricField<Counter64> displayPipelinedOplogWriteBatches(
+    "repl.apply.pipelinedBatches", &pipelinedOplogWriteBatches);
+
 /**
  * Used for logging a report of ops that take longer than "slowMS" to apply. This is called
  * right before returning from applyOplogEntryOrGroupedInserts, and it returns the same status.
@@ -115,6 +126,7 @@ void _addOplogChainOpsToWriterVectors(OperationContext* opCtx,
                                       std::vector<std::vector<OplogEntry>>* derivedOps,
                                       OplogEntry* op,
                                       CachedCollectionProperties* collPropertiesCache,
+                                      WriterAssignment* writerAssignment,
                                       std::vector<std::vector<const OplogEntry*>>* writerVectors) {
     std::vector<OplogEntry> txnOps;
     bool shouldSerialize = false;
@@ -124,8 +136,12 @@ void _addOplogChainOpsToWriterVectors(OperationContext* opCtx,
     partialTxnList->clear();
 
     // Transaction entries cannot have different session updates.
-    OplogApplierUtils::addDerivedOps(
-        opCtx, &derivedOps->back(), writerVectors, collPropertiesCache, shouldSerialize);
+    OplogApplierUtils::addDerivedOps(opCtx,
+                                     &derivedOps->back(),
+                                     writerVectors,
+                                     collPropertiesCache,
+                                     writerAssignment,
+                                     shouldSerialize);
 }
 
 }  // namespace
@@ -265,6 +281,22 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
             ? new ApplyBatchFinalizerForJournal(_replCoord)
             : new ApplyBatchFinalizer(_replCoord)};
 
+    // Writing the next batch to the oplog can only overlap with applying the current one if this
+    // applier writes the entries it applies to the oplog at all.
+    if (replPipelinedOplogWrites && !getOptions().skipWritesToOplog) {
+        _oplogWriterPool = makeReplWriterPool(_writerPool->getStats().options.maxThreads,
+                                              "ReplOplogWriter"_sd);
+    }
+    ON_BLOCK_EXIT([this] {
+        if (_oplogWriterPool) {
+            _oplogWriterPool->shutdown();
+            _oplogWriterPool->join();
+            _oplogWriterPool.reset();
+        }
+        _nextBatch = boost::none;
+        _oplogWrittenThrough = OpTime();
+    });
+
     while (true) {  // Exits on message from OplogBatcher.
         // Use a new operation context each iteration, as otherwise we may appear to use a single
         // collection name to refer to collections with different UUIDs.
@@ -289,7 +321,7 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
         // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
         // ready in time, we'll loop again so we can do the above checks periodically.
-        OplogBatch ops = _oplogBatcher->getNextBatch(Seconds(1));
+        OplogBatch ops = _getNextBatch(Seconds(1));
         if (ops.empty()) {
             if (ops.mustShutdown()) {
                 // Shut down and exit oplog application loop.
@@ -316,6 +348,13 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         const auto lastWallTimeInBatch = lastOpInBatch.getWallClockTime();
         const auto lastAppliedOpTimeAtStartOfBatch = _replCoord->getMyLastAppliedOpTime();
 
+        if (getOptions().mode == OplogApplication::Mode::kSecondary) {
+            ReplicationLatencyTracker::get(opCtx.getServiceContext())
+                ->record(ReplicationLatencyTracker::Stage::kBatched,
+                         lastWallTimeInBatch,
+                         Date_t::now());
+        }
+
         // Make sure the oplog doesn't go back in time or repeat an entry.
         if (firstOpTimeInBatch <= lastAppliedOpTimeAtStartOfBatch) {
             fassert(34361,
@@ -329,9 +368,17 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         // Don't allow the fsync+lock thread to see intermediate states of batch application.
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
+        OplogBatchSizeController::BatchFeedback feedback;
+        feedback.numOps = ops.getBatch().size();
+        for (const auto& op : ops.getBatch()) {
+            feedback.numBytes += op.getRawObjSizeBytes();
+        }
+
         // Apply the operations in this batch. '_applyOplogBatch' returns the optime of the
         // last op that was applied, which should be the last optime in the batch.
+        Timer applyTimer;
         auto swLastOpTimeAppliedInBatch = _applyOplogBatch(&opCtx, ops.releaseBatch());
+        feedback.applyDuration = Milliseconds(applyTimer.millis());
         if (swLastOpTimeAppliedInBatch.getStatus().code() == ErrorCodes::InterruptedAtShutdown) {
             // If an operation was interrupted at shutdown, fail the batch without advancing
             // appliedThrough as if this were an unclean shutdown. This ensures the stable timestamp
@@ -360,6 +407,13 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
         // 3. Finalize this batch. The finalizer advances the global timestamp to lastOpTimeInBatch.
         finalizer->record({lastOpTimeInBatch, lastWallTimeInBatch});
+
+        // 4. Let the size of the next batches follow how long this one took to apply.
+        feedback.writerUtilization = _lastBatchWriterUtilization;
+        const auto lastCommittedWallTime = _replCoord->getLastCommittedOpTimeAndWallTime().wallTime;
+        feedback.majorityCommitLag =
+            std::max(Milliseconds(0), lastWallTimeInBatch - lastCommittedWallTime);
+        OplogBatchSizeController::get(opCtx.getServiceContext())->onBatchApplied(feedback);
     }
 }
 
@@ -449,17 +503,33 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
     // Increment the batch size stat.
     oplogApplicationBatchSize.increment(ops.size());
 
-    std::vector<WorkerMultikeyPathInfo> multikeyVector(_writerPool->getStats().options.maxThreads);
+    // With a work-stealing writer pool, split the batch into more writer vectors than there are
+    // threads, so that threads which finish their vectors early take over the remaining ones.
+    const auto writerPoolOptions = _writerPool->getStats().options;
+    const size_t numWriterVectors = writerPoolOptions.maxThreads *
+        (writerPoolOptions.workStealing ? kWriterVectorsPerThreadWithWorkStealing : 1);
+
+    std::vector<WorkerMultikeyPathInfo> multikeyVector(numWriterVectors);
     {
         // Each node records cumulative batch application stats for itself using this timer.
         TimerHolder timer(&applyBatchStats);
 
         // We must wait for the all work we've dispatched to complete before leaving this block
         // because the spawned threads refer to objects on the stack
-        ON_BLOCK_EXIT([&] { _writerPool->waitForIdle(); });
-
-        // Write batch of ops into oplog.
-        if (!getOptions().skipWritesToOplog) {
+        ON_BLOCK_EXIT([&] {
+            _writerPool->waitForIdle();
+            if (_oplogWriterPool) {
+                _oplogWriterPool->waitForIdle();
+            }
+        });
+
+        // Write batch of ops into oplog, unless that already happened while the previous batch was
+        // being applied.
+        const bool writtenToOplog =
+            !_oplogWrittenThrough.isNull() && ops.back().getOpTime() <= _oplogWrittenThrough;
+        if (writtenToOplog) {
+            pipelinedOplogWriteBatches.increment();
+        } else if (!getOptions().skipWritesToOplog) {
             _consistencyMarkers->setOplogTruncateAfterPoint(
                 opCtx, _replCoord->getMyLastAppliedOpTime().getTimestamp());
             scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
@@ -474,8 +544,7 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
         //   and create a pseudo oplog.
         std::vector<std::vector<OplogEntry>> derivedOps;
 
-        std::vector<std::vector<const OplogEntry*>> writerVectors(
-            _writerPool->getStats().options.maxThreads);
+        std::vector<std::vector<const OplogEntry*>> writerVectors(numWriterVectors);
         fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
 
         // Wait for writes to finish before applying ops.
@@ -501,8 +570,11 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 
         {
 
-            std::vector<Status> statusVector(_writerPool->getStats().options.maxThreads,
-                                             Status::OK());
+            std::vector<Status> statusVector(numWriterVectors, Status::OK());
+            // Time each writer vector keeps a writer thread busy, to measure how well the batch
+            // kept the writer pool occupied.
+            std::vector<Microseconds> busyVector(numWriterVectors, Microseconds(0));
+            Timer applyPhaseTimer;
             // Doles out all the work to the writer pool threads. writerVectors is not modified,
             // but  applyOplogBatchPerWorker will modify the vectors that it contains.
             invariant(writerVectors.size() == statusVector.size());
@@ -513,9 +585,12 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                 _writerPool->schedule([this,
                                        &writer = writerVectors.at(i),
                                        &status = statusVector.at(i),
+                                       &busy = busyVector.at(i),
                                        &multikeyVector = multikeyVector.at(i),
                                        isDataConsistent = isDataConsistent](auto scheduleStatus) {
                     invariant(scheduleStatus);
+                    Timer busyTimer;
+                    ON_BLOCK_EXIT([&] { busy = Microseconds(busyTimer.micros()); });
 
                     auto opCtx = cc().makeOperationContext();
 
@@ -531,7 +606,25 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                 });
             }
 
+            // Overlap writing the next batch to the oplog with applying this one.
+            _scheduleWritesToOplogForNextBatch(opCtx, ops.back().getOpTime());
+
             _writerPool->waitForIdle();
+            if (_oplogWriterPool) {
+                _oplogWriterPool->waitForIdle();
+            }
+
+            const auto applyPhaseMicros = applyPhaseTimer.micros();
+            if (applyPhaseMicros > 0) {
+                Microseconds totalBusy(0);
+                for (const auto& busy : busyVector) {
+                    totalBusy += busy;
+                }
+                _lastBatchWriterUtilization = std::min(
+                    1.0,
+                    static_cast<double>(durationCount<Microseconds>(totalBusy)) /
+                        (static_cast<double>(applyPhaseMicros) * writerPoolOptions.maxThreads));
+            }
 
             // If any of the statuses is not ok, return error.
             for (auto it = statusVector.cbegin(); it != statusVector.cend(); ++it) {
@@ -600,6 +693,46 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
     return ops.back().getOpTime();
 }
 
+void OplogApplierImpl::_scheduleWritesToOplogForNextBatch(OperationContext* opCtx,
+                                                          const OpTime& lastOpTimeInBatch) {
+    if (!_oplogWriterPool || _nextBatch) {
+        return;
+    }
+
+    // Leave the next batch in the batcher while replication is paused for tests, so that nothing
+    // past the last applied optime is written to the oplog.
+    if (MONGO_unlikely(rsSyncApplyStop.shouldFail())) {
+        return;
+    }
+
+    auto batch = _oplogBatcher->getNextBatch(Seconds(0));
+    if (batch.empty()) {
+        // Shutdown and drain signals must still reach _run() in order.
+        if (batch.mustShutdown() || batch.termWhenExhausted()) {
+            _nextBatch = std::move(batch);
+        }
+        return;
+    }
+    _nextBatch = std::move(batch);
+
+    // Every entry up to 'lastOpTimeInBatch' is already in the oplog, so if we crash while the next
+    // batch is partially written, startup recovery only needs to truncate the oplog after it.
+    _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, lastOpTimeInBatch.getTimestamp());
+    scheduleWritesToOplog(opCtx, _storageInterface, _oplogWriterPool.get(), _nextBatch->getBatch());
+
+    // The caller waits for '_oplogWriterPool' to be idle before the next batch is applied.
+    _oplogWrittenThrough = _nextBatch->back().getOpTime();
+}
+
+OplogBatch OplogApplierImpl::_getNextBatch(Seconds maxWaitTime) {
+    if (_nextBatch) {
+        OplogBatch batch = std::move(*_nextBatch);
+        _nextBatch = boost::none;
+        return batch;
+    }
+    return _oplogBatcher->getNextBatch(maxWaitTime);
+}
+
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
@@ -614,6 +747,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
     std::vector<OplogEntry>* ops,
     std::vector<std::vector<const OplogEntry*>>* writerVectors,
     std::vector<std::vector<OplogEntry>>* derivedOps,
+    WriterAssignment* writerAssignment,
     SessionUpdateTracker* sessionUpdateTracker) noexcept {
 
     LogicalSessionIdMap<std::vector<OplogEntry*>> partialTxnOps;
@@ -637,6 +771,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                                                  &derivedOps->back(),
                                                  writerVectors,
                                                  &collPropertiesCache,
+                                                 writerAssignment,
                                                  false /*serial*/);
             }
         }
@@ -673,8 +808,13 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                 // oplog and fill writers with those operations.
                 // Flush partialTxnList operations for current transaction.
                 auto& partialTxnList = partialTxnOps[*logicalSessionId];
-                _addOplogChainOpsToWriterVectors(
-                    opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writerVectors);
+                _addOplogChainOpsToWriterVectors(opCtx,
+                                                 &partialTxnList,
+                                                 derivedOps,
+                                                 &op,
+                                                 &collPropertiesCache,
+                                                 writerAssignment,
+                                                 writerVectors);
             } else {
                 // The applyOps entry was not generated as part of a transaction.
                 invariant(!op.getPrevWriteOpTimeInTransaction());
@@ -686,6 +826,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                                                  &derivedOps->back(),
                                                  writerVectors,
                                                  &collPropertiesCache,
+                                                 writerAssignment,
                                                  false /*serial*/);
             }
             continue;
@@ -697,8 +838,13 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
         if (op.isPreparedCommit() && (getOptions().mode == OplogApplication::Mode::kInitialSync)) {
             auto logicalSessionId = op.getSessionId();
             auto& partialTxnList = partialTxnOps[*logicalSessionId];
-            _addOplogChainOpsToWriterVectors(
-                opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writerVectors);
+            _addOplogChainOpsToWriterVectors(opCtx,
+                                             &partialTxnList,
+                                             derivedOps,
+                                             &op,
+                                             &collPropertiesCache,
+                                             writerAssignment,
+                                             writerVectors);
             continue;
         }
 
@@ -706,8 +852,12 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
         // migration and access blocker states.
         if (op.getNss() == NamespaceString::kTenantMigrationDonorsNamespace ||
             op.getNss() == NamespaceString::kTenantMigrationRecipientsNamespace) {
-            auto writerId = OplogApplierUtils::addToWriterVector(
-                opCtx, &op, writerVectors, &collPropertiesCache, tenantMigrationsWriterId);
+            auto writerId = OplogApplierUtils::addToWriterVector(opCtx,
+                                                                 &op,
+                                                                 writerVectors,
+                                                                 &collPropertiesCache,
+                                                                 writerAssignment,
+                                                                 tenantMigrationsWriterId);
             if (!tenantMigrationsWriterId) {
                 tenantMigrationsWriterId.emplace(writerId);
             } else {
@@ -715,7 +865,8 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
             }
             continue;
         }
-        OplogApplierUtils::addToWriterVector(opCtx, &op, writerVectors, &collPropertiesCache);
+        OplogApplierUtils::addToWriterVector(
+            opCtx, &op, writerVectors, &collPropertiesCache, writerAssignment);
     }
 }
 
@@ -726,13 +877,15 @@ void OplogApplierImpl::fillWriterVectors(
     std::vector<std::vector<OplogEntry>>* derivedOps) noexcept {
 
     SessionUpdateTracker sessionUpdateTracker;
-    _deriveOpsAndFillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    WriterAssignment writerAssignment;
+    _deriveOpsAndFillWriterVectors(
+        opCtx, ops, writerVectors, derivedOps, &writerAssignment, &sessionUpdateTracker);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
         _deriveOpsAndFillWriterVectors(
-            opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+            opCtx, &derivedOps->back(), writerVectors, derivedOps, &writerAssignment, nullptr);
     }
 }
 
@@ -44,6 +44,8 @@
 namespace mongo {
 namespace repl {
 
+class WriterAssignment;
+
 /**
  * Applies oplog entries.
  * Primarily used to apply batches of operations fetched from a sync source during steady state
@@ -90,7 +92,8 @@ private:
     /**
      * Applies a batch of oplog entries by writing the oplog entries to the local oplog and then
      * using a set of threads to apply the operations. It writes all entries to the oplog, but only
-     * applies entries with timestamp >= beginApplyingTimestamp.
+     * applies entries with timestamp >= beginApplyingTimestamp. Batches that were already written
+     * to the oplog by _scheduleWritesToOplogForNextBatch() are only applied.
      *
      * If the batch application is successful, returns the optime of the last op applied, which
      * should be the last op in the batch.
@@ -102,10 +105,29 @@ private:
      */
     StatusWith<OpTime> _applyOplogBatch(OperationContext* opCtx, std::vector<OplogEntry> ops);
 
+    /**
+     * Takes the next batch from the batcher without waiting and schedules its writes to the oplog
+     * on '_oplogWriterPool', so that they overlap with the application of the batch ending at
+     * 'lastOpTimeInBatch'. The batch is stashed in '_nextBatch' and returned by the next call to
+     * _getNextBatch(). The caller must wait for '_oplogWriterPool' to be idle before the batch
+     * is released.
+     *
+     * Does nothing if pipelined oplog writes are disabled or a batch is already stashed.
+     */
+    void _scheduleWritesToOplogForNextBatch(OperationContext* opCtx,
+                                            const OpTime& lastOpTimeInBatch);
+
+    /**
+     * Returns the batch stashed by _scheduleWritesToOplogForNextBatch(), if any. Otherwise blocks
+     * up to 'maxWaitTime' waiting for the batcher.
+     */
+    OplogBatch _getNextBatch(Seconds maxWaitTime);
+
     void _deriveOpsAndFillWriterVectors(OperationContext* opCtx,
                                         std::vector<OplogEntry>* ops,
                                         std::vector<std::vector<const OplogEntry*>>* writerVectors,
                                         std::vector<std::vector<OplogEntry>>* derivedOps,
+                                        WriterAssignment* writerAssignment,
                                         SessionUpdateTracker* sessionUpdateTracker) noexcept;
 
     // Not owned by us.
@@ -119,6 +141,22 @@ private:
 
     ReplicationConsistencyMarkers* const _consistencyMarkers;
 
+    // Pool of threads for writing the next batch to the oplog while the current batch is being
+    // applied. Only set while _run() is active and 'replPipelinedOplogWrites' is enabled.
+    std::unique_ptr<ThreadPool> _oplogWriterPool;
+
+    // A batch taken from the batcher ahead of time, whose oplog writes may be in progress on
+    // '_oplogWriterPool'. Only accessed by the applier thread.
+    boost::optional<OplogBatch> _nextBatch;
+
+    // The optime of the last entry that was written to the oplog ahead of being applied. Batches
+    // ending at or before this optime skip the oplog writes in _applyOplogBatch().
+    OpTime _oplogWrittenThrough;
+
+    // Fraction of the time the writer threads spent applying the operations of the last batch,
+    // reported to the OplogBatchSizeController. Only accessed by the applier thread.
+    double _lastBatchWriterUtilization = 1.0;
+
     // Used to determine which operations should be applied during initial sync. If this is null,
     // we will apply all operations that were fetched.
     OpTime _beginApplyingOpTime = OpTime();
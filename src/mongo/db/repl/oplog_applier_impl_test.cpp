@@ -680,6 +680,116 @@ TEST_F(OplogApplierImplTest,
                   secondDerivedOp.getObject()["lastWriteOpTime"]["ts"].timestamp());
 }
 
+TEST_F(OplogApplierImplTest, FillWriterVectorsAssignsOpsOnTheSameDocumentToOneWriterInOrder) {
+    const NamespaceString nss{"test", "foo"};
+    auto writerPool = makeReplWriterPool();
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+
+    const int kNumDocs = 3;
+    const int kOpsPerDoc = 4;
+    std::vector<OplogEntry> ops;
+    for (int i = 0; i < kNumDocs * kOpsPerDoc; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i + 1), 1LL}, nss, BSON("_id" << i % kNumDocs << "x" << i)));
+    }
+
+    std::vector<std::vector<const OplogEntry*>> writerVectors(
+        writerPool->getStats().options.maxThreads);
+    std::vector<std::vector<OplogEntry>> derivedOps;
+    oplogApplier.fillWriterVectors_forTest(_opCtx.get(), &ops, &writerVectors, &derivedOps);
+
+    for (int id = 0; id < kNumDocs; id++) {
+        // All ops on the document must be in a single writer vector.
+        std::vector<int> values;
+        for (auto&& writer : writerVectors) {
+            bool writerHasDoc = false;
+            for (auto&& op : writer) {
+                if (op->getIdElement().numberInt() == id) {
+                    values.push_back(op->getObject()["x"].numberInt());
+                    writerHasDoc = true;
+                }
+            }
+            if (writerHasDoc) {
+                break;
+            }
+        }
+        ASSERT_EQ(kOpsPerDoc, values.size());
+        for (int i = 0; i < kOpsPerDoc; i++) {
+            ASSERT_EQ(id + i * kNumDocs, values[i]);
+        }
+    }
+}
+
+TEST_F(OplogApplierImplTest, FillWriterVectorsSpreadsDistinctDocumentsEvenlyAcrossWriters) {
+    const NamespaceString nss{"test", "foo"};
+    auto writerPool = makeReplWriterPool();
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+
+    const size_t numWriters = writerPool->getStats().options.maxThreads;
+    std::vector<OplogEntry> ops;
+    for (size_t i = 0; i < 2 * numWriters; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i + 1), 1LL}, nss, BSON("_id" << static_cast<int>(i))));
+    }
+
+    std::vector<std::vector<const OplogEntry*>> writerVectors(numWriters);
+    std::vector<std::vector<OplogEntry>> derivedOps;
+    oplogApplier.fillWriterVectors_forTest(_opCtx.get(), &ops, &writerVectors, &derivedOps);
+
+    for (auto&& writer : writerVectors) {
+        ASSERT_EQ(2U, writer.size());
+    }
+}
+
+TEST_F(OplogApplierImplTest, FillWriterVectorsAssignsCappedCollectionOpsToOneWriter) {
+    const NamespaceString nss{"test", "capped"};
+    createCollection(_opCtx.get(), nss, createOplogCollectionOptions());
+    auto writerPool = makeReplWriterPool();
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+
+    std::vector<OplogEntry> ops;
+    for (int i = 0; i < 10; i++) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i + 1), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    std::vector<std::vector<const OplogEntry*>> writerVectors(
+        writerPool->getStats().options.maxThreads);
+    std::vector<std::vector<OplogEntry>> derivedOps;
+    oplogApplier.fillWriterVectors_forTest(_opCtx.get(), &ops, &writerVectors, &derivedOps);
+
+    auto numNonEmptyWriters = std::count_if(
+        writerVectors.begin(), writerVectors.end(), [](auto& writer) { return !writer.empty(); });
+    ASSERT_EQ(1, numNonEmptyWriters);
+}
+
 class MultiOplogEntryOplogApplierImplTest : public OplogApplierImplTest {
 public:
     MultiOplogEntryOplogApplierImplTest()
@@ -2102,6 +2212,110 @@ TEST_F(OplogApplierImplTest,
     ASSERT_EQUALS(1U, numFailedGroupedInserts);
 }
 
+class OplogApplierImplUpdateDeleteGroupTest : public OplogApplierImplTest {
+protected:
+    /**
+     * Applies 'ops' in steady state and returns, for each update or delete, the number of
+     * updates and deletes whose storage transaction had committed when it was applied.
+     */
+    std::vector<int> applyAndRecordCommittedCounts(std::vector<OplogEntry> ops) {
+        auto committed = std::make_shared<int>(0);
+        std::vector<int> committedWhenApplied;
+        auto recordOp = [&, committed](OperationContext* opCtx) {
+            committedWhenApplied.push_back(*committed);
+            opCtx->recoveryUnit()->onCommit([committed](boost::optional<Timestamp>) {
+                ++*committed;
+            });
+        };
+        _opObserver->onUpdateFn = [&](OperationContext* opCtx, const OplogUpdateEntryArgs&) {
+            recordOp(opCtx);
+        };
+        _opObserver->onDeleteFn = [&](OperationContext* opCtx,
+                                      const NamespaceString&,
+                                      boost::optional<UUID>,
+                                      StmtId,
+                                      const OplogDeleteEntryArgs&) { recordOp(opCtx); };
+        ASSERT_OK(runOpsSteadyState(std::move(ops)));
+        _opObserver->onUpdateFn = nullptr;
+        _opObserver->onDeleteFn = nullptr;
+        return committedWhenApplied;
+    }
+
+    void insertDocuments(const NamespaceString& nss, int numDocs) {
+        createCollectionWithUuid(_opCtx.get(), nss);
+        std::vector<OplogEntry> ops;
+        for (int i = 1; i <= numDocs; ++i) {
+            ops.push_back(makeInsertDocumentOplogEntry(
+                {Timestamp(Seconds(_seconds++), 0), 1LL}, nss, BSON("_id" << i << "x" << 0)));
+        }
+        ASSERT_OK(runOpsSteadyState(ops));
+    }
+
+    OplogEntry makeUpdate(const NamespaceString& nss, int id, int x) {
+        return makeUpdateDocumentOplogEntry({Timestamp(Seconds(_seconds++), 0), 1LL},
+                                            nss,
+                                            BSON("_id" << id),
+                                            BSON("_id" << id << "x" << x));
+    }
+
+    OplogEntry makeDelete(const NamespaceString& nss, int id) {
+        return makeDeleteDocumentOplogEntry(
+            {Timestamp(Seconds(_seconds++), 0), 1LL}, nss, BSON("_id" << id));
+    }
+
+    int _seconds = 1;
+};
+
+TEST_F(OplogApplierImplUpdateDeleteGroupTest,
+       ApplyGroupAppliesUpdatesAndDeletesOnOneCollectionInOneTransaction) {
+    RAIIServerParameterControllerForTest controller("oplogApplicationGroupsUpdatesAndDeletes",
+                                                    true);
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    insertDocuments(nss, 3);
+
+    auto committedWhenApplied = applyAndRecordCommittedCounts(
+        {makeUpdate(nss, 1, 1), makeUpdate(nss, 2, 2), makeDelete(nss, 3)});
+    ASSERT(std::vector<int>({0, 0, 0}) == committedWhenApplied);
+
+    DBDirectClient client(_opCtx.get());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "x" << 1), client.findOne(nss, BSON("_id" << 1)));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2 << "x" << 2), client.findOne(nss, BSON("_id" << 2)));
+    ASSERT_BSONOBJ_EQ(BSONObj(), client.findOne(nss, BSON("_id" << 3)));
+}
+
+TEST_F(OplogApplierImplUpdateDeleteGroupTest, ApplyGroupDoesNotGroupUpdatesAndDeletesByDefault) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    insertDocuments(nss, 3);
+
+    auto committedWhenApplied = applyAndRecordCommittedCounts(
+        {makeUpdate(nss, 1, 1), makeUpdate(nss, 2, 2), makeDelete(nss, 3)});
+    ASSERT(std::vector<int>({0, 1, 2}) == committedWhenApplied);
+}
+
+TEST_F(OplogApplierImplUpdateDeleteGroupTest,
+       ApplyGroupEndsUpdateDeleteGroupAtRepeatedDocumentOrNewCollection) {
+    RAIIServerParameterControllerForTest controller("oplogApplicationGroupsUpdatesAndDeletes",
+                                                    true);
+    NamespaceString nss1("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_1");
+    NamespaceString nss2("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_2");
+    insertDocuments(nss1, 2);
+    insertDocuments(nss2, 2);
+
+    // The repeated update of {_id: 1} starts a new group, which ends at the next namespace.
+    auto committedWhenApplied = applyAndRecordCommittedCounts({makeUpdate(nss1, 1, 1),
+                                                               makeUpdate(nss1, 2, 1),
+                                                               makeUpdate(nss1, 1, 2),
+                                                               makeDelete(nss1, 2),
+                                                               makeUpdate(nss2, 1, 1),
+                                                               makeUpdate(nss2, 2, 1)});
+    ASSERT(std::vector<int>({0, 0, 2, 2, 4, 4}) == committedWhenApplied);
+
+    DBDirectClient client(_opCtx.get());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "x" << 2), client.findOne(nss1, BSON("_id" << 1)));
+    ASSERT_BSONOBJ_EQ(BSONObj(), client.findOne(nss1, BSON("_id" << 2)));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2 << "x" << 1), client.findOne(nss2, BSON("_id" << 2)));
+}
+
 TEST_F(OplogApplierImplTest, ApplyGroupIgnoresUpdateOperationIfDocumentIsMissingFromSyncSource) {
     TestApplyOplogGroupApplier oplogApplier(
         nullptr, nullptr, OplogApplier::Options(OplogApplication::Mode::kInitialSync));
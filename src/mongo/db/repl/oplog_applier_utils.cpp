@@ -39,6 +39,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/repl/oplog_applier_utils.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/update_delete_group.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/util/fail_point.h"
 
@@ -78,6 +79,28 @@ CachedCollectionProperties::getCollectionPropertiesImpl(OperationContext* opCtx,
     return collProperties;
 }
 
+uint32_t WriterAssignment::getWriterId(
+    uint32_t conflictHash,
+    const std::vector<std::vector<const OplogEntry*>>& writerVectors,
+    boost::optional<uint32_t> forceWriterId) {
+    auto [it, inserted] = _writerIds.try_emplace(conflictHash, 0);
+    if (forceWriterId) {
+        if (inserted) {
+            it->second = *forceWriterId;
+        }
+        return *forceWriterId;
+    }
+
+    if (inserted) {
+        auto leastLoaded = std::min_element(
+            writerVectors.begin(), writerVectors.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.size() < rhs.size();
+            });
+        it->second = static_cast<uint32_t>(std::distance(writerVectors.begin(), leastLoaded));
+    }
+    return it->second;
+}
+
 void OplogApplierUtils::processCrudOp(OperationContext* opCtx,
                                       OplogEntry* op,
                                       uint32_t* hash,
@@ -111,19 +134,19 @@ uint32_t OplogApplierUtils::addToWriterVector(
     OplogEntry* op,
     std::vector<std::vector<const OplogEntry*>>* writerVectors,
     CachedCollectionProperties* collPropertiesCache,
+    WriterAssignment* writerAssignment,
     boost::optional<uint32_t> forceWriterId) {
     auto hashedNs = StringMapHasher().hashed_key(op->getNss().ns());
 
     // Reduce the hash from 64bit down to 32bit, just to allow combinations with murmur3 later
-    // on. Bit depth not important, we end up just doing integer modulo with this in the end.
-    // The hash function should provide entropy in the lower bits as it's used in hash tables.
+    // on. Ops whose hashes collide are only applied by the same writer, so bit depth is not
+    // important.
     uint32_t hash = static_cast<uint32_t>(hashedNs.hash());
 
     if (op->isCrudOpType())
         processCrudOp(opCtx, op, &hash, &hashedNs, collPropertiesCache);
 
-    const uint32_t numWriters = writerVectors->size();
-    auto writerId = (forceWriterId ? *forceWriterId : hash) % numWriters;
+    auto writerId = writerAssignment->getWriterId(hash, *writerVectors, forceWriterId);
     auto& writer = (*writerVectors)[writerId];
     if (writer.empty()) {
         writer.reserve(8);  // Skip a few growth rounds
@@ -153,13 +176,14 @@ void OplogApplierUtils::addDerivedOps(OperationContext* opCtx,
                                       std::vector<OplogEntry>* derivedOps,
                                       std::vector<std::vector<const OplogEntry*>>* writerVectors,
                                       CachedCollectionProperties* collPropertiesCache,
+                                      WriterAssignment* writerAssignment,
                                       bool serial) {
     boost::optional<uint32_t>
         serialWriterId;  // Used to determine which writer vector to assign serial ops.
 
     for (auto&& op : *derivedOps) {
-        auto writerId =
-            addToWriterVector(opCtx, &op, writerVectors, collPropertiesCache, serialWriterId);
+        auto writerId = addToWriterVector(
+            opCtx, &op, writerVectors, collPropertiesCache, writerAssignment, serialWriterId);
         if (serial && !serialWriterId) {
             serialWriterId.emplace(writerId);
         }
@@ -303,6 +327,8 @@ Status OplogApplierUtils::applyOplogBatchCommon(
     stableSortByNamespace(ops);
     InsertGroup insertGroup(
         ops, opCtx, oplogApplicationMode, isDataConsistent, applyOplogEntryOrGroupedInserts);
+    UpdateDeleteGroup updateDeleteGroup(
+        ops, opCtx, oplogApplicationMode, isDataConsistent, applyOplogEntryOrGroupedInserts);
 
     for (auto it = ops->cbegin(); it != ops->cend(); ++it) {
         const OplogEntry& entry = **it;
@@ -315,6 +341,13 @@ Status OplogApplierUtils::applyOplogBatchCommon(
             continue;
         }
 
+        // Likewise for a group of updates and deletes on the same collection.
+        groupResult = updateDeleteGroup.groupAndApplyUpdatesAndDeletes(it);
+        if (groupResult.isOK()) {
+            it = groupResult.getValue();
+            continue;
+        }
+
         // If we didn't create a group, try to apply the op individually.
         try {
             const Status status = applyOplogEntryOrGroupedInserts(
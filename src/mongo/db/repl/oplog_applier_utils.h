@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/db/repl/insert_group.h"
+#include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
 class CollatorInterface;
@@ -59,6 +60,28 @@ private:
     StringMap<CollectionProperties> _cache;
 };
 
+/**
+ * Assigns the ops of a batch to writer vectors. Ops that may conflict with each other, because
+ * they have the same conflict hash, are assigned to the same writer in batch order. An op whose
+ * conflict hash is new to the batch is assigned to the writer with the fewest ops so far, so that
+ * the work is spread evenly across the writers instead of wherever the hash happens to land.
+ *
+ * One instance must be used for all ops of a batch.
+ */
+class WriterAssignment {
+public:
+    /**
+     * Returns the writer that an op with 'conflictHash' must be applied by. If 'forceWriterId' is
+     * set, returns it and assigns 'conflictHash' to it if the hash has not been seen before.
+     */
+    uint32_t getWriterId(uint32_t conflictHash,
+                         const std::vector<std::vector<const OplogEntry*>>& writerVectors,
+                         boost::optional<uint32_t> forceWriterId = boost::none);
+
+private:
+    stdx::unordered_map<uint32_t, uint32_t> _writerIds;
+};
+
 /**
  * This class contains some static methods common to ordinary oplog application and oplog
  * application as part of tenant migration.
@@ -85,23 +108,26 @@ public:
 
 
     /**
-     * Adds a single oplog entry to the appropriate writer vector.  Returns the index of the
-     * writer vector the entry was written to.
+     * Adds a single oplog entry to the writer vector chosen by 'writerAssignment' for its
+     * namespace and, if applicable, _id. Returns the index of the writer vector the entry was
+     * written to.
      */
     static uint32_t addToWriterVector(OperationContext* opCtx,
                                       OplogEntry* op,
                                       std::vector<std::vector<const OplogEntry*>>* writerVectors,
                                       CachedCollectionProperties* collPropertiesCache,
+                                      WriterAssignment* writerAssignment,
                                       boost::optional<uint32_t> forceWriterId = boost::none);
     /**
      * Adds a set of derivedOps to writerVectors.
-     * If `serial` is true, assign all derived operations to the writer vector corresponding to the
-     * hash of the first operation in `derivedOps`.
+     * If `serial` is true, assign all derived operations to the writer vector of the first
+     * operation in `derivedOps`.
      */
     static void addDerivedOps(OperationContext* opCtx,
                               std::vector<OplogEntry>* derivedOps,
                               std::vector<std::vector<const OplogEntry*>>* writerVectors,
                               CachedCollectionProperties* collPropertiesCache,
+                              WriterAssignment* writerAssignment,
                               bool serial);
 
     /**
@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_batch_size_controller.h"
+
+#include <algorithm>
+
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const auto getOplogBatchSizeController =
+    ServiceContext::declareDecoration<OplogBatchSizeController>();
+
+// Bounds on the fraction of the static limits that batches are limited to.
+constexpr double kMinScale = 0.001;
+constexpr double kMaxScale = 1.0;
+
+// Bounds on how much the limits change after a single batch.
+constexpr double kMaxShrinkFactor = 0.5;
+constexpr double kMaxGrowthFactor = 2.0;
+
+// Writer utilization below this is not credited any further when growing the limits.
+constexpr double kMinWriterUtilization = 0.1;
+
+// A batch is full when it reaches this fraction of either of its limits. Batches that are cut
+// short by the end of the available oplog say nothing about how large a batch could be.
+constexpr double kFullBatchFraction = 0.9;
+
+std::size_t scaleLimit(std::size_t staticLimit, double scale, std::size_t minLimit) {
+    auto scaled = static_cast<std::size_t>(static_cast<double>(staticLimit) * scale);
+    return std::min(staticLimit, std::max(minLimit, scaled));
+}
+
+class AdaptiveBatchingSSM : public ServerStatusMetric {
+public:
+    AdaptiveBatchingSSM() : ServerStatusMetric("repl.apply.adaptiveBatching") {}
+
+    void appendAtLeaf(BSONObjBuilder& b) const override {
+        BSONObjBuilder leaf(b.subobjStart(_leafName));
+        OplogBatchSizeController::get(getGlobalServiceContext())->appendStats(&leaf);
+    }
+} adaptiveBatchingSSM;
+
+}  // namespace
+
+OplogBatchSizeController* OplogBatchSizeController::get(ServiceContext* service) {
+    return &getOplogBatchSizeController(service);
+}
+
+void OplogBatchSizeController::adjustBatchLimits(OplogBatcher::BatchLimits* limits) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (oplogApplicationAdaptiveBatchSizing.load()) {
+        limits->ops = scaleLimit(limits->ops, _scale, kMinBatchOps);
+        limits->bytes = scaleLimit(limits->bytes, _scale, kMinBatchBytes);
+    }
+    _targetOps = limits->ops;
+    _targetBytes = limits->bytes;
+}
+
+void OplogBatchSizeController::onBatchApplied(const BatchFeedback& feedback) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _lastBatch = feedback;
+    _batchOpsHistogram.increment(static_cast<int64_t>(feedback.numOps));
+    _batchLatencyMillisHistogram.increment(durationCount<Milliseconds>(feedback.applyDuration));
+
+    if (!oplogApplicationAdaptiveBatchSizing.load()) {
+        _scale = kMaxScale;
+        return;
+    }
+
+    const double target = oplogApplicationTargetBatchLatencyMillis.load();
+    // Sub-millisecond batches count as taking a millisecond, so that they do not suggest an
+    // unbounded growth.
+    const double latency = std::max<double>(1, durationCount<Milliseconds>(feedback.applyDuration));
+
+    double factor = 1.0;
+    if (latency > target) {
+        factor = std::max(kMaxShrinkFactor, target / latency);
+    } else {
+        const bool full = feedback.numOps >= kFullBatchFraction * _targetOps ||
+            feedback.numBytes >= kFullBatchFraction * _targetBytes;
+        const bool majorityKeepingUp =
+            durationCount<Milliseconds>(feedback.majorityCommitLag) <= target;
+        if (full && majorityKeepingUp) {
+            const double utilization =
+                std::clamp(feedback.writerUtilization, kMinWriterUtilization, 1.0);
+            factor = std::min(kMaxGrowthFactor, target / latency / utilization);
+        }
+    }
+
+    const double newScale = std::clamp(_scale * factor, kMinScale, kMaxScale);
+    if (newScale != _scale) {
+        LOGV2_DEBUG(6719000,
+                    2,
+                    "Adjusted oplog application batch size",
+                    "scale"_attr = newScale,
+                    "previousScale"_attr = _scale,
+                    "batchOps"_attr = feedback.numOps,
+                    "batchBytes"_attr = feedback.numBytes,
+                    "applyDuration"_attr = feedback.applyDuration,
+                    "writerUtilization"_attr = feedback.writerUtilization,
+                    "majorityCommitLag"_attr = feedback.majorityCommitLag);
+    }
+    _scale = newScale;
+}
+
+void OplogBatchSizeController::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    builder->append("enabled", oplogApplicationAdaptiveBatchSizing.load());
+    builder->append("targetLatencyMillis", oplogApplicationTargetBatchLatencyMillis.load());
+    builder->append("scale", _scale);
+    builder->append("targetOps", static_cast<long long>(_targetOps));
+    builder->append("targetBytes", static_cast<long long>(_targetBytes));
+    {
+        BSONObjBuilder last(builder->subobjStart("lastBatch"));
+        last.append("ops", static_cast<long long>(_lastBatch.numOps));
+        last.append("bytes", static_cast<long long>(_lastBatch.numBytes));
+        last.append("applyMillis", durationCount<Milliseconds>(_lastBatch.applyDuration));
+        last.append("writerUtilization", _lastBatch.writerUtilization);
+        last.append("majorityCommitLagMillis",
+                    durationCount<Milliseconds>(_lastBatch.majorityCommitLag));
+    }
+    appendHistogram(*builder, _batchOpsHistogram, "batchSizeOps");
+    appendHistogram(*builder, _batchLatencyMillisHistogram, "batchLatencyMillis");
+}
+
+double OplogBatchSizeController::getScaleForTest() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _scale;
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/repl/oplog_batcher.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/histogram.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Sizes the batches of secondary oplog application from the measured application of previous
+ * batches, when 'oplogApplicationAdaptiveBatchSizing' is enabled.
+ *
+ * The controller scales replBatchLimitOperations and replBatchLimitBytes down by a factor in
+ * (0, 1]. A batch that takes longer than 'oplogApplicationTargetBatchLatencyMillis' to apply
+ * shrinks the next ones in proportion. A batch that filled its limits and took less than the
+ * target grows the next ones. The growth allows for the writer threads left idle by that batch,
+ * which absorb more operations without adding to its latency. The limits do not grow while the
+ * majority commit point lags the last applied optime by more than the target, since bigger
+ * batches only delay the point at which this node reports its progress.
+ */
+class OplogBatchSizeController {
+    OplogBatchSizeController(const OplogBatchSizeController&) = delete;
+    OplogBatchSizeController& operator=(const OplogBatchSizeController&) = delete;
+
+public:
+    /**
+     * What oplog application measured about a batch it has applied.
+     */
+    struct BatchFeedback {
+        std::size_t numOps = 0;
+        std::size_t numBytes = 0;
+        Milliseconds applyDuration{0};
+        // Fraction of the time the writer threads spent applying the batch, in [0, 1].
+        double writerUtilization = 1.0;
+        Milliseconds majorityCommitLag{0};
+    };
+
+    // The batch limits never shrink below these, unless the static limits are lower.
+    static constexpr std::size_t kMinBatchOps = 16;
+    static constexpr std::size_t kMinBatchBytes = 1024 * 1024;
+
+    OplogBatchSizeController() = default;
+
+    static OplogBatchSizeController* get(ServiceContext* service);
+
+    /**
+     * Scales down 'limits', which hold the static limits on entry, to the current target.
+     */
+    void adjustBatchLimits(OplogBatcher::BatchLimits* limits);
+
+    void onBatchApplied(const BatchFeedback& feedback);
+
+    void appendStats(BSONObjBuilder* builder) const;
+
+    double getScaleForTest() const;
+
+private:
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("OplogBatchSizeController::_mutex");
+
+    // Fraction of the static limits that batches are currently limited to.
+    double _scale = 1.0;
+
+    // The limits most recently handed out to the batcher.
+    std::size_t _targetOps = 0;
+    std::size_t _targetBytes = 0;
+
+    BatchFeedback _lastBatch;
+
+    Histogram<int64_t> _batchOpsHistogram{{1, 10, 100, 1000, 5000, 10000, 50000}};
+    Histogram<int64_t> _batchLatencyMillisHistogram{{1, 5, 10, 50, 100, 500, 1000, 5000}};
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,191 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_batch_size_controller.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+constexpr std::size_t kStaticOps = 5000;
+constexpr std::size_t kStaticBytes = 100 * 1024 * 1024;
+
+OplogBatcher::BatchLimits staticLimits() {
+    OplogBatcher::BatchLimits limits;
+    limits.ops = kStaticOps;
+    limits.bytes = kStaticBytes;
+    return limits;
+}
+
+OplogBatchSizeController::BatchFeedback makeFeedback(
+    std::size_t numOps,
+    Milliseconds applyDuration,
+    double writerUtilization = 1.0,
+    Milliseconds majorityCommitLag = Milliseconds(0)) {
+    OplogBatchSizeController::BatchFeedback feedback;
+    feedback.numOps = numOps;
+    feedback.numBytes = numOps * 100;
+    feedback.applyDuration = applyDuration;
+    feedback.writerUtilization = writerUtilization;
+    feedback.majorityCommitLag = majorityCommitLag;
+    return feedback;
+}
+
+class OplogBatchSizeControllerTest : public unittest::Test {
+protected:
+    RAIIServerParameterControllerForTest _enabled{"oplogApplicationAdaptiveBatchSizing", true};
+    RAIIServerParameterControllerForTest _target{"oplogApplicationTargetBatchLatencyMillis", 100};
+    OplogBatchSizeController _controller;
+};
+
+TEST_F(OplogBatchSizeControllerTest, LimitsAreUnchangedWhenDisabled) {
+    RAIIServerParameterControllerForTest disabled{"oplogApplicationAdaptiveBatchSizing", false};
+
+    auto limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(kStaticOps, Milliseconds(1000)));
+
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    ASSERT_EQUALS(kStaticOps, limits.ops);
+    ASSERT_EQUALS(kStaticBytes, limits.bytes);
+    ASSERT_EQUALS(1.0, _controller.getScaleForTest());
+}
+
+TEST_F(OplogBatchSizeControllerTest, SlowBatchShrinksLimits) {
+    auto limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    ASSERT_EQUALS(kStaticOps, limits.ops);
+
+    // Twice the target latency halves the batches.
+    _controller.onBatchApplied(makeFeedback(kStaticOps, Milliseconds(200)));
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    ASSERT_EQUALS(kStaticOps / 2, limits.ops);
+    ASSERT_EQUALS(kStaticBytes / 2, limits.bytes);
+
+    // A single batch never shrinks them by more than half.
+    _controller.onBatchApplied(makeFeedback(limits.ops, Milliseconds(10000)));
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    ASSERT_EQUALS(kStaticOps / 4, limits.ops);
+}
+
+TEST_F(OplogBatchSizeControllerTest, LimitsDoNotShrinkBelowMinimum) {
+    auto limits = staticLimits();
+    for (int i = 0; i < 20; ++i) {
+        limits = staticLimits();
+        _controller.adjustBatchLimits(&limits);
+        _controller.onBatchApplied(makeFeedback(limits.ops, Milliseconds(10000)));
+    }
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    ASSERT_EQUALS(OplogBatchSizeController::kMinBatchOps, limits.ops);
+    ASSERT_EQUALS(OplogBatchSizeController::kMinBatchBytes, limits.bytes);
+}
+
+TEST_F(OplogBatchSizeControllerTest, FullFastBatchGrowsLimits) {
+    auto limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(kStaticOps, Milliseconds(400)));
+    _controller.onBatchApplied(makeFeedback(kStaticOps / 2, Milliseconds(400)));
+    ASSERT_EQUALS(0.25, _controller.getScaleForTest());
+
+    // A full batch applied in 80% of the target grows by 25%.
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(limits.ops, Milliseconds(80)));
+    ASSERT_APPROX_EQUAL(0.3125, _controller.getScaleForTest(), 1e-9);
+
+    // Writers left idle by the batch make it grow faster, up to twice its size.
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(limits.ops, Milliseconds(80), 0.5));
+    ASSERT_APPROX_EQUAL(0.625, _controller.getScaleForTest(), 1e-9);
+
+    // The limits never grow beyond the static ones.
+    for (int i = 0; i < 5; ++i) {
+        limits = staticLimits();
+        _controller.adjustBatchLimits(&limits);
+        _controller.onBatchApplied(makeFeedback(limits.ops, Milliseconds(1)));
+    }
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    ASSERT_EQUALS(kStaticOps, limits.ops);
+    ASSERT_EQUALS(kStaticBytes, limits.bytes);
+}
+
+TEST_F(OplogBatchSizeControllerTest, PartialBatchDoesNotGrowLimits) {
+    auto limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(kStaticOps, Milliseconds(200)));
+
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(limits.ops / 10, Milliseconds(1)));
+    ASSERT_EQUALS(0.5, _controller.getScaleForTest());
+}
+
+TEST_F(OplogBatchSizeControllerTest, MajorityCommitLagHoldsLimits) {
+    auto limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(kStaticOps, Milliseconds(200)));
+
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(limits.ops, Milliseconds(10), 1.0, Milliseconds(1000)));
+    ASSERT_EQUALS(0.5, _controller.getScaleForTest());
+}
+
+TEST_F(OplogBatchSizeControllerTest, AppendStatsReportsTargetsAndHistograms) {
+    auto limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+    _controller.onBatchApplied(makeFeedback(kStaticOps, Milliseconds(200)));
+    limits = staticLimits();
+    _controller.adjustBatchLimits(&limits);
+
+    BSONObjBuilder builder;
+    _controller.appendStats(&builder);
+    auto stats = builder.obj();
+    ASSERT_TRUE(stats["enabled"].trueValue());
+    ASSERT_EQUALS(100, stats["targetLatencyMillis"].numberInt());
+    ASSERT_EQUALS(static_cast<long long>(kStaticOps / 2), stats["targetOps"].numberLong());
+    ASSERT_EQUALS(static_cast<long long>(kStaticOps), stats["lastBatch"]["ops"].numberLong());
+    ASSERT_EQUALS(200, stats["lastBatch"]["applyMillis"].numberLong());
+    ASSERT_EQUALS(1, stats["batchSizeOps"]["totalCount"].numberLong());
+    ASSERT_EQUALS(1, stats["batchLatencyMillis"]["totalCount"].numberLong());
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
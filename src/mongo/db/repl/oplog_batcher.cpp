@@ -34,6 +34,7 @@
 #include "mongo/db/catalog_raii.h"
 #include "mongo/db/commands/txn_cmds_gen.h"
 #include "mongo/db/repl/oplog_applier.h"
+#include "mongo/db/repl/oplog_batch_size_controller.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/logv2/log.h"
 
@@ -291,6 +292,11 @@ void OplogBatcher::_run(StorageInterface* storageInterface) {
             // Locks the oplog to check its max size, do this in the UninterruptibleLockGuard.
             batchLimits.bytes = getBatchLimitOplogBytes(opCtx.get(), storageInterface);
 
+            // Shrink the limits to what recent batches suggest can be applied within the target
+            // latency, when adaptive batch sizing is enabled.
+            OplogBatchSizeController::get(opCtx->getServiceContext())
+                ->adjustBatchLimits(&batchLimits);
+
             auto oplogEntries =
                 fassertNoTrace(31004, getNextApplierBatch(opCtx.get(), batchLimits));
             for (const auto& oplogEntry : oplogEntries) {
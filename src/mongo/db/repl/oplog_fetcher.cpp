@@ -103,6 +103,21 @@ Counter64 readersCreatedStats;
 ServerStatusMetricField<Counter64> displayReadersCreated("repl.network.readersCreated",
                                                          &readersCreatedStats);
 
+// Where the oplog fetcher spends its time: waiting for and receiving batches, decompressing them,
+// extracting and validating the entries, and handing them to the oplog buffer.
+Counter64 fetcherNetworkMicros;
+ServerStatusMetricField<Counter64> displayFetcherNetworkMicros(
+    "repl.network.oplogFetcherMicros.network", &fetcherNetworkMicros);
+Counter64 fetcherDecompressionMicros;
+ServerStatusMetricField<Counter64> displayFetcherDecompressionMicros(
+    "repl.network.oplogFetcherMicros.decompression", &fetcherDecompressionMicros);
+Counter64 fetcherParsingMicros;
+ServerStatusMetricField<Counter64> displayFetcherParsingMicros(
+    "repl.network.oplogFetcherMicros.parsing", &fetcherParsingMicros);
+Counter64 fetcherEnqueueMicros;
+ServerStatusMetricField<Counter64> displayFetcherEnqueueMicros(
+    "repl.network.oplogFetcherMicros.enqueue", &fetcherEnqueueMicros);
+
 const Milliseconds maximumAwaitDataTimeoutMS(30 * 1000);
 
 /**
@@ -663,6 +678,7 @@ StatusWith<OplogFetcher::Documents> OplogFetcher::_getNextBatch() {
     Documents batch;
     try {
         Timer timer;
+        auto decompressionTimeBefore = _conn->getDecompressionTime();
         if (!_cursor) {
             // An error occurred and we should recreate the cursor.
             // The OplogFetcher uses an aggregation command in tenant migrations, which does not
@@ -715,9 +731,21 @@ StatusWith<OplogFetcher::Documents> OplogFetcher::_getNextBatch() {
             }
             _cursor->more();
         }
+        const auto receiveMicros = timer.micros();
+        const auto decompressionMicros =
+            durationCount<Microseconds>(_conn->getDecompressionTime() - decompressionTimeBefore);
+        fetcherDecompressionMicros.increment(decompressionMicros);
+        fetcherNetworkMicros.increment(std::max(receiveMicros - decompressionMicros, 0LL));
+
+        // The documents in the batch share ownership of the buffer of the reply message they were
+        // received in, so taking them from the cursor and later handing them to the oplog buffer
+        // only moves references to that buffer and does not copy the entries.
+        Timer parseTimer;
+        batch.reserve(_cursor->objsLeftInBatch());
         while (_cursor->moreInCurrentBatch()) {
             batch.emplace_back(_cursor->nextSafe());
         }
+        fetcherParsingMicros.increment(parseTimer.micros());
 
         // This value is only used on a successful batch for metrics.repl.network.getmores. This
         // metric intentionally tracks the time taken by the initial find as well.
@@ -850,8 +878,10 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
     // This lastFetched value is the last OpTime from the previous batch.
     auto previousOpTimeFetched = _getLastOpTimeFetched();
 
+    Timer parseTimer;
     auto validateResult = OplogFetcher::validateDocuments(
         documents, _firstBatch, previousOpTimeFetched.getTimestamp(), _config.startingPoint);
+    fetcherParsingMicros.increment(parseTimer.micros());
     if (!validateResult.isOK()) {
         return validateResult.getStatus();
     }
@@ -878,18 +908,22 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
     // Determine if we should stop syncing from our current sync source.
     auto changeSyncSourceAction = _dataReplicatorExternalState->shouldStopFetching(
         _config.source, replSetMetadata, oqMetadata, previousOpTimeFetched, lastDocOpTime);
-    str::stream errMsg;
-    errMsg << "sync source " << _config.source.toString();
-    errMsg << " (config version: " << replSetMetadata.getConfigVersion();
-    errMsg << "; last applied optime: " << oqMetadata.getLastOpApplied().toString();
-    errMsg << "; sync source index: " << oqMetadata.getSyncSourceIndex();
-    errMsg << "; has primary index: " << oqMetadata.hasPrimaryIndex();
-    errMsg << ") is no longer valid";
-    errMsg << " previous batch last fetched optime: " << previousOpTimeFetched.toString();
-    errMsg << " current batch last fetched optime: " << lastDocOpTime.toString();
+    // Only build the error message when we actually stop fetching, not for every batch.
+    auto makeStopFetchingStatus = [&] {
+        str::stream errMsg;
+        errMsg << "sync source " << _config.source.toString();
+        errMsg << " (config version: " << replSetMetadata.getConfigVersion();
+        errMsg << "; last applied optime: " << oqMetadata.getLastOpApplied().toString();
+        errMsg << "; sync source index: " << oqMetadata.getSyncSourceIndex();
+        errMsg << "; has primary index: " << oqMetadata.hasPrimaryIndex();
+        errMsg << ") is no longer valid";
+        errMsg << " previous batch last fetched optime: " << previousOpTimeFetched.toString();
+        errMsg << " current batch last fetched optime: " << lastDocOpTime.toString();
+        return Status(ErrorCodes::InvalidSyncSource, errMsg);
+    };
 
     if (changeSyncSourceAction == ChangeSyncSourceAction::kStopSyncingAndDropLastBatch) {
-        return Status(ErrorCodes::InvalidSyncSource, errMsg);
+        return makeStopFetchingStatus();
     }
 
     _dataReplicatorExternalState->processMetadata(replSetMetadata, oqMetadata);
@@ -908,7 +942,9 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
     }
 
     try {
+        Timer enqueueTimer;
         auto status = _enqueueDocumentsFn(firstDocToApply, documents.cend(), info);
+        fetcherEnqueueMicros.increment(enqueueTimer.micros());
         if (!status.isOK()) {
             return status;
         }
@@ -917,7 +953,7 @@ Status OplogFetcher::_onSuccessfulBatch(const Documents& documents) {
     }
 
     if (changeSyncSourceAction == ChangeSyncSourceAction::kStopSyncingAndEnqueueLastBatch) {
-        return Status(ErrorCodes::InvalidSyncSource, errMsg);
+        return makeStopFetchingStatus();
     }
 
     if (MONGO_unlikely(hangOplogFetcherBeforeAdvancingLastFetched.shouldFail())) {
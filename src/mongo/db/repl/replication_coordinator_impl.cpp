@@ -82,6 +82,7 @@
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replica_set_aware_service.h"
 #include "mongo/db/repl/replication_coordinator_impl_gen.h"
+#include "mongo/db/repl/replication_latency_tracker.h"
 #include "mongo/db/repl/replication_metrics.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/repl/storage_interface.h"
@@ -1415,8 +1416,12 @@ void ReplicationCoordinatorImpl::_setMyLastAppliedOpTimeAndWallTime(
     dassert(!VectorClock::get(getServiceContext())->isEnabled() ||
             _externalState->getGlobalTimestamp(getServiceContext()) >= opTime.getTimestamp());
 
-    _topCoord->setMyLastAppliedOpTimeAndWallTime(
-        opTimeAndWallTime, _replExecutor->now(), isRollbackAllowed);
+    const auto now = _replExecutor->now();
+    if (opTime > _topCoord->getMyLastAppliedOpTime()) {
+        ReplicationLatencyTracker::get(getServiceContext())
+            ->record(ReplicationLatencyTracker::Stage::kApplied, opTimeAndWallTime.wallTime, now);
+    }
+    _topCoord->setMyLastAppliedOpTimeAndWallTime(opTimeAndWallTime, now, isRollbackAllowed);
     // If we are using applied times to calculate the commit level, update it now.
     if (!_rsConfig.getWriteConcernMajorityShouldJournal()) {
         _updateLastCommittedOpTimeAndWallTime(lk);
@@ -1461,8 +1466,12 @@ void ReplicationCoordinatorImpl::_setMyLastAppliedOpTimeAndWallTime(
 
 void ReplicationCoordinatorImpl::_setMyLastDurableOpTimeAndWallTime(
     WithLock lk, const OpTimeAndWallTime& opTimeAndWallTime, bool isRollbackAllowed) {
-    _topCoord->setMyLastDurableOpTimeAndWallTime(
-        opTimeAndWallTime, _replExecutor->now(), isRollbackAllowed);
+    const auto now = _replExecutor->now();
+    if (opTimeAndWallTime.opTime > _topCoord->getMyLastDurableOpTime()) {
+        ReplicationLatencyTracker::get(getServiceContext())
+            ->record(ReplicationLatencyTracker::Stage::kDurable, opTimeAndWallTime.wallTime, now);
+    }
+    _topCoord->setMyLastDurableOpTimeAndWallTime(opTimeAndWallTime, now, isRollbackAllowed);
     // If we are using durable times to calculate the commit level, update it now.
     if (_rsConfig.getWriteConcernMajorityShouldJournal()) {
         _updateLastCommittedOpTimeAndWallTime(lk);
@@ -3175,7 +3184,8 @@ Status ReplicationCoordinatorImpl::processReplSetGetStatus(
             electionCandidateMetrics,
             electionParticipantMetrics,
             lastStableRecoveryTimestamp,
-            _externalState->tooStale()},
+            _externalState->tooStale(),
+            ReplicationLatencyTracker::get(getServiceContext())->toBSON()},
         response,
         &result);
     return result;
@@ -5174,10 +5184,18 @@ ChangeSyncSourceAction ReplicationCoordinatorImpl::shouldChangeSyncSource(
 
 void ReplicationCoordinatorImpl::_updateLastCommittedOpTimeAndWallTime(WithLock lk) {
     if (_topCoord->updateLastCommittedOpTimeAndWallTime()) {
+        _recordCommitPointLatency(lk);
         _setStableTimestampForStorage(lk);
     }
 }
 
+void ReplicationCoordinatorImpl::_recordCommitPointLatency(WithLock lk) {
+    ReplicationLatencyTracker::get(getServiceContext())
+        ->record(ReplicationLatencyTracker::Stage::kMajorityCommitted,
+                 _topCoord->getLastCommittedOpTimeAndWallTime().wallTime,
+                 _replExecutor->now());
+}
+
 void ReplicationCoordinatorImpl::attemptToAdvanceStableTimestamp() {
     stdx::unique_lock<Latch> lk(_mutex);
     _setStableTimestampForStorage(lk);
@@ -5440,6 +5458,7 @@ void ReplicationCoordinatorImpl::_advanceCommitPoint(
     bool forInitiate) {
     if (_topCoord->advanceLastCommittedOpTimeAndWallTime(
             committedOpTimeAndWallTime, fromSyncSource, forInitiate)) {
+        _recordCommitPointLatency(lk);
         if (_getMemberState_inlock().arbiter()) {
             // Arbiters do not store replicated data, so we consider their data trivially
             // consistent.
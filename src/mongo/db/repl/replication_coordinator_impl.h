@@ -1357,6 +1357,11 @@ private:
      */
     void _updateLastCommittedOpTimeAndWallTime(WithLock lk);
 
+    /**
+     * Records how long the newest entry covered by the commit point took to become committed.
+     */
+    void _recordCommitPointLatency(WithLock lk);
+
     /**
      * Callback that attempts to set the current term in topology coordinator and
      * relinquishes primary if the term actually changes and we are primary.
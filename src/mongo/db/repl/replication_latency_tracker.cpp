@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/replication_latency_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const auto getReplicationLatencyTracker =
+    ServiceContext::declareDecoration<ReplicationLatencyTracker>();
+
+constexpr std::array<StringData, 5> kStageNames = {
+    "fetched"_sd, "batched"_sd, "applied"_sd, "durable"_sd, "majorityCommitted"_sd};
+
+}  // namespace
+
+constexpr std::array<long long, 13> ReplicationLatencyHistogram::kBucketUpperBoundsMillis;
+
+void ReplicationLatencyHistogram::record(Date_t opWallTime, Date_t now) {
+    if (opWallTime == Date_t()) {
+        return;
+    }
+    record(now - opWallTime);
+}
+
+void ReplicationLatencyHistogram::record(Milliseconds latency) {
+    latency = std::max(latency, Milliseconds(0));
+    const auto& bounds = kBucketUpperBoundsMillis;
+    auto bucket =
+        std::upper_bound(bounds.begin(), bounds.end(), durationCount<Milliseconds>(latency)) -
+        bounds.begin();
+    ++_counts[bucket];
+    ++_count;
+    _total += latency;
+    _max = std::max(_max, latency);
+}
+
+Milliseconds ReplicationLatencyHistogram::getPercentile(double percentile) const {
+    if (_count == 0) {
+        return Milliseconds(0);
+    }
+    const auto rank = static_cast<long long>(std::ceil(_count * percentile / 100));
+    long long seen = 0;
+    for (std::size_t i = 0; i < kBucketUpperBoundsMillis.size(); ++i) {
+        seen += _counts[i];
+        if (seen >= std::max(rank, 1LL)) {
+            return std::min(_max, Milliseconds(kBucketUpperBoundsMillis[i]));
+        }
+    }
+    return _max;
+}
+
+void ReplicationLatencyHistogram::append(BSONObjBuilder* builder) const {
+    using namespace fmt::literals;
+    builder->append("count", _count);
+    builder->append("totalMillis", durationCount<Milliseconds>(_total));
+    builder->append("maxMillis", durationCount<Milliseconds>(_max));
+    builder->append("p50Millis", durationCount<Milliseconds>(getPercentile(50)));
+    builder->append("p90Millis", durationCount<Milliseconds>(getPercentile(90)));
+    builder->append("p99Millis", durationCount<Milliseconds>(getPercentile(99)));
+
+    BSONObjBuilder buckets(builder->subobjStart("buckets"));
+    long long lower = 0;
+    for (std::size_t i = 0; i < kBucketUpperBoundsMillis.size(); ++i) {
+        buckets.append("[{}, {})"_format(lower, kBucketUpperBoundsMillis[i]), _counts[i]);
+        lower = kBucketUpperBoundsMillis[i];
+    }
+    buckets.append("[{}, inf)"_format(lower), _counts.back());
+}
+
+ReplicationLatencyTracker* ReplicationLatencyTracker::get(ServiceContext* service) {
+    return &getReplicationLatencyTracker(service);
+}
+
+void ReplicationLatencyTracker::record(Stage stage, Date_t opWallTime, Date_t now) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _histograms[static_cast<std::size_t>(stage)].record(opWallTime, now);
+}
+
+BSONObj ReplicationLatencyTracker::toBSON() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    BSONObjBuilder builder;
+    for (std::size_t i = 0; i < kNumStages; ++i) {
+        BSONObjBuilder stage(builder.subobjStart(kStageNames[i]));
+        _histograms[i].append(&stage);
+    }
+    return builder.obj();
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * Histogram of replication latencies in milliseconds, with fixed buckets so that its output keeps
+ * the same shape for FTDC. It is not synchronized; callers guard it with the lock that protects
+ * its owner.
+ */
+class ReplicationLatencyHistogram {
+public:
+    // Exclusive upper bounds of every bucket but the last, which is unbounded.
+    static constexpr std::array<long long, 13> kBucketUpperBoundsMillis = {
+        1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000};
+
+    /**
+     * Records the time from 'opWallTime', the wall clock time at which the primary wrote an oplog
+     * entry, to 'now'. Negative latencies, which come from clock skew between members, are
+     * recorded as 0. Entries without a wall clock time are ignored.
+     */
+    void record(Date_t opWallTime, Date_t now);
+
+    void record(Milliseconds latency);
+
+    long long getCount() const {
+        return _count;
+    }
+
+    /**
+     * Estimates the given percentile, in [0, 100], as the upper bound of the bucket that holds it.
+     * The last bucket is reported as the largest latency recorded.
+     */
+    Milliseconds getPercentile(double percentile) const;
+
+    void append(BSONObjBuilder* builder) const;
+
+private:
+    std::array<long long, kBucketUpperBoundsMillis.size() + 1> _counts{};
+    long long _count = 0;
+    Milliseconds _total{0};
+    Milliseconds _max{0};
+};
+
+/**
+ * Records how long oplog entries take to reach each stage of the replication pipeline of this
+ * node, measured from the wall clock time at which the primary wrote them. The stages are
+ * cumulative, so the difference between the percentiles of consecutive stages shows where the
+ * time goes. Latencies are sampled once per batch or per advance of the relevant optime, using the
+ * newest entry it covers.
+ *
+ * How long the other members take to apply and journal entries, as reported to this node by
+ * heartbeats and replSetUpdatePosition, is kept with their MemberData.
+ */
+class ReplicationLatencyTracker {
+    ReplicationLatencyTracker(const ReplicationLatencyTracker&) = delete;
+    ReplicationLatencyTracker& operator=(const ReplicationLatencyTracker&) = delete;
+
+public:
+    enum class Stage {
+        kFetched,            // Returned to the oplog fetcher by the sync source.
+        kBatched,            // Taken out of the oplog buffer into a batch to apply.
+        kApplied,            // Applied; this node's lastApplied covers it.
+        kDurable,            // Journaled; this node's lastDurable covers it.
+        kMajorityCommitted,  // Covered by the commit point known to this node.
+    };
+
+    ReplicationLatencyTracker() = default;
+
+    static ReplicationLatencyTracker* get(ServiceContext* service);
+
+    void record(Stage stage, Date_t opWallTime, Date_t now);
+
+    BSONObj toBSON() const;
+
+private:
+    static constexpr std::size_t kNumStages = 5;
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("ReplicationLatencyTracker::_mutex");
+    std::array<ReplicationLatencyHistogram, kNumStages> _histograms;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/replication_latency_tracker.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+TEST(ReplicationLatencyHistogramTest, EmptyHistogram) {
+    ReplicationLatencyHistogram histogram;
+    ASSERT_EQUALS(0, histogram.getCount());
+    ASSERT_EQUALS(Milliseconds(0), histogram.getPercentile(99));
+
+    BSONObjBuilder builder;
+    histogram.append(&builder);
+    auto obj = builder.obj();
+    ASSERT_EQUALS(0, obj["count"].numberLong());
+    ASSERT_EQUALS(0, obj["p99Millis"].numberLong());
+    const auto numBuckets = ReplicationLatencyHistogram::kBucketUpperBoundsMillis.size() + 1;
+    ASSERT_EQUALS(static_cast<int>(numBuckets), obj["buckets"].Obj().nFields());
+}
+
+TEST(ReplicationLatencyHistogramTest, RecordsIntoBuckets) {
+    ReplicationLatencyHistogram histogram;
+    histogram.record(Milliseconds(0));
+    histogram.record(Milliseconds(1));
+    histogram.record(Milliseconds(7));
+    histogram.record(Milliseconds(20000));
+
+    BSONObjBuilder builder;
+    histogram.append(&builder);
+    auto obj = builder.obj();
+    ASSERT_EQUALS(4, obj["count"].numberLong());
+    ASSERT_EQUALS(20008, obj["totalMillis"].numberLong());
+    ASSERT_EQUALS(20000, obj["maxMillis"].numberLong());
+
+    auto buckets = obj["buckets"].Obj();
+    ASSERT_EQUALS(1, buckets["[0, 1)"].numberLong());
+    ASSERT_EQUALS(1, buckets["[1, 2)"].numberLong());
+    ASSERT_EQUALS(0, buckets["[2, 5)"].numberLong());
+    ASSERT_EQUALS(1, buckets["[5, 10)"].numberLong());
+    ASSERT_EQUALS(1, buckets["[10000, inf)"].numberLong());
+}
+
+TEST(ReplicationLatencyHistogramTest, PercentilesUseBucketUpperBounds) {
+    ReplicationLatencyHistogram histogram;
+    for (int i = 0; i < 98; ++i) {
+        histogram.record(Milliseconds(3));
+    }
+    histogram.record(Milliseconds(150));
+    histogram.record(Milliseconds(30000));
+
+    ASSERT_EQUALS(Milliseconds(5), histogram.getPercentile(50));
+    ASSERT_EQUALS(Milliseconds(5), histogram.getPercentile(98));
+    ASSERT_EQUALS(Milliseconds(200), histogram.getPercentile(99));
+    ASSERT_EQUALS(Milliseconds(30000), histogram.getPercentile(100));
+}
+
+TEST(ReplicationLatencyHistogramTest, MeasuresFromOpWallTime) {
+    ReplicationLatencyHistogram histogram;
+    const auto now = Date_t::fromMillisSinceEpoch(100000);
+
+    // Entries without a wall clock time are not recorded.
+    histogram.record(Date_t(), now);
+    ASSERT_EQUALS(0, histogram.getCount());
+
+    histogram.record(now - Milliseconds(40), now);
+    // A wall clock time ahead of this node's clock counts as no latency.
+    histogram.record(now + Milliseconds(40), now);
+    ASSERT_EQUALS(2, histogram.getCount());
+    ASSERT_EQUALS(Milliseconds(40), histogram.getPercentile(100));
+    ASSERT_EQUALS(Milliseconds(1), histogram.getPercentile(50));
+}
+
+TEST(ReplicationLatencyTrackerTest, ReportsEveryStage) {
+    ReplicationLatencyTracker tracker;
+    const auto now = Date_t::fromMillisSinceEpoch(100000);
+    tracker.record(ReplicationLatencyTracker::Stage::kFetched, now - Milliseconds(3), now);
+    tracker.record(ReplicationLatencyTracker::Stage::kApplied, now - Milliseconds(12), now);
+    tracker.record(ReplicationLatencyTracker::Stage::kApplied, now - Milliseconds(15), now);
+    tracker.record(
+        ReplicationLatencyTracker::Stage::kMajorityCommitted, now - Milliseconds(250), now);
+
+    auto obj = tracker.toBSON();
+    ASSERT_EQUALS(5, obj.nFields());
+    ASSERT_EQUALS(1, obj["fetched"]["count"].numberLong());
+    ASSERT_EQUALS(0, obj["batched"]["count"].numberLong());
+    ASSERT_EQUALS(2, obj["applied"]["count"].numberLong());
+    ASSERT_EQUALS(15, obj["applied"]["maxMillis"].numberLong());
+    ASSERT_EQUALS(0, obj["durable"]["count"].numberLong());
+    ASSERT_EQUALS(1, obj["majorityCommitted"]["count"].numberLong());
+    ASSERT_EQUALS(250, obj["majorityCommitted"]["p99Millis"].numberLong());
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -36,6 +36,7 @@
 #include "mongo/db/repl/replication_recovery.h"
 
 #include "mongo/db/catalog/document_validation.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/namespace_string.h"
@@ -50,12 +51,16 @@
 #include "mongo/db/repl/transaction_oplog_application.h"
 #include "mongo/db/server_recovery.h"
 #include "mongo/db/session.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/control/journal_flusher.h"
 #include "mongo/db/storage/durable_history_pin.h"
 #include "mongo/db/storage/storage_parameters_gen.h"
 #include "mongo/db/transaction_history_iterator.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/logv2/log.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/timer.h"
 
@@ -70,12 +75,41 @@ namespace {
 const auto kRecoveryBatchLogLevel = logv2::LogSeverity::Debug(2);
 const auto kRecoveryOperationLogLevel = logv2::LogSeverity::Debug(3);
 
+// How often the progress of oplog application is logged during recovery.
+const Seconds kRecoveryProgressLogInterval{10};
+
+// Batches and operations applied by replication recovery, at startup and during rollback.
+TimerStats recoveryBatchStats;
+ServerStatusMetricField<TimerStats> displayRecoveryBatches("repl.recovery.batches",
+                                                           &recoveryBatchStats);
+Counter64 recoveryOpsApplied;
+ServerStatusMetricField<Counter64> displayRecoveryOpsApplied("repl.recovery.ops",
+                                                             &recoveryOpsApplied);
+
+// Time oplog application spent waiting for the next batch to be read from the oplog.
+Counter64 recoveryWaitForBatchMillis;
+ServerStatusMetricField<Counter64> displayRecoveryWaitForBatchMillis(
+    "repl.recovery.waitForBatchMillis", &recoveryWaitForBatchMillis);
+
 /**
  * Tracks and logs operations applied during recovery.
  */
 class RecoveryOplogApplierStats : public OplogApplier::Observer {
 public:
+    explicit RecoveryOplogApplierStats(Timestamp endPoint) : _endPoint(endPoint) {}
+
     void onBatchBegin(const std::vector<OplogEntry>& batch) final {
+        if (_progressTimer.elapsed() >= kRecoveryProgressLogInterval) {
+            LOGV2(6718000,
+                  "Oplog application for recovery in progress",
+                  "numBatches"_attr = _numBatches,
+                  "numOpsApplied"_attr = _numOpsApplied,
+                  "nextOpTime"_attr = batch.front().getOpTime(),
+                  "endPoint"_attr = _endPoint,
+                  "elapsedMillis"_attr = _timer.millis());
+            _progressTimer.reset();
+        }
+
         _numBatches++;
         LOGV2_FOR_RECOVERY(24098,
                            kRecoveryBatchLogLevel.toInt(),
@@ -90,6 +124,7 @@ public:
                            "numOpsApplied"_attr = _numOpsApplied);
 
         _numOpsApplied += batch.size();
+        recoveryOpsApplied.increment(batch.size());
         if (shouldLog(::mongo::logv2::LogComponent::kStorageRecovery, kRecoveryOperationLogLevel)) {
             std::size_t i = 0;
             for (const auto& entry : batch) {
@@ -117,12 +152,16 @@ public:
               "Completed oplog application for recovery",
               "numOpsApplied"_attr = _numOpsApplied,
               "numBatches"_attr = _numBatches,
-              "applyThroughOpTime"_attr = applyThroughOpTime);
+              "applyThroughOpTime"_attr = applyThroughOpTime,
+              "durationMillis"_attr = _timer.millis());
     }
 
 private:
+    const Timestamp _endPoint;
     std::size_t _numBatches = 0;
     std::size_t _numOpsApplied = 0;
+    Timer _timer;
+    Timer _progressTimer;
 };
 
 /**
@@ -241,6 +280,102 @@ private:
     std::unique_ptr<DBClientCursor> _cursor;
 };
 
+/**
+ * Reads batches of oplog entries to replay on a thread of its own, one batch ahead of oplog
+ * application, so that reading and parsing the oplog overlaps with the writer threads applying
+ * the previous batch. Owns the oplog buffer from startup to shutdown.
+ */
+class RecoveryOplogBatchPrefetcher {
+    RecoveryOplogBatchPrefetcher(const RecoveryOplogBatchPrefetcher&) = delete;
+    RecoveryOplogBatchPrefetcher& operator=(const RecoveryOplogBatchPrefetcher&) = delete;
+
+public:
+    RecoveryOplogBatchPrefetcher(OplogApplier* oplogApplier,
+                                 OplogBufferLocalOplog* oplogBuffer,
+                                 const OplogApplier::BatchLimits& batchLimits)
+        : _oplogApplier(oplogApplier), _oplogBuffer(oplogBuffer), _batchLimits(batchLimits) {
+        _thread = stdx::thread([this] { _run(); });
+    }
+
+    ~RecoveryOplogBatchPrefetcher() {
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _inShutdown = true;
+            _cv.notify_all();
+        }
+        _thread.join();
+    }
+
+    /**
+     * Returns the next batch to apply, or an empty batch once the oplog buffer is exhausted.
+     */
+    std::vector<OplogEntry> getNextBatch() {
+        Timer waitTimer;
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return _nextBatch.has_value(); });
+        recoveryWaitForBatchMillis.increment(waitTimer.millis());
+
+        auto batch = fassert(50763, std::move(*_nextBatch));
+        _nextBatch.reset();
+        _cv.notify_all();
+        return batch;
+    }
+
+private:
+    void _run() {
+        Client::initThread("ReplRecoveryBatcher");
+        auto opCtx = cc().makeOperationContext();
+
+        // Oplog application must not block on this thread reading the oplog.
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(opCtx->lockState());
+        opCtx->lockState()->skipAcquireTicket();
+
+        try {
+            _oplogBuffer->startup(opCtx.get());
+            ON_BLOCK_EXIT([&] { _oplogBuffer->shutdown(opCtx.get()); });
+
+            while (true) {
+                auto batch = _oplogApplier->getNextApplierBatch(opCtx.get(), _batchLimits);
+                if (batch.isOK() && batch.getValue().empty()) {
+                    invariant(_oplogBuffer->isEmpty(),
+                              "Oplog buffer not empty after reading the last batch to apply");
+                }
+                if (!_publish(std::move(batch))) {
+                    return;
+                }
+            }
+        } catch (const DBException& ex) {
+            _publish(ex.toStatus());
+        }
+    }
+
+    /**
+     * Hands 'batch' over to getNextBatch() once the previous one has been taken. Returns whether
+     * there may be more batches to read.
+     */
+    bool _publish(StatusWith<std::vector<OplogEntry>> batch) {
+        const bool isLastBatch = !batch.isOK() || batch.getValue().empty();
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return !_nextBatch || _inShutdown; });
+        if (_inShutdown) {
+            return false;
+        }
+        _nextBatch = std::move(batch);
+        _cv.notify_all();
+        return !isLastBatch;
+    }
+
+    OplogApplier* const _oplogApplier;
+    OplogBufferLocalOplog* const _oplogBuffer;
+    const OplogApplier::BatchLimits _batchLimits;
+
+    Mutex _mutex = MONGO_MAKE_LATCH("RecoveryOplogBatchPrefetcher::_mutex");
+    stdx::condition_variable _cv;
+    boost::optional<StatusWith<std::vector<OplogEntry>>> _nextBatch;
+    bool _inShutdown = false;
+    stdx::thread _thread;
+};
+
 boost::optional<Timestamp> recoverFromOplogPrecursor(OperationContext* opCtx,
                                                      StorageInterface* storageInterface) {
     if (!storageInterface->supportsRecoveryTimestamp(opCtx->getServiceContext())) {
@@ -694,9 +829,8 @@ Timestamp ReplicationRecoveryImpl::_applyOplogOperations(OperationContext* opCtx
           "endPoint"_attr = endPoint);
 
     OplogBufferLocalOplog oplogBuffer(startPoint, endPoint);
-    oplogBuffer.startup(opCtx);
 
-    RecoveryOplogApplierStats stats;
+    RecoveryOplogApplierStats stats(endPoint);
 
     auto writerPool = makeReplWriterPool();
     auto* replCoord = ReplicationCoordinator::get(opCtx);
@@ -726,17 +860,22 @@ Timestamp ReplicationRecoveryImpl::_applyOplogOperations(OperationContext* opCtx
         (recoveryMode == RecoveryMode::kStartupFromStableTimestamp ||
          recoveryMode == RecoveryMode::kStartupFromUnstableCheckpoint);
 
+    RecoveryOplogBatchPrefetcher prefetcher(&oplogApplier, &oplogBuffer, batchLimits);
+
     OpTime applyThroughOpTime;
     std::vector<OplogEntry> batch;
-    while (
-        !(batch = fassert(50763, oplogApplier.getNextApplierBatch(opCtx, batchLimits))).empty()) {
+    while (!(batch = prefetcher.getNextBatch()).empty()) {
         if (advanceTimestampsEachBatch && applyThroughOpTime.isNull()) {
             // We must set appliedThrough before applying anything at all, so we know
             // any unstable checkpoints we take are "dirty".  A null appliedThrough indicates
             // a clean shutdown which may not be the case if we had started applying a batch.
             _consistencyMarkers->setAppliedThrough(opCtx, oplogBuffer.getOpTimeAtStartPoint());
         }
-        applyThroughOpTime = uassertStatusOK(oplogApplier.applyOplogBatch(opCtx, std::move(batch)));
+        {
+            TimerHolder timer(&recoveryBatchStats);
+            applyThroughOpTime =
+                uassertStatusOK(oplogApplier.applyOplogBatch(opCtx, std::move(batch)));
+        }
         if (advanceTimestampsEachBatch) {
             invariant(!applyThroughOpTime.isNull());
             _consistencyMarkers->setAppliedThrough(opCtx, applyThroughOpTime);
@@ -745,11 +884,6 @@ Timestamp ReplicationRecoveryImpl::_applyOplogOperations(OperationContext* opCtx
         }
     }
     stats.complete(applyThroughOpTime);
-    invariant(oplogBuffer.isEmpty(),
-              str::stream() << "Oplog buffer not empty after applying operations. Last operation "
-                               "applied with optime: "
-                            << applyThroughOpTime.toBSON());
-    oplogBuffer.shutdown(opCtx);
 
     // The applied up to timestamp will be null if no oplog entries were applied.
     if (applyThroughOpTime.isNull()) {
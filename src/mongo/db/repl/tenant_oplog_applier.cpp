@@ -904,6 +904,7 @@ std::vector<std::vector<const OplogEntry*>> TenantOplogApplier::_fillWriterVecto
     std::vector<std::vector<const OplogEntry*>> writerVectors(
         _writerPool->getStats().options.maxThreads);
     CachedCollectionProperties collPropertiesCache;
+    WriterAssignment writerAssignment;
 
     for (auto&& op : batch->ops) {
         // If the operation's optime is before or the same as the beginApplyingAfterOpTime we don't
@@ -938,11 +939,12 @@ std::vector<std::vector<const OplogEntry*>> TenantOplogApplier::_fillWriterVecto
                                              expansions,
                                              &writerVectors,
                                              &collPropertiesCache,
+                                             &writerAssignment,
                                              isTransactionWithCommand /* serial */);
         } else {
             // Add a single op to the writer vectors.
             OplogApplierUtils::addToWriterVector(
-                opCtx, &op.entry, &writerVectors, &collPropertiesCache);
+                opCtx, &op.entry, &writerVectors, &collPropertiesCache, &writerAssignment);
         }
     }
     return writerVectors;
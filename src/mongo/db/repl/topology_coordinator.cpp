@@ -1857,6 +1857,7 @@ void TopologyCoordinator::prepareStatusResponse(const ReplSetStatusArgs& rsStatu
     const BSONObj& initialSyncStatus = rsStatusArgs.initialSyncStatus;
     const BSONObj& electionCandidateMetrics = rsStatusArgs.electionCandidateMetrics;
     const BSONObj& electionParticipantMetrics = rsStatusArgs.electionParticipantMetrics;
+    const BSONObj& replicationLatency = rsStatusArgs.replicationLatency;
     const boost::optional<Timestamp>& lastStableRecoveryTimestamp =
         rsStatusArgs.lastStableRecoveryTimestamp;
 
@@ -1962,6 +1963,16 @@ void TopologyCoordinator::prepareStatusResponse(const ReplSetStatusArgs& rsStatu
 
                 bb.appendDate("lastAppliedWallTime", it->getLastAppliedWallTime());
                 bb.appendDate("lastDurableWallTime", it->getLastDurableWallTime());
+
+                if (it->getAppliedLatency().getCount() || it->getDurableLatency().getCount()) {
+                    BSONObjBuilder latency(bb.subobjStart("replicationLatency"));
+                    {
+                        BSONObjBuilder applied(latency.subobjStart("applied"));
+                        it->getAppliedLatency().append(&applied);
+                    }
+                    BSONObjBuilder durable(latency.subobjStart("durable"));
+                    it->getDurableLatency().append(&durable);
+                }
             }
             bb.appendDate("lastHeartbeat", it->getLastHeartbeat());
             bb.appendDate("lastHeartbeatRecv", it->getLastHeartbeatRecv());
@@ -2063,6 +2074,10 @@ void TopologyCoordinator::prepareStatusResponse(const ReplSetStatusArgs& rsStatu
         response->append("electionParticipantMetrics", electionParticipantMetrics);
     }
 
+    if (!replicationLatency.isEmpty()) {
+        response->append("replicationLatency", replicationLatency);
+    }
+
     response->append("members", membersOut);
     *result = Status::OK();
 }
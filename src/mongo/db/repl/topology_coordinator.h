@@ -381,6 +381,7 @@ public:
         // engines.
         const boost::optional<Timestamp> lastStableRecoveryTimestamp;
         bool tooStale;
+        const BSONObj replicationLatency;
     };
 
     // produce a reply to a status request
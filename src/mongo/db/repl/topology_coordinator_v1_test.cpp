@@ -2100,6 +2100,60 @@ TEST_F(TopoCoordTest, ReplSetGetStatusVotingMembersCountAndWritableVotingMembers
     ASSERT_EQUALS(2, rsStatus["writableVotingMembersCount"].numberInt());
 }
 
+TEST_F(TopoCoordTest, ReplSetGetStatusReportsReplicationLatencyOfMembers) {
+    std::string setName = "mySet";
+    updateConfig(BSON("_id" << setName << "version" << 1 << "members"
+                            << BSON_ARRAY(BSON("_id" << 0 << "host"
+                                                     << "test0:1234")
+                                          << BSON("_id" << 1 << "host"
+                                                        << "test1:1234"))),
+                 0);
+
+    HostAndPort member("test1:1234");
+    auto heartbeatWithOpTime = [&](Date_t now, OpTime opTime, Date_t wallTime) {
+        ReplSetHeartbeatResponse hb;
+        hb.setConfigVersion(1);
+        hb.setState(MemberState::RS_SECONDARY);
+        hb.setAppliedOpTimeAndWallTime({opTime, wallTime});
+        hb.setDurableOpTimeAndWallTime({opTime, wallTime});
+        getTopoCoord().prepareHeartbeatRequestV1(now, setName, member);
+        getTopoCoord().processHeartbeatResponse(
+            now, Milliseconds(1), member, StatusWith<ReplSetHeartbeatResponse>(hb));
+    };
+
+    // The first optimes learned for the member are not recorded, later advances are.
+    Date_t wallTime = Date_t::fromMillisSinceEpoch(10000);
+    heartbeatWithOpTime(wallTime + Seconds(5), OpTime(Timestamp(10, 1), 1), wallTime);
+    heartbeatWithOpTime(wallTime + Milliseconds(30), OpTime(Timestamp(10, 2), 1), wallTime);
+    heartbeatWithOpTime(wallTime + Milliseconds(40), OpTime(Timestamp(10, 2), 1), wallTime);
+
+    BSONObjBuilder statusBuilder;
+    Status resultStatus(ErrorCodes::InternalError, "prepareStatusResponse didn't set result");
+    getTopoCoord().prepareStatusResponse(
+        TopologyCoordinator::ReplSetStatusArgs{Date_t(),
+                                               10,
+                                               OpTime(),
+                                               BSONObj(),
+                                               BSONObj(),
+                                               BSONObj(),
+                                               boost::none,
+                                               false,
+                                               BSON("dummyReplicationLatency" << 1)},
+        &statusBuilder,
+        &resultStatus);
+    ASSERT_OK(resultStatus);
+
+    BSONObj rsStatus = statusBuilder.obj();
+    ASSERT_BSONOBJ_EQ(BSON("dummyReplicationLatency" << 1), rsStatus["replicationLatency"].Obj());
+    std::vector<BSONElement> memberArray = rsStatus["members"].Array();
+    ASSERT_FALSE(memberArray[0].Obj().hasField("replicationLatency"));
+    BSONObj latency = memberArray[1].Obj()["replicationLatency"].Obj();
+    ASSERT_EQUALS(1, latency["applied"]["count"].numberLong());
+    ASSERT_EQUALS(30, latency["applied"]["maxMillis"].numberLong());
+    ASSERT_EQUALS(1, latency["durable"]["count"].numberLong());
+    ASSERT_EQUALS(30, latency["durable"]["maxMillis"].numberLong());
+}
+
 TEST_F(TopoCoordTest, NodeReturnsInvalidReplicaSetConfigInResponseToGetStatusWhenAbsentFromConfig) {
     // This test starts by configuring a TopologyCoordinator to NOT be a member of a 3 node
     // replica set. Then running prepareStatusResponse should fail.
@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/update_delete_group.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/ops/write_ops.h"
+#include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_applier_utils.h"
+#include "mongo/db/repl/oplog_entry.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// Bounds the size of the storage transaction, using the same limit as grouped inserts.
+const auto kUpdateDeleteGroupMaxGroupSize = write_ops::insertVectorMaxBytes;
+
+// Limit number of ops in a single group.
+constexpr auto kUpdateDeleteGroupMaxOpCount = 64;
+
+bool isGroupableOp(const OplogEntry& entry) {
+    const auto opType = entry.getOpType();
+    if (opType != OpTypeEnum::kUpdate && opType != OpTypeEnum::kDelete) {
+        return false;
+    }
+    // Malformed operations are left to applyOperation_inlock() to report.
+    if (opType == OpTypeEnum::kUpdate && !entry.getObject2()) {
+        return false;
+    }
+    // Retryable findAndModify images are upserted with their own write conflict handling, which
+    // must stay confined to the single operation that produced them.
+    return !entry.getIdElement().eoo() && !entry.getNeedsRetryImage() &&
+        !entry.isForCappedCollection() && !entry.getNss().isSystemDotViews();
+}
+
+}  // namespace
+
+UpdateDeleteGroup::UpdateDeleteGroup(std::vector<const OplogEntry*>* ops,
+                                     OperationContext* opCtx,
+                                     UpdateDeleteGroup::Mode mode,
+                                     const bool isDataConsistent,
+                                     InsertGroup::ApplyFunc applyOplogEntryOrGroupedInserts)
+    : _end(ops->cend()),
+      _opCtx(opCtx),
+      _mode(mode),
+      _isDataConsistent(isDataConsistent),
+      _applyOplogEntryOrGroupedInserts(applyOplogEntryOrGroupedInserts) {}
+
+StatusWith<UpdateDeleteGroup::ConstIterator> UpdateDeleteGroup::groupAndApplyUpdatesAndDeletes(
+    ConstIterator it) noexcept {
+    const auto& entry = **it;
+
+    // The following conditions must be met before attempting to group the oplog entries starting
+    // at 'it':
+    // 1) Grouping is enabled and we are in steady state secondary application, where any failure
+    //    of an operation is unexpected;
+    // 2) The CRUD operation must be a groupable update or delete;
+    // 3) We have not attempted to group this operation during a previous call to this function.
+    if (!oplogApplicationGroupsUpdatesAndDeletes || _mode != Mode::kSecondary) {
+        return Status(ErrorCodes::IllegalOperation,
+                      "Grouping updates and deletes is only enabled in secondary mode.");
+    }
+    if (!isGroupableOp(entry)) {
+        return Status(ErrorCodes::TypeMismatch, "Can only group update and delete operations.");
+    }
+    if (_doNotGroupBeforePoint && it <= *_doNotGroupBeforePoint) {
+        return Status(ErrorCodes::InvalidPath,
+                      "Cannot group an operation that we previously attempted to group.");
+    }
+
+    size_t groupSize = entry.getObject().objsize();
+    auto opCount = std::vector<const OplogEntry*>::size_type(1);
+    const auto groupNamespace = entry.getNss();
+    const auto groupUuid = entry.getUuid();
+
+    // A document is only written once per group, so that a group never stacks several
+    // timestamped versions of the same record in one storage transaction.
+    auto groupIds = SimpleBSONElementComparator::kInstance.makeBSONEltUnorderedSet();
+    groupIds.insert(entry.getIdElement());
+
+    // Find the first op that cannot be added to the group, like InsertGroup does for inserts.
+    auto endOfGroupableOpsIterator =
+        std::find_if(it + 1, _end, [&](const OplogEntry* nextEntry) -> bool {
+            groupSize += nextEntry->getObject().objsize();
+            opCount += 1;
+
+            return !isGroupableOp(*nextEntry)                 // Must be an update or delete.
+                || nextEntry->getNss() != groupNamespace      // Must be in the same namespace.
+                || nextEntry->getUuid() != groupUuid          // Must be on the same collection.
+                || groupSize > kUpdateDeleteGroupMaxGroupSize  // Must not be too large.
+                || opCount > kUpdateDeleteGroupMaxOpCount      // Limit number of ops in a group.
+                || !groupIds.insert(nextEntry->getIdElement()).second;  // Distinct documents.
+        });
+
+    // See if we were able to create a group that contains more than a single op.
+    if (std::distance(it, endOfGroupableOpsIterator) == 1) {
+        return Status(ErrorCodes::NoSuchKey,
+                      "Not able to create a group with more than a single update or delete");
+    }
+
+    try {
+        writeConflictRetry(_opCtx, "applyGroupedUpdatesAndDeletes", groupNamespace.ns(), [&] {
+            AutoGetCollection autoColl(
+                _opCtx, OplogApplierUtils::getNsOrUUID(groupNamespace, entry), MODE_IX);
+            WriteUnitOfWork wuow(_opCtx);
+            TimestampGroupedWritesBlock timestampGroupedWrites(_opCtx);
+            for (auto opIt = it; opIt != endOfGroupableOpsIterator; ++opIt) {
+                // A write conflict propagates out of the per-operation retry loop, because we
+                // hold a WriteUnitOfWork, and the whole group is retried.
+                uassertStatusOK(
+                    _applyOplogEntryOrGroupedInserts(_opCtx, *opIt, _mode, _isDataConsistent));
+            }
+            wuow.commit();
+        });
+        // It succeeded, advance the iterator to the end of the group.
+        return endOfGroupableOpsIterator - 1;
+    } catch (...) {
+        // The group failed and was rolled back. Log and fall through to the application of the
+        // first op on its own.
+        auto status = exceptionToStatus();
+        LOGV2_DEBUG(6716000,
+                    1,
+                    "Error applying updates and deletes in a group. Trying first operation on "
+                    "its own",
+                    "error"_attr = redact(status),
+                    "groupSize"_attr = std::distance(it, endOfGroupableOpsIterator),
+                    "firstOp"_attr = redact(entry.toBSONForLogging()));
+
+        // Avoid quadratic run time by not retrying until we are beyond this group of ops.
+        _doNotGroupBeforePoint = endOfGroupableOpsIterator - 1;
+
+        return status;
+    }
+
+    MONGO_UNREACHABLE;
+}
+
+}  // namespace repl
+}  // namespace mongo
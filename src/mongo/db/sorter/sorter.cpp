@@ -52,6 +52,8 @@
 #include <snappy.h>
 #include <vector>
 
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
 #include "mongo/db/jsobj.h"
@@ -64,6 +66,7 @@
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/str.h"
+#include "mongo/util/timer.h"
 
 // As this file is included in various places we need to handle the case of having the log header
 // already included
@@ -209,14 +212,16 @@ public:
                  std::streamoff fileEndOffset,
                  const Settings& settings,
                  const boost::optional<std::string>& dbName,
-                 const uint32_t checksum)
+                 const uint32_t checksum,
+                 boost::optional<int32_t> blockFormatVersion)
         : _settings(settings),
           _file(std::move(file)),
           _fileStartOffset(fileStartOffset),
           _fileCurrentOffset(fileStartOffset),
           _fileEndOffset(fileEndOffset),
           _dbName(dbName),
-          _originalChecksum(checksum) {}
+          _originalChecksum(checksum),
+          _blockFormatVersion(blockFormatVersion) {}
 
     void openSource() {}
 
@@ -264,7 +269,9 @@ public:
     }
 
     SorterRange getRange() const {
-        return {_fileStartOffset, _fileEndOffset, _originalChecksum};
+        SorterRange range{_fileStartOffset, _fileEndOffset, _originalChecksum};
+        range.setBlockFormatVersion(_blockFormatVersion);
+        return range;
     }
 
 private:
@@ -283,11 +290,74 @@ private:
      * read, then _done is set to true and the function returns immediately.
      */
     void _fillBufferFromDisk() {
+        const Timer timer;
+        const auto startOffset = _fileCurrentOffset;
+
         int32_t rawSize;
         _read(&rawSize, sizeof(rawSize));
         if (_done)
             return;
 
+        if (rawSize == SorterSpillBlockHeader::kMarker) {
+            _fillBufferFromBlock();
+        } else {
+            _fillBufferFromLegacyBlock(rawSize);
+        }
+
+        const uint64_t bytesRead = _fileCurrentOffset - startOffset;
+        const auto readTime = Microseconds(timer.micros());
+        auto& stats = _file->spillStats();
+        stats.bytesRead += bytesRead;
+        stats.readTime += readTime;
+        recordSorterSpillRead(bytesRead, readTime);
+    }
+
+    /**
+     * Reads a block in the current format, described by SorterSpillBlockHeader, whose marker has
+     * already been read.
+     */
+    void _fillBufferFromBlock() {
+        char headerBuffer[SorterSpillBlockHeader::kSerializedSize];
+        _read(headerBuffer, sizeof(headerBuffer));
+        uassert(6723010, "Sorter spill file too short to hold a block header", !_done);
+        const auto header = SorterSpillBlockHeader::parse(headerBuffer);
+
+        // The size is checked against the range before anything is allocated, since it is only
+        // known to be intact once the block was read and its checksum verified.
+        size_t blockSize = header.storedSize;
+        uassert(6723011,
+                "Sorter spill file too short to hold a block",
+                static_cast<std::streamoff>(blockSize) <= _fileEndOffset - _fileCurrentOffset);
+        _buffer.reset(new char[blockSize]);
+        _read(_buffer.get(), blockSize);
+
+        const auto headerChecksum =
+            addDataToChecksum(headerBuffer, SorterSpillBlockHeader::kChecksumOffset, 0);
+        uassert(ErrorCodes::ChecksumMismatch,
+                "Checksum of sorter spill block does not match, data is corrupt",
+                addDataToChecksum(_buffer.get(), blockSize, headerChecksum) == header.checksum);
+
+        _unprotect(&blockSize);
+
+        const auto& codec = SorterSpillCodec::get(header.codec);
+        if (codec.id() == SorterSpillCodec::Id::kNone) {
+            uassert(6723012,
+                    "Uncompressed sorter spill block does not have the expected length",
+                    blockSize == header.uncompressedSize);
+        } else {
+            std::unique_ptr<char[]> decompressionBuffer(new char[header.uncompressedSize]);
+            codec.decompress(ConstDataRange(_buffer.get(), blockSize),
+                             DataRange(decompressionBuffer.get(), header.uncompressedSize));
+            _buffer.swap(decompressionBuffer);
+        }
+        _bufferReader.reset(new BufReader(_buffer.get(), header.uncompressedSize));
+    }
+
+    /**
+     * Reads a block of the format that preceded SorterSpillBlockHeader, as kept by resumable index
+     * builds across an upgrade.
+     */
+    void _fillBufferFromLegacyBlock(int32_t rawSize) {
         // negative size means compressed
         const bool compressed = rawSize < 0;
         int32_t blockSize = std::abs(rawSize);
@@ -296,22 +366,9 @@ private:
         _read(_buffer.get(), blockSize);
         uassert(16816, "file too short?", !_done);
 
-        if (auto encryptionHooks = getEncryptionHooksIfEnabled()) {
-            std::unique_ptr<char[]> out(new char[blockSize]);
-            size_t outLen;
-            Status status =
-                encryptionHooks->unprotectTmpData(reinterpret_cast<const uint8_t*>(_buffer.get()),
-                                                  blockSize,
-                                                  reinterpret_cast<uint8_t*>(out.get()),
-                                                  blockSize,
-                                                  &outLen,
-                                                  _dbName);
-            uassert(28841,
-                    str::stream() << "Failed to unprotect data: " << status.toString(),
-                    status.isOK());
-            blockSize = outLen;
-            _buffer.swap(out);
-        }
+        size_t unprotectedSize = blockSize;
+        _unprotect(&unprotectedSize);
+        blockSize = unprotectedSize;
 
         if (!compressed) {
             _bufferReader.reset(new BufReader(_buffer.get(), blockSize));
@@ -335,6 +392,32 @@ private:
         _bufferReader.reset(new BufReader(_buffer.get(), uncompressedSize));
     }
 
+    /**
+     * Decrypts the '*blockSize' bytes of _buffer in place, if encryption is enabled, and updates
+     * '*blockSize' to the size of the decrypted data.
+     */
+    void _unprotect(size_t* blockSize) {
+        auto encryptionHooks = getEncryptionHooksIfEnabled();
+        if (!encryptionHooks) {
+            return;
+        }
+
+        std::unique_ptr<char[]> out(new char[*blockSize]);
+        size_t outLen;
+        Status status =
+            encryptionHooks->unprotectTmpData(reinterpret_cast<const uint8_t*>(_buffer.get()),
+                                              *blockSize,
+                                              reinterpret_cast<uint8_t*>(out.get()),
+                                              *blockSize,
+                                              &outLen,
+                                              _dbName);
+        uassert(28841,
+                str::stream() << "Failed to unprotect data: " << status.toString(),
+                status.isOK());
+        *blockSize = outLen;
+        _buffer.swap(out);
+    }
+
     /**
      * Attempts to read data from disk. Sets _done to true when file offset reaches _fileEndOffset.
      */
@@ -373,6 +456,10 @@ private:
     // to disk. This is not modified, and is only used for comparison against _afterReadChecksum
     // when the FileIterator is exhausted to ensure no data corruption.
     const uint32_t _originalChecksum;
+
+    // Version of the SorterSpillBlockHeader of the blocks in the range, or none for version 1
+    // blocks. Recorded in the range so that binaries unable to read the blocks refuse it.
+    const boost::optional<int32_t> _blockFormatVersion;
 };
 
 /**
@@ -578,8 +665,8 @@ protected:
                    "maxNumSpills"_attr = numTargetedSpills);
 
         while (iterators.size() > numTargetedSpills) {
-            std::shared_ptr<File> newSpillsFile =
-                std::make_shared<File>(this->_opts.tempDir + "/" + nextFileName());
+            std::shared_ptr<File> newSpillsFile = std::make_shared<File>(
+                this->_opts.tempDir + "/" + nextFileName(), this->_spillStats);
 
             LOGV2_DEBUG(6033103,
                         1,
@@ -670,7 +757,8 @@ public:
                                range.getEndOffset(),
                                this->_settings,
                                this->_opts.dbName,
-                               range.getChecksum());
+                               range.getChecksum(),
+                               range.getBlockFormatVersion());
                        });
         this->_numSpills = this->_iters.size();
     }
@@ -718,6 +806,10 @@ public:
         return Iterator::merge(this->_iters, this->_opts, this->_comp);
     }
 
+    size_t memUsed() const {
+        return _memUsed;
+    }
+
 private:
     class STLComparator {
     public:
@@ -811,6 +903,10 @@ public:
         }
     }
 
+    size_t memUsed() const {
+        return _haveData ? _best.first.memUsageForSorter() + _best.second.memUsageForSorter() : 0;
+    }
+
 private:
     void spill() {
         invariant(false, "LimitOneSorter does not spill to disk");
@@ -914,6 +1010,10 @@ public:
         return iterator;
     }
 
+    size_t memUsed() const {
+        return _memUsed;
+    }
+
 private:
     class STLComparator {
     public:
@@ -1074,14 +1174,15 @@ private:
 template <typename Key, typename Value>
 Sorter<Key, Value>::Sorter(const SortOptions& opts)
     : _opts(opts),
-      _file(opts.extSortAllowed
-                ? std::make_shared<Sorter<Key, Value>::File>(opts.tempDir + "/" + nextFileName())
-                : nullptr) {}
+      _file(opts.extSortAllowed ? std::make_shared<Sorter<Key, Value>::File>(
+                                      opts.tempDir + "/" + nextFileName(), _spillStats)
+                                : nullptr) {}
 
 template <typename Key, typename Value>
 Sorter<Key, Value>::Sorter(const SortOptions& opts, const std::string& fileName)
     : _opts(opts),
-      _file(std::make_shared<Sorter<Key, Value>::File>(opts.tempDir + "/" + fileName)) {
+      _file(std::make_shared<Sorter<Key, Value>::File>(opts.tempDir + "/" + fileName,
+                                                       _spillStats)) {
     invariant(opts.extSortAllowed);
     invariant(!opts.tempDir.empty());
     invariant(!fileName.empty());
@@ -1220,7 +1321,8 @@ SortedFileWriter<Key, Value>::SortedFileWriter(
     : _settings(settings),
       _file(std::move(file)),
       _fileStartOffset(_file->currentOffset()),
-      _dbName(opts.dbName) {
+      _dbName(opts.dbName),
+      _writeBlockHeaders(SorterSpillBlockHeader::canWrite()) {
     // This should be checked by consumers, but if we get here don't allow writes.
     uassert(
         16946, "Attempting to use external sort from mongos. This is not allowed.", !isMongos());
@@ -1257,12 +1359,26 @@ void SortedFileWriter<Key, Value>::spill() {
     if (size == 0)
         return;
 
+    SorterSpillBlockHeader header;
+    header.uncompressedSize = size;
+
+    const auto* codec = &SorterSpillCodec::getSelected();
+    if (!_writeBlockHeaders && codec->id() != SorterSpillCodec::Id::kNone) {
+        // Version 1 blocks can only be compressed with snappy.
+        codec = &SorterSpillCodec::get(SorterSpillCodec::Id::kSnappy);
+    }
+
     std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
-    verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+    if (codec->id() != SorterSpillCodec::Id::kNone) {
+        codec->compress(ConstDataRange(outBuffer, size), &compressed);
+        verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+    }
 
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
+    // Blocks which do not compress well are cheaper to store uncompressed than to decompress.
+    const bool shouldCompress = codec->id() != SorterSpillCodec::Id::kNone &&
+        compressed.size() < size_t(_buffer.len() / 10 * 9);
     if (shouldCompress) {
+        header.codec = codec->id();
         size = compressed.size();
         outBuffer = const_cast<char*>(compressed.data());
     }
@@ -1285,10 +1401,33 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
-    // Negative size means compressed.
-    size = shouldCompress ? -size : size;
-    _file->write(reinterpret_cast<const char*>(&size), sizeof(size));
-    _file->write(outBuffer, std::abs(size));
+    header.storedSize = size;
+
+    char headerBuffer[sizeof(SorterSpillBlockHeader::kMarker) +
+                      SorterSpillBlockHeader::kSerializedSize];
+    size_t headerSize = sizeof(headerBuffer);
+    if (_writeBlockHeaders) {
+        char* serializedHeader = headerBuffer + sizeof(SorterSpillBlockHeader::kMarker);
+        DataView(headerBuffer).write<int32_t>(SorterSpillBlockHeader::kMarker);
+        header.serialize(serializedHeader);
+        header.checksum = addDataToChecksum(
+            outBuffer,
+            size,
+            addDataToChecksum(serializedHeader, SorterSpillBlockHeader::kChecksumOffset, 0));
+        header.serialize(serializedHeader);
+    } else {
+        // A version 1 block is preceded by its size, negated when the block is compressed.
+        DataView(headerBuffer).write<int32_t>(shouldCompress ? -size : size);
+        headerSize = sizeof(int32_t);
+    }
+    _file->write(headerBuffer, headerSize);
+    _file->write(outBuffer, size);
+
+    const uint64_t bytesWritten = headerSize + size;
+    auto& stats = _file->spillStats();
+    stats.spilledDataSizeBytes += header.uncompressedSize;
+    stats.bytesWritten += bytesWritten;
+    recordSorterSpillWrite(header.uncompressedSize, bytesWritten);
 
     _buffer.reset();
 }
@@ -1297,8 +1436,16 @@ template <typename Key, typename Value>
 SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
     spill();
 
-    return new sorter::FileIterator<Key, Value>(
-        _file, _fileStartOffset, _file->currentOffset(), _settings, _dbName, _checksum);
+    const auto blockFormatVersion = _writeBlockHeaders
+        ? boost::make_optional<int32_t>(SorterSpillBlockHeader::kVersion)
+        : boost::none;
+    return new sorter::FileIterator<Key, Value>(_file,
+                                                _fileStartOffset,
+                                                _file->currentOffset(),
+                                                _settings,
+                                                _dbName,
+                                                _checksum,
+                                                blockFormatVersion);
 }
 
 //
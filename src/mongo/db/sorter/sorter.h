@@ -42,6 +42,7 @@
 
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/sorter/sorter_gen.h"
+#include "mongo/db/sorter/sorter_spill_format.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 
@@ -259,7 +260,13 @@ public:
      */
     class File {
     public:
-        File(std::string path) : _path(std::move(path)) {
+        /**
+         * 'stats' accumulates the volume of data spilled to and read from this file, and may be
+         * shared with other files spilled by the same sorter.
+         */
+        File(std::string path, std::shared_ptr<SorterSpillStats> stats = nullptr)
+            : _path(std::move(path)),
+              _stats(stats ? std::move(stats) : std::make_shared<SorterSpillStats>()) {
             invariant(!_path.empty());
         }
 
@@ -276,6 +283,10 @@ public:
             _keep = true;
         };
 
+        SorterSpillStats& spillStats() {
+            return *_stats;
+        }
+
         /**
          * Reads the requested data from the file. Cannot write more to the file once this has been
          * called.
@@ -300,6 +311,8 @@ public:
         boost::filesystem::path _path;
         std::fstream _file;
 
+        const std::shared_ptr<SorterSpillStats> _stats;
+
         // The current offset of the end of the file, or -1 if the file either has not yet been
         // opened or is already being read.
         std::streamoff _offset = -1;
@@ -350,18 +363,39 @@ public:
         return _totalDataSizeSorted;
     }
 
+    /**
+     * Returns the volume of data spilled to and read back from disk so far, across all the files
+     * of this sorter.
+     */
+    const SorterSpillStats& spillStats() const {
+        return *_spillStats;
+    }
+
+    /**
+     * Returns the approximate number of bytes held in memory by the data which has not been spilled
+     * yet.
+     */
+    virtual size_t memUsed() const = 0;
+
+    /**
+     * Writes the data held in memory out to disk, for callers which need to free memory before the
+     * sorter reaches its own limit. Requires that external sorting is allowed.
+     */
+    virtual void spill() = 0;
+
     PersistedState persistDataForShutdown();
 
 protected:
     Sorter() {}  // can only be constructed as a base
 
-    virtual void spill() = 0;
-
     size_t _numSorted = 0;              // Keeps track of the number of keys sorted.
     uint64_t _totalDataSizeSorted = 0;  // Keeps track of the total size of data sorted.
 
     SortOptions _opts;
 
+    // Shared by every file this sorter spills to, so must be initialized before '_file'.
+    std::shared_ptr<SorterSpillStats> _spillStats = std::make_shared<SorterSpillStats>();
+
     std::shared_ptr<File> _file;
 
     std::size_t _numSpills = 0;  // Keeps track of the number of spills that have happened.
@@ -531,6 +565,10 @@ private:
     std::streamoff _fileStartOffset;
 
     boost::optional<std::string> _dbName;
+
+    // Whether blocks are spilled with a SorterSpillBlockHeader or in the version 1 format. Decided
+    // once so that all blocks of the range have the same version.
+    const bool _writeBlockHeaders;
 };
 }  // namespace mongo
 
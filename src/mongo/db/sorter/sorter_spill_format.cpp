@@ -0,0 +1,247 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter_spill_format.h"
+
+#include <snappy.h>
+#include <zstd.h>
+
+#include "mongo/base/counter.h"
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/sorter/sorter_spill_format_gen.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+class NoopSpillCodec final : public SorterSpillCodec {
+public:
+    Id id() const final {
+        return Id::kNone;
+    }
+
+    StringData name() const final {
+        return "none"_sd;
+    }
+
+    void compress(ConstDataRange input, std::string* out) const final {
+        out->assign(input.data(), input.length());
+    }
+
+    void decompress(ConstDataRange input, DataRange output) const final {
+        uassert(6723000,
+                "Uncompressed sorter spill block does not have the expected length",
+                input.length() == output.length());
+        std::memcpy(const_cast<char*>(output.data()), input.data(), input.length());
+    }
+};
+
+class SnappySpillCodec final : public SorterSpillCodec {
+public:
+    Id id() const final {
+        return Id::kSnappy;
+    }
+
+    StringData name() const final {
+        return "snappy"_sd;
+    }
+
+    void compress(ConstDataRange input, std::string* out) const final {
+        out->clear();
+        snappy::Compress(input.data(), input.length(), out);
+    }
+
+    void decompress(ConstDataRange input, DataRange output) const final {
+        size_t uncompressedSize;
+        uassert(6723001,
+                "Sorter spill block compressed with snappy does not have the expected length",
+                snappy::GetUncompressedLength(input.data(), input.length(), &uncompressedSize) &&
+                    uncompressedSize == output.length());
+        uassert(6723002,
+                "Failed to decompress sorter spill block with snappy",
+                snappy::RawUncompress(
+                    input.data(), input.length(), const_cast<char*>(output.data())));
+    }
+};
+
+class ZstdSpillCodec final : public SorterSpillCodec {
+public:
+    Id id() const final {
+        return Id::kZstd;
+    }
+
+    StringData name() const final {
+        return "zstd"_sd;
+    }
+
+    void compress(ConstDataRange input, std::string* out) const final {
+        out->resize(ZSTD_compressBound(input.length()));
+        size_t ret = ZSTD_compress(
+            out->data(), out->size(), input.data(), input.length(), ZSTD_CLEVEL_DEFAULT);
+        uassert(6723003,
+                str::stream() << "Failed to compress sorter spill block with zstd: "
+                              << ZSTD_getErrorName(ret),
+                !ZSTD_isError(ret));
+        out->resize(ret);
+    }
+
+    void decompress(ConstDataRange input, DataRange output) const final {
+        size_t ret = ZSTD_decompress(
+            const_cast<char*>(output.data()), output.length(), input.data(), input.length());
+        uassert(6723004,
+                str::stream() << "Failed to decompress sorter spill block with zstd: "
+                              << ZSTD_getErrorName(ret),
+                !ZSTD_isError(ret));
+        uassert(6723005,
+                "Sorter spill block compressed with zstd does not have the expected length",
+                ret == output.length());
+    }
+};
+
+const NoopSpillCodec kNoopSpillCodec;
+const SnappySpillCodec kSnappySpillCodec;
+const ZstdSpillCodec kZstdSpillCodec;
+
+const SorterSpillCodec* const kSpillCodecs[] = {
+    &kNoopSpillCodec, &kSnappySpillCodec, &kZstdSpillCodec};
+
+const SorterSpillCodec* findSpillCodec(StringData name) {
+    for (auto codec : kSpillCodecs) {
+        if (codec->name() == name) {
+            return codec;
+        }
+    }
+    return nullptr;
+}
+
+Counter64 spilledDataSizeBytes;
+Counter64 spillBytesWritten;
+Counter64 spillBytesRead;
+Counter64 spillReadMicros;
+
+ServerStatusMetricField<Counter64> displaySpilledDataSizeBytes("sorter.spilledDataSizeBytes",
+                                                               &spilledDataSizeBytes);
+ServerStatusMetricField<Counter64> displaySpillBytesWritten("sorter.spillBytesWritten",
+                                                            &spillBytesWritten);
+ServerStatusMetricField<Counter64> displaySpillBytesRead("sorter.spillBytesRead",
+                                                         &spillBytesRead);
+ServerStatusMetricField<Counter64> displaySpillReadMicros("sorter.spillReadMicros",
+                                                          &spillReadMicros);
+
+}  // namespace
+
+const SorterSpillCodec& SorterSpillCodec::get(Id id) {
+    for (auto codec : kSpillCodecs) {
+        if (codec->id() == id) {
+            return *codec;
+        }
+    }
+    uasserted(6723006,
+              str::stream() << "Unknown sorter spill block codec: " << static_cast<int>(id));
+}
+
+const SorterSpillCodec& SorterSpillCodec::getSelected() {
+    auto codec = findSpillCodec(sorterSpillCompressor.get());
+    invariant(codec);
+    return *codec;
+}
+
+Status SorterSpillCodec::validateName(const std::string& name) {
+    if (!findSpillCodec(name)) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Unknown sorter spill compressor '" << name
+                              << "', expected one of 'none', 'snappy' or 'zstd'"};
+    }
+    return Status::OK();
+}
+
+void SorterSpillBlockHeader::serialize(char* out) const {
+    DataView view(out);
+    view.write<uint8_t>(version, 0);
+    view.write<uint8_t>(static_cast<uint8_t>(codec), 1);
+    view.write<LittleEndian<uint16_t>>(0, 2);
+    view.write<LittleEndian<uint32_t>>(storedSize, 4);
+    view.write<LittleEndian<uint32_t>>(uncompressedSize, 8);
+    view.write<LittleEndian<uint32_t>>(checksum, kChecksumOffset);
+}
+
+SorterSpillBlockHeader SorterSpillBlockHeader::parse(const char* in) {
+    ConstDataView view(in);
+
+    SorterSpillBlockHeader header;
+    header.version = view.read<uint8_t>(0);
+    uassert(6723007,
+            str::stream() << "Unsupported sorter spill block version: "
+                          << static_cast<int>(header.version),
+            header.version == kVersion);
+
+    // Throws for an unknown codec.
+    const auto codec = static_cast<SorterSpillCodec::Id>(view.read<uint8_t>(1));
+    header.codec = SorterSpillCodec::get(codec).id();
+    header.storedSize = view.read<LittleEndian<uint32_t>>(4);
+    header.uncompressedSize = view.read<LittleEndian<uint32_t>>(8);
+    uassert(6723013,
+            str::stream() << "Sorter spill block header has an invalid size, stored size: "
+                          << header.storedSize << ", uncompressed size: "
+                          << header.uncompressedSize,
+            header.storedSize <= kMaxBlockSize && header.uncompressedSize <= kMaxBlockSize);
+    header.checksum = view.read<LittleEndian<uint32_t>>(kChecksumOffset);
+    return header;
+}
+
+bool SorterSpillBlockHeader::canWrite() {
+    const auto& fcv = serverGlobalParams.featureCompatibility;
+    return fcv.isVersionInitialized() && feature_flags::gSorterSpillFormatV2.isEnabled(fcv);
+}
+
+SorterSpillStats& SorterSpillStats::operator+=(const SorterSpillStats& other) {
+    spilledDataSizeBytes += other.spilledDataSizeBytes;
+    bytesWritten += other.bytesWritten;
+    bytesRead += other.bytesRead;
+    readTime += other.readTime;
+    return *this;
+}
+
+void recordSorterSpillWrite(uint64_t dataSizeBytes, uint64_t bytesWritten) {
+    spilledDataSizeBytes.increment(dataSizeBytes);
+    spillBytesWritten.increment(bytesWritten);
+}
+
+void recordSorterSpillRead(uint64_t bytesRead, Microseconds readTime) {
+    spillBytesRead.increment(bytesRead);
+    spillReadMicros.increment(durationCount<Microseconds>(readTime));
+}
+
+}  // namespace mongo
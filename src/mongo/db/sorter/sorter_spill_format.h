@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "mongo/base/data_range.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/util/duration.h"
+
+namespace mongo {
+
+/**
+ * A compression algorithm for the blocks that sorters spill to disk. The id of the codec is stored
+ * in the header of every block, so a block is always read back with the codec that wrote it,
+ * whichever codec 'sorterSpillCompressor' selects by then.
+ */
+class SorterSpillCodec {
+public:
+    enum class Id : uint8_t { kNone = 0, kSnappy = 1, kZstd = 2 };
+
+    virtual ~SorterSpillCodec() = default;
+
+    virtual Id id() const = 0;
+
+    virtual StringData name() const = 0;
+
+    /**
+     * Replaces the contents of 'out' with the compressed form of 'input'.
+     */
+    virtual void compress(ConstDataRange input, std::string* out) const = 0;
+
+    /**
+     * Decompresses 'input' into 'output', whose length must be exactly that of the uncompressed
+     * data. Throws if 'input' is not a valid compressed block of that length.
+     */
+    virtual void decompress(ConstDataRange input, DataRange output) const = 0;
+
+    /**
+     * Returns the codec with the given id. Throws if there is none, as is the case for blocks
+     * written by a newer version.
+     */
+    static const SorterSpillCodec& get(Id id);
+
+    /**
+     * Returns the codec selected by the 'sorterSpillCompressor' server parameter.
+     */
+    static const SorterSpillCodec& getSelected();
+
+    static Status validateName(const std::string& name);
+};
+
+/**
+ * Header of a block in version 2 of the format of the files that sorters spill to disk.
+ *
+ * A version 1 block is a signed 32-bit size, negative when the block is compressed with snappy,
+ * followed by the block. A version 2 block starts with kMarker in place of that size, which no
+ * version 1 block can have, followed by the serialized header and then the block. Files spilled by
+ * an earlier version, such as those kept for resumable index builds, therefore remain readable.
+ */
+struct SorterSpillBlockHeader {
+    static constexpr int32_t kMarker = std::numeric_limits<int32_t>::min();
+    static constexpr uint8_t kVersion = 2;
+
+    // Size of the serialized header, which follows kMarker.
+    static constexpr size_t kSerializedSize = 16;
+
+    // Offset of the checksum in the serialized header. The checksum covers the bytes of the
+    // serialized header before it, so that corrupt sizes or codec are detected too.
+    static constexpr size_t kChecksumOffset = 12;
+
+    // Like the size of a version 1 block, the sizes of a block fit a signed 32-bit integer.
+    static constexpr uint32_t kMaxBlockSize = std::numeric_limits<int32_t>::max();
+
+    void serialize(char* out) const;
+
+    /**
+     * Throws if the header is of a version this one cannot read, names an unknown codec, or has a
+     * size larger than kMaxBlockSize.
+     */
+    static SorterSpillBlockHeader parse(const char* in);
+
+    /**
+     * Returns whether sorters may spill version 2 blocks, which binaries that only read version 1
+     * blocks fail on. Until the FCV enables 'featureFlagSorterSpillFormatV2', sorters spill version
+     * 1 blocks.
+     */
+    static bool canWrite();
+
+    uint8_t version = kVersion;
+    SorterSpillCodec::Id codec = SorterSpillCodec::Id::kNone;
+
+    // Size of the block on disk, after it has been compressed and encrypted.
+    uint32_t storedSize = 0;
+
+    // Size of the block once decrypted and decompressed.
+    uint32_t uncompressedSize = 0;
+
+    // Checksum of the serialized header up to kChecksumOffset followed by the block as stored on
+    // disk.
+    uint32_t checksum = 0;
+};
+
+/**
+ * Volume of the data that a sorter has spilled to disk and read back.
+ */
+struct SorterSpillStats {
+    SorterSpillStats& operator+=(const SorterSpillStats& other);
+
+    // Size of the spilled data before compression.
+    uint64_t spilledDataSizeBytes = 0;
+
+    // Number of bytes written to disk, including block headers.
+    uint64_t bytesWritten = 0;
+
+    uint64_t bytesRead = 0;
+    Microseconds readTime{0};
+};
+
+/**
+ * Adds to the process-wide spill metrics reported under 'metrics.sorter' in serverStatus.
+ */
+void recordSorterSpillWrite(uint64_t spilledDataSizeBytes, uint64_t bytesWritten);
+void recordSorterSpillRead(uint64_t bytesRead, Microseconds readTime);
+
+}  // namespace mongo
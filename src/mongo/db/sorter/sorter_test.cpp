@@ -39,10 +39,12 @@
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/logv2/log.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/death_test.h"
+#include "mongo/unittest/ensure_fcv.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 
@@ -902,6 +904,175 @@ TEST_F(SorterMakeFromExistingRangesTest, RoundTrip) {
     }
 }
 
+/**
+ * Writes 'numPairs' pairs with a SortedFileWriter compressing with 'codecName', reads them back and
+ * returns the spill stats of the file.
+ */
+SorterSpillStats spillAndReadBack(StringData codecName, int numPairs) {
+    RAIIServerParameterControllerForTest codecController("sorterSpillCompressor", codecName);
+
+    unittest::TempDir tempDir("sorterSpillFormatTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+    auto file = std::make_shared<IWSorter::File>(opts.tempDir + "/" + nextFileName());
+
+    // Repeated keys make the data compressible.
+    SortedFileWriter<IntWrapper, IntWrapper> writer(opts, file);
+    for (int i = 0; i < numPairs; i++) {
+        writer.addAlreadySorted(i / 16, i % 16);
+    }
+
+    std::unique_ptr<IWIterator> it(writer.done());
+    it->openSource();
+    for (int i = 0; i < numPairs; i++) {
+        ASSERT(it->more());
+        auto pair = it->next();
+        ASSERT_EQ(i / 16, pair.first);
+        ASSERT_EQ(i % 16, pair.second);
+    }
+    ASSERT_FALSE(it->more());
+    it->closeSource();
+    return file->spillStats();
+}
+
+TEST(SorterSpillFormatTest, RoundTripWithEachCodec) {
+    const int numPairs = 100 * 1000;
+    const uint64_t dataSize = numPairs * 2 * sizeof(int);
+
+    auto noneStats = spillAndReadBack("none", numPairs);
+    ASSERT_EQ(dataSize, noneStats.spilledDataSizeBytes);
+    ASSERT_GT(noneStats.bytesWritten, dataSize);
+    ASSERT_EQ(noneStats.bytesWritten, noneStats.bytesRead);
+
+    for (auto codecName : {"snappy"_sd, "zstd"_sd}) {
+        auto stats = spillAndReadBack(codecName, numPairs);
+        ASSERT_EQ(dataSize, stats.spilledDataSizeBytes) << codecName;
+        ASSERT_LT(stats.bytesWritten, noneStats.bytesWritten) << codecName;
+        ASSERT_EQ(stats.bytesWritten, stats.bytesRead) << codecName;
+    }
+}
+
+TEST(SorterSpillFormatTest, InvalidCodecName) {
+    ASSERT_OK(SorterSpillCodec::validateName("zstd"));
+    ASSERT_NOT_OK(SorterSpillCodec::validateName("lz4"));
+}
+
+TEST(SorterSpillFormatTest, ReadLegacyBlock) {
+    unittest::TempDir tempDir("sorterSpillFormatTests");
+    auto file = std::make_shared<IWSorter::File>(tempDir.path() + "/" + nextFileName());
+
+    // An uncompressed block in the format preceding SorterSpillBlockHeader.
+    BufBuilder block;
+    IntWrapper(1).serializeForSorter(block);
+    IntWrapper(-1).serializeForSorter(block);
+    const uint32_t checksum = addDataToChecksum(block.buf(), block.len(), 0);
+    const int32_t blockSize = block.len();
+    file->write(reinterpret_cast<const char*>(&blockSize), sizeof(blockSize));
+    file->write(block.buf(), block.len());
+
+    sorter::FileIterator<IntWrapper, IntWrapper> it(
+        file, 0, file->currentOffset(), {}, boost::none, checksum, boost::none);
+    ASSERT(it.more());
+    auto pair = it.next();
+    ASSERT_EQ(1, pair.first);
+    ASSERT_EQ(-1, pair.second);
+    ASSERT_FALSE(it.more());
+}
+
+TEST(SorterSpillFormatTest, WriteLegacyBlocksUntilFCVAllowsHeaders) {
+    unittest::TempDir tempDir("sorterSpillFormatTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+
+    // Spills a range, checks that it reads back, and returns it with the first 4 bytes of the file.
+    auto spillAndReadBack = [&]() {
+        auto file = std::make_shared<IWSorter::File>(opts.tempDir + "/" + nextFileName());
+        SortedFileWriter<IntWrapper, IntWrapper> writer(opts, file);
+        for (int i = 0; i < 1000; i++) {
+            writer.addAlreadySorted(i, -i);
+        }
+        std::unique_ptr<IWIterator> it(writer.done());
+        for (int i = 0; i < 1000; i++) {
+            ASSERT(it->more());
+            ASSERT_EQ(i, it->next().first);
+        }
+        ASSERT_FALSE(it->more());
+
+        int32_t firstInt;
+        std::ifstream ifs(file->path().string(), std::ios::binary);
+        ifs.read(reinterpret_cast<char*>(&firstInt), sizeof(firstInt));
+        return std::make_pair(it->getRange(), firstInt);
+    };
+
+    {
+        unittest::EnsureFCV ensureFCV(multiversion::GenericFCV::kLastLTS);
+        auto [range, firstInt] = spillAndReadBack();
+        ASSERT_NE(SorterSpillBlockHeader::kMarker, firstInt);
+        ASSERT_FALSE(range.getBlockFormatVersion());
+    }
+
+    auto [range, firstInt] = spillAndReadBack();
+    ASSERT_EQ(SorterSpillBlockHeader::kMarker, firstInt);
+    ASSERT(range.getBlockFormatVersion());
+    ASSERT_EQ(SorterSpillBlockHeader::kVersion, *range.getBlockFormatVersion());
+}
+
+TEST(SorterSpillFormatTest, CorruptedBlock) {
+    unittest::TempDir tempDir("sorterSpillFormatTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+    auto file = std::make_shared<IWSorter::File>(opts.tempDir + "/" + nextFileName());
+
+    SortedFileWriter<IntWrapper, IntWrapper> writer(opts, file);
+    for (int i = 0; i < 1000; i++) {
+        writer.addAlreadySorted(i, -i);
+    }
+    std::unique_ptr<IWIterator> it(writer.done());
+
+    // Flip the last byte of the block.
+    {
+        std::fstream fs(file->path().string(), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekg(-1, std::ios::end);
+        char lastByte = fs.get();
+        fs.seekp(-1, std::ios::end);
+        fs.put(~lastByte);
+    }
+
+    ASSERT_THROWS_CODE(it->more(), DBException, ErrorCodes::ChecksumMismatch);
+}
+
+TEST(SorterSpillFormatTest, CorruptedBlockHeader) {
+    unittest::TempDir tempDir("sorterSpillFormatTests");
+    const SortOptions opts = SortOptions().TempDir(tempDir.path());
+
+    // Overwrites 'size' bytes of the header of the only block in a fresh spill file, which starts
+    // after the marker, and returns an iterator over that block.
+    auto corruptHeader = [&](size_t offset, const char* bytes, size_t size) {
+        auto file = std::make_shared<IWSorter::File>(opts.tempDir + "/" + nextFileName());
+        SortedFileWriter<IntWrapper, IntWrapper> writer(opts, file);
+        for (int i = 0; i < 1000; i++) {
+            writer.addAlreadySorted(i, -i);
+        }
+        std::unique_ptr<IWIterator> it(writer.done());
+
+        std::fstream fs(file->path().string(), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(sizeof(SorterSpillBlockHeader::kMarker) + offset);
+        fs.write(bytes, size);
+        return it;
+    };
+
+    // An unknown codec is rejected when parsing the header.
+    const char codec = 0x7f;
+    ASSERT_THROWS_CODE(corruptHeader(1, &codec, 1)->more(), DBException, 6723006);
+
+    // A stored size past the end of the range is rejected before anything is allocated.
+    const char storedSize[] = {'\xff', '\xff', '\xff', '\x7f'};
+    ASSERT_THROWS_CODE(corruptHeader(4, storedSize, 4)->more(), DBException, 6723011);
+
+    // Any other change to the header is caught by the checksum.
+    const char uncompressedSize[] = {'\x01', '\x00', '\x00', '\x00'};
+    ASSERT_THROWS_CODE(corruptHeader(8, uncompressedSize, 4)->more(),
+                       DBException,
+                       ErrorCodes::ChecksumMismatch);
+}
+
 class BoundedSorterTest : public unittest::Test {
 public:
     using Key = int;
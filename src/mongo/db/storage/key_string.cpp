@@ -37,6 +37,7 @@
 #include <type_traits>
 
 #include "mongo/base/data_cursor.h"
+#include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_depth.h"
 #include "mongo/db/exec/sbe/values/value_builder.h"
@@ -243,10 +244,24 @@ const uint8_t kGreater = 254;
 // some utility functions
 namespace {
 
+/**
+ * Copies 'bytes' bytes from 'src' to 'dst', flipping every bit. 'dst' may be equal to 'src' to flip
+ * the bits in place.
+ */
 void memcpy_flipBits(void* dst, const void* src, size_t bytes) {
     const char* input = static_cast<const char*>(src);
     char* output = static_cast<char*>(dst);
     const char* const end = input + bytes;
+
+    // Flip a word at a time, which the compiler is free to vectorize, then the remaining bytes.
+    while (static_cast<size_t>(end - input) >= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, input, sizeof(word));
+        word = ~word;
+        std::memcpy(output, &word, sizeof(word));
+        input += sizeof(word);
+        output += sizeof(word);
+    }
     while (input != end) {
         *output++ = ~(*input++);
     }
@@ -298,10 +313,8 @@ string readInvertedCString(BufReader* reader) {
     const char* end = static_cast<const char*>(memchr(start, 0xFF, reader->remaining()));
     keyStringAssert(50817, "Failed to find '0xFF' in inverted string.", end);
     size_t actualBytes = end - start;
-    string s(start, actualBytes);
-    for (size_t i = 0; i < s.size(); i++) {
-        s[i] = ~s[i];
-    }
+    string s(actualBytes, '\0');
+    memcpy_flipBits(&s[0], start, actualBytes);
     reader->skip(1 + actualBytes);
     return s;
 }
@@ -328,10 +341,7 @@ string readInvertedCStringWithNuls(BufReader* reader) {
         reader->skip(1 + actualBytes);
     } while (reader->peek<unsigned char>() == 0x00);
 
-    for (size_t i = 0; i < out.size(); i++) {
-        out[i] = ~out[i];
-    }
-
+    memcpy_flipBits(&out[0], out.data(), out.size());
     return out;
 }
 }  // namespace
@@ -681,8 +691,7 @@ void BuilderBase<BufferT>::_appendTimestamp(Timestamp val, bool invert) {
 
 template <class BufferT>
 void BuilderBase<BufferT>::_appendOID(OID val, bool invert) {
-    _append(CType::kOID, invert);
-    _appendBytes(val.view().view(), OID::kOIDSize, invert);
+    _appendCTypeAndBytes(CType::kOID, invert, val.view().view(), OID::kOIDSize, invert);
 }
 
 template <class BufferT>
@@ -1128,6 +1137,19 @@ void BuilderBase<BufferT>::_appendBsonValue(const BSONElement& elem,
 
 template <class BufferT>
 void BuilderBase<BufferT>::_appendStringLike(StringData str, bool invert) {
+    if (str.empty() || !memchr(str.rawData(), 0, str.size())) {
+        // Most strings have no NUL bytes to escape, so append them and their terminator with a
+        // single reservation.
+        char* const base = _buffer().skip(str.size() + 1);
+        if (invert) {
+            memcpy_flipBits(base, str.rawData(), str.size());
+        } else {
+            memcpy(base, str.rawData(), str.size());
+        }
+        base[str.size()] = invert ? char(0xFF) : char(0);
+        return;
+    }
+
     while (true) {
         size_t firstNul = strnlen(str.rawData(), str.size());
         // No NULs in string.
@@ -1337,11 +1359,17 @@ void BuilderBase<BufferT>::_appendPreshiftedIntegerPortion(uint64_t value,
     const void* firstUsedByte = reinterpret_cast<const char*>((&value) + 1) - bytesNeeded;
 
     if (isNegative) {
-        _append(uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, !invert);
+        _appendCTypeAndBytes(uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1)),
+                             invert,
+                             firstUsedByte,
+                             bytesNeeded,
+                             !invert);
     } else {
-        _append(uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, invert);
+        _appendCTypeAndBytes(uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1)),
+                             invert,
+                             firstUsedByte,
+                             bytesNeeded,
+                             invert);
     }
 }
 
@@ -1357,6 +1385,19 @@ void BuilderBase<BufferT>::_appendBytes(const void* source, size_t bytes, bool i
     }
 }
 
+template <class BufferT>
+void BuilderBase<BufferT>::_appendCTypeAndBytes(
+    uint8_t ctype, bool invertCType, const void* source, size_t bytes, bool invertBytes) {
+    char* const base = _buffer().skip(1 + bytes);
+
+    base[0] = invertCType ? ~ctype : ctype;
+    if (invertBytes) {
+        memcpy_flipBits(base + 1, source, bytes);
+    } else {
+        memcpy(base + 1, source, bytes);
+    }
+}
+
 
 // ----------------------------------------------------------------------
 // ----------- DECODING CODE --------------------------------------------
@@ -2483,6 +2524,25 @@ uint8_t TypeBits::Reader::readBit() {
     return (_typeBits.getDataBuffer()[byte] & (1 << offsetInByte)) ? 1 : 0;
 }
 
+uint8_t TypeBits::Reader::readTwoBits() {
+    if (_typeBits._isAllZeros)
+        return 0;
+
+    const uint32_t byte = _curBit / 8;
+    const uint8_t offsetInByte = _curBit % 8;
+    if (offsetInByte == 7) {
+        // The two bits straddle a byte boundary.
+        uint8_t highBit = readBit();
+        return (highBit << 1) | readBit();
+    }
+    _curBit += 2;
+
+    keyStringAssert(6724000, "Invalid size byte(s).", byte < _typeBits.getDataBufferLen());
+
+    const uint8_t bits = _typeBits.getDataBuffer()[byte] >> offsetInByte;
+    return ((bits & 1) << 1) | ((bits >> 1) & 1);
+}
+
 uint8_t TypeBits::Reader::readZero() {
     uint8_t res = readNumeric();
 
@@ -2596,6 +2656,27 @@ BSONObj toBson(StringData data, Ordering ord, const TypeBits& typeBits) {
     return toBson(data.rawData(), data.size(), ord, typeBits);
 }
 
+std::vector<BSONObj> toBsonBatch(const Value* keys, size_t numKeys, Ordering ord) {
+    std::vector<int> offsets;
+    offsets.reserve(numKeys);
+
+    BufBuilder buffer;
+    for (size_t i = 0; i < numKeys; ++i) {
+        offsets.push_back(buffer.len());
+        BSONObjBuilder builder(buffer);
+        toBsonSafe(keys[i].getBuffer(), keys[i].getSize(), ord, keys[i].getTypeBits(), builder);
+        builder.doneFast();
+    }
+
+    ConstSharedBuffer sharedBuffer(buffer.release());
+    std::vector<BSONObj> objs;
+    objs.reserve(numKeys);
+    for (auto offset : offsets) {
+        objs.push_back(BSONObj(sharedBuffer.get() + offset).shareOwnershipWith(sharedBuffer));
+    }
+    return objs;
+}
+
 RecordId decodeRecordIdLongAtEnd(const void* bufferRaw, size_t bufSize) {
     const unsigned char* buffer = static_cast<const unsigned char*>(bufferRaw);
     invariant(bufSize >= 2);  // smallest possible encoding of a RecordId.
@@ -2697,6 +2778,28 @@ RecordId decodeRecordIdStrAtEnd(const void* bufferRaw, size_t bufSize) {
                     ridSize);
 }
 
+size_t commonPrefixSize(const char* leftBuf,
+                        const char* rightBuf,
+                        size_t leftSize,
+                        size_t rightSize) {
+    const size_t minSize = std::min(leftSize, rightSize);
+    size_t size = 0;
+
+    // Compare a word at a time. Read big-endian, the first differing byte is the most significant
+    // differing one.
+    for (; size + sizeof(uint64_t) <= minSize; size += sizeof(uint64_t)) {
+        const uint64_t left = ConstDataView(leftBuf + size).read<BigEndian<uint64_t>>();
+        const uint64_t right = ConstDataView(rightBuf + size).read<BigEndian<uint64_t>>();
+        if (left != right) {
+            return size + countLeadingZeros64(left ^ right) / 8;
+        }
+    }
+    while (size < minSize && leftBuf[size] == rightBuf[size]) {
+        ++size;
+    }
+    return size;
+}
+
 int compare(const char* leftBuf, const char* rightBuf, size_t leftSize, size_t rightSize) {
     // memcmp has undefined behavior if either leftBuf or rightBuf is a null pointer.
     if (MONGO_unlikely(leftSize == 0))
@@ -247,8 +247,7 @@ public:
             return readBit();
         }
         uint8_t readNumeric() {
-            uint8_t highBit = readBit();
-            return (highBit << 1) | readBit();
+            return readTwoBits();
         }
         uint8_t readZero();
 
@@ -262,6 +261,9 @@ public:
     private:
         uint8_t readBit();
 
+        // Reads two bits, the first being the high bit of the result.
+        uint8_t readTwoBits();
+
         uint32_t _curBit;
         const TypeBits& _typeBits;
     };
@@ -612,6 +614,21 @@ public:
         memcpy(_buffer().skip(size), buffer, size);
     }
 
+    /**
+     * Like resetFromBuffer(), but only copies what follows the first 'sharedPrefixSize' bytes of
+     * 'buffer', which must be equal to those already held.
+     */
+    void resetFromBufferWithSharedPrefix(const void* buffer,
+                                         size_t size,
+                                         size_t sharedPrefixSize) {
+        dassert(sharedPrefixSize <= std::min(size, getSize()));
+        dassert(memcmp(getBuffer(), buffer, sharedPrefixSize) == 0);
+        _buffer().setlen(sharedPrefixSize);
+        memcpy(_buffer().skip(size - sharedPrefixSize),
+               static_cast<const char*>(buffer) + sharedPrefixSize,
+               size - sharedPrefixSize);
+    }
+
     const char* getBuffer() const {
         invariant(_state != BuildState::kReleased);
         return _buffer().buf();
@@ -716,6 +733,12 @@ protected:
 
     void _appendBytes(const void* source, size_t bytes, bool invert);
 
+    /**
+     * Appends 'ctype' followed by 'bytes' bytes of 'source', reserving space for both at once.
+     */
+    void _appendCTypeAndBytes(
+        uint8_t ctype, bool invertCType, const void* source, size_t bytes, bool invertBytes);
+
     void _doneAppending() {
         if (_state == BuildState::kAppendingBSONElements) {
             appendDiscriminator(_discriminator);
@@ -981,6 +1004,13 @@ BSONObj toBson(const char* buffer, size_t len, Ordering ord, const TypeBits& typ
 BSONObj toBsonSafe(const char* buffer, size_t len, Ordering ord, const TypeBits& types);
 void toBsonSafe(
     const char* buffer, size_t len, Ordering ord, const TypeBits& types, BSONObjBuilder& builder);
+
+/**
+ * Decodes each of the 'numKeys' KeyStrings starting at 'keys' as toBson() does. The returned
+ * objects share a single buffer, rather than each allocating its own, which makes decoding many
+ * small keys at once considerably cheaper.
+ */
+std::vector<BSONObj> toBsonBatch(const Value* keys, size_t numKeys, Ordering ord);
 Discriminator decodeDiscriminator(const char* buffer,
                                   size_t len,
                                   Ordering ord,
@@ -1021,6 +1051,14 @@ RecordId decodeRecordIdLong(BufReader* reader);
 
 int compare(const char* leftBuf, const char* rightBuf, size_t leftSize, size_t rightSize);
 
+/**
+ * Returns the number of leading bytes that the two buffers have in common.
+ */
+size_t commonPrefixSize(const char* leftBuf,
+                        const char* rightBuf,
+                        size_t leftSize,
+                        size_t rightSize);
+
 /**
  * Read one KeyString component from the given 'reader' and 'typeBits' inputs and stream it to the
  * 'valueBuilder' object, which converts it to a "Slot-Based Execution" (SBE) representation. When
@@ -65,6 +65,7 @@ enum BsonValueType {
     STRING,
     ARRAY,
     DECIMAL,
+    COMPOUND,
 };
 
 BSONObj generateBson(BsonValueType bsonValueType) {
@@ -92,6 +93,10 @@ BSONObj generateBson(BsonValueType bsonValueType) {
                                          Decimal128::kRoundTo34Digits,
                                          Decimal128::kRoundTiesToAway)
                                   .quantize(Decimal128("0.01", Decimal128::kRoundTiesToAway)));
+        case COMPOUND:
+            // The shape of a typical compound index on numeric fields and an ObjectId.
+            return BSON("" << static_cast<int>(expReal(gen)) << ""
+                           << static_cast<long long>(expReal(gen)) << "" << OID::gen());
     }
     MONGO_UNREACHABLE;
 }
@@ -152,6 +157,62 @@ void BM_KeyStringToBSON(benchmark::State& state,
     state.SetItemsProcessed(state.iterations() * kSampleSize);
 }
 
+void BM_BSONToKeyStringDescending(benchmark::State& state,
+                                  const KeyString::Version version,
+                                  BsonValueType bsonType) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+    const Ordering allDescending = Ordering::make(BSON("a" << -1 << "b" << -1 << "c" << -1));
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        for (auto bson : bsonsAndKeyStrings.bsons) {
+            benchmark::DoNotOptimize(KeyString::Builder(version, bson, allDescending));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.bsonSize);
+    state.SetItemsProcessed(state.iterations() * kSampleSize);
+}
+
+void BM_KeyStringToBSONBatch(benchmark::State& state,
+                             const KeyString::Version version,
+                             BsonValueType bsonType) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+
+    std::vector<KeyString::Value> values;
+    for (size_t i = 0; i < kSampleSize; i++) {
+        KeyString::HeapBuilder builder(version, bsonsAndKeyStrings.bsons[i], ALL_ASCENDING);
+        values.emplace_back(builder.release());
+    }
+
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        benchmark::DoNotOptimize(
+            KeyString::toBsonBatch(values.data(), values.size(), ALL_ASCENDING));
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.bsonSize);
+    state.SetItemsProcessed(state.iterations() * kSampleSize);
+}
+
+void BM_KeyStringValueCompare(benchmark::State& state, BsonValueType bsonType) {
+    // The KeyString version does not matter for this test.
+    const auto version = KeyString::Version::V1;
+    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+
+    std::vector<KeyString::Value> values;
+    for (size_t i = 0; i < kSampleSize; i++) {
+        KeyString::HeapBuilder builder(version, bsonsAndKeyStrings.bsons[i], ALL_ASCENDING);
+        values.emplace_back(builder.release());
+    }
+
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        for (size_t i = 1; i < kSampleSize; i++) {
+            benchmark::DoNotOptimize(values[i - 1].compare(values[i]));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.keystringSize);
+    state.SetItemsProcessed(state.iterations() * (kSampleSize - 1));
+}
+
 void BM_KeyStringValueAssign(benchmark::State& state, BsonValueType bsonType) {
     // The KeyString version does not matter for this test.
     const auto version = KeyString::Version::V1;
@@ -254,6 +315,11 @@ BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_Int, KeyString::Version::V1, INT);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_String, KeyString::Version::V1, STRING);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_Compound, KeyString::Version::V1, COMPOUND);
 
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Int, KeyString::Version::V0, INT);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Int, KeyString::Version::V1, INT);
@@ -264,6 +330,15 @@ BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(BM_KeyStringToBSONBatch, V1_Int, KeyString::Version::V1, INT);
+BENCHMARK_CAPTURE(BM_KeyStringToBSONBatch, V1_String, KeyString::Version::V1, STRING);
+BENCHMARK_CAPTURE(BM_KeyStringToBSONBatch, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(BM_KeyStringValueCompare, Int, INT);
+BENCHMARK_CAPTURE(BM_KeyStringValueCompare, String, STRING);
+BENCHMARK_CAPTURE(BM_KeyStringValueCompare, Compound, COMPOUND);
 
 BENCHMARK_CAPTURE(BM_KeyStringRecordIdStrAppend, 16B, 16);
 BENCHMARK_CAPTURE(BM_KeyStringRecordIdStrAppend, 512B, 512);
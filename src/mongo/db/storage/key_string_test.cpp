@@ -364,6 +364,70 @@ TEST_F(KeyStringBuilderTest, DeprecatedBinData) {
     ROUNDTRIP(version, BSON("" << BSONBinData(nullptr, 0, ByteArrayDeprecated)));
 }
 
+TEST_F(KeyStringBuilderTest, StringsAcrossWordBoundaries) {
+    // Long enough to be flipped a word at a time when inverted, with NULs to escape at and around
+    // word boundaries.
+    for (size_t len : {7, 8, 9, 16, 17, 33}) {
+        std::string str(len, 'x');
+        ROUNDTRIP(version, BSON("" << str));
+        for (size_t nulPos : {size_t(0), len / 2, len - 1}) {
+            std::string withNul = str;
+            withNul[nulPos] = '\0';
+            ROUNDTRIP(version, BSON("" << withNul));
+        }
+    }
+}
+
+TEST_F(KeyStringBuilderTest, ToBsonBatch) {
+    const std::vector<BSONObj> objs = {BSON("" << 5 << "" << OID()),
+                                       BSON("" << std::string("abc\0def", 7) << "" << 2.5),
+                                       BSON("" << -12345678901LL << "" << BSONNULL),
+                                       BSON("" << BSON("a" << 1) << "" << true)};
+
+    for (auto ord : {ALL_ASCENDING, ONE_DESCENDING}) {
+        std::vector<KeyString::Value> keys;
+        for (const auto& obj : objs) {
+            keys.push_back(KeyString::HeapBuilder(version, obj, ord).release());
+        }
+
+        auto decoded = KeyString::toBsonBatch(keys.data(), keys.size(), ord);
+        ASSERT_EQ(objs.size(), decoded.size());
+        for (size_t i = 0; i < objs.size(); i++) {
+            ASSERT(decoded[i].binaryEqual(objs[i])) << decoded[i] << " " << objs[i];
+            ASSERT(decoded[i].isOwned());
+        }
+    }
+}
+
+TEST_F(KeyStringBuilderTest, CommonPrefixSize) {
+    const std::string base(40, 'a');
+    ASSERT_EQ(0U, KeyString::commonPrefixSize(base.data(), base.data(), 0, 0));
+    ASSERT_EQ(40U, KeyString::commonPrefixSize(base.data(), base.data(), 40, 40));
+    ASSERT_EQ(17U, KeyString::commonPrefixSize(base.data(), base.data(), 17, 40));
+
+    // Differences within and after the word compared first.
+    for (size_t pos : {0, 3, 7, 8, 15, 16, 39}) {
+        std::string other = base;
+        other[pos] = 'b';
+        ASSERT_EQ(pos, KeyString::commonPrefixSize(base.data(), other.data(), 40, 40));
+        ASSERT_EQ(pos, KeyString::commonPrefixSize(other.data(), base.data(), 40, 40));
+    }
+}
+
+TEST_F(KeyStringBuilderTest, ResetFromBufferWithSharedPrefix) {
+    KeyString::Builder key(version, BSON("" << "tenant" << "" << 1), ALL_ASCENDING, RecordId(1));
+    const KeyString::Builder next(
+        version, BSON("" << "tenant" << "" << 2), ALL_ASCENDING, RecordId(200));
+
+    const size_t sharedPrefixSize = KeyString::commonPrefixSize(
+        key.getBuffer(), next.getBuffer(), key.getSize(), next.getSize());
+    ASSERT_GT(sharedPrefixSize, 0U);
+
+    key.resetFromBufferWithSharedPrefix(next.getBuffer(), next.getSize(), sharedPrefixSize);
+    ASSERT_EQ(next.getSize(), key.getSize());
+    ASSERT_EQ(0, memcmp(next.getBuffer(), key.getBuffer(), next.getSize()));
+}
+
 TEST_F(KeyStringBuilderTest, ActualBytesDouble) {
     // just one test like this for utter sanity
 
@@ -196,6 +196,19 @@ public:
      */
     virtual boost::optional<Record> seekNear(const RecordId& start) = 0;
 
+    /**
+     * Hints that the records with the given ids are about to be read with seekExact(), in order.
+     * Storage engines may start loading the records in the background so that the subsequent
+     * seeks do not each wait for a separate disk read. Does not change the position of this
+     * cursor or the results of any later call.
+     *
+     * Returns the number of records the storage engine has started loading. The default
+     * implementation ignores the hint.
+     */
+    virtual size_t prefetch(const std::vector<RecordId>& ids) {
+        return 0;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
@@ -0,0 +1,705 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_column_store.h"
+
+#include "mongo/base/data_view.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/catalog/validate_results.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/global_settings.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/stats/resource_consumption_metrics.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_cursor.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_cursor_helpers.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_prepare_conflict.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/endian.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/fail_point.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+MONGO_FAIL_POINT_DEFINE(WTCompactColumnStoreEBUSY);
+
+// Only one on-disk format exists so far. Bump kMaximumColumnStoreVersion when the key or cell
+// encoding changes in a way older binaries cannot read.
+const int kColumnStoreVersionV1 = 1;
+const int kMinimumColumnStoreVersion = kColumnStoreVersionV1;
+const int kMaximumColumnStoreVersion = kColumnStoreVersionV1;
+
+// Flipping the sign bit of a big-endian int64 makes unsigned byte-wise comparison agree with
+// signed integer comparison.
+const uint64_t kRecordIdSignBit = 1ull << 63;
+const size_t kRecordIdSize = sizeof(int64_t);
+
+}  // namespace
+
+// static
+std::string& WiredTigerColumnStore::makeKey(std::string& buffer, PathView path, RecordId rid) {
+    dassert(path.find('\0') == std::string::npos);
+    buffer.clear();
+    buffer.reserve(path.size() + 1 + kRecordIdSize);
+    buffer.append(path.rawData(), path.size());
+    buffer += '\0';
+    if (rid.isNull()) {
+        // The bare path followed by its terminator sorts before every cell for this path.
+        return buffer;
+    }
+
+    invariant(rid.isLong(), "column stores only support integer RecordIds");
+    const uint64_t encoded = endian::nativeToBig(static_cast<uint64_t>(rid.getLong()) ^
+                                                 kRecordIdSignBit);
+    buffer.append(reinterpret_cast<const char*>(&encoded), sizeof(encoded));
+    return buffer;
+}
+
+// static
+FullCellView WiredTigerColumnStore::decodeKey(StringData key, CellView value) {
+    const auto nullByte = key.find('\0');
+    invariant(nullByte != std::string::npos && key.size() == nullByte + 1 + kRecordIdSize,
+              str::stream() << "Malformed column store key: "
+                            << hexblob::encode(key.rawData(), key.size()));
+
+    const uint64_t encoded =
+        endian::bigToNative(ConstDataView(key.rawData() + nullByte + 1).read<uint64_t>());
+    const auto rid = RecordId(static_cast<int64_t>(encoded ^ kRecordIdSignBit));
+    return FullCellView{key.substr(0, nullByte), rid, value};
+}
+
+// static
+StatusWith<std::string> WiredTigerColumnStore::generateCreateString(
+    const std::string& engineName,
+    const std::string& sysIndexConfig,
+    const std::string& collIndexConfig,
+    const NamespaceString& collectionNamespace,
+    const IndexDescriptor& desc) {
+    str::stream ss;
+
+    // Cells for the same path share a long key prefix and are usually small, so prefix
+    // compression is always worthwhile here regardless of the index-wide setting.
+    ss << "type=file,internal_page_max=16k,leaf_page_max=16k,";
+    ss << "checksum=on,";
+    ss << "prefix_compression=true,";
+
+    ss << WiredTigerCustomizationHooks::get(getGlobalServiceContext())
+              ->getTableCreateConfig(collectionNamespace.ns());
+    ss << sysIndexConfig << ",";
+    ss << collIndexConfig << ",";
+
+    BSONElement storageEngineElement = desc.infoObj()["storageEngine"];
+    if (storageEngineElement.isABSONObj()) {
+        BSONObj storageEngine = storageEngineElement.Obj();
+        StatusWith<std::string> parseStatus =
+            WiredTigerIndex::parseIndexOptions(storageEngine.getObjectField(engineName));
+        if (!parseStatus.isOK()) {
+            return parseStatus;
+        }
+        if (!parseStatus.getValue().empty()) {
+            ss << "," << parseStatus.getValue();
+        }
+    }
+
+    // WARNING: No user-specified config can appear below this line. These options are required
+    // for correct behavior of the server.
+
+    ss << ",key_format=u";
+    ss << ",value_format=u";
+    ss << ",app_metadata=(formatVersion=" << kColumnStoreVersionV1 << "),";
+
+    bool replicatedWrites = getGlobalReplSettings().usingReplSets() ||
+        repl::ReplSettings::shouldRecoverFromOplogAsStandalone();
+    if (WiredTigerUtil::useTableLogging(collectionNamespace, replicatedWrites)) {
+        ss << "log=(enabled=true)";
+    } else {
+        ss << "log=(enabled=false)";
+    }
+
+    LOGV2_DEBUG(6701000, 3, "column store create string", "str"_attr = ss.ss.str());
+    return StatusWith<std::string>(ss);
+}
+
+// static
+Status WiredTigerColumnStore::create(OperationContext* opCtx,
+                                     const std::string& uri,
+                                     const std::string& config) {
+    // Don't use the session from the recovery unit: create should not be used in a transaction
+    WiredTigerSession session(WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->conn());
+    WT_SESSION* s = session.getSession();
+    LOGV2_DEBUG(6701001, 1, "create column store", "uri"_attr = uri, "config"_attr = config);
+    return wtRCToStatus(s->create(s, uri.c_str(), config.c_str()), s);
+}
+
+WiredTigerColumnStore::WiredTigerColumnStore(OperationContext* ctx,
+                                             const std::string& uri,
+                                             StringData ident,
+                                             const IndexDescriptor* desc,
+                                             bool isReadOnly)
+    : ColumnStore(ident),
+      _uri(uri),
+      _tableId(WiredTigerSession::genTableId()),
+      _desc(desc),
+      _indexName(desc->indexName()) {
+    auto version = WiredTigerUtil::checkApplicationMetadataFormatVersion(
+        ctx, uri, kMinimumColumnStoreVersion, kMaximumColumnStoreVersion);
+    if (!version.isOK()) {
+        fassertFailedWithStatus(
+            6701002,
+            Status(ErrorCodes::UnsupportedFormat,
+                   str::stream() << version.getStatus().reason()
+                                 << " Column store: {name: " << _indexName
+                                 << "} - version either too old or too new for this mongod."));
+    }
+
+    if (!isReadOnly) {
+        bool replicatedWrites = getGlobalReplSettings().usingReplSets() ||
+            repl::ReplSettings::shouldRecoverFromOplogAsStandalone();
+        bool useTableLogging = !replicatedWrites ||
+            WiredTigerUtil::useTableLogging(desc->getEntry()->getNSSFromCatalog(ctx),
+                                            replicatedWrites);
+        uassertStatusOK(WiredTigerUtil::setTableLogging(ctx, uri, useTableLogging));
+    }
+}
+
+class WiredTigerColumnStore::WriteCursor final : public ColumnStore::WriteCursor {
+public:
+    WriteCursor(OperationContext* opCtx, const std::string& uri, uint64_t tableId)
+        : _opCtx(opCtx), _curwrap(uri, tableId, false, opCtx) {
+        _curwrap.assertInActiveTxn();
+    }
+
+    void insert(PathView path, RecordId rid, CellView cell) override {
+        WT_CURSOR* c = setKey(path, rid);
+        WiredTigerItem valueItem(cell.rawData(), cell.size());
+        c->set_value(c, valueItem.Get());
+
+        // Every (path, RecordId) pair is written at most once, so a duplicate is a bug in the
+        // caller rather than a user error.
+        invariantWTOK(wiredTigerCursorInsert(_opCtx, c), c->session);
+
+        auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+        metricsCollector.incrementOneIdxEntryWritten(_buffer.size());
+    }
+
+    void remove(PathView path, RecordId rid) override {
+        WT_CURSOR* c = setKey(path, rid);
+        int ret = wiredTigerCursorRemove(_opCtx, c);
+        if (ret == WT_NOTFOUND) {
+            // Removing a cell that is already gone is harmless, as with index keys.
+            return;
+        }
+        invariantWTOK(ret, c->session);
+    }
+
+    void update(PathView path, RecordId rid, CellView cell) override {
+        WT_CURSOR* c = setKey(path, rid);
+        WiredTigerItem valueItem(cell.rawData(), cell.size());
+        c->set_value(c, valueItem.Get());
+        invariantWTOK(wiredTigerCursorUpdate(_opCtx, c), c->session);
+
+        auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+        metricsCollector.incrementOneIdxEntryWritten(_buffer.size());
+    }
+
+private:
+    WT_CURSOR* setKey(PathView path, RecordId rid) {
+        WT_CURSOR* c = _curwrap.get();
+        makeKey(_buffer, path, rid);
+        // WT only copies the key into its own buffer when the operation runs, so '_buffer' must
+        // outlive the call that consumes it.
+        WiredTigerItem keyItem(_buffer);
+        c->set_key(c, keyItem.Get());
+        return c;
+    }
+
+    OperationContext* const _opCtx;
+    WiredTigerCursor _curwrap;
+    std::string _buffer;
+};
+
+std::unique_ptr<ColumnStore::WriteCursor> WiredTigerColumnStore::newWriteCursor(
+    OperationContext* opCtx) {
+    dassert(opCtx->lockState()->isWriteLocked());
+    return std::make_unique<WriteCursor>(opCtx, _uri, _tableId);
+}
+
+void WiredTigerColumnStore::insert(OperationContext* opCtx,
+                                   PathView path,
+                                   RecordId rid,
+                                   CellView cell) {
+    WriteCursor(opCtx, _uri, _tableId).insert(path, rid, cell);
+}
+
+void WiredTigerColumnStore::remove(OperationContext* opCtx, PathView path, RecordId rid) {
+    WriteCursor(opCtx, _uri, _tableId).remove(path, rid);
+}
+
+void WiredTigerColumnStore::update(OperationContext* opCtx,
+                                   PathView path,
+                                   RecordId rid,
+                                   CellView cell) {
+    WriteCursor(opCtx, _uri, _tableId).update(path, rid, cell);
+}
+
+/**
+ * Forward-only cursor over the whole table. The path and RecordId of the current cell are decoded
+ * from a private copy of the key, which is also what save() and restore() reposition on. The cell
+ * value is returned as a view into WiredTiger-owned memory and is only valid until the cursor is
+ * moved, saved or destroyed.
+ */
+class WiredTigerColumnStore::Cursor final : public ColumnStore::Cursor {
+public:
+    Cursor(OperationContext* opCtx, const WiredTigerColumnStore& store)
+        : _opCtx(opCtx), _store(store) {
+        _cursor.emplace(_store.uri(), _store.tableId(), false, _opCtx);
+    }
+
+    boost::optional<FullCellView> next() override {
+        if (_eof)
+            return {};
+
+        // Ensure an active transaction is open.
+        WiredTigerRecoveryUnit::get(_opCtx)->getSession();
+
+        if (!_lastMoveSkippedKey)
+            advanceWTCursor();
+        _lastMoveSkippedKey = false;
+        return curr();
+    }
+
+    boost::optional<FullCellView> seekAtOrPast(PathView path, RecordId rid) override {
+        makeKey(_buffer, path, rid);
+        seekWTCursor();
+        _lastMoveSkippedKey = false;
+        return curr();
+    }
+
+    boost::optional<FullCellView> seekExact(PathView path, RecordId rid) override {
+        makeKey(_buffer, path, rid);
+        seekWTCursor(/*exactOnly*/ true);
+        _lastMoveSkippedKey = false;
+        return curr();
+    }
+
+    void save() override {
+        try {
+            if (_cursor)
+                _cursor->reset();
+        } catch (const WriteConflictException&) {
+            // Ignore since this is only called when we are about to kill our transaction
+            // anyway.
+        }
+    }
+
+    void saveUnpositioned() override {
+        save();
+        _eof = true;
+    }
+
+    void restore() override {
+        if (!_cursor) {
+            _cursor.emplace(_store.uri(), _store.tableId(), false, _opCtx);
+        }
+
+        // Ensure an active session exists, so any restored cursors will bind to it
+        invariant(WiredTigerRecoveryUnit::get(_opCtx)->getSession() == _cursor->getSession());
+
+        if (!_eof) {
+            // '_buffer' still holds the key of the last cell returned. If that cell is gone we
+            // are now positioned on its successor, which next() must return without advancing.
+            _lastMoveSkippedKey = !seekWTCursor();
+        }
+    }
+
+    void detachFromOperationContext() override {
+        _opCtx = nullptr;
+        _cursor = boost::none;
+    }
+
+    void reattachToOperationContext(OperationContext* opCtx) override {
+        _opCtx = opCtx;
+        // _cursor recreated in restore() to avoid risk of WT_ROLLBACK issues.
+    }
+
+private:
+    void advanceWTCursor() {
+        WT_CURSOR* c = _cursor->get();
+        int ret = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->next(c); });
+        if (ret == WT_NOTFOUND) {
+            _eof = true;
+            return;
+        }
+        invariantWTOK(ret, c->session);
+        _eof = false;
+    }
+
+    // Seeks to the key in '_buffer'. Returns true on exact match.
+    bool seekWTCursor(bool exactOnly = false) {
+        // Ensure an active transaction is open.
+        WiredTigerRecoveryUnit::get(_opCtx)->getSession();
+
+        WT_CURSOR* c = _cursor->get();
+        const WiredTigerItem searchKey(_buffer);
+        c->set_key(c, searchKey.Get());
+
+        auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+        metricsCollector.incrementOneCursorSeek();
+
+        if (exactOnly) {
+            int ret = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search(c); });
+            if (ret == WT_NOTFOUND) {
+                _eof = true;
+                return false;
+            }
+            invariantWTOK(ret, c->session);
+            _eof = false;
+            return true;
+        }
+
+        int cmp = -1;
+        int ret = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search_near(c, &cmp); });
+        if (ret == WT_NOTFOUND) {
+            _eof = true;
+            return false;
+        }
+        invariantWTOK(ret, c->session);
+        _eof = false;
+
+        // Landing before the search key is possible since search_near() picks the closest key in
+        // either direction. As in the WiredTigerIndex cursor, keep advancing rather than stepping
+        // once, because ignoring prepare conflicts can surface newly committed keys (SERVER-56839).
+        WT_ITEM curKey;
+        while (cmp < 0) {
+            advanceWTCursor();
+            if (_eof)
+                break;
+            invariantWTOK(c->get_key(c, &curKey), c->session);
+            cmp = std::memcmp(curKey.data, searchKey.data, std::min(searchKey.size, curKey.size));
+            if (cmp == 0)
+                cmp = curKey.size < searchKey.size ? -1 : (curKey.size > searchKey.size ? 1 : 0);
+        }
+        return cmp == 0;
+    }
+
+    boost::optional<FullCellView> curr() {
+        if (_eof)
+            return {};
+
+        WT_CURSOR* c = _cursor->get();
+        WT_ITEM key;
+        WT_ITEM value;
+        invariantWTOK(c->get_key(c, &key), c->session);
+        invariantWTOK(c->get_value(c, &value), c->session);
+
+        auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+        metricsCollector.incrementOneIdxEntryRead(key.size);
+
+        _buffer.assign(static_cast<const char*>(key.data), key.size);
+        return decodeKey(_buffer, CellView(static_cast<const char*>(value.data), value.size));
+    }
+
+    OperationContext* _opCtx;
+    boost::optional<WiredTigerCursor> _cursor;
+    const WiredTigerColumnStore& _store;  // not owned
+
+    // Holds the key of the current cell, or the search key while seeking.
+    std::string _buffer;
+
+    bool _eof = true;
+
+    // Used by next to decide to return current position rather than moving. Should be reset to
+    // false by any operation that moves the cursor, other than subsequent save/restore pairs.
+    bool _lastMoveSkippedKey = false;
+};
+
+std::unique_ptr<ColumnStore::Cursor> WiredTigerColumnStore::newCursor(
+    OperationContext* opCtx) const {
+    return std::make_unique<Cursor>(opCtx, *this);
+}
+
+/**
+ * Appends cells through a bulk cursor. Cells must be added in key order, i.e. sorted by path and
+ * then by RecordId, which is the order a column store build naturally produces after sorting.
+ */
+class WiredTigerColumnStore::BulkBuilder final : public ColumnStore::BulkBuilder {
+public:
+    BulkBuilder(WiredTigerColumnStore* store, OperationContext* opCtx)
+        : _opCtx(opCtx),
+          _session(WiredTigerRecoveryUnit::get(_opCtx)->getSessionCache()->getSession()),
+          _cursor(openBulkCursor(store)) {}
+
+    ~BulkBuilder() {
+        _cursor->close(_cursor);
+    }
+
+    void addCell(PathView path, RecordId rid, CellView cell) override {
+        makeKey(_buffer, path, rid);
+
+        // Can't use WiredTigerCursor since we aren't using the cache.
+        WiredTigerItem keyItem(_buffer);
+        _cursor->set_key(_cursor, keyItem.Get());
+
+        WiredTigerItem valueItem(cell.rawData(), cell.size());
+        _cursor->set_value(_cursor, valueItem.Get());
+
+        invariantWTOK(wiredTigerCursorInsert(_opCtx, _cursor), _cursor->session);
+
+        auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+        metricsCollector.incrementOneIdxEntryWritten(keyItem.size);
+    }
+
+private:
+    WT_CURSOR* openBulkCursor(WiredTigerColumnStore* store) {
+        // Open cursors can cause bulk open_cursor to fail with EBUSY.
+        WiredTigerSession* outerSession = WiredTigerRecoveryUnit::get(_opCtx)->getSession();
+        outerSession->closeAllCursors(store->uri());
+
+        // Not using cursor cache since we need to set "bulk". Use a different session to ensure
+        // we don't hijack an existing transaction.
+        WT_CURSOR* cursor;
+        WT_SESSION* session = _session->getSession();
+        int err = session->open_cursor(
+            session, store->uri().c_str(), nullptr, "bulk,checkpoint_wait=false", &cursor);
+        if (!err)
+            return cursor;
+
+        LOGV2_WARNING(6701003,
+                      "Failed to create WiredTiger bulk cursor, falling back to non-bulk",
+                      "error"_attr = wiredtiger_strerror(err),
+                      "columnStore"_attr = store->uri());
+
+        invariantWTOK(
+            session->open_cursor(session, store->uri().c_str(), nullptr, nullptr, &cursor),
+            session);
+        return cursor;
+    }
+
+    OperationContext* const _opCtx;
+    UniqueWiredTigerSession const _session;
+    WT_CURSOR* const _cursor;
+    std::string _buffer;
+};
+
+std::unique_ptr<ColumnStore::BulkBuilder> WiredTigerColumnStore::makeBulkBuilder(
+    OperationContext* opCtx) {
+    return std::make_unique<BulkBuilder>(this, opCtx);
+}
+
+Status WiredTigerColumnStore::compact(OperationContext* opCtx) {
+    dassert(opCtx->lockState()->isWriteLocked());
+    WiredTigerSessionCache* cache = WiredTigerRecoveryUnit::get(opCtx)->getSessionCache();
+    if (!cache->isEphemeral()) {
+        WT_SESSION* s = WiredTigerRecoveryUnit::get(opCtx)->getSession()->getSession();
+        opCtx->recoveryUnit()->abandonSnapshot();
+        int ret = s->compact(s, uri().c_str(), "timeout=0");
+        if (MONGO_unlikely(WTCompactColumnStoreEBUSY.shouldFail())) {
+            ret = EBUSY;
+        }
+
+        if (ret == EBUSY) {
+            return Status(ErrorCodes::Interrupted,
+                          str::stream() << "Compaction interrupted on " << uri().c_str()
+                                        << " due to cache eviction pressure");
+        }
+        invariantWTOK(ret, s);
+    }
+    return Status::OK();
+}
+
+void WiredTigerColumnStore::fullValidate(OperationContext* opCtx,
+                                         int64_t* numKeysOut,
+                                         IndexValidateResults* fullResults) const {
+    dassert(opCtx->lockState()->isReadLocked());
+    if (fullResults && !WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->isEphemeral()) {
+        int err = WiredTigerUtil::verifyTable(opCtx, _uri, &(fullResults->errors));
+        if (err == EBUSY) {
+            std::string msg = str::stream()
+                << "Could not complete validation of " << _uri << ". "
+                << "This is a transient issue as the collection was actively "
+                   "in use by other operations.";
+
+            LOGV2_WARNING(6701004,
+                          "Could not complete validation. This is a transient issue as "
+                          "the collection was actively in use by other operations",
+                          "uri"_attr = _uri);
+            fullResults->warnings.push_back(msg);
+        } else if (err) {
+            std::string msg = str::stream()
+                << "verify() returned " << wiredtiger_strerror(err) << ". "
+                << "This indicates structural damage. "
+                << "Not examining individual column store entries.";
+            LOGV2_ERROR(6701005,
+                        "verify() returned an error. This indicates structural damage. Not "
+                        "examining individual column store entries.",
+                        "error"_attr = wiredtiger_strerror(err));
+            fullResults->errors.push_back(msg);
+            fullResults->valid = false;
+            return;
+        }
+    }
+
+    // Walk the raw table rather than going through Cursor so that a malformed key is reported
+    // instead of tripping the invariant in decodeKey().
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    WT_CURSOR* c = curwrap.get();
+    int64_t count = 0;
+    int ret;
+    while ((ret = wiredTigerPrepareConflictRetry(opCtx, [&] { return c->next(c); })) == 0) {
+        WT_ITEM key;
+        invariantWTOK(c->get_key(c, &key), c->session);
+        StringData keyData(static_cast<const char*>(key.data), key.size);
+        const auto nullByte = keyData.find('\0');
+        if (fullResults &&
+            (nullByte == std::string::npos || keyData.size() != nullByte + 1 + kRecordIdSize)) {
+            fullResults->errors.push_back(str::stream()
+                                          << "Column store " << _indexName
+                                          << " contains a malformed key: "
+                                          << hexblob::encode(keyData.rawData(), keyData.size()));
+            fullResults->valid = false;
+        }
+        count++;
+    }
+    if (ret != WT_NOTFOUND) {
+        invariantWTOK(ret, c->session);
+    }
+
+    if (numKeysOut) {
+        *numKeysOut = count;
+    }
+}
+
+bool WiredTigerColumnStore::appendCustomStats(OperationContext* opCtx,
+                                              BSONObjBuilder* output,
+                                              double scale) const {
+    dassert(opCtx->lockState()->isReadLocked());
+    {
+        BSONObjBuilder metadata(output->subobjStart("metadata"));
+        Status status = WiredTigerUtil::getApplicationMetadata(opCtx, uri(), &metadata);
+        if (!status.isOK()) {
+            metadata.append("error", "unable to retrieve metadata");
+            metadata.append("code", static_cast<int>(status.code()));
+            metadata.append("reason", status.reason());
+        }
+    }
+    std::string type, sourceURI;
+    WiredTigerUtil::fetchTypeAndSourceURI(opCtx, _uri, &type, &sourceURI);
+    StatusWith<std::string> metadataResult = WiredTigerUtil::getMetadataCreate(opCtx, sourceURI);
+    StringData creationStringName("creationString");
+    if (!metadataResult.isOK()) {
+        BSONObjBuilder creationString(output->subobjStart(creationStringName));
+        creationString.append("error", "unable to retrieve creation config");
+        creationString.append("code", static_cast<int>(metadataResult.getStatus().code()));
+        creationString.append("reason", metadataResult.getStatus().reason());
+    } else {
+        output->append(creationStringName, metadataResult.getValue());
+        output->append("type", type);
+    }
+
+    WiredTigerSession* session = WiredTigerRecoveryUnit::get(opCtx)->getSession();
+    WT_SESSION* s = session->getSession();
+    Status status =
+        WiredTigerUtil::exportTableToBSON(s, "statistics:" + uri(), "statistics=(fast)", output);
+    if (!status.isOK()) {
+        output->append("error", "unable to retrieve statistics");
+        output->append("code", static_cast<int>(status.code()));
+        output->append("reason", status.reason());
+    }
+    return true;
+}
+
+long long WiredTigerColumnStore::getSpaceUsedBytes(OperationContext* opCtx) const {
+    dassert(opCtx->lockState()->isReadLocked());
+    auto ru = WiredTigerRecoveryUnit::get(opCtx);
+    WiredTigerSession* session = ru->getSession();
+
+    if (ru->getSessionCache()->isEphemeral()) {
+        // For ephemeral case, use cursor statistics as WiredTigerIndex does.
+        const auto statsUri = "statistics:" + uri();
+        auto getStats = [&](int key) -> int64_t {
+            auto result = WiredTigerUtil::getStatisticsValue(
+                session->getSession(), statsUri, "statistics=(fast)", key);
+            if (!result.isOK()) {
+                if (result.getStatus().code() == ErrorCodes::CursorNotFound)
+                    return 0;  // ident gone, so return 0
+
+                uassertStatusOK(result.getStatus());
+            }
+            return result.getValue();
+        };
+
+        auto inserts = getStats(WT_STAT_DSRC_CURSOR_INSERT);
+        auto removes = getStats(WT_STAT_DSRC_CURSOR_REMOVE);
+        auto insertBytes = getStats(WT_STAT_DSRC_CURSOR_INSERT_BYTES);
+
+        if (inserts == 0 || removes >= inserts)
+            return 0;
+
+        auto bytesPerEntry = (insertBytes + inserts - 1) / inserts;  // round up
+        auto numEntries = inserts - removes;
+        return numEntries * bytesPerEntry;
+    }
+
+    return static_cast<long long>(WiredTigerUtil::getIdentSize(session->getSession(), _uri));
+}
+
+long long WiredTigerColumnStore::getFreeStorageBytes(OperationContext* opCtx) const {
+    dassert(opCtx->lockState()->isReadLocked());
+    auto ru = WiredTigerRecoveryUnit::get(opCtx);
+    WiredTigerSession* session = ru->getSessionNoTxn();
+
+    return static_cast<long long>(WiredTigerUtil::getIdentReuseSize(session->getSession(), _uri));
+}
+
+bool WiredTigerColumnStore::isEmpty(OperationContext* opCtx) {
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    WT_CURSOR* c = curwrap.get();
+    if (!c)
+        return true;
+    int ret = wiredTigerPrepareConflictRetry(opCtx, [&] { return c->next(c); });
+    if (ret == WT_NOTFOUND)
+        return true;
+    invariantWTOK(ret, c->session);
+    return false;
+}
+
+}  // namespace mongo
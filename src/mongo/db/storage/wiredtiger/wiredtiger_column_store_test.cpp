@@ -0,0 +1,277 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <list>
+#include <memory>
+
+#include "mongo/db/concurrency/locker_noop_client_observer.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/storage/test_harness_helper.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_column_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_oplog_manager.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/system_clock_source.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerColumnStoreHarnessHelper final : public HarnessHelper {
+public:
+    WiredTigerColumnStoreHarnessHelper() : _dbpath("wt_test"), _conn(nullptr) {
+        auto service = getServiceContext();
+        service->registerClientObserver(std::make_unique<LockerNoopClientObserver>());
+
+        const char* config = "create,cache_size=1G,";
+        int ret = wiredtiger_open(_dbpath.path().c_str(), nullptr, config, &_conn);
+        invariantWTOK(ret, nullptr);
+
+        _fastClockSource = std::make_unique<SystemClockSource>();
+        _sessionCache = new WiredTigerSessionCache(_conn, _fastClockSource.get());
+
+        WiredTigerUtil::notifyStartupComplete();
+    }
+
+    ~WiredTigerColumnStoreHarnessHelper() final {
+        delete _sessionCache;
+        _conn->close(_conn, nullptr);
+
+        WiredTigerUtil::resetTableLoggingInfo();
+    }
+
+    std::unique_ptr<ColumnStore> newColumnStore() {
+        std::string ns = "test.wt";
+        auto opCtx = newOperationContext();
+
+        BSONObj spec = BSON("key" << BSON("$**"
+                                          << "columnstore")
+                                  << "name"
+                                  << "csi"
+                                  << "v" << static_cast<int>(IndexDescriptor::kLatestIndexVersion));
+        IndexDescriptor& desc = _descriptors.emplace_back("", spec);
+
+        StatusWith<std::string> result = WiredTigerColumnStore::generateCreateString(
+            kWiredTigerEngineName, "", "", NamespaceString(ns), desc);
+        ASSERT_OK(result.getStatus());
+
+        std::string uri = WiredTigerKVEngine::kTableUriPrefix + ns;
+        ASSERT_OK(WiredTigerColumnStore::create(opCtx.get(), uri, result.getValue()));
+
+        return std::make_unique<WiredTigerColumnStore>(opCtx.get(), uri, "" /* ident */, &desc);
+    }
+
+    std::unique_ptr<RecoveryUnit> newRecoveryUnit() final {
+        return std::make_unique<WiredTigerRecoveryUnit>(_sessionCache, &_oplogManager);
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    std::unique_ptr<ClockSource> _fastClockSource;
+    std::list<IndexDescriptor> _descriptors;
+    WT_CONNECTION* _conn;
+    WiredTigerSessionCache* _sessionCache;
+    WiredTigerOplogManager _oplogManager;
+};
+
+class WiredTigerColumnStoreTest : public unittest::Test {
+protected:
+    WiredTigerColumnStoreTest() : _columnStore(_helper.newColumnStore()) {}
+
+    void insertCells(const std::vector<FullCellView>& cells) {
+        auto opCtx = _helper.newOperationContext();
+        WriteUnitOfWork wuow(opCtx.get());
+        auto cursor = _columnStore->newWriteCursor(opCtx.get());
+        for (auto&& cell : cells) {
+            cursor->insert(cell.path, cell.rid, cell.value);
+        }
+        wuow.commit();
+    }
+
+    WiredTigerColumnStoreHarnessHelper _helper;
+    std::unique_ptr<ColumnStore> _columnStore;
+};
+
+TEST(WiredTigerColumnStoreKeyTest, KeysSortByPathThenRecordId) {
+    std::string a, b;
+    auto less = [&](PathView p1, RecordId r1, PathView p2, RecordId r2) {
+        WiredTigerColumnStore::makeKey(a, p1, r1);
+        WiredTigerColumnStore::makeKey(b, p2, r2);
+        return a < b;
+    };
+
+    ASSERT_TRUE(less("a", RecordId(1), "a", RecordId(2)));
+    ASSERT_TRUE(less("a", RecordId(255), "a", RecordId(256)));
+    ASSERT_TRUE(less("a", RecordId(-1), "a", RecordId(1)));
+    ASSERT_TRUE(less("a", RecordId(), "a", RecordId(1)));
+    ASSERT_TRUE(less("a", RecordId(1LL << 40), "a.b", RecordId(1)));
+    ASSERT_TRUE(less("a.b", RecordId(1LL << 40), "b", RecordId(1)));
+    ASSERT_TRUE(less("z", RecordId(1LL << 40), ColumnStore::kRowIdPath, RecordId(1)));
+}
+
+TEST(WiredTigerColumnStoreKeyTest, DecodeKeyRoundTrips) {
+    std::string key;
+    for (auto rid : {RecordId(1), RecordId(-7), RecordId(1LL << 50), RecordId::maxLong()}) {
+        WiredTigerColumnStore::makeKey(key, "a.b.c", rid);
+        auto cell = WiredTigerColumnStore::decodeKey(key, "val"_sd);
+        ASSERT_EQ(cell.path, "a.b.c"_sd);
+        ASSERT_EQ(cell.rid, rid);
+        ASSERT_EQ(cell.value, "val"_sd);
+    }
+}
+
+TEST_F(WiredTigerColumnStoreTest, ScanPathInRecordIdOrder) {
+    insertCells({{"b", RecordId(2), "b2"},
+                 {"a", RecordId(3), "a3"},
+                 {"a", RecordId(1), "a1"},
+                 {"b", RecordId(1), "b1"},
+                 {"a", RecordId(2), "a2"}});
+
+    auto opCtx = _helper.newOperationContext();
+    auto cursor = _columnStore->newCursor(opCtx.get(), "a");
+
+    auto cell = cursor->seekAtOrPast(RecordId());
+    ASSERT(cell);
+    ASSERT_EQ(cell->rid, RecordId(1));
+    ASSERT_EQ(cell->value, "a1"_sd);
+
+    cell = cursor->next();
+    ASSERT(cell);
+    ASSERT_EQ(cell->rid, RecordId(2));
+
+    cell = cursor->next();
+    ASSERT(cell);
+    ASSERT_EQ(cell->rid, RecordId(3));
+    ASSERT_EQ(cell->value, "a3"_sd);
+
+    // Reaching cells of the next path ends the scan for this one.
+    ASSERT_FALSE(cursor->next());
+}
+
+TEST_F(WiredTigerColumnStoreTest, SeekExactAndAtOrPast) {
+    insertCells({{"a", RecordId(1), "a1"}, {"a", RecordId(5), "a5"}, {"b", RecordId(3), "b3"}});
+
+    auto opCtx = _helper.newOperationContext();
+    auto cursor = _columnStore->newCursor(opCtx.get(), "a");
+
+    ASSERT_FALSE(cursor->seekExact(RecordId(3)));
+
+    auto cell = cursor->seekAtOrPast(RecordId(3));
+    ASSERT(cell);
+    ASSERT_EQ(cell->rid, RecordId(5));
+
+    cell = cursor->seekExact(RecordId(1));
+    ASSERT(cell);
+    ASSERT_EQ(cell->value, "a1"_sd);
+
+    ASSERT_FALSE(cursor->seekAtOrPast(RecordId(6)));
+}
+
+TEST_F(WiredTigerColumnStoreTest, UpdateAndRemove) {
+    insertCells({{"a", RecordId(1), "a1"}, {"a", RecordId(2), "a2"}});
+
+    {
+        auto opCtx = _helper.newOperationContext();
+        WriteUnitOfWork wuow(opCtx.get());
+        _columnStore->update(opCtx.get(), "a", RecordId(1), "updated");
+        _columnStore->remove(opCtx.get(), "a", RecordId(2));
+        // Removing a missing cell is a no-op.
+        _columnStore->remove(opCtx.get(), "a", RecordId(3));
+        wuow.commit();
+    }
+
+    auto opCtx = _helper.newOperationContext();
+    auto cursor = _columnStore->newCursor(opCtx.get(), "a");
+    auto cell = cursor->seekAtOrPast(RecordId());
+    ASSERT(cell);
+    ASSERT_EQ(cell->value, "updated"_sd);
+    ASSERT_FALSE(cursor->next());
+}
+
+TEST_F(WiredTigerColumnStoreTest, SaveRestoreAfterCellRemoved) {
+    insertCells({{"a", RecordId(1), "a1"}, {"a", RecordId(2), "a2"}, {"a", RecordId(3), "a3"}});
+
+    auto opCtx = _helper.newOperationContext();
+    auto cursor = _columnStore->newCursor(opCtx.get(), "a");
+    auto cell = cursor->seekAtOrPast(RecordId());
+    ASSERT(cell);
+    ASSERT_EQ(cell->rid, RecordId(1));
+
+    cursor->save();
+    {
+        WriteUnitOfWork wuow(opCtx.get());
+        _columnStore->remove(opCtx.get(), "a", RecordId(1));
+        wuow.commit();
+    }
+    cursor->restore();
+
+    // The cell we were positioned on is gone, so next() returns its successor.
+    cell = cursor->next();
+    ASSERT(cell);
+    ASSERT_EQ(cell->rid, RecordId(2));
+    cell = cursor->next();
+    ASSERT(cell);
+    ASSERT_EQ(cell->rid, RecordId(3));
+}
+
+TEST_F(WiredTigerColumnStoreTest, BulkBuildAndValidate) {
+    {
+        auto opCtx = _helper.newOperationContext();
+        auto builder = _columnStore->makeBulkBuilder(opCtx.get());
+        for (int i = 1; i <= 10; ++i) {
+            builder->addCell("a", RecordId(i), "x");
+        }
+        for (int i = 1; i <= 10; ++i) {
+            builder->addCell(ColumnStore::kRowIdPath, RecordId(i), "");
+        }
+    }
+
+    auto opCtx = _helper.newOperationContext();
+    ASSERT_FALSE(_columnStore->isEmpty(opCtx.get()));
+
+    IndexValidateResults results;
+    int64_t numKeys = 0;
+    _columnStore->fullValidate(opCtx.get(), &numKeys, &results);
+    ASSERT_TRUE(results.valid);
+    ASSERT_EQ(numKeys, 20);
+    ASSERT_EQ(_columnStore->numEntries(opCtx.get()), 20);
+
+    auto paths = _columnStore->uniquePaths(opCtx.get());
+    ASSERT_EQ(paths.size(), 2U);
+    ASSERT_EQ(paths[0], "a");
+    ASSERT_EQ(paths[1], ColumnStore::kRowIdPath);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -958,6 +958,7 @@ public:
             : KeyString::Discriminator::kExclusiveBefore;
         _endPosition = std::make_unique<KeyString::Builder>(_idx.getKeyStringVersion());
         _endPosition->resetToKey(BSONObj::stripFieldNames(key), _idx.getOrdering(), discriminator);
+        _endPositionComparison.reset();
     }
 
     boost::optional<IndexKeyEntry> seek(const KeyString::Value& keyString,
@@ -1096,8 +1097,10 @@ protected:
         if (!_endPosition)
             return false;
 
-        const int cmp = _key.compare(*_endPosition);
+        return isPastEndPosition(_key.compare(*_endPosition));
+    }
 
+    bool isPastEndPosition(int cmp) const {
         // We set up _endPosition to be in between the last in-range value and the first
         // out-of-range value. In particular, it is constructed to never equal any legal index
         // key.
@@ -1112,6 +1115,49 @@ protected:
         }
     }
 
+    /**
+     * Compares _key with _endPosition. The first 'sharedPrefixSize' bytes of _key must be those of
+     * the key that _key held before it was last updated. As keys of compound indexes that are
+     * next to each other often share long prefixes, the comparison starts where the new key
+     * departs from either the previous key or the end position, rather than at the beginning.
+     */
+    int compareWithEndPosition(size_t sharedPrefixSize) {
+        invariant(_endPosition);
+
+        size_t alreadyCompared = 0;
+        if (_endPositionComparison) {
+            if (sharedPrefixSize > _endPositionComparison->commonPrefixSize) {
+                // The key agrees with the previous key beyond where the previous key departed
+                // from the end position, so the two compare with it the same way.
+                return _endPositionComparison->cmp;
+            }
+            alreadyCompared = sharedPrefixSize;
+        }
+
+        const char* key = _key.getBuffer();
+        const char* end = _endPosition->getBuffer();
+        const size_t keySize = _key.getSize();
+        const size_t endSize = _endPosition->getSize();
+        const size_t prefixSize = alreadyCompared +
+            KeyString::commonPrefixSize(key + alreadyCompared,
+                                        end + alreadyCompared,
+                                        keySize - alreadyCompared,
+                                        endSize - alreadyCompared);
+
+        int cmp;
+        if (prefixSize < std::min(keySize, endSize)) {
+            cmp = static_cast<uint8_t>(key[prefixSize]) < static_cast<uint8_t>(end[prefixSize])
+                ? -1
+                : 1;
+        } else {
+            cmp = keySize == endSize ? 0 : (keySize < endSize ? -1 : 1);
+        }
+        dassert(cmp == _key.compare(*_endPosition));
+
+        _endPositionComparison = EndPositionComparison{prefixSize, cmp};
+        return cmp;
+    }
+
     void advanceWTCursor() {
         WT_CURSOR* c = _cursor->get();
         int ret = wiredTigerPrepareConflictRetry(
@@ -1224,13 +1270,24 @@ protected:
         WT_ITEM item;
         getKey(c, &item);
 
+        // Number of leading bytes that the new key has in common with the previous one.
+        const size_t sharedPrefixSize =
+            KeyString::commonPrefixSize(_key.getBuffer(),
+                                        static_cast<const char*>(item.data),
+                                        _key.getSize(),
+                                        item.size);
+
         const auto isForwardNextCall = _forward && inNext && !_key.isEmpty();
         if (isForwardNextCall) {
             // Due to a bug in wired tiger (SERVER-21867) sometimes calling next
             // returns something prev.
-            const int cmp =
-                std::memcmp(_key.getBuffer(), item.data, std::min(_key.getSize(), item.size));
-            bool nextNotIncreasing = cmp > 0 || (cmp == 0 && _key.getSize() > item.size);
+            bool nextNotIncreasing;
+            if (sharedPrefixSize < std::min(_key.getSize(), item.size)) {
+                nextNotIncreasing = static_cast<uint8_t>(_key.getBuffer()[sharedPrefixSize]) >
+                    static_cast<const uint8_t*>(item.data)[sharedPrefixSize];
+            } else {
+                nextNotIncreasing = _key.getSize() > item.size;
+            }
 
             if (MONGO_unlikely(WTEmulateOutOfOrderNextIndexKey.shouldFail())) {
                 LOGV2(51789, "WTIndex::updatePosition simulating next key not increasing.");
@@ -1256,10 +1313,13 @@ protected:
             }
         }
 
-        // Store (a copy of) the new item data as the current key for this cursor.
-        _key.resetFromBuffer(item.data, item.size);
+        // Store (a copy of) the new item data as the current key for this cursor. Only the part
+        // which differs from the previous key needs to be copied.
+        _key.resetFromBufferWithSharedPrefix(item.data, item.size, sharedPrefixSize);
 
-        if (atOrPastEndPointAfterSeeking()) {
+        if (!_endPosition) {
+            _endPositionComparison.reset();
+        } else if (isPastEndPosition(compareWithEndPosition(sharedPrefixSize))) {
             _eof = true;
             return;
         }
@@ -1335,6 +1395,14 @@ protected:
 
     std::unique_ptr<KeyString::Builder> _endPosition;
 
+    // Result of the last comparison of _key with _endPosition, and the number of leading bytes
+    // they had in common. Unset when _key has changed without being compared with _endPosition.
+    struct EndPositionComparison {
+        size_t commonPrefixSize;
+        int cmp;
+    };
+    boost::optional<EndPositionComparison> _endPositionComparison;
+
     bool _saveStorageCursorOnDetachFromOperationContext = false;
 };
 
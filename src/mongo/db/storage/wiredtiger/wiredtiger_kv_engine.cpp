@@ -80,6 +80,7 @@
 #include "mongo/db/storage/storage_parameters_gen.h"
 #include "mongo/db/storage/storage_repair_observer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_cursor.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_column_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_extensions.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
@@ -511,6 +512,12 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sessionSweeper = std::make_unique<WiredTigerSessionSweeper>(_sessionCache.get());
     _sessionSweeper->go();
 
+    // Read-ahead only helps when records have to be read from disk.
+    if (!_ephemeral && gWiredTigerPrefetchThreads > 0) {
+        _prefetcher = std::make_unique<WiredTigerPrefetcher>(
+            _sessionCache.get(), static_cast<size_t>(gWiredTigerPrefetchThreads));
+    }
+
     // Until the Replication layer installs a real callback, prevent truncating the oplog.
     setOldestActiveTransactionTimestampCallback(
         [](Timestamp) { return StatusWith(boost::make_optional(Timestamp::min())); });
@@ -744,6 +751,10 @@ void WiredTigerKVEngine::cleanShutdown() {
         _sessionSweeper->shutdown();
         LOGV2(22319, "Finished shutting down session sweeper thread");
     }
+    if (_prefetcher) {
+        // The prefetcher's sessions must all be returned before the session cache shuts down.
+        _prefetcher->shutdown();
+    }
     LOGV2_FOR_RECOVERY(23988,
                        2,
                        "Shutdown timestamps.",
@@ -1658,6 +1669,50 @@ Status WiredTigerKVEngine::dropSortedDataInterface(OperationContext* opCtx, Stri
     return WiredTigerIndex::Drop(opCtx, _uri(ident));
 }
 
+Status WiredTigerKVEngine::createColumnStore(OperationContext* opCtx,
+                                             const CollectionOptions& collOptions,
+                                             StringData ident,
+                                             const IndexDescriptor* desc) {
+    _ensureIdentPath(ident);
+    invariant(!collOptions.clusteredIndex, "column stores require integer RecordIds");
+
+    std::string collIndexOptions;
+    if (auto storageEngineOptions = collOptions.indexOptionDefaults.getStorageEngine()) {
+        collIndexOptions =
+            dps::extractElementAtPath(*storageEngineOptions, _canonicalName + ".configString")
+                .str();
+    }
+    // Some unittests use a OperationContextNoop that can't support such lookups.
+    auto ns = collOptions.uuid
+        ? *CollectionCatalog::get(opCtx)->lookupNSSByUUID(opCtx, *collOptions.uuid)
+        : NamespaceString();
+
+    StatusWith<std::string> result = WiredTigerColumnStore::generateCreateString(
+        _canonicalName, _indexOptions, collIndexOptions, ns, *desc);
+    if (!result.isOK()) {
+        return result.getStatus();
+    }
+
+    std::string config = result.getValue();
+
+    LOGV2_DEBUG(6701006,
+                2,
+                "WiredTigerKVEngine::createColumnStore",
+                "collection_uuid"_attr = collOptions.uuid,
+                "ident"_attr = ident,
+                "config"_attr = config);
+    return WiredTigerColumnStore::create(opCtx, _uri(ident), config);
+}
+
+std::unique_ptr<ColumnStore> WiredTigerKVEngine::getColumnStore(
+    OperationContext* opCtx,
+    const CollectionOptions& collOptions,
+    StringData ident,
+    const IndexDescriptor* desc) {
+    invariant(!collOptions.clusteredIndex, "column stores require integer RecordIds");
+    return std::make_unique<WiredTigerColumnStore>(opCtx, _uri(ident), ident, desc, _readOnly);
+}
+
 std::unique_ptr<SortedDataInterface> WiredTigerKVEngine::getSortedDataInterface(
     OperationContext* opCtx,
     const CollectionOptions& collOptions,
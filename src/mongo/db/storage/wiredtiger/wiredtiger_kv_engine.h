@@ -44,6 +44,7 @@
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_oplog_manager.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_prefetcher.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/platform/mutex.h"
@@ -175,6 +176,16 @@ public:
      */
     Status dropSortedDataInterface(OperationContext* opCtx, StringData ident) override;
 
+    Status createColumnStore(OperationContext* opCtx,
+                             const CollectionOptions& collOptions,
+                             StringData ident,
+                             const IndexDescriptor* desc) override;
+
+    std::unique_ptr<ColumnStore> getColumnStore(OperationContext* opCtx,
+                                                const CollectionOptions& collOptions,
+                                                StringData ident,
+                                                const IndexDescriptor* desc) override;
+
     Status dropIdent(RecoveryUnit* ru,
                      StringData ident,
                      StorageEngine::DropIdentCallback&& onDrop = nullptr) override;
@@ -309,6 +320,14 @@ public:
         return _oplogManager.get();
     }
 
+    /**
+     * Returns the prefetcher used to read records ahead of queries, or nullptr if read-ahead is
+     * disabled.
+     */
+    WiredTigerPrefetcher* getPrefetcher() const {
+        return _prefetcher.get();
+    }
+
     static void appendGlobalStats(BSONObjBuilder& b);
 
     Timestamp getStableTimestamp() const override;
@@ -472,6 +491,8 @@ private:
 
     std::unique_ptr<WiredTigerSessionSweeper> _sessionSweeper;
 
+    std::unique_ptr<WiredTigerPrefetcher> _prefetcher;
+
     std::string _rsOptions;
     std::string _indexOptions;
 
@@ -0,0 +1,149 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_prefetcher.h"
+
+#include <algorithm>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+// Use the configuration of regular read cursors, so that the cursors cached in a session can be
+// reused by queries once the session is returned to the session cache.
+const std::string kPrefetchCursorConfig = "";
+
+ThreadPool::Options makeThreadPoolOptions(size_t numThreads) {
+    ThreadPool::Options options;
+    options.poolName = "WiredTigerPrefetcher";
+    options.threadNamePrefix = "WTPrefetch-";
+    options.minThreads = 0;
+    options.maxThreads = numThreads;
+    return options;
+}
+
+}  // namespace
+
+WiredTigerPrefetcher::WiredTigerPrefetcher(WiredTigerSessionCache* sessionCache,
+                                           size_t numThreads)
+    : _sessionCache(sessionCache),
+      _numThreads(numThreads),
+      _maxOutstandingRecords(numThreads * kMaxOutstandingRecordsPerThread),
+      _pool(makeThreadPoolOptions(numThreads)) {
+    invariant(_numThreads > 0);
+    _pool.startup();
+}
+
+WiredTigerPrefetcher::~WiredTigerPrefetcher() {
+    shutdown();
+}
+
+void WiredTigerPrefetcher::shutdown() {
+    if (_shutdown.swap(true)) {
+        return;
+    }
+    _pool.shutdown();
+    _pool.join();
+}
+
+size_t WiredTigerPrefetcher::prefetch(const std::string& uri,
+                                      uint64_t tableId,
+                                      KeyFormat keyFormat,
+                                      const std::vector<RecordId>& ids) {
+    if (ids.empty() || _shutdown.load()) {
+        return 0;
+    }
+
+    // Reserve room for as many of the records as the bound allows.
+    size_t outstanding = _outstandingRecords.load();
+    size_t count;
+    do {
+        if (outstanding >= _maxOutstandingRecords) {
+            return 0;
+        }
+        count = std::min(ids.size(), _maxOutstandingRecords - outstanding);
+    } while (!_outstandingRecords.compareAndSwap(&outstanding, outstanding + count));
+
+    // Spread the records over the threads so that the reads proceed in parallel.
+    const size_t chunkSize = (count + _numThreads - 1) / _numThreads;
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        const size_t end = std::min(begin + chunkSize, count);
+        _pool.schedule([this,
+                        uri,
+                        tableId,
+                        keyFormat,
+                        chunk = std::vector<RecordId>(ids.begin() + begin, ids.begin() + end)](
+                           Status status) {
+            ON_BLOCK_EXIT([&] { _outstandingRecords.fetchAndSubtract(chunk.size()); });
+            if (status.isOK()) {
+                _readRecords(uri, tableId, keyFormat, chunk);
+            }
+        });
+    }
+    return count;
+}
+
+void WiredTigerPrefetcher::_readRecords(const std::string& uri,
+                                        uint64_t tableId,
+                                        KeyFormat keyFormat,
+                                        const std::vector<RecordId>& ids) {
+    try {
+        auto session = _sessionCache->getSession();
+        WT_CURSOR* cursor = session->getCachedCursor(tableId, kPrefetchCursorConfig);
+        if (!cursor) {
+            cursor = session->getNewCursor(uri, kPrefetchCursorConfig.c_str());
+        }
+        ON_BLOCK_EXIT([&] { session->releaseCursor(tableId, cursor, kPrefetchCursorConfig); });
+
+        for (const auto& id : ids) {
+            if (keyFormat == KeyFormat::Long) {
+                cursor->set_key(cursor, id.getLong());
+            } else {
+                auto str = id.getStr();
+                WiredTigerItem item(str.rawData(), str.size());
+                cursor->set_key(cursor, item.Get());
+            }
+
+            // Only the side effect of bringing the record's page into the cache matters here. A
+            // missing record, a prepare conflict or a rollback is left for the query to observe
+            // when it reads the record itself.
+            cursor->search(cursor);
+        }
+    } catch (const DBException&) {
+        // The table may have been dropped or be temporarily unavailable; the query will read the
+        // records on its own.
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/key_format.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+class WiredTigerSessionCache;
+
+/**
+ * Reads records into the WiredTiger cache ahead of a query that is about to seek to them.
+ *
+ * WiredTiger reads a page from disk on the thread that searches for it, so a query which seeks to
+ * one record at a time can have at most one disk read outstanding. The prefetcher searches for the
+ * records on a small pool of background threads, each using its own session, so that several reads
+ * are in flight at once while the query consumes the records in order with its own cursor. The
+ * background searches only warm the cache; they never return data to the caller, so they do not
+ * need to share the query's snapshot.
+ *
+ * The number of records waiting to be read is bounded. Requests beyond the bound are dropped.
+ */
+class WiredTigerPrefetcher {
+    WiredTigerPrefetcher(const WiredTigerPrefetcher&) = delete;
+    WiredTigerPrefetcher& operator=(const WiredTigerPrefetcher&) = delete;
+
+public:
+    // The maximum number of records each background thread may have waiting to be read.
+    static constexpr size_t kMaxOutstandingRecordsPerThread = 256;
+
+    WiredTigerPrefetcher(WiredTigerSessionCache* sessionCache, size_t numThreads);
+
+    ~WiredTigerPrefetcher();
+
+    /**
+     * Stops accepting new requests and waits for the outstanding reads to finish. Must be called
+     * before the session cache is shut down.
+     */
+    void shutdown();
+
+    /**
+     * Schedules background reads of the records 'ids' from the table 'uri'. Returns the number of
+     * records scheduled, which is smaller than the number requested when too many reads are
+     * already outstanding.
+     */
+    size_t prefetch(const std::string& uri,
+                    uint64_t tableId,
+                    KeyFormat keyFormat,
+                    const std::vector<RecordId>& ids);
+
+private:
+    void _readRecords(const std::string& uri,
+                      uint64_t tableId,
+                      KeyFormat keyFormat,
+                      const std::vector<RecordId>& ids);
+
+    WiredTigerSessionCache* const _sessionCache;
+    const size_t _numThreads;
+    const size_t _maxOutstandingRecords;
+
+    AtomicWord<size_t> _outstandingRecords{0};
+    AtomicWord<bool> _shutdown{false};
+
+    ThreadPool _pool;
+};
+
+}  // namespace mongo
@@ -2293,6 +2293,20 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
 }
 
+size_t WiredTigerRecordStoreCursorBase::prefetch(const std::vector<RecordId>& ids) {
+    // Oplog cursors apply their own visibility rules on every read and are not driven by index
+    // scans, so there is nothing to gain from reading ahead of them.
+    if (_rs._isOplog) {
+        return 0;
+    }
+
+    auto prefetcher = _rs._kvEngine->getPrefetcher();
+    if (!prefetcher) {
+        return 0;
+    }
+    return prefetcher->prefetch(_rs.getURI(), _rs.tableId(), _rs.keyFormat(), ids);
+}
+
 boost::optional<Record> WiredTigerRecordStoreCursorBase::seekNear(const RecordId& id) {
     dassert(_opCtx->lockState()->isReadLocked());
 
@@ -397,6 +397,8 @@ public:
 
     boost::optional<Record> seekNear(const RecordId& start);
 
+    size_t prefetch(const std::vector<RecordId>& ids) override;
+
     void save();
 
     void saveUnpositioned();
@@ -1073,6 +1073,37 @@ TEST(WiredTigerRecordStoreTest, CursorInActiveTxnAfterSeek) {
     }
 }
 
+TEST(WiredTigerRecordStoreTest, PrefetchDoesNotAffectSeeks) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newRecordStore());
+
+    std::vector<RecordId> rids;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        WriteUnitOfWork uow(opCtx.get());
+        for (auto data : {"a", "b", "c"}) {
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), data, 2, Timestamp());
+            ASSERT_OK(res.getStatus());
+            rids.push_back(res.getValue());
+        }
+        uow.commit();
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    // Read ahead out of order, including a record which does not exist.
+    const RecordId missing(rids.back().getLong() + 1);
+    const std::vector<RecordId> hinted{rids[2], rids[0], missing, rids[1]};
+    ASSERT_EQ(hinted.size(), cursor->prefetch(hinted));
+
+    ASSERT_EQ(std::string("c"), cursor->seekExact(rids[2])->data.data());
+    ASSERT_EQ(std::string("a"), cursor->seekExact(rids[0])->data.data());
+    ASSERT_FALSE(cursor->seekExact(missing));
+    ASSERT_EQ(std::string("b"), cursor->seekExact(rids[1])->data.data());
+}
+
 // Verify clustered record stores.
 // This test case complements StorageEngineTest:TemporaryRecordStoreClustered which verifies
 // clustered temporary record stores.
@@ -40,8 +40,10 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/timeseries/timeseries_options.h"
 #include "mongo/platform/compiler.h"
+#include "mongo/stdx/new.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/processinfo.h"
 
 namespace mongo {
 namespace {
@@ -205,19 +207,44 @@ Status getTimeseriesBucketClearedError(const OID& bucketId,
 }
 }  // namespace
 
+/**
+ * Execution stats for a single namespace. Writers only ever increment the counters belonging to
+ * the stripe of the bucket they are operating on, so each stripe's counters live on their own
+ * cache line and concurrent inserts into different stripes never contend. Readers sum the counters
+ * across all stripes when reporting.
+ */
 struct BucketCatalog::ExecutionStats {
-    AtomicWord<long long> numBucketInserts;
-    AtomicWord<long long> numBucketUpdates;
-    AtomicWord<long long> numBucketsOpenedDueToMetadata;
-    AtomicWord<long long> numBucketsClosedDueToCount;
-    AtomicWord<long long> numBucketsClosedDueToSchemaChange;
-    AtomicWord<long long> numBucketsClosedDueToSize;
-    AtomicWord<long long> numBucketsClosedDueToTimeForward;
-    AtomicWord<long long> numBucketsClosedDueToTimeBackward;
-    AtomicWord<long long> numBucketsClosedDueToMemoryThreshold;
-    AtomicWord<long long> numCommits;
-    AtomicWord<long long> numWaits;
-    AtomicWord<long long> numMeasurementsCommitted;
+    struct alignas(stdx::hardware_destructive_interference_size) Counters {
+        AtomicWord<long long> numBucketInserts;
+        AtomicWord<long long> numBucketUpdates;
+        AtomicWord<long long> numBucketsOpenedDueToMetadata;
+        AtomicWord<long long> numBucketsClosedDueToCount;
+        AtomicWord<long long> numBucketsClosedDueToSchemaChange;
+        AtomicWord<long long> numBucketsClosedDueToSize;
+        AtomicWord<long long> numBucketsClosedDueToTimeForward;
+        AtomicWord<long long> numBucketsClosedDueToTimeBackward;
+        AtomicWord<long long> numBucketsClosedDueToMemoryThreshold;
+        AtomicWord<long long> numCommits;
+        AtomicWord<long long> numWaits;
+        AtomicWord<long long> numMeasurementsCommitted;
+    };
+
+    explicit ExecutionStats(std::size_t numberOfStripes) : _counters(numberOfStripes) {}
+
+    Counters& forStripe(StripeNumber stripe) {
+        return _counters[stripe];
+    }
+
+    long long sum(AtomicWord<long long> Counters::*counter) const {
+        long long total = 0;
+        for (const auto& counters : _counters) {
+            total += (counters.*counter).load();
+        }
+        return total;
+    }
+
+private:
+    std::vector<Counters> _counters;
 };
 
 class BucketCatalog::Bucket {
@@ -438,7 +465,7 @@ bool BucketCatalog::WriteBatch::claimCommitRights() {
 
 StatusWith<BucketCatalog::CommitInfo> BucketCatalog::WriteBatch::getResult() const {
     if (!_promise.getFuture().isReady()) {
-        _stats->numWaits.fetchAndAddRelaxed(1);
+        _stats->forStripe(_bucket.stripe).numWaits.fetchAndAddRelaxed(1);
     }
     return _promise.getFuture().getNoThrow();
 }
@@ -551,6 +578,14 @@ BucketCatalog& BucketCatalog::get(OperationContext* opCtx) {
     return get(opCtx->getServiceContext());
 }
 
+BucketCatalog::BucketCatalog()
+    : _stripes(std::clamp(std::size_t{2} * ProcessInfo::getNumAvailableCores(),
+                          kMinNumberOfStripes,
+                          kMaxNumberOfStripes)),
+      _bucketStates(_stripes.size()) {}
+
+BucketCatalog::~BucketCatalog() = default;
+
 BSONObj BucketCatalog::getMetadata(const BucketHandle& handle) const {
     auto const& stripe = _stripes[handle.stripe];
     stdx::lock_guard stripeLock{stripe.mutex};
@@ -579,9 +614,6 @@ StatusWith<BucketCatalog::InsertResult> BucketCatalog::insert(
     }
     auto time = timeElem.Date();
 
-    auto stats = _getExecutionStats(ns);
-    invariant(stats);
-
     BSONElement metadata;
     auto metaFieldName = options.getMetaField();
     if (metaFieldName) {
@@ -593,12 +625,16 @@ StatusWith<BucketCatalog::InsertResult> BucketCatalog::insert(
     auto key = BucketKey{ns, BucketMetadata{metadata, comparator}};
     auto stripeNumber = _getStripeNumber(key);
 
-    ClosedBuckets closedBuckets;
-    CreationInfo info{key, stripeNumber, time, options, stats.get(), &closedBuckets};
-
     auto& stripe = _stripes[stripeNumber];
     stdx::lock_guard stripeLock{stripe.mutex};
 
+    auto stats = _getExecutionStats(&stripe, stripeLock, ns);
+    invariant(stats);
+    auto& counters = stats->forStripe(stripeNumber);
+
+    ClosedBuckets closedBuckets;
+    CreationInfo info{key, stripeNumber, time, options, stats.get(), &closedBuckets};
+
     Bucket* bucket = _useOrCreateBucket(&stripe, stripeLock, info);
     invariant(bucket);
 
@@ -613,24 +649,24 @@ StatusWith<BucketCatalog::InsertResult> BucketCatalog::insert(
 
     auto shouldCloseBucket = [&](Bucket* bucket) -> bool {
         if (bucket->schemaIncompatible(doc, metaFieldName, comparator)) {
-            stats->numBucketsClosedDueToSchemaChange.fetchAndAddRelaxed(1);
+            counters.numBucketsClosedDueToSchemaChange.fetchAndAddRelaxed(1);
             return true;
         }
         if (bucket->_numMeasurements == static_cast<std::uint64_t>(gTimeseriesBucketMaxCount)) {
-            stats->numBucketsClosedDueToCount.fetchAndAddRelaxed(1);
+            counters.numBucketsClosedDueToCount.fetchAndAddRelaxed(1);
             return true;
         }
         if (bucket->_size + sizeToBeAdded > static_cast<std::uint64_t>(gTimeseriesBucketMaxSize)) {
-            stats->numBucketsClosedDueToSize.fetchAndAddRelaxed(1);
+            counters.numBucketsClosedDueToSize.fetchAndAddRelaxed(1);
             return true;
         }
         auto bucketTime = bucket->getTime();
         if (time - bucketTime >= Seconds(*options.getBucketMaxSpanSeconds())) {
-            stats->numBucketsClosedDueToTimeForward.fetchAndAddRelaxed(1);
+            counters.numBucketsClosedDueToTimeForward.fetchAndAddRelaxed(1);
             return true;
         }
         if (time < bucketTime) {
-            stats->numBucketsClosedDueToTimeBackward.fetchAndAddRelaxed(1);
+            counters.numBucketsClosedDueToTimeBackward.fetchAndAddRelaxed(1);
             return true;
         }
         return false;
@@ -726,15 +762,15 @@ boost::optional<BucketCatalog::ClosedBucket> BucketCatalog::finish(
         bucket->_preparedBatch.reset();
     }
 
-    auto& stats = batch->_stats;
-    stats->numCommits.fetchAndAddRelaxed(1);
+    auto& counters = batch->_stats->forStripe(batch->bucket().stripe);
+    counters.numCommits.fetchAndAddRelaxed(1);
     if (batch->numPreviouslyCommittedMeasurements() == 0) {
-        stats->numBucketInserts.fetchAndAddRelaxed(1);
+        counters.numBucketInserts.fetchAndAddRelaxed(1);
     } else {
-        stats->numBucketUpdates.fetchAndAddRelaxed(1);
+        counters.numBucketUpdates.fetchAndAddRelaxed(1);
     }
 
-    stats->numMeasurementsCommitted.fetchAndAddRelaxed(batch->measurements().size());
+    counters.numMeasurementsCommitted.fetchAndAddRelaxed(batch->measurements().size());
     if (bucket) {
         bucket->_numCommittedMeasurements += batch->measurements().size();
     }
@@ -805,6 +841,7 @@ void BucketCatalog::clear(const OID& oid) {
 }
 
 void BucketCatalog::clear(const std::function<bool(const NamespaceString&)>& shouldClear) {
+    stdx::unordered_set<NamespaceString> clearedNamespaces;
     for (auto& stripe : _stripes) {
         stdx::lock_guard stripeLock{stripe.mutex};
         for (auto it = stripe.allBuckets.begin(); it != stripe.allBuckets.end();) {
@@ -812,10 +849,7 @@ void BucketCatalog::clear(const std::function<bool(const NamespaceString&)>& sho
 
             const auto& bucket = it->second;
             if (shouldClear(bucket->_ns)) {
-                {
-                    stdx::lock_guard catalogLock{_mutex};
-                    _executionStats.erase(bucket->_ns);
-                }
+                clearedNamespaces.insert(bucket->_ns);
                 _abort(&stripe,
                        stripeLock,
                        bucket.get(),
@@ -826,6 +860,26 @@ void BucketCatalog::clear(const std::function<bool(const NamespaceString&)>& sho
             it = nextIt;
         }
     }
+
+    if (clearedNamespaces.empty()) {
+        return;
+    }
+
+    {
+        stdx::lock_guard catalogLock{_mutex};
+        for (const auto& ns : clearedNamespaces) {
+            _executionStats.erase(ns);
+        }
+    }
+
+    // Drop the stripe-local references only after the stats have been removed from the catalog,
+    // so that a concurrent insert cannot re-cache the stats we are discarding.
+    for (auto& stripe : _stripes) {
+        stdx::lock_guard stripeLock{stripe.mutex};
+        for (const auto& ns : clearedNamespaces) {
+            stripe.executionStats.erase(ns);
+        }
+    }
 }
 
 void BucketCatalog::clear(const NamespaceString& ns) {
@@ -837,26 +891,29 @@ void BucketCatalog::clear(StringData dbName) {
 }
 
 void BucketCatalog::appendExecutionStats(const NamespaceString& ns, BSONObjBuilder* builder) const {
+    using Counters = ExecutionStats::Counters;
     const auto stats = _getExecutionStats(ns);
 
-    builder->appendNumber("numBucketInserts", stats->numBucketInserts.load());
-    builder->appendNumber("numBucketUpdates", stats->numBucketUpdates.load());
+    builder->appendNumber("numBucketInserts", stats->sum(&Counters::numBucketInserts));
+    builder->appendNumber("numBucketUpdates", stats->sum(&Counters::numBucketUpdates));
     builder->appendNumber("numBucketsOpenedDueToMetadata",
-                          stats->numBucketsOpenedDueToMetadata.load());
-    builder->appendNumber("numBucketsClosedDueToCount", stats->numBucketsClosedDueToCount.load());
+                          stats->sum(&Counters::numBucketsOpenedDueToMetadata));
+    builder->appendNumber("numBucketsClosedDueToCount",
+                          stats->sum(&Counters::numBucketsClosedDueToCount));
     builder->appendNumber("numBucketsClosedDueToSchemaChange",
-                          stats->numBucketsClosedDueToSchemaChange.load());
-    builder->appendNumber("numBucketsClosedDueToSize", stats->numBucketsClosedDueToSize.load());
+                          stats->sum(&Counters::numBucketsClosedDueToSchemaChange));
+    builder->appendNumber("numBucketsClosedDueToSize",
+                          stats->sum(&Counters::numBucketsClosedDueToSize));
     builder->appendNumber("numBucketsClosedDueToTimeForward",
-                          stats->numBucketsClosedDueToTimeForward.load());
+                          stats->sum(&Counters::numBucketsClosedDueToTimeForward));
     builder->appendNumber("numBucketsClosedDueToTimeBackward",
-                          stats->numBucketsClosedDueToTimeBackward.load());
+                          stats->sum(&Counters::numBucketsClosedDueToTimeBackward));
     builder->appendNumber("numBucketsClosedDueToMemoryThreshold",
-                          stats->numBucketsClosedDueToMemoryThreshold.load());
-    auto commits = stats->numCommits.load();
+                          stats->sum(&Counters::numBucketsClosedDueToMemoryThreshold));
+    auto commits = stats->sum(&Counters::numCommits);
     builder->appendNumber("numCommits", commits);
-    builder->appendNumber("numWaits", stats->numWaits.load());
-    auto measurementsCommitted = stats->numMeasurementsCommitted.load();
+    builder->appendNumber("numWaits", stats->sum(&Counters::numWaits));
+    auto measurementsCommitted = stats->sum(&Counters::numMeasurementsCommitted);
     builder->appendNumber("numMeasurementsCommitted", measurementsCommitted);
     if (commits) {
         builder->appendNumber("avgNumMeasurementsPerCommit", measurementsCommitted / commits);
@@ -902,7 +959,7 @@ std::size_t BucketCatalog::BucketHasher::operator()(const BucketKey& key) const
 }
 
 BucketCatalog::StripeNumber BucketCatalog::_getStripeNumber(const BucketKey& key) {
-    return key.hash % kNumberOfStripes;
+    return key.hash % _stripes.size();
 }
 
 const BucketCatalog::Bucket* BucketCatalog::_findBucket(const Stripe& stripe,
@@ -1078,8 +1135,9 @@ void BucketCatalog::_markBucketNotIdle(Stripe* stripe, WithLock stripeLock, Buck
 
 void BucketCatalog::_expireIdleBuckets(Stripe* stripe,
                                        WithLock stripeLock,
-                                       ExecutionStats* stats,
-                                       std::vector<BucketCatalog::ClosedBucket>* closedBuckets) {
+                                       const CreationInfo& info) {
+    auto& counters = info.stats->forStripe(info.stripe);
+
     // As long as we still need space and have entries and remaining attempts, close idle buckets.
     int32_t numClosed = 0;
     while (!stripe->idleBuckets.empty() &&
@@ -1090,8 +1148,8 @@ void BucketCatalog::_expireIdleBuckets(Stripe* stripe,
             bucket->id(), bucket->getTimeField().toString(), bucket->numMeasurements()};
 
         if (_removeBucket(stripe, stripeLock, bucket)) {
-            stats->numBucketsClosedDueToMemoryThreshold.fetchAndAddRelaxed(1);
-            closedBuckets->push_back(closed);
+            counters.numBucketsClosedDueToMemoryThreshold.fetchAndAddRelaxed(1);
+            info.closedBuckets->push_back(closed);
             ++numClosed;
         }
     }
@@ -1100,7 +1158,7 @@ void BucketCatalog::_expireIdleBuckets(Stripe* stripe,
 BucketCatalog::Bucket* BucketCatalog::_allocateBucket(Stripe* stripe,
                                                       WithLock stripeLock,
                                                       const CreationInfo& info) {
-    _expireIdleBuckets(stripe, stripeLock, info.stats, info.closedBuckets);
+    _expireIdleBuckets(stripe, stripeLock, info);
 
     auto [bucketId, roundedTime] = generateBucketId(info.time, info.options);
 
@@ -1112,7 +1170,7 @@ BucketCatalog::Bucket* BucketCatalog::_allocateBucket(Stripe* stripe,
     _initializeBucketState(bucketId);
 
     if (info.openedDuetoMetadata) {
-        info.stats->numBucketsOpenedDueToMetadata.fetchAndAddRelaxed(1);
+        info.stats->forStripe(info.stripe).numBucketsOpenedDueToMetadata.fetchAndAddRelaxed(1);
     }
 
     bucket->_timeField = info.options.getTimeField().toString();
@@ -1148,20 +1206,30 @@ BucketCatalog::Bucket* BucketCatalog::_rollover(Stripe* stripe,
 }
 
 std::shared_ptr<BucketCatalog::ExecutionStats> BucketCatalog::_getExecutionStats(
-    const NamespaceString& ns) {
-    stdx::lock_guard catalogLock{_mutex};
-    auto it = _executionStats.find(ns);
-    if (it != _executionStats.end()) {
-        return it->second;
+    Stripe* stripe, WithLock stripeLock, const NamespaceString& ns) {
+    auto cached = stripe->executionStats.find(ns);
+    if (cached != stripe->executionStats.end()) {
+        return cached->second;
+    }
+
+    std::shared_ptr<ExecutionStats> stats;
+    {
+        stdx::lock_guard catalogLock{_mutex};
+        auto it = _executionStats.find(ns);
+        if (it == _executionStats.end()) {
+            it = _executionStats.emplace(ns, std::make_shared<ExecutionStats>(_stripes.size()))
+                     .first;
+        }
+        stats = it->second;
     }
 
-    auto res = _executionStats.emplace(ns, std::make_shared<ExecutionStats>());
-    return res.first->second;
+    stripe->executionStats.emplace(ns, stats);
+    return stats;
 }
 
 const std::shared_ptr<BucketCatalog::ExecutionStats> BucketCatalog::_getExecutionStats(
     const NamespaceString& ns) const {
-    static const auto kEmptyStats{std::make_shared<ExecutionStats>()};
+    static const auto kEmptyStats{std::make_shared<ExecutionStats>(1)};
 
     stdx::lock_guard catalogLock{_mutex};
 
@@ -1172,27 +1240,35 @@ const std::shared_ptr<BucketCatalog::ExecutionStats> BucketCatalog::_getExecutio
     return kEmptyStats;
 }
 
+BucketCatalog::BucketStateShard& BucketCatalog::_getBucketStateShard(const OID& id) const {
+    return _bucketStates[OID::Hasher{}(id) % _bucketStates.size()];
+}
+
 void BucketCatalog::_initializeBucketState(const OID& id) {
-    stdx::lock_guard catalogLock{_mutex};
-    _bucketStates.emplace(id, BucketState::kNormal);
+    auto& shard = _getBucketStateShard(id);
+    stdx::lock_guard shardLock{shard.mutex};
+    shard.states.emplace(id, BucketState::kNormal);
 }
 
 void BucketCatalog::_eraseBucketState(const OID& id) {
-    stdx::lock_guard catalogLock{_mutex};
-    _bucketStates.erase(id);
+    auto& shard = _getBucketStateShard(id);
+    stdx::lock_guard shardLock{shard.mutex};
+    shard.states.erase(id);
 }
 
 boost::optional<BucketCatalog::BucketState> BucketCatalog::_getBucketState(const OID& id) const {
-    stdx::lock_guard catalogLock{_mutex};
-    auto it = _bucketStates.find(id);
-    return it != _bucketStates.end() ? boost::make_optional(it->second) : boost::none;
+    auto& shard = _getBucketStateShard(id);
+    stdx::lock_guard shardLock{shard.mutex};
+    auto it = shard.states.find(id);
+    return it != shard.states.end() ? boost::make_optional(it->second) : boost::none;
 }
 
 boost::optional<BucketCatalog::BucketState> BucketCatalog::_setBucketState(const OID& id,
                                                                            BucketState target) {
-    stdx::lock_guard catalogLock{_mutex};
-    auto it = _bucketStates.find(id);
-    if (it == _bucketStates.end()) {
+    auto& shard = _getBucketStateShard(id);
+    stdx::lock_guard shardLock{shard.mutex};
+    auto it = shard.states.find(id);
+    if (it == shard.states.end()) {
         return boost::none;
     }
 
@@ -31,6 +31,7 @@
 
 #include <boost/container/small_vector.hpp>
 #include <boost/container/static_vector.hpp>
+#include <limits>
 #include <queue>
 
 #include "mongo/bson/unordered_fields_bsonobj_comparator.h"
@@ -188,7 +189,8 @@ public:
     static BucketCatalog& get(ServiceContext* svcCtx);
     static BucketCatalog& get(OperationContext* opCtx);
 
-    BucketCatalog() = default;
+    BucketCatalog();
+    ~BucketCatalog();
 
     BucketCatalog(const BucketCatalog&) = delete;
     BucketCatalog operator=(const BucketCatalog&) = delete;
@@ -356,6 +358,22 @@ private:
         // Buckets that do not have any outstanding writes.
         using IdleList = std::list<Bucket*>;
         IdleList idleBuckets;
+
+        // Stripe-local cache of the per-namespace execution stats, so that inserts only need to
+        // take the catalog-wide '_mutex' the first time a namespace is seen on this stripe.
+        stdx::unordered_map<NamespaceString, std::shared_ptr<ExecutionStats>> executionStats;
+    };
+
+    /**
+     * Struct to hold a portion of the bucket states tracked by the catalog. Bucket states are
+     * spread across shards by bucket id so that lookups from different stripes do not serialize on
+     * a single mutex.
+     */
+    struct BucketStateShard {
+        mutable Mutex mutex = MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0),
+                                               "BucketCatalog::BucketStateShard::mutex");
+
+        stdx::unordered_map<OID, BucketState, OID::Hasher> states;
     };
 
     StripeNumber _getStripeNumber(const BucketKey& key);
@@ -440,10 +458,7 @@ private:
      * Expires idle buckets until the bucket catalog's memory usage is below the expiry
      * threshold.
      */
-    void _expireIdleBuckets(Stripe* stripe,
-                            WithLock stripeLock,
-                            ExecutionStats* stats,
-                            ClosedBuckets* closedBuckets);
+    void _expireIdleBuckets(Stripe* stripe, WithLock stripeLock, const CreationInfo& info);
 
     /**
      * Allocates a new bucket and adds it to the catalog.
@@ -460,9 +475,17 @@ private:
                       Bucket* bucket,
                       const CreationInfo& info);
 
-    std::shared_ptr<ExecutionStats> _getExecutionStats(const NamespaceString& ns);
+    /**
+     * Returns the execution stats for the given namespace, creating them if necessary. Consults
+     * the stripe-local cache before falling back to the catalog-wide map.
+     */
+    std::shared_ptr<ExecutionStats> _getExecutionStats(Stripe* stripe,
+                                                       WithLock stripeLock,
+                                                       const NamespaceString& ns);
     const std::shared_ptr<ExecutionStats> _getExecutionStats(const NamespaceString& ns) const;
 
+    BucketStateShard& _getBucketStateShard(const OID& id) const;
+
     /**
      * Retreives the bucket state if it is tracked in the catalog.
      */
@@ -488,18 +511,24 @@ private:
      */
     boost::optional<BucketState> _setBucketState(const OID& id, BucketState target);
 
-    static constexpr std::size_t kNumberOfStripes = 32;
-    std::array<Stripe, kNumberOfStripes> _stripes;
+    // The number of stripes scales with the number of cores available to the process, within
+    // these bounds. The upper bound must be representable as a StripeNumber.
+    static constexpr std::size_t kMinNumberOfStripes = 32;
+    static constexpr std::size_t kMaxNumberOfStripes =
+        std::size_t{std::numeric_limits<StripeNumber>::max()} + 1;
+    std::vector<Stripe> _stripes;
+
+    // Bucket state for synchronization with direct writes, sharded by bucket id. Each shard is
+    // protected by its own mutex.
+    mutable std::vector<BucketStateShard> _bucketStates;
 
     mutable Mutex _mutex =
         MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0), "BucketCatalog::_mutex");
 
-    // Bucket state for synchronization with direct writes, protected by '_mutex'
-    stdx::unordered_map<OID, BucketState, OID::Hasher> _bucketStates;
-
     // Per-namespace execution stats. This map is protected by '_mutex'. Once you complete your
     // lookup, you can keep the shared_ptr to an individual namespace's stats object and release the
-    // lock. The object itself is thread-safe (using atomics).
+    // lock. The object itself is thread-safe (using atomics), and its counters are striped so that
+    // writers on different stripes do not contend on the same cache lines.
     stdx::unordered_map<NamespaceString, std::shared_ptr<ExecutionStats>> _executionStats;
 
     // Approximate memory usage of the bucket catalog.
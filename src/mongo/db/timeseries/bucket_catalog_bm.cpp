@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/db/timeseries/timeseries_options.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss{"test", "system.buckets.ts"};
+
+class BucketCatalogBenchmark : public benchmark::Fixture {
+public:
+    void SetUp(benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            catalog = std::make_unique<BucketCatalog>();
+            options.setMetaField("meta"_sd);
+            options.setBucketMaxSpanSeconds(
+                timeseries::getMaxSpanSecondsFromGranularity(options.getGranularity()));
+        }
+    }
+
+    void TearDown(benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            catalog.reset();
+        }
+    }
+
+    /**
+     * Inserts 'doc' into the catalog and commits the resulting batch, or waits for the batch to be
+     * committed if another thread claimed the commit rights first.
+     */
+    void insertAndCommit(const BSONObj& doc) {
+        auto result = uassertStatusOK(
+            catalog->insert(nullptr,
+                            kNss,
+                            nullptr,
+                            options,
+                            doc,
+                            BucketCatalog::CombineWithInsertsFromOtherClients::kAllow));
+        auto& batch = result.batch;
+        if (batch->claimCommitRights()) {
+            uassertStatusOK(catalog->prepareCommit(batch));
+            catalog->finish(batch, {});
+        } else {
+            uassertStatusOK(batch->getResult());
+        }
+    }
+
+protected:
+    std::unique_ptr<BucketCatalog> catalog;
+    TimeseriesOptions options{"time"};
+};
+
+/**
+ * Each thread inserts measurements for its own metadata value, so the threads spread across
+ * stripes and only share the per-namespace state of the catalog.
+ */
+BENCHMARK_DEFINE_F(BucketCatalogBenchmark, BM_InsertDistinctMeta)(benchmark::State& state) {
+    auto doc = BSON("time" << Date_t::now() << "meta" << state.thread_index << "value" << 1.0);
+
+    for (auto keepRunning : state) {
+        insertAndCommit(doc);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * All threads insert measurements with the same metadata value, so they contend on a single
+ * stripe and share write batches.
+ */
+BENCHMARK_DEFINE_F(BucketCatalogBenchmark, BM_InsertSameMeta)(benchmark::State& state) {
+    auto doc = BSON("time" << Date_t::now() << "meta" << 0 << "value" << 1.0);
+
+    for (auto keepRunning : state) {
+        insertAndCommit(doc);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(BucketCatalogBenchmark, BM_InsertDistinctMeta)
+    ->ThreadRange(1, ProcessInfo::getNumAvailableCores());
+BENCHMARK_REGISTER_F(BucketCatalogBenchmark, BM_InsertSameMeta)
+    ->ThreadRange(1, ProcessInfo::getNumAvailableCores());
+
+}  // namespace
+}  // namespace mongo
@@ -491,6 +491,40 @@ TEST_F(BucketCatalogTest, ClearDatabaseBuckets) {
     _insertOneAndCommit(_ns3, 1);
 }
 
+TEST_F(BucketCatalogTest, ExecutionStatsAggregateAcrossStripes) {
+    // Measurements with distinct metadata land in buckets spread across the stripes, each of
+    // which tracks its own counters. The reported stats should be the sum over all stripes.
+    const int numMeta = 100;
+    for (int i = 0; i < numMeta; ++i) {
+        auto result =
+            _bucketCatalog->insert(_opCtx,
+                                   _ns1,
+                                   _getCollator(_ns1),
+                                   _getTimeseriesOptions(_ns1),
+                                   BSON(_timeField << Date_t::now() << _metaField << i),
+                                   BucketCatalog::CombineWithInsertsFromOtherClients::kAllow);
+        _commit(result.getValue().batch, 0);
+    }
+
+    BSONObjBuilder builder;
+    _bucketCatalog->appendExecutionStats(_ns1, &builder);
+    auto stats = builder.obj();
+    ASSERT_EQ(numMeta, stats.getIntField("numBucketsOpenedDueToMetadata"));
+    ASSERT_EQ(numMeta, stats.getIntField("numBucketInserts"));
+    ASSERT_EQ(numMeta, stats.getIntField("numCommits"));
+    ASSERT_EQ(numMeta, stats.getIntField("numMeasurementsCommitted"));
+
+    // Clearing the namespace discards its stats on every stripe.
+    _bucketCatalog->clear(_ns1);
+    _insertOneAndCommit(_ns1, 0);
+
+    BSONObjBuilder clearedBuilder;
+    _bucketCatalog->appendExecutionStats(_ns1, &clearedBuilder);
+    auto clearedStats = clearedBuilder.obj();
+    ASSERT_EQ(1, clearedStats.getIntField("numBucketsOpenedDueToMetadata"));
+    ASSERT_EQ(1, clearedStats.getIntField("numCommits"));
+}
+
 TEST_F(BucketCatalogTest, InsertBetweenPrepareAndFinish) {
     auto batch1 = _bucketCatalog
                       ->insert(_opCtx,
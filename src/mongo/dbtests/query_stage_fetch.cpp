@@ -47,6 +47,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/idl/server_parameter_test_util.h"
 
 namespace QueryStageFetch {
 
@@ -226,6 +227,70 @@ public:
     }
 };
 
+//
+// Test that read-ahead returns the members in the order the child produced them.
+//
+class FetchStageReadAhead : public QueryStageFetchBase {
+public:
+    void run() {
+        RAIIServerParameterControllerForTest readAheadDepth("internalQueryFetchReadAheadDepth", 4);
+
+        dbtests::WriteContextForTests ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        CollectionPtr coll =
+            CollectionCatalog::get(&_opCtx)->lookupCollectionByNamespace(&_opCtx, nss());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, nss());
+            wuow.commit();
+        }
+
+        const int numDocs = 10;
+        for (int i = 0; i < numDocs; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(numDocs), recordIds.size());
+
+        // Return the records in the reverse of their insertion order, so that the order of the
+        // results is not an accident of the storage layout.
+        WorkingSet ws;
+        auto mockStage = std::make_unique<QueuedDataStage>(_expCtx.get(), &ws);
+        for (auto it = recordIds.rbegin(); it != recordIds.rend(); ++it) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = *it;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+        }
+
+        auto fetchStage =
+            std::make_unique<FetchStage>(_expCtx.get(), &ws, std::move(mockStage), nullptr, coll);
+
+        std::vector<int> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state;
+        while ((state = fetchStage->work(&id)) != PlanStage::IS_EOF) {
+            if (state == PlanStage::ADVANCED) {
+                results.push_back(ws.get(id)->doc.value()["foo"].getInt());
+                ws.free(id);
+            } else {
+                ASSERT_EQUALS(PlanStage::NEED_TIME, state);
+            }
+        }
+
+        ASSERT_EQUALS(size_t(numDocs), results.size());
+        for (int i = 0; i < numDocs; ++i) {
+            ASSERT_EQUALS(numDocs - 1 - i, results[i]);
+        }
+
+        auto stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_EQUALS(size_t(numDocs), stats->docsExamined);
+        ASSERT_LTE(stats->docsPrefetched, size_t(numDocs));
+    }
+};
+
 class All : public OldStyleSuiteSpecification {
 public:
     All() : OldStyleSuiteSpecification("query_stage_fetch") {}
@@ -233,6 +298,7 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageReadAhead>();
     }
 };
 
@@ -47,6 +47,7 @@
 #include "mongo/util/assert_util.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
 #include "mongo/util/hierarchical_acquisition.h"
 
 namespace mongo {
@@ -598,33 +599,63 @@ void ThreadPool::Impl::_setState_inlock(const LifecycleState newState) {
 }
 
 // ========================================
-// ThreadPool public functions that simply forward to the `_impl`.
-
-ThreadPool::ThreadPool(Options options) : _impl{std::make_unique<Impl>(std::move(options))} {}
+// ThreadPool public functions that simply forward to the `_impl`, or to the `_workStealingPool` if
+// the pool was configured with `workStealing`.
+
+ThreadPool::ThreadPool(Options options) {
+    if (options.workStealing) {
+        _workStealingPool = std::make_unique<WorkStealingThreadPool>(std::move(options));
+    } else {
+        _impl = std::make_unique<Impl>(std::move(options));
+    }
+}
 
 ThreadPool::~ThreadPool() = default;
 
 void ThreadPool::startup() {
-    _impl->startup();
+    if (_workStealingPool) {
+        _workStealingPool->startup();
+    } else {
+        _impl->startup();
+    }
 }
 
 void ThreadPool::shutdown() {
-    _impl->shutdown();
+    if (_workStealingPool) {
+        _workStealingPool->shutdown();
+    } else {
+        _impl->shutdown();
+    }
 }
 
 void ThreadPool::join() {
-    _impl->join();
+    if (_workStealingPool) {
+        _workStealingPool->join();
+    } else {
+        _impl->join();
+    }
 }
 
 void ThreadPool::schedule(Task task) {
-    _impl->schedule(std::move(task));
+    if (_workStealingPool) {
+        _workStealingPool->schedule(std::move(task));
+    } else {
+        _impl->schedule(std::move(task));
+    }
 }
 
 void ThreadPool::waitForIdle() {
-    _impl->waitForIdle();
+    if (_workStealingPool) {
+        _workStealingPool->waitForIdle();
+    } else {
+        _impl->waitForIdle();
+    }
 }
 
 ThreadPool::Stats ThreadPool::getStats() const {
+    if (_workStealingPool) {
+        return _workStealingPool->getStats();
+    }
     return _impl->getStats();
 }
 
@@ -40,6 +40,8 @@
 
 namespace mongo {
 
+class WorkStealingThreadPool;
+
 /**
  * A configurable thread pool, for general use.
  *
@@ -109,6 +111,13 @@ public:
          * avoid complex logic in the callback.
          */
         std::function<void(const stdx::thread&)> onJoinRetiredThread;
+
+        /**
+         * If set, tasks run on a WorkStealingThreadPool with per-thread queues instead of a single
+         * queue shared by all threads. Such a pool always runs 'maxThreads' threads, which must be
+         * bounded, and ignores 'minThreads', 'maxIdleThreadAge' and 'onJoinRetiredThread'.
+         */
+        bool workStealing = false;
     };
 
     /**
@@ -169,6 +178,7 @@ public:
 private:
     class Impl;
     std::unique_ptr<Impl> _impl;
+    std::unique_ptr<WorkStealingThreadPool> _workStealingPool;
 };
 
 }  // namespace mongo
@@ -0,0 +1,321 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+
+#include <fmt/format.h>
+
+#include "mongo/base/status.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_name.h"
+
+namespace mongo {
+
+namespace {
+
+using namespace fmt::literals;
+
+// Counter used to assign unique names to otherwise-unnamed pools.
+AtomicWord<int> nextUnnamedPoolId{1};
+
+// The pool and queue of the worker running on this thread, if any. Used to keep tasks scheduled by
+// a task on the worker that scheduled them.
+thread_local const WorkStealingThreadPool* currentPool = nullptr;
+thread_local size_t currentWorkerId = 0;
+
+ThreadPool::Options cleanUpOptions(ThreadPool::Options&& options) {
+    if (options.poolName.empty()) {
+        options.poolName = "WorkStealingThreadPool{}"_format(nextUnnamedPoolId.fetchAndAdd(1));
+    }
+    if (options.threadNamePrefix.empty()) {
+        options.threadNamePrefix = "{}-"_format(options.poolName);
+    }
+    if (options.maxThreads < 1 || options.maxThreads == ThreadPool::Options::kUnlimited) {
+        LOGV2_FATAL(6713000,
+                    "Cannot create work-stealing pool {poolName} with {maxThreads} threads",
+                    "Cannot create work-stealing pool with less than 1 or unlimited threads",
+                    "poolName"_attr = options.poolName,
+                    "maxThreads"_attr = options.maxThreads);
+    }
+    return {std::move(options)};
+}
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(ThreadPool::Options options)
+    : _options(cleanUpOptions(std::move(options))) {
+    _queues.reserve(_options.maxThreads);
+    for (size_t i = 0; i < _options.maxThreads; ++i) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    stdx::unique_lock<Latch> lk(_mutex);
+    _shutdown_inlock();
+    if (_state != shutdownComplete) {
+        _join_inlock(&lk);
+    }
+
+    if (_state != shutdownComplete) {
+        LOGV2_FATAL(6713001, "Failed to shutdown pool during destruction");
+    }
+    invariant(_threads.empty());
+    invariant(_numPendingTasks.load() == 0);
+}
+
+void WorkStealingThreadPool::startup() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_state != preStart) {
+        LOGV2_FATAL(6713002,
+                    "Attempted to start pool {poolName}, but it has already started",
+                    "Attempted to start pool that has already started",
+                    "poolName"_attr = _options.poolName);
+    }
+    _setState_inlock(running);
+    invariant(_threads.empty());
+    for (size_t i = 0; i < _queues.size(); ++i) {
+        _threads.emplace_back([this, i, threadName = "{}{}"_format(_options.threadNamePrefix, i)] {
+            _workerThreadBody(i, threadName);
+        });
+    }
+}
+
+void WorkStealingThreadPool::shutdown() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _shutdown_inlock();
+}
+
+void WorkStealingThreadPool::_shutdown_inlock() {
+    switch (_state) {
+        case preStart:
+        case running:
+            // Close the queues first, so that no task can be scheduled once the workers see the
+            // new state.
+            for (auto& queue : _queues) {
+                stdx::lock_guard<Latch> queueLk(queue->mutex);
+                queue->closed = true;
+            }
+            _setState_inlock(joinRequired);
+            _workAvailable.notify_all();
+            return;
+        case joinRequired:
+        case joining:
+        case shutdownComplete:
+            return;
+    }
+    MONGO_UNREACHABLE;
+}
+
+void WorkStealingThreadPool::join() {
+    stdx::unique_lock<Latch> lk(_mutex);
+    _join_inlock(&lk);
+}
+
+void WorkStealingThreadPool::_join_inlock(stdx::unique_lock<Latch>* lk) {
+    _stateChange.wait(*lk, [this] { return _state != preStart && _state != running; });
+    if (_state != joinRequired) {
+        LOGV2_FATAL(6713003,
+                    "Attempted to join pool {poolName} more than once",
+                    "Attempted to join pool more than once",
+                    "poolName"_attr = _options.poolName);
+    }
+
+    _setState_inlock(joining);
+    auto threadsToJoin = std::exchange(_threads, {});
+    lk->unlock();
+    for (auto& t : threadsToJoin) {
+        t.join();
+    }
+
+    // Tasks are left over if the pool was never started.
+    if (_numPendingTasks.load() > 0) {
+        _drainPendingTasks();
+    }
+    lk->lock();
+    invariant(_state == joining);
+    _setState_inlock(shutdownComplete);
+}
+
+void WorkStealingThreadPool::_drainPendingTasks() {
+    // Tasks cannot be run inline because they can create OperationContexts and the join() caller
+    // may already have one associated with the thread.
+    stdx::thread cleanThread = stdx::thread([&] {
+        const std::string threadName = "{}{}"_format(_options.threadNamePrefix, _queues.size());
+        setThreadName(threadName);
+        if (_options.onCreateThread)
+            _options.onCreateThread(threadName);
+        while (_runOneTask(0)) {
+        }
+    });
+    cleanThread.join();
+}
+
+void WorkStealingThreadPool::schedule(Task task) {
+    const bool onWorker = currentPool == this;
+    auto& queue = *_queues[onWorker ? currentWorkerId
+                                    : _nextQueue.fetchAndAdd(1) % _queues.size()];
+    {
+        stdx::unique_lock<Latch> queueLk(queue.mutex);
+        if (queue.closed) {
+            queueLk.unlock();
+            task(Status(ErrorCodes::ShutdownInProgress,
+                        "Shutdown of thread pool {} in progress"_format(_options.poolName)));
+            return;
+        }
+        _numOutstandingTasks.fetchAndAdd(1);
+        _numPendingTasks.fetchAndAdd(1);
+        queue.tasks.emplace_back(std::move(task));
+    }
+
+    // A worker increments '_numSleepingThreads' before checking '_numPendingTasks' for the last
+    // time, so either it sees this task or we see it and wake it up.
+    if (_numSleepingThreads.load() > 0) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _workAvailable.notify_one();
+    }
+}
+
+void WorkStealingThreadPool::waitForIdle() {
+    stdx::unique_lock<Latch> lk(_mutex);
+    // As with ThreadPool, also returns when the pool has been shutdown but not yet joined.
+    _poolIsIdle.wait(
+        lk, [this] { return _numOutstandingTasks.load() == 0 || _state == joinRequired; });
+}
+
+ThreadPool::Stats WorkStealingThreadPool::getStats() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    ThreadPool::Stats result;
+    result.options = _options;
+    result.numThreads = _threads.size();
+    // The counters are not read atomically together, so clamp their differences at zero.
+    const size_t numPendingTasks = _numPendingTasks.load();
+    const size_t numOutstandingTasks = _numOutstandingTasks.load();
+    const size_t numRunningTasks =
+        numOutstandingTasks > numPendingTasks ? numOutstandingTasks - numPendingTasks : 0;
+    result.numIdleThreads =
+        _threads.size() > numRunningTasks ? _threads.size() - numRunningTasks : 0;
+    result.numPendingTasks = numPendingTasks;
+    return result;
+}
+
+void WorkStealingThreadPool::_workerThreadBody(size_t workerId,
+                                               const std::string& threadName) noexcept {
+    setThreadName(threadName);
+    if (_options.onCreateThread)
+        _options.onCreateThread(threadName);
+    LOGV2_DEBUG(6713004,
+                1,
+                "Starting thread {threadName} in pool {poolName}",
+                "Starting thread",
+                "threadName"_attr = threadName,
+                "poolName"_attr = _options.poolName);
+
+    currentPool = this;
+    currentWorkerId = workerId;
+    while (true) {
+        if (_runOneTask(workerId)) {
+            continue;
+        }
+
+        stdx::unique_lock<Latch> lk(_mutex);
+        _numSleepingThreads.fetchAndAdd(1);
+        auto wake = [&] { return _state != running || _numPendingTasks.load() > 0; };
+        {
+            MONGO_IDLE_THREAD_BLOCK;
+            _workAvailable.wait(lk, wake);
+        }
+        _numSleepingThreads.fetchAndSubtract(1);
+
+        // Leftover tasks are run by whichever workers are still around to see them.
+        if (_state != running && _numPendingTasks.load() == 0) {
+            break;
+        }
+    }
+    currentPool = nullptr;
+
+    LOGV2_DEBUG(6713005,
+                1,
+                "Shutting down thread {threadName} in pool {poolName}",
+                "Shutting down thread",
+                "threadName"_attr = threadName,
+                "poolName"_attr = _options.poolName);
+}
+
+bool WorkStealingThreadPool::_runOneTask(size_t workerId) noexcept {
+    Task task;
+    for (size_t i = 0; i < _queues.size() && !task; ++i) {
+        auto& queue = *_queues[(workerId + i) % _queues.size()];
+        stdx::lock_guard<Latch> queueLk(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        // Run our own tasks in the order they were scheduled, but steal the newest task of
+        // another worker, which is the one that worker would get to last.
+        if (i == 0) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+    _numPendingTasks.fetchAndSubtract(1);
+
+    // Note that if the task throws, the task destructor will run before the exception hits the
+    // noexcept boundary.
+    task(Status::OK());
+
+    // Reset the task and run the dtor before reporting it finished.
+    task = {};
+    if (_numOutstandingTasks.subtractAndFetch(1) == 0) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _poolIsIdle.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingThreadPool::_setState_inlock(const LifecycleState newState) {
+    if (newState == _state) {
+        return;
+    }
+    _state = newState;
+    _stateChange.notify_all();
+}
+
+}  // namespace mongo
@@ -0,0 +1,160 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/new.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/thread_pool_interface.h"
+
+namespace mongo {
+
+/**
+ * A thread pool with a fixed number of worker threads, each of which owns its own queue of tasks.
+ * Tasks scheduled by a worker of the pool go to that worker's queue, other tasks are spread over
+ * the queues round-robin. A worker runs the tasks in its own queue in FIFO order and, once that is
+ * empty, steals the most recently queued task from the other workers' queues. Unlike ThreadPool,
+ * scheduling and running a task never takes a mutex shared by all the workers, and a long task
+ * only delays the tasks queued behind it until another worker runs out of work.
+ *
+ * Configured with ThreadPool::Options. The pool starts 'maxThreads' threads at startup() and keeps
+ * them until join(), so 'minThreads' and 'maxIdleThreadAge' are ignored and 'maxThreads' must be
+ * bounded. Usually used through a ThreadPool constructed with 'workStealing' set.
+ */
+class WorkStealingThreadPool final : public ThreadPoolInterface {
+public:
+    explicit WorkStealingThreadPool(ThreadPool::Options options);
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    ~WorkStealingThreadPool() override;
+
+    // from OutOfLineExecutor (base of ThreadPoolInterface)
+    void schedule(Task task) override;
+
+    // from ThreadPoolInterface
+    void startup() override;
+    void shutdown() override;
+    void join() override;
+
+    /**
+     * Blocks the caller until there are no pending or running tasks on this pool. Has the same
+     * guarantees as ThreadPool::waitForIdle().
+     */
+    void waitForIdle();
+
+    /**
+     * Returns statistics about the thread pool's utilization. 'lastFullUtilizationDate' is not
+     * tracked.
+     */
+    ThreadPool::Stats getStats() const;
+
+private:
+    /**
+     * Representation of the stage of life of the pool. See ThreadPool for the legal transitions.
+     */
+    enum LifecycleState { preStart, running, joinRequired, joining, shutdownComplete };
+
+    /**
+     * A task queue owned by a single worker thread.
+     */
+    struct alignas(stdx::hardware_destructive_interference_size) WorkerQueue {
+        // Guards 'tasks' and 'closed'. Only held while pushing or popping a task.
+        Mutex mutex =
+            MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(0), "WorkStealingThreadPool::Worker");
+        std::deque<Task> tasks;
+        // Set by shutdown(), after which tasks can no longer be pushed to this queue.
+        bool closed = false;
+    };
+
+    /** The thread body for worker thread 'workerId'. */
+    void _workerThreadBody(size_t workerId, const std::string& threadName) noexcept;
+
+    /**
+     * Pops a task from the queue of 'workerId', or steals one from another queue, and runs it.
+     * Returns false if all the queues were empty.
+     */
+    bool _runOneTask(size_t workerId) noexcept;
+
+    /**
+     * Runs the remaining tasks on a new thread as part of the join process, blocking until
+     * complete. Caller must not hold the mutex!
+     */
+    void _drainPendingTasks();
+
+    void _shutdown_inlock();
+    void _join_inlock(stdx::unique_lock<Latch>* lk);
+    void _setState_inlock(LifecycleState newState);
+
+    // These are the options with which the pool was configured at construction time.
+    const ThreadPool::Options _options;
+
+    // One queue per worker thread. Never resized after construction.
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+
+    // Round-robin position for tasks scheduled from outside the pool.
+    AtomicWord<size_t> _nextQueue{0};
+
+    // Number of tasks in '_queues'.
+    AtomicWord<size_t> _numPendingTasks{0};
+
+    // Number of tasks that have been scheduled but have not finished running.
+    AtomicWord<size_t> _numOutstandingTasks{0};
+
+    // Number of workers that are about to wait, or are waiting, on '_workAvailable'.
+    AtomicWord<size_t> _numSleepingThreads{0};
+
+    // Guards the lifecycle state and the worker threads, and is used to put idle workers to sleep.
+    mutable Mutex _mutex =
+        MONGO_MAKE_LATCH(HierarchicalAcquisitionLevel(1), "WorkStealingThreadPool::_mutex");
+
+    LifecycleState _state = preStart;
+
+    // Signaled when a task is scheduled while a worker may be sleeping, or on shutdown.
+    stdx::condition_variable _workAvailable;
+
+    // Signaled when '_numOutstandingTasks' drops to zero.
+    stdx::condition_variable _poolIsIdle;
+
+    // Signaled whenever '_state' changes.
+    stdx::condition_variable _stateChange;
+
+    std::vector<stdx::thread> _threads;
+};
+
+}  // namespace mongo
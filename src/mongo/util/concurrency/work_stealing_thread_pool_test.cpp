@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/init.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/unittest/death_test.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_pool_test_common.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+
+namespace {
+using namespace mongo;
+
+MONGO_INITIALIZER(WorkStealingThreadPoolCommonTests)(InitializerContext*) {
+    addTestsForThreadPool("WorkStealingThreadPoolCommon", []() {
+        return std::make_unique<WorkStealingThreadPool>(ThreadPool::Options());
+    });
+}
+
+ThreadPool::Options makeOptions(size_t numThreads) {
+    ThreadPool::Options options;
+    options.poolName = "WorkStealingThreadPoolTest";
+    options.maxThreads = numThreads;
+    return options;
+}
+
+TEST(WorkStealingThreadPoolTest, StartsAllThreadsAtStartup) {
+    WorkStealingThreadPool pool(makeOptions(4));
+    ASSERT_EQ(0U, pool.getStats().numThreads);
+    pool.startup();
+    auto stats = pool.getStats();
+    ASSERT_EQ(4U, stats.numThreads);
+    ASSERT_EQ(4U, stats.numIdleThreads);
+    ASSERT_EQ(0U, stats.numPendingTasks);
+    pool.shutdown();
+    pool.join();
+}
+
+TEST(WorkStealingThreadPoolTest, WaitForIdleWaitsForAllTasks) {
+    WorkStealingThreadPool pool(makeOptions(4));
+    pool.startup();
+
+    AtomicWord<int> numRun{0};
+    for (int i = 0; i < 1000; ++i) {
+        pool.schedule([&](auto status) {
+            ASSERT_OK(status);
+            numRun.fetchAndAdd(1);
+        });
+    }
+    pool.waitForIdle();
+    ASSERT_EQ(1000, numRun.load());
+    ASSERT_EQ(0U, pool.getStats().numPendingTasks);
+
+    pool.shutdown();
+    pool.join();
+}
+
+TEST(WorkStealingThreadPoolTest, IdleWorkerStealsTasksQueuedBehindLongTask) {
+    WorkStealingThreadPool pool(makeOptions(2));
+    pool.startup();
+
+    auto mutex = MONGO_MAKE_LATCH();
+    stdx::condition_variable cv;
+    int numStolenRun = 0;
+
+    // Tasks scheduled by a task go to the queue of the worker running it, so they can only run
+    // while that task is blocked if the other worker steals them.
+    pool.schedule([&](auto status) {
+        ASSERT_OK(status);
+        for (int i = 0; i < 2; ++i) {
+            pool.schedule([&](auto status) {
+                ASSERT_OK(status);
+                stdx::lock_guard<Latch> lk(mutex);
+                ++numStolenRun;
+                cv.notify_all();
+            });
+        }
+
+        stdx::unique_lock<Latch> lk(mutex);
+        ASSERT(cv.wait_for(lk, Seconds(30).toSystemDuration(), [&] {
+            return numStolenRun == 2;
+        }));
+    });
+
+    pool.waitForIdle();
+    ASSERT_EQ(2, numStolenRun);
+    pool.shutdown();
+    pool.join();
+}
+
+TEST(WorkStealingThreadPoolTest, ThreadPoolWithWorkStealingOptionUsesWorkStealingPool) {
+    auto options = makeOptions(3);
+    options.minThreads = 0;
+    options.workStealing = true;
+    ThreadPool pool(options);
+    pool.startup();
+
+    // Unlike a regular ThreadPool with 'minThreads' of zero, all threads are started up front.
+    ASSERT_EQ(3U, pool.getStats().numThreads);
+
+    AtomicWord<int> numRun{0};
+    for (int i = 0; i < 100; ++i) {
+        pool.schedule([&](auto status) {
+            ASSERT_OK(status);
+            numRun.fetchAndAdd(1);
+        });
+    }
+    pool.waitForIdle();
+    ASSERT_EQ(100, numRun.load());
+
+    pool.shutdown();
+    pool.join();
+    pool.schedule([](auto status) { ASSERT_EQ(status, ErrorCodes::ShutdownInProgress); });
+}
+
+DEATH_TEST_REGEX(WorkStealingThreadPoolTest,
+                 UnlimitedThreadsDies,
+                 "Cannot create work-stealing pool.*unlimited threads") {
+    WorkStealingThreadPool pool(makeOptions(ThreadPool::Options::kUnlimited));
+}
+
+}  // namespace
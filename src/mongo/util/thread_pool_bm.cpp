@@ -0,0 +1,112 @@
+/**
+ *    Copyright (C) 2022-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace {
+
+constexpr int kTasksPerIteration = 10 * 1000;
+
+ThreadPool::Options makeOptions(bool workStealing) {
+    ThreadPool::Options options;
+    options.poolName = "ThreadPoolBenchmark";
+    options.minThreads = ProcessInfo::getNumAvailableCores();
+    options.maxThreads = options.minThreads;
+    options.workStealing = workStealing;
+    return options;
+}
+
+/**
+ * Burns roughly 'n' units of CPU time.
+ */
+MONGO_COMPILER_NOINLINE void spin(int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+        benchmark::DoNotOptimize(i);
+    }
+}
+
+// Many tiny tasks scheduled from outside the pool: measures the cost of the queues themselves.
+void BM_ScheduleTrivialTasks(benchmark::State& state) {
+    ThreadPool pool(makeOptions(state.range(0)));
+    pool.startup();
+
+    for (auto _ : state) {
+        for (int i = 0; i < kTasksPerIteration; ++i) {
+            pool.schedule([](auto status) { benchmark::DoNotOptimize(status); });
+        }
+        pool.waitForIdle();
+    }
+    state.SetItemsProcessed(state.iterations() * kTasksPerIteration);
+
+    pool.shutdown();
+    pool.join();
+}
+
+// One task per thread, each of which fans out into small tasks of very different sizes, like
+// writer vectors of an uneven oplog batch.
+void BM_FanOutUnevenTasks(benchmark::State& state) {
+    ThreadPool pool(makeOptions(state.range(0)));
+    pool.startup();
+    const size_t numThreads = pool.getStats().options.maxThreads;
+
+    AtomicWord<int64_t> numTasksRun{0};
+    for (auto _ : state) {
+        for (size_t thread = 0; thread < numThreads; ++thread) {
+            pool.schedule([&, thread](auto status) {
+                const int numChildren = kTasksPerIteration / numThreads;
+                for (int i = 0; i < numChildren; ++i) {
+                    // Every 64th task is 100 times larger than the others.
+                    const int64_t cost = (i + thread) % 64 == 0 ? 100 * 1000 : 1000;
+                    pool.schedule([&, cost](auto status) {
+                        spin(cost);
+                        numTasksRun.fetchAndAdd(1);
+                    });
+                }
+            });
+        }
+        pool.waitForIdle();
+    }
+    state.SetItemsProcessed(numTasksRun.load());
+
+    pool.shutdown();
+    pool.join();
+}
+
+BENCHMARK(BM_ScheduleTrivialTasks)->ArgName("workStealing")->Arg(0)->Arg(1);
+BENCHMARK(BM_FanOutUnevenTasks)->ArgName("workStealing")->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace mongo